@@ -0,0 +1,43 @@
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+#include <CLI/App.hpp>
+#include <CLI/Formatter.hpp>
+#include <CLI/Config.hpp>
+
+#include <rtac_display/PointOctree.h>
+using namespace rtac::display;
+
+int main(int argc, char** argv)
+{
+    CLI::App app("Builds the octree of the vertices of a .ply file "
+                 "(to be rendered with PointOctreeRenderer).\n"
+                 "The build is done in memory (about 32 bytes per vertex) and is "
+                 "limited to " + std::to_string(PointOctree::MaxBuildPoints)
+                 + " vertices, larger point clouds have to be split in tiles.");
+    std::string input(""), output("");
+    uint32_t maxNodePoints = 32768;
+    unsigned int gridResolution = 128;
+    app.add_option("-i,--input", input, ".ply file to convert")
+        ->required()
+        ->check(CLI::ExistingFile);
+    app.add_option("-o,--output", output, "output octree file (default is <input>.octree)");
+    app.add_option("-n,--max-node-points", maxNodePoints, "maximum number of points in a node");
+    app.add_option("-g,--grid", gridResolution, "resolution of the sampling grid of a node");
+    CLI11_PARSE(app, argc, argv);
+
+    if(output.size() == 0) {
+        output = input + ".octree";
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    PointOctree::build_from_ply(output, input, maxNodePoints, gridResolution);
+    double buildTime = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t0).count();
+
+    cout << *PointOctree::Open(output) << endl;
+    cout << "Built in " << buildTime << "s" << endl;
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <chrono>
 using namespace std;
 
 #include <CLI/App.hpp>
@@ -8,13 +9,8 @@ using namespace std;
 #include <rtac_display/samples/Display3D.h>
 #include <rtac_display/renderers/Frame.h>
 #include <rtac_display/renderers/MeshRenderer.h>
+#include <rtac_display/PlyFile.h>
 using namespace rtac::display;
-using Mesh = MeshRenderer::Mesh;
-
-Mesh::Point operator-(const Mesh::Point& lhs, const Mesh::Point& rhs)
-{
-    return Mesh::Point({lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z});
-}
 
 int main(int argc, char** argv)
 {
@@ -26,27 +22,36 @@ int main(int argc, char** argv)
     CLI11_PARSE(app, argc, argv);
 
     samples::Display3D display;
-    display.add_renderer(Frame::New(Frame::Pose(), display.view()));
-
-    auto mesh = Mesh::from_ply(filename);
-    Mesh::Point min = mesh.points()[0];
-    Mesh::Point max = mesh.points()[0];
-
-    for(const auto& p : mesh.points()) {
-        min.x = std::min(min.x, p.x);
-        min.y = std::min(min.y, p.y);
-        min.z = std::min(min.z, p.z);
-        max.x = std::max(max.x, p.x);
-        max.y = std::max(max.y, p.y);
-        max.z = std::max(max.z, p.z);
+    display.create_renderer<Frame>(display.view());
+
+    size_t fileSize = 0;
+    {
+        auto ply = PlyFile::Open(filename);
+        fileSize = ply->file_size();
+        cout << *ply << endl;
     }
-    cout << "min  : " << min << endl;
-    cout << "max  : " << max << endl;
-    cout << "diff : " << max - min << endl;
 
-    auto meshRenderer = MeshRenderer::New(display.view());
-    meshRenderer->set_mesh(mesh);
-    display.add_renderer(meshRenderer);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    auto mesh = GLMesh::from_ply(filename);
+    glFinish();
+    double loadTime = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t0).count();
+    cout << "Loaded " << mesh->vertex_count() << " points, "
+         << mesh->faces().size() << " faces in " << 1000.0*loadTime << " ms ("
+         << fileSize / (1024.0*1024.0*loadTime) << " MiB/s)" << endl;
+    cout << "bounds : " << mesh->bounds() << endl;
+    if(mesh->bounds().is_infinite()) {
+        cout << "Warning : infinite bounds, the mesh won't be culled." << endl;
+    }
+
+    auto renderer = display.create_renderer<MeshRenderer>(display.view());
+    renderer->mesh() = mesh;
+    if(mesh->normals().size() > 0) {
+        renderer->set_render_mode(MeshRenderer::NormalShading);
+    }
+    else {
+        renderer->set_render_mode(MeshRenderer::Solid);
+    }
     
     while(!display.should_close()) {
         display.draw();
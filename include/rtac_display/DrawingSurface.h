@@ -21,6 +21,10 @@ namespace rtac { namespace display {
  * and inform the renderers of size changes. Being itself a Renderer, it can be
  * nested under other DrawingSurface instances.
  *
+ * Render items entirely outside of the frustum of their view (see
+ * Renderer::world_bounds) are not drawn. The number of drawn and culled items
+ * during the last draw are available for profiling.
+ *
  * This is the base of the Display class which creates its own window.
  */
 class DrawingSurface : public Renderer
@@ -67,6 +71,10 @@ class DrawingSurface : public Renderer
     Color::RGBAf clearColor_;
     Flags        displayFlags_;
 
+    bool         cullingEnabled_;
+    unsigned int drawnCount_;
+    unsigned int culledCount_;
+
     DrawingSurface(const GLContext::Ptr& context, const Shape& shape);
 
     public:
@@ -90,6 +98,12 @@ class DrawingSurface : public Renderer
     void set_clear_color(const Color::RGBAf& color);
     Color::RGBAf clear_color() const;
 
+    void enable_culling()  { cullingEnabled_ = true;  }
+    void disable_culling() { cullingEnabled_ = false; }
+    bool culling_enabled() const { return cullingEnabled_; }
+    unsigned int drawn_count()  const { return drawnCount_;  }
+    unsigned int culled_count() const { return culledCount_; }
+
     void add_display_flags(Flags flags);
     void set_display_flags(Flags flags);
     void remove_display_flags(Flags flags);
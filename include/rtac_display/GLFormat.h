@@ -7,6 +7,8 @@
 
 #include <rtac_base/types/Point.h>
 
+#include <rtac_display/Half.h>
+
 namespace rtac { namespace display {
 
 // These are used to automatically infer GLenum values from custom types
@@ -330,6 +332,46 @@ struct GLFormat<types::Point4<unsigned char>>
     static constexpr GLenum InternalFormat = GL_RGBA;
 };
 
+// Narrow single channel types. Integer types are read as normalized values
+// in [0,1] in the shaders (see normalization_factor).
+template<>
+struct GLFormat<uint16_t>
+{
+    using Scalar = uint16_t;
+
+    static constexpr unsigned int Size  = 1;
+    static constexpr GLenum PixelFormat = GL_RED;
+    static constexpr GLenum Type        = GL_UNSIGNED_SHORT;
+
+    static constexpr GLenum InternalFormat = GL_R16;
+};
+
+template<>
+struct GLFormat<Half>
+{
+    using Scalar = Half;
+
+    static constexpr unsigned int Size  = 1;
+    static constexpr GLenum PixelFormat = GL_RED;
+    static constexpr GLenum Type        = GL_HALF_FLOAT;
+
+    static constexpr GLenum InternalFormat = GL_R16F;
+};
+
+/**
+ * Factor to apply to a value read from a normalized integer texture to
+ * retrieve the original sample value (texture() returns value / max(T) for
+ * unsigned normalized formats). Returns 1 for floating point types.
+ */
+inline float normalization_factor(GLenum scalarType)
+{
+    switch(scalarType) {
+        case GL_UNSIGNED_BYTE:  return 255.0f;
+        case GL_UNSIGNED_SHORT: return 65535.0f;
+        default:                return 1.0f;
+    }
+}
+
 // template <>
 // struct GLFormat<double>
 // {
@@ -1,6 +1,10 @@
 #ifndef _DEF_RTAC_DISPLAY_GL_MESH_H_
 #define _DEF_RTAC_DISPLAY_GL_MESH_H_
 
+#include <vector>
+#include <future>
+#include <functional>
+
 #include <rtac_base/types/Handle.h>
 #include <rtac_base/types/Point.h>
 #include <rtac_base/types/Mesh.h>
@@ -8,9 +12,43 @@
 
 #include <rtac_display/GLFormat.h>
 #include <rtac_display/GLVector.h>
+#include <rtac_display/Half.h>
+#include <rtac_display/views/Frustum.h>
 
 namespace rtac { namespace display {
 
+/**
+ * Mesh data stored in OpenGL buffers.
+ *
+ * By default positions, faces, normals and uvs are stored in separate float
+ * buffers. GLMesh::pack converts the vertex attributes to a single
+ * interleaved buffer, optionally with compressed attribute formats
+ * (quantized positions, octahedral or 10:10:10:2 normals, half float uvs)
+ * which are decoded in the vertex shaders of MeshRenderer. Renderers should
+ * use the attribute descriptions (position_attribute...) which are valid in
+ * both cases.
+ *
+ * GLMesh::split partitions the faces in chunks of at most 65536 vertices
+ * indexed with 16 bits indices (see Chunk). Each chunk has its own bounding
+ * sphere and its triangles are reordered for the post-transform vertex cache.
+ * Preprocessing functions must be called in this order : compute_normals,
+ * split, generate_lods, pack.
+ *
+ * GLMesh::generate_lods builds a chain of simplified versions of the faces
+ * (levels of detail) of the whole mesh or of each chunk if the mesh is split.
+ * The simplification runs on a worker thread, the levels are uploaded on the
+ * rendering thread by update_lods (called by MeshRenderer before drawing).
+ *
+ * A preprocessed mesh can be saved to a binary cache file (save_cache) in
+ * its device layout (packed vertices, chunks and levels of detail included)
+ * and reloaded without any processing (load_cache, from_ply_cached).
+ *
+ * The bounding sphere of the mesh (used for visibility culling) is computed
+ * when the mesh is loaded, split or assigned from a Mesh or PointCloud. It is
+ * infinite (never culled) for a mesh built from its vectors. It is not
+ * updated when the points are modified through points() : call
+ * update_bounds (or invalidate_bounds to disable culling) afterwards.
+ */
 class GLMesh
 {
     public:
@@ -29,6 +67,74 @@ class GLMesh
     static const std::string expandVerticesShader;
     static const std::string computeNormalsShader;
 
+    enum class PositionFormat : uint8_t {
+        Float32     = 0,
+        Quantized16 = 1, // 16 bits per component, relative to the bounding box.
+    };
+    enum class NormalFormat : uint8_t {
+        Float32       = 0,
+        Octahedral16  = 1, // octahedral encoding, 2x16 bits signed normalized.
+        Snorm10_10_10 = 2, // xyz in GL_INT_2_10_10_10_REV.
+    };
+    enum class UVFormat : uint8_t {
+        Float32 = 0,
+        Half    = 1,
+    };
+
+    struct VertexFormat {
+        PositionFormat position;
+        NormalFormat   normal;
+        UVFormat       uv;
+
+        static VertexFormat Float32() {
+            return VertexFormat({PositionFormat::Float32, NormalFormat::Float32,
+                                 UVFormat::Float32});
+        }
+        // 16 bytes per vertex with normals and uvs (positions are padded to
+        // 4x16 bits to keep the attributes 4 bytes aligned), 32 in Float32.
+        static VertexFormat Compact() {
+            return VertexFormat({PositionFormat::Quantized16,
+                                 NormalFormat::Octahedral16, UVFormat::Half});
+        }
+    };
+
+    /**
+     * A range of 16 bits indices in chunk_indices(). Indices are relative to
+     * baseVertex (to be used with glDrawElementsBaseVertex).
+     */
+    struct Chunk {
+        size_t   indexOffset; // in indices, not bytes.
+        uint32_t indexCount;
+        int32_t  baseVertex;
+        uint32_t vertexCount;
+        BoundingSphere bounds; // in mesh coordinates
+    };
+    static constexpr unsigned int MaxChunkVertices = 65536;
+
+    /**
+     * A simplified level of the faces of a chunk (in lod_chunk_indices(), 16
+     * bits indices relative to the chunk baseVertex) or of the whole mesh if
+     * it is not split (in lod_indices(), 32 bits indices). error is the
+     * geometric error of the level, in mesh coordinates units.
+     */
+    struct Lod {
+        size_t   indexOffset; // in indices, not bytes.
+        uint32_t indexCount;
+        float    error;
+    };
+
+    /**
+     * Description of a vertex attribute, as expected by glVertexAttribPointer.
+     */
+    struct VertexAttribute {
+        GLuint    buffer; // 0 if the attribute is not available.
+        GLint     size;
+        GLenum    type;
+        GLboolean normalized;
+        GLsizei   stride;
+        size_t    offset;
+    };
+
     protected:
     
     GLVector<Point>  points_;
@@ -36,11 +142,45 @@ class GLMesh
     GLVector<Normal> normals_;
     GLVector<UV>     uvs_;
 
+    // Interleaved vertices (see pack)
+    GLVector<uint8_t> vertices_;
+    VertexFormat      format_;
+    size_t            packedCount_;
+    bool              packedNormals_;
+    bool              packedUVs_;
+    unsigned int      stride_;
+    unsigned int      normalOffset_;
+    unsigned int      uvOffset_;
+    Point             positionOffset_;
+    Point             positionScale_;
+
+    // 16 bits indices (see split)
+    GLVector<uint16_t> chunkIndices_;
+    std::vector<Chunk> chunks_;
+
+    BoundingSphere bounds_;
+
+    // Levels of detail (see generate_lods). They are mutable because they
+    // are finalized on the rendering thread by update_lods.
+    struct LodData {
+        std::vector<std::vector<Lod>> lods;
+        std::vector<uint32_t>         indices;
+    };
+    mutable std::vector<std::vector<Lod>> lods_; // one chain per chunk
+    mutable GLVector<uint32_t>            lodIndices_;
+    mutable GLVector<uint16_t>            lodChunkIndices_;
+    mutable std::future<LodData>          pendingLods_;
+
+    static LodData build_lods(std::vector<Point> points,
+                              std::vector<uint32_t> indices,
+                              std::vector<Chunk> chunks,
+                              unsigned int levelCount, float reduction);
+
     public:
 
     static Ptr Create() { return Ptr(new GLMesh()); }
 
-    GLMesh() {}
+    GLMesh();
     GLMesh(GLMesh&& other);
     GLMesh& operator=(GLMesh&& other);
 
@@ -64,13 +204,74 @@ class GLMesh
     void compute_normals();
     void expand_vertices();
 
+    void pack(const VertexFormat& format = VertexFormat::Compact(),
+              bool keepAttributes = false);
+    bool is_packed() const { return vertices_.size() > 0; }
+    const VertexFormat&      vertex_format() const { return format_;   }
+    const GLVector<uint8_t>& vertices()      const { return vertices_; }
+    unsigned int             vertex_stride() const { return stride_;   }
+
+    size_t vertex_count() const;
+    bool   has_normals()  const;
+    bool   has_uvs()      const;
+    size_t memory_size()  const;
+
+    VertexAttribute position_attribute() const;
+    VertexAttribute normal_attribute()   const;
+    VertexAttribute uv_attribute()       const;
+    Point position_offset() const { return positionOffset_; }
+    Point position_scale()  const { return positionScale_;  }
+
+    void split(unsigned int maxVertices = MaxChunkVertices, bool keepFaces = false);
+    bool is_split() const { return chunks_.size() > 0; }
+    const std::vector<Chunk>&  chunks()        const { return chunks_;       }
+    const GLVector<uint16_t>&  chunk_indices() const { return chunkIndices_; }
+
+    void generate_lods(unsigned int levelCount = 4, float reduction = 0.25f);
+    bool update_lods() const;
+    void wait_lods() const;
+    void clear_lods();
+    bool lods_pending() const { return pendingLods_.valid(); }
+    unsigned int lod_count() const;
+    const std::vector<Lod>&   lods(size_t chunk = 0) const;
+    const GLVector<uint32_t>& lod_indices()       const { return lodIndices_;      }
+    const GLVector<uint16_t>& lod_chunk_indices() const { return lodChunkIndices_; }
+
+    const BoundingSphere& bounds() const { return bounds_; }
+    void update_bounds();
+    void invalidate_bounds() { bounds_ = BoundingSphere::Infinite(); }
+    static BoundingSphere compute_bounds(const Point* points, size_t count);
+
     static Ptr cube(float scale = 1.0f);
     static Ptr icosahedron(float scale = 1.0f);
     static Ptr cube_with_uvs(float scale = 1.0f);
     static Ptr from_ply(const std::string& path,
                         bool transposeUVs = false);
+
+    static constexpr uint32_t CacheVersion = 1;
+    void save_cache(const std::string& path, uint64_t sourceHash = 0,
+                    bool compress = false) const;
+    static Ptr  load_cache(const std::string& path, uint64_t sourceHash = 0);
+    static bool cache_valid(const std::string& path, uint64_t sourceHash = 0);
+    static bool cache_compression_available();
+    static Ptr  from_ply_cached(const std::string& plyPath,
+                                const std::string& cachePath = "",
+                                const std::function<void(GLMesh&)>& preprocess = nullptr,
+                                bool compress = false);
 };
 
+inline GLMesh::GLMesh() :
+    format_(VertexFormat::Float32()),
+    packedCount_(0),
+    packedNormals_(false),
+    packedUVs_(false),
+    stride_(0),
+    normalOffset_(0),
+    uvOffset_(0),
+    positionOffset_({0.0f,0.0f,0.0f}),
+    positionScale_({1.0f,1.0f,1.0f})
+{}
+
 inline GLMesh::GLMesh(GLMesh&& other) :
     GLMesh()
 {
@@ -84,6 +285,26 @@ inline GLMesh& GLMesh::operator=(GLMesh&& other)
     normals_  = std::move(other.normals_);
     uvs_      = std::move(other.uvs_);
 
+    vertices_       = std::move(other.vertices_);
+    format_         = other.format_;
+    packedCount_    = other.packedCount_;
+    packedNormals_  = other.packedNormals_;
+    packedUVs_      = other.packedUVs_;
+    stride_         = other.stride_;
+    normalOffset_   = other.normalOffset_;
+    uvOffset_       = other.uvOffset_;
+    positionOffset_ = other.positionOffset_;
+    positionScale_  = other.positionScale_;
+
+    chunkIndices_ = std::move(other.chunkIndices_);
+    chunks_       = std::move(other.chunks_);
+    bounds_       = other.bounds_;
+
+    lods_            = std::move(other.lods_);
+    lodIndices_      = std::move(other.lodIndices_);
+    lodChunkIndices_ = std::move(other.lodChunkIndices_);
+    pendingLods_     = std::move(other.pendingLods_);
+
     return *this;
 }
 
@@ -101,6 +322,11 @@ GLMesh& GLMesh::operator=(const types::Mesh<Point,Face,Normal,UV,VectorT>& other
     faces_   = other.faces();
     normals_ = other.normals();
     uvs_     = other.uvs();
+    vertices_.resize(0); // not packed anymore
+    chunkIndices_.resize(0);
+    chunks_.clear();
+    this->clear_lods();
+    this->update_bounds();
 
     return *this;
 }
@@ -112,6 +338,10 @@ GLMesh& GLMesh::operator=(const types::PointCloud<T>& pointcloud)
     faces_.resize(0);
     normals_.resize(0);
     uvs_.resize(0);
+    vertices_.resize(0);
+    chunkIndices_.resize(0);
+    chunks_.clear();
+    this->clear_lods();
 
     auto p = points_.map();
     for(int i = 0; i < points_.size(); i++) {
@@ -119,6 +349,7 @@ GLMesh& GLMesh::operator=(const types::PointCloud<T>& pointcloud)
         p[i].y = pointcloud[i].y;
         p[i].z = pointcloud[i].z;
     }
+    bounds_ = compute_bounds(p, points_.size());
 
     return *this;
 }
@@ -155,6 +386,7 @@ inline void GLMesh::compute_normals()
 inline void GLMesh::expand_vertices()
 {
     if(faces_.size() == 0) return;
+    this->clear_lods();
 
     static const GLuint computeProgram = create_compute_program(expandVerticesShader);
     glUseProgram(computeProgram);
@@ -223,7 +455,7 @@ inline GLMesh::Ptr GLMesh::cube_with_uvs(float scale) {
     Ptr mesh(new GLMesh(*BaseMesh::cube(scale)));
     mesh->compute_normals();
 
-    std::vector<UV> uvs(mesh->points().size());
+    std::vector<UV> uvs(mesh->vertex_count());
 
     for(int i = 0; i < 36; i+=6) {
         uvs[i]     = UV({0.0,0.0});
@@ -238,86 +470,6 @@ inline GLMesh::Ptr GLMesh::cube_with_uvs(float scale) {
     return mesh;
 }
 
-inline GLMesh::Ptr GLMesh::from_ply(const std::string& path, bool transposeUVs)
-{
-    std::ifstream f(path, std::ios::binary | std::ios::in);
-    if(!f.is_open()) {
-        throw std::runtime_error(
-            "PointCloud::from_ply : could not open file for reading " + path);
-    }
-    happly::PLYData data(f);
-    
-    if(!data.hasElement("vertex")) {
-        throw std::runtime_error(
-            "Invalid ply file : No vertex defined in \"" + path + "\"");
-    }
-
-    auto mesh = Create();
-    {
-        // Loading vertices
-        auto x = data.getElement("vertex").getProperty<float>("x");
-        auto y = data.getElement("vertex").getProperty<float>("y");
-        auto z = data.getElement("vertex").getProperty<float>("z");
-
-        mesh->points().resize(x.size());
-        auto ptr = mesh->points().map();
-        Point* data = ptr;
-        for(int i = 0; i < x.size(); i++) {
-            data[i].x = x[i];
-            data[i].y = y[i];
-            data[i].z = z[i];
-        }
-    }
-
-    if(data.hasElement("face")) {
-        // Loading faces
-        std::vector<std::string> names({"vertex_indices", "vertex_index"});
-        std::vector<std::vector<uint32_t>> f;
-        for(auto& name : names) {
-            try {
-                f = data.getElement("face").getListPropertyAnySign<uint32_t>(name);
-                break;
-            }
-            catch(const std::runtime_error& e) {
-                // wrong face index name, trying another
-            }
-        }
-        
-        mesh->faces().resize(f.size());
-        auto ptr = mesh->faces().map();
-        Face* data = ptr;
-        for(int i = 0; i < f.size(); i++) {
-            data[i].x = f[i][0];
-            data[i].y = f[i][1];
-            data[i].z = f[i][2];
-        }
-    }
-
-    if(data.hasElement("texCoords")) {
-        // Loading texture coordinates
-        auto x = data.getElement("texCoords").getProperty<float>("x");
-        auto y = data.getElement("texCoords").getProperty<float>("y");
-
-        mesh->uvs().resize(x.size());
-        auto ptr = mesh->uvs().map();
-        UV* data = ptr;
-        if(transposeUVs) {
-            for(int i = 0; i < x.size(); i++) {
-                data[i].x = y[i];
-                data[i].y = x[i];
-            }
-        }
-        else {
-            for(int i = 0; i < x.size(); i++) {
-                data[i].x = x[i];
-                data[i].y = y[i];
-            }
-        }
-    }
-    
-    return mesh;
-}
-
 }; //namespace display
 }; //namespace rtac
 
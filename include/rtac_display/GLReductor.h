@@ -17,6 +17,11 @@ namespace rtac { namespace display {
  * GLVectors (finding extrema, sum, product of data arrays...).
  *
  * This class use compute shaders to compute the reductions.
+ *
+ * Narrow scalar types (uint8_t, uint16_t and Half) cannot be addressed
+ * directly in a GLSL buffer. They are first expanded to float with
+ * GLReductor::unpack before the reduction (GLReductor::min_value and
+ * GLReductor::max_value do this automatically).
  */
 class GLReductor
 {
@@ -30,6 +35,10 @@ class GLReductor
     static const std::string SubOperatorShader;
     static const std::string MinOperatorShader;
     static const std::string MaxOperatorShader;
+    static const std::string UnpackShader;
+    static const std::string UnpackU8Function;
+    static const std::string UnpackU16Function;
+    static const std::string UnpackHalfFunction;
 
     static constexpr const char*  Typename  = "Typename";
     static constexpr unsigned int BlockSize = 256;
@@ -44,6 +53,7 @@ class GLReductor
     
     mutable std::unordered_map<std::string,GLuint> programs_;
     mutable GLVector<uint8_t> tmpData_;
+    mutable GLVector<float>   unpacked_;
 
     public:
 
@@ -62,6 +72,14 @@ class GLReductor
     GLuint sub_program(const std::string& glslType) const;
     GLuint min_program(const std::string& glslType) const;
     GLuint max_program(const std::string& glslType) const;
+    GLuint unpack_program(GLenum scalarType) const;
+
+    template <typename T>
+    const GLVector<float>& unpack(const GLVector<T>& input) const;
+    template <typename T> float min_value(const GLVector<T>& input) const;
+    template <typename T> float max_value(const GLVector<T>& input) const;
+    float min_value(const GLVector<float>& input) const { return this->min(input); }
+    float max_value(const GLVector<float>& input) const { return this->max(input); }
 
     // Below are helper function. Nothing special.
     template <typename T> GLuint sum_program() const {
@@ -116,6 +134,66 @@ T GLReductor::reduce(const GLVector<T>& input, GLuint reductionProgram) const
     return res;
 }
 
+/**
+ * Expands a buffer of narrow scalars (uint8_t, uint16_t or Half) to float.
+ * Integer values are not normalized (a uint8_t 255 becomes 255.0f).
+ *
+ * @return a reference to an internal buffer, valid until the next call.
+ */
+template <typename T>
+const GLVector<float>& GLReductor::unpack(const GLVector<T>& input) const
+{
+    static_assert(sizeof(T) < 4, "GLReductor::unpack is meant for narrow types");
+
+    // always resized : the reductions run on unpacked_.size() elements.
+    unsigned int N = input.size();
+    unpacked_.resize(N);
+    if(N == 0) {
+        return unpacked_;
+    }
+
+    GLuint program = this->unpack_program(GLFormat<T>::Type);
+    glUseProgram(program);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, input.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, unpacked_.gl_id());
+
+    glUniform1ui(0, N);
+    glDispatchCompute((N + BlockSize - 1) / BlockSize, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+    glUseProgram(0);
+    GL_CHECK_LAST();
+
+    return unpacked_;
+}
+
+/**
+ * Minimum of input as a float. Narrow types are unpacked first.
+ */
+template <typename T>
+float GLReductor::min_value(const GLVector<T>& input) const
+{
+    const auto& unpacked = this->unpack(input);
+    reduce(unpacked, this->min_program<float>(), tmpData_);
+    auto p = tmpData_.map();
+    return reinterpret_cast<const float*>(&p[0])[0];
+}
+
+/**
+ * Maximum of input as a float. Narrow types are unpacked first.
+ */
+template <typename T>
+float GLReductor::max_value(const GLVector<T>& input) const
+{
+    const auto& unpacked = this->unpack(input);
+    reduce(unpacked, this->max_program<float>(), tmpData_);
+    auto p = tmpData_.map();
+    return reinterpret_cast<const float*>(&p[0])[0];
+}
+
 inline GLuint GLReductor::program(const std::string& glslType, const std::string& op) const
 {
     auto it = programs_.find(this->key(glslType, op));
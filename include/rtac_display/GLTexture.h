@@ -28,7 +28,9 @@ namespace rtac { namespace display {
  * infered from the input data type at compile-time through the use of the
  * GLFormat structure.
  *
- * For now pixel data is stored as float32 only.
+ * Narrow scalar types (uint8_t, uint16_t and Half) are stored natively (R8,
+ * R16 and R16F) instead of being expanded to float32. Integer types are read
+ * as normalized values in the shaders (see normalization_factor).
  */
 class GLTexture
 {
@@ -54,6 +56,7 @@ class GLTexture
     Shape  shape_;
     GLuint texId_;
     GLint  format_;
+    GLenum scalarType_;
 
     void init_texture();
     void delete_texture();
@@ -76,6 +79,7 @@ class GLTexture
     Shape  shape()  const;
     GLuint gl_id()  const;
     GLint  format() const;
+    GLenum scalar_type() const;
     size_t width() const;
     size_t height() const;
 
@@ -91,6 +95,9 @@ class GLTexture
     template <typename T>
     void set_image(const Rect& shape, const GLVector<T>& data);
 
+    template <typename T>
+    static GLint unpack_alignment(size_t width);
+
     void bind(GLenum target = GL_TEXTURE_2D);
     void unbind(GLenum target = GL_TEXTURE_2D);
     
@@ -129,7 +136,8 @@ class GLTexture
 template <typename T>
 void GLTexture::resize(const Shape& shape)
 {
-    format_ = GLFormat<T>::PixelFormat;
+    format_     = GLFormat<T>::PixelFormat;
+    scalarType_ = GLFormat<T>::Type;
 
     // ensuring no buffer bound to GL_PIXEL_UNPACK_BUFFER for data to be read
     // from CPU side memory.
@@ -160,12 +168,16 @@ void GLTexture::set_image(const Shape& shape,
     // ensuring no buffer bound to GL_PIXEL_UNPACK_BUFFER for data to be read
     // from CPU side memory.
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment<T>(shape.width));
 
     glBindTexture(GL_TEXTURE_2D, texId_);
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, shape.width, shape.height,
         0, pixelFormat, scalarType, data);
     GL_CHECK_LAST();
     glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    scalarType_ = scalarType;
 
     shape_ = shape;
 }
@@ -184,17 +196,20 @@ template <typename T>
 void GLTexture::set_image(const Shape& shape, const T* data)
 {
     format_ = GLFormat<T>::PixelFormat;
+    scalarType_ = GLFormat<T>::Type;
     using Format = GLFormat<T>;
 
     // ensuring no buffer bound to GL_PIXEL_UNPACK_BUFFER for data to be read
     // from CPU side memory.
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment<T>(shape.width));
 
     glBindTexture(GL_TEXTURE_2D, texId_);
     glTexImage2D(GL_TEXTURE_2D, 0, Format::InternalFormat, shape.width, shape.height,
         0, Format::PixelFormat, Format::Type, data);
     GL_CHECK_LAST();
     glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
     shape_ = shape;
 }
@@ -217,10 +232,12 @@ void GLTexture::set_image(const Shape& shape, const GLVector<T>& data)
     }
     using Format = GLFormat<T>;
     format_ = GLFormat<T>::PixelFormat;
+    scalarType_ = GLFormat<T>::Type;
 
     // ensuring no buffer bound to GL_PIXEL_UNPACK_BUFFER for data to be read
     // from CPU side memory.
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, data.gl_id());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment<T>(shape.width));
 
     glBindTexture(GL_TEXTURE_2D, texId_);
     glTexImage2D(GL_TEXTURE_2D, 0, Format::InternalFormat, shape.width, shape.height,
@@ -228,6 +245,7 @@ void GLTexture::set_image(const Shape& shape, const GLVector<T>& data)
     GL_CHECK_LAST();
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
     shape_ = shape;
 }
@@ -251,10 +269,12 @@ void GLTexture::set_image(const Rect& rect, const GLVector<T>& data)
     }
     using Format = GLFormat<T>;
     format_ = GLFormat<T>::PixelFormat;
+    scalarType_ = GLFormat<T>::Type;
 
     // ensuring no buffer bound to GL_PIXEL_UNPACK_BUFFER for data to be read
     // from CPU side memory.
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, data.gl_id());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment<T>(rect.width()));
 
     glBindTexture(GL_TEXTURE_2D, texId_);
     glTexSubImage2D(GL_TEXTURE_2D, 0,
@@ -264,6 +284,18 @@ void GLTexture::set_image(const Rect& rect, const GLVector<T>& data)
     GL_CHECK_LAST();
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/**
+ * Row alignment of tightly packed pixel data of type T (OpenGL assumes rows
+ * to be 4-bytes aligned by default, which is not the case for narrow types
+ * and odd widths).
+ */
+template <typename T>
+GLint GLTexture::unpack_alignment(size_t width)
+{
+    return (width*sizeof(T)) % 4 == 0 ? 4 : 1;
 }
 
 inline void GLTexture::set_filter_mode(FilterMode mode)
@@ -0,0 +1,159 @@
+#ifndef _DEF_RTAC_DISPLAY_GL_TEXTURE_ARRAY_H_
+#define _DEF_RTAC_DISPLAY_GL_TEXTURE_ARRAY_H_
+
+#include <utility>
+
+#include <GL/glew.h>
+#include <GL/gl.h>
+
+#include <rtac_base/types/Handle.h>
+
+#include <rtac_display/utils.h>
+#include <rtac_display/GLFormat.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/GLTexture.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Helper class to manipulate OpenGL 2D array textures (GL_TEXTURE_2D_ARRAY).
+ *
+ * All layers have the same size and format. Layers can be updated
+ * individually, which makes this type suitable for ring buffers of images
+ * (history of sensor data...) where only one layer is uploaded per update.
+ *
+ * As for GLTexture, the pixel format is infered from the input data type
+ * through the GLFormat structure.
+ */
+class GLTextureArray
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<GLTextureArray>;
+    using ConstPtr = rtac::types::Handle<const GLTextureArray>;
+
+    using WrapMode   = GLTexture::WrapMode;
+    using FilterMode = GLTexture::FilterMode;
+
+    protected:
+
+    Shape        shape_;
+    unsigned int depth_;
+    GLuint       texId_;
+    GLint        format_;
+
+    void init_texture();
+    void delete_texture();
+
+    public:
+
+    static Ptr New();
+
+    GLTextureArray();
+    ~GLTextureArray();
+
+    // disallowing copy but authorizing ressource move
+    GLTextureArray(const GLTextureArray&)            = delete;
+    GLTextureArray& operator=(const GLTextureArray&) = delete;
+
+    GLTextureArray(GLTextureArray&& other);
+    GLTextureArray& operator=(GLTextureArray&& other);
+
+    Shape        shape()  const { return shape_;  }
+    unsigned int depth()  const { return depth_;  }
+    GLuint       gl_id()  const { return texId_;  }
+    GLint        format() const { return format_; }
+    size_t       width()  const { return shape_.width;  }
+    size_t       height() const { return shape_.height; }
+
+    void resize(const Shape& shape, unsigned int depth, GLint internalFormat,
+                GLenum pixelFormat, GLenum scalarType);
+    template <typename T>
+    void resize(const Shape& shape, unsigned int depth);
+
+    template <typename T>
+    void set_layer(unsigned int layer, const T* data);
+    template <typename T>
+    void set_layer(unsigned int layer, const GLVector<T>& data);
+
+    void bind(GLenum target = GL_TEXTURE_2D_ARRAY) const;
+    void unbind(GLenum target = GL_TEXTURE_2D_ARRAY) const;
+
+    void set_filter_mode(FilterMode mode);
+    void set_wrap_mode(WrapMode xyWrap);
+};
+
+/**
+ * Allocates the texture array without data initialization. The pixel format
+ * is infered from T.
+ *
+ * @param shape dimensions of each layer {width,height}.
+ * @param depth number of layers.
+ */
+template <typename T>
+void GLTextureArray::resize(const Shape& shape, unsigned int depth)
+{
+    using Format = GLFormat<T>;
+    this->resize(shape, depth, Format::InternalFormat,
+                 Format::PixelFormat, Format::Type);
+}
+
+/**
+ * Uploads a single layer from host memory (other layers are untouched).
+ *
+ * @param layer index of the layer to update.
+ * @param data  shape().area() pixels.
+ */
+template <typename T>
+void GLTextureArray::set_layer(unsigned int layer, const T* data)
+{
+    if(layer >= depth_) {
+        throw std::out_of_range("GLTextureArray : layer index out of range.");
+    }
+    using Format = GLFormat<T>;
+
+    // ensuring no buffer bound to GL_PIXEL_UNPACK_BUFFER for data to be read
+    // from CPU side memory.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texId_);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+                    shape_.width, shape_.height, 1,
+                    Format::PixelFormat, Format::Type, data);
+    GL_CHECK_LAST();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+/**
+ * Uploads a single layer from an OpenGL Buffer Object (device to device
+ * copy).
+ *
+ * @param layer index of the layer to update.
+ * @param data  GLVector containing at least shape().area() pixels.
+ */
+template <typename T>
+void GLTextureArray::set_layer(unsigned int layer, const GLVector<T>& data)
+{
+    if(layer >= depth_) {
+        throw std::out_of_range("GLTextureArray : layer index out of range.");
+    }
+    if(shape_.area() > data.size()) {
+        throw std::runtime_error("Too few data for requested texture size");
+    }
+    using Format = GLFormat<T>;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, data.gl_id());
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texId_);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+                    shape_.width, shape_.height, 1,
+                    Format::PixelFormat, Format::Type, 0);
+    GL_CHECK_LAST();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_GL_TEXTURE_ARRAY_H_
@@ -76,6 +76,9 @@ class GLVector
     GLVector& operator=(GLVector<T>&& other);
     GLVector& operator=(const std::vector<T>& other);
     void set_data(unsigned int size, const T* data);
+    void set_sub_data(size_t offset, size_t count, const T* data);
+    void copy_sub_data(size_t offset, const GLVector<T>& src,
+                       size_t srcOffset, size_t count);
     
     template <template <typename> class VectorT>
     void copy_to(VectorT<T>& other) const;
@@ -310,6 +313,55 @@ void GLVector<T>::set_data(unsigned int size, const T* data)
     this->unbind(GL_ARRAY_BUFFER);
 }
 
+/**
+ * Copy data from host memory into a sub-range of the vector (no
+ * reallocation, only count elements are uploaded).
+ *
+ * @param offset index of the first element to write.
+ * @param count  number of elements to copy.
+ * @param data   Host memory pointer to the data to be copied.
+ */
+template <typename T>
+void GLVector<T>::set_sub_data(size_t offset, size_t count, const T* data)
+{
+    if(count == 0) return;
+    if(offset + count > this->size()) {
+        throw std::runtime_error("GLVector::set_sub_data : range out of bounds.");
+    }
+
+    this->bind(GL_ARRAY_BUFFER);
+    glBufferSubData(GL_ARRAY_BUFFER, offset*sizeof(T), count*sizeof(T), data);
+    this->unbind(GL_ARRAY_BUFFER);
+}
+
+/**
+ * Copy a sub-range of another GLVector into a sub-range of this vector (no
+ * reallocation, copy happens solely on the device).
+ *
+ * @param offset    index of the first element to write.
+ * @param src       GLVector to copy from.
+ * @param srcOffset index of the first element to read in src.
+ * @param count     number of elements to copy.
+ */
+template <typename T>
+void GLVector<T>::copy_sub_data(size_t offset, const GLVector<T>& src,
+                                size_t srcOffset, size_t count)
+{
+    if(count == 0) return;
+    if(offset + count > this->size() || srcOffset + count > src.size()) {
+        throw std::runtime_error("GLVector::copy_sub_data : range out of bounds.");
+    }
+
+    src.bind(GL_COPY_READ_BUFFER);
+    this->bind(GL_COPY_WRITE_BUFFER);
+
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                        srcOffset*sizeof(T), offset*sizeof(T), count*sizeof(T));
+
+    this->unbind(GL_COPY_WRITE_BUFFER);
+    src.unbind(GL_COPY_READ_BUFFER);
+}
+
 /**
  * Copy data to client memory (host memory in CUDA terminology)
  *
@@ -343,6 +395,10 @@ void GLVector<T>::copy_to(T* dst) const
 /**
  * Reallocate data on the device.
  *
+ * The allocated size is rounded up to a multiple of 4 bytes so that shaders
+ * reading narrow types (uint8_t, uint16_t...) as 32-bit words never read past
+ * the end of the buffer.
+ *
  * An OpenGL context must have been created beforehand.
  *
  * @param size Number of elements to allocate.
@@ -353,7 +409,7 @@ void GLVector<T>::allocate(size_t size)
     if(!bufferId_)
         glGenBuffers(1, &bufferId_);
     this->bind();
-    glBufferData(GL_ARRAY_BUFFER, size*sizeof(T), NULL, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, (size*sizeof(T) + 3) & ~(size_t)3, NULL, GL_STATIC_DRAW);
     this->unbind();
 }
 
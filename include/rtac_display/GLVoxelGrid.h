@@ -0,0 +1,111 @@
+#ifndef _DEF_RTAC_DISPLAY_GL_VOXEL_GRID_H_
+#define _DEF_RTAC_DISPLAY_GL_VOXEL_GRID_H_
+
+#include <iostream>
+#include <vector>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Point.h>
+
+#include <rtac_display/utils.h>
+#include <rtac_display/GLVector.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Voxel grid decimation of point clouds on the GPU (compute shaders).
+ *
+ * The space is divided in cubic voxels of a given size and a single point is
+ * kept for each occupied voxel :
+ * - Mode::First        : the point with the lowest index in the voxel.
+ * - Mode::Centroid     : the mean of the points of the voxel.
+ * - Mode::MaxIntensity : the point with the highest intensity (float per
+ *                        point attribute) in the voxel.
+ *
+ * The occupied voxels are inserted in a hash table with open addressing (the
+ * table stores the index of the first point inserted in each voxel, so the
+ * voxel coordinates are never truncated). The kept points are flagged, the
+ * flags are scanned (exclusive prefix sum) and the kept points are written
+ * at their scanned index. The output keeps the order of the input points.
+ *
+ * The hash table has two slots per input point (rounded up to a power of
+ * 2), so the decimation cannot fail whatever the voxel size and the load
+ * factor stays below 0.5. The temporary buffers are kept between calls.
+ *
+ * Narrow intensity types can be expanded to float with GLReductor::unpack.
+ */
+class GLVoxelGrid
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<GLVoxelGrid>;
+    using ConstPtr = rtac::types::Handle<const GLVoxelGrid>;
+
+    using Point = rtac::types::Point3<float>;
+
+    enum class Mode : unsigned int {
+        First        = 0,
+        Centroid     = 1,
+        MaxIntensity = 2,
+    };
+
+    static const std::string CommonShader;
+    static const std::string InsertShader;
+    static const std::string SelectShader;
+    static const std::string FlagShader;
+    static const std::string ScatterShader;
+    static const std::string ScanShader;
+    static const std::string AddOffsetsShader;
+
+    static constexpr unsigned int BlockSize = 256;
+
+    protected:
+
+    mutable GLuint insertProgram_;
+    mutable GLuint selectProgram_;
+    mutable GLuint flagProgram_;
+    mutable GLuint scatterProgram_;
+    mutable GLuint scanProgram_;
+    mutable GLuint addOffsetsProgram_;
+
+    mutable GLVector<uint32_t> voxelPoints_; // first point inserted + 1 (0 : empty)
+    mutable GLVector<uint32_t> voxelOwners_; // ~(index of the kept point)
+    mutable GLVector<uint32_t> voxelMax_;    // ordered bits of the max intensity
+    mutable GLVector<uint32_t> voxelSums_;   // count and fixed point sums
+    mutable GLVector<uint32_t> offsets_;
+    mutable GLVector<uint32_t> keptCount_;
+    mutable std::vector<GLVector<uint32_t>> blockSums_;
+    mutable GLVector<uint32_t> dummy_;
+
+    void   build_programs() const;
+    static void dispatch(size_t blockCount);
+    void   scan(GLVector<uint32_t>& data, size_t size, unsigned int level = 0) const;
+    size_t run(const GLVector<Point>& input, const GLVector<float>* intensities,
+               float voxelSize, Mode mode,
+               GLVector<Point>* output, GLVector<uint32_t>* indices) const;
+
+    public:
+
+    GLVoxelGrid();
+    ~GLVoxelGrid();
+
+    GLVoxelGrid(const GLVoxelGrid&)            = delete;
+    GLVoxelGrid& operator=(const GLVoxelGrid&) = delete;
+
+    size_t decimate(const GLVector<Point>& input, float voxelSize,
+                    GLVector<Point>& output, Mode mode = Mode::First) const;
+    size_t decimate(const GLVector<Point>& input, const GLVector<float>& intensities,
+                    float voxelSize, GLVector<Point>& output) const;
+
+    size_t select(const GLVector<Point>& input, float voxelSize,
+                  GLVector<uint32_t>& indices) const;
+    size_t select(const GLVector<Point>& input, const GLVector<float>& intensities,
+                  float voxelSize, GLVector<uint32_t>& indices) const;
+};
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, rtac::display::GLVoxelGrid::Mode mode);
+
+#endif //_DEF_RTAC_DISPLAY_GL_VOXEL_GRID_H_
@@ -0,0 +1,112 @@
+#ifndef _DEF_RTAC_DISPLAY_HALF_H_
+#define _DEF_RTAC_DISPLAY_HALF_H_
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+namespace rtac { namespace display {
+
+/**
+ * IEEE 754 half precision (binary16) floating point value.
+ *
+ * This is only a storage type : it allows half precision data to be uploaded
+ * to OpenGL (see GLFormat<Half>) and converted from / to float on the host
+ * side. No arithmetic is implemented.
+ */
+struct Half
+{
+    uint16_t bits;
+
+    Half() = default;
+    Half(float value) : bits(from_float(value)) {}
+
+    operator float() const { return to_float(bits); }
+
+    static uint16_t from_float(float value);
+    static float    to_float(uint16_t bits);
+};
+
+/**
+ * Converts a float to half precision (round to nearest even). Values out of
+ * the half range are converted to infinity, NaN stays NaN.
+ */
+inline uint16_t Half::from_float(float value)
+{
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+
+    uint32_t sign     = (f >> 16) & 0x8000;
+    uint32_t exponent = (f >> 23) & 0xff;
+    uint32_t mantissa = f & 0x007fffff;
+
+    if(exponent == 0xff) { // inf or NaN
+        return sign | 0x7c00 | (mantissa ? 0x0200 : 0);
+    }
+
+    int e = (int)exponent - 127 + 15;
+    if(e >= 0x1f) { // overflow
+        return sign | 0x7c00;
+    }
+    if(e <= 0) { // subnormal half or zero
+        if(e < -10)
+            return sign;
+        mantissa |= 0x00800000;
+        uint32_t shift = 14 - e;
+        uint32_t res   = mantissa >> shift;
+        uint32_t rest  = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if(rest > halfway || (rest == halfway && (res & 1)))
+            res++;
+        return sign | res;
+    }
+
+    uint32_t res  = (e << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if(rest > 0x1000 || (rest == 0x1000 && (res & 1)))
+        res++; // may carry into exponent, which is the expected behavior.
+    return sign | res;
+}
+
+inline float Half::to_float(uint16_t bits)
+{
+    uint32_t sign     = (uint32_t)(bits & 0x8000) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1f;
+    uint32_t mantissa = bits & 0x03ff;
+
+    uint32_t f;
+    if(exponent == 0x1f) { // inf or NaN
+        f = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else if(exponent == 0) {
+        if(mantissa == 0) {
+            f = sign;
+        }
+        else { // subnormal half, normalizing
+            int e = -1;
+            do {
+                e++;
+                mantissa <<= 1;
+            } while((mantissa & 0x0400) == 0);
+            f = sign | ((127 - 15 - e) << 23) | ((mantissa & 0x03ff) << 13);
+        }
+    }
+    else {
+        f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float res;
+    std::memcpy(&res, &f, sizeof(res));
+    return res;
+}
+
+}; //namespace display
+}; //namespace rtac
+
+inline std::ostream& operator<<(std::ostream& os, const rtac::display::Half& h)
+{
+    os << (float)h;
+    return os;
+}
+
+#endif //_DEF_RTAC_DISPLAY_HALF_H_
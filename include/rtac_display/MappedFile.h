@@ -0,0 +1,51 @@
+#ifndef _DEF_RTAC_DISPLAY_MAPPED_FILE_H_
+#define _DEF_RTAC_DISPLAY_MAPPED_FILE_H_
+
+#include <iostream>
+#include <string>
+
+#include <rtac_base/types/Handle.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Read-only memory mapping of a whole file (POSIX mmap). Used by the file
+ * loaders (PlyFile, GLMesh::load_cache) to parse or upload data without
+ * intermediate copies.
+ */
+class MappedFile
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<MappedFile>;
+    using ConstPtr = rtac::types::Handle<const MappedFile>;
+
+    protected:
+
+    std::string    path_;
+    int            fd_;
+    const uint8_t* data_;
+    size_t         size_;
+
+    MappedFile(const std::string& path);
+
+    public:
+
+    static Ptr Open(const std::string& path) { return Ptr(new MappedFile(path)); }
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    const uint8_t*     data() const { return data_; }
+    size_t             size() const { return size_; }
+
+    uint64_t hash() const;
+    static uint64_t hash(const uint8_t* data, size_t size, uint64_t seed = 0);
+};
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_MAPPED_FILE_H_
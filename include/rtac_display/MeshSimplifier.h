@@ -0,0 +1,98 @@
+#ifndef _DEF_RTAC_DISPLAY_MESH_SIMPLIFIER_H_
+#define _DEF_RTAC_DISPLAY_MESH_SIMPLIFIER_H_
+
+#include <iostream>
+#include <vector>
+
+#include <rtac_base/types/Point.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Triangle mesh simplification by quadric error metrics (Garland & Heckbert,
+ * "Surface Simplification Using Quadric Error Metrics", 1997).
+ *
+ * This is a CPU only tool (GLMesh uses it to generate its levels of detail
+ * on a worker thread). Edges are collapsed onto one of their vertices
+ * (half-edge collapse) so the simplified faces index a subset of the
+ * original vertices and all the vertex attributes stay valid. Vertices on
+ * the mesh borders are never removed, which keeps separately simplified
+ * chunks of a mesh watertight. Collapses flipping a face are rejected.
+ *
+ * Vertices with the same position are welded before simplification, so
+ * unwelded meshes (e.g. after GLMesh::expand_vertices or
+ * GLMesh::compute_normals) are simplified as a connected surface. The output
+ * faces still index the input vertices : a face corner which was not moved
+ * keeps its vertex, a moved corner takes the copy of its new position whose
+ * original face is the most aligned with the simplified face.
+ *
+ * simplify can be called several times with decreasing targets to build a
+ * chain of levels of detail.
+ */
+class MeshSimplifier
+{
+    public:
+
+    using Point = rtac::types::Point3<float>;
+
+    protected:
+
+    struct Quadric {
+        double a[10];
+        double weight;
+
+        void add_plane(double nx, double ny, double nz, double d, double w);
+        void add(const Quadric& other);
+        double evaluate(const Point& p) const;
+    };
+
+    struct Collapse {
+        double   cost;    // cost of the cheapest collapse of vertex.
+        uint32_t vertex;
+        uint32_t version;
+        bool operator<(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    const Point*                       points_;
+    std::vector<uint32_t>              inputFaces_;
+    std::vector<uint32_t>              welded_;      // input vertex -> welded vertex
+    std::vector<uint32_t>              copyOffsets_; // welded vertex -> input vertices
+    std::vector<uint32_t>              copies_;
+    std::vector<uint32_t>              copyFace_;    // an input face of each input vertex
+    std::vector<uint32_t>              faces_;       // indexing welded vertices
+    std::vector<bool>                  faceRemoved_;
+    std::vector<std::vector<uint32_t>> vertexFaces_;
+    std::vector<Quadric>               quadrics_;
+    std::vector<bool>                  locked_;
+    std::vector<bool>                  removed_;
+    std::vector<uint32_t>              versions_;
+    std::vector<Collapse>              queue_; // binary heap
+    std::vector<uint32_t>              neighbours_;
+    size_t                             faceCount_;
+    double                             maxError_; // squared
+
+    void weld(size_t pointCount);
+    void face_normal(const uint32_t* face, double* n) const;
+    uint32_t output_vertex(size_t face, int corner) const;
+
+    double cost(uint32_t from, uint32_t to) const;
+    void find_neighbours(uint32_t vertex);
+    void push_vertex(uint32_t vertex, bool updateHeap = true);
+    bool flips(uint32_t from, uint32_t to) const;
+    void collapse(uint32_t from, uint32_t to);
+
+    public:
+
+    MeshSimplifier(const Point* points, size_t pointCount,
+                   const uint32_t* indices, size_t indexCount);
+
+    float  simplify(size_t targetFaceCount);
+    size_t face_count() const { return faceCount_; }
+    std::vector<uint32_t> indices() const;
+    float  error() const;
+};
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_MESH_SIMPLIFIER_H_
@@ -0,0 +1,116 @@
+#ifndef _DEF_RTAC_DISPLAY_PLY_FILE_H_
+#define _DEF_RTAC_DISPLAY_PLY_FILE_H_
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <rtac_base/types/Handle.h>
+
+#include <rtac_display/MappedFile.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Memory mapped PLY file (ascii, binary little endian and binary big
+ * endian formats).
+ *
+ * Only the header is parsed when the file is opened. Element data is then
+ * parsed on demand by the read_* methods, directly into a destination buffer
+ * (typically a mapped GLVector) by all the available CPU cores. No
+ * intermediate copy of the data is made, the extra memory used does not
+ * depend on the file size.
+ *
+ * Binary elements with a fixed record size are split in equal ranges of
+ * records. Face elements are assumed to be triangles (this is checked in
+ * parallel), other polygons are triangulated as fans in a sequential pass.
+ * Ascii elements are split in ranges of lines.
+ */
+class PlyFile
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<PlyFile>;
+    using ConstPtr = rtac::types::Handle<const PlyFile>;
+
+    enum class Format : uint8_t {
+        Ascii,
+        BinaryLittleEndian,
+        BinaryBigEndian,
+    };
+
+    enum class Type : uint8_t {
+        Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64,
+    };
+
+    struct Property {
+        std::string name;
+        Type        type;
+        bool        isList;
+        Type        countType; // type of the list size (if isList)
+        size_t      offset;    // in a binary record (if the record size is fixed)
+    };
+
+    struct Element {
+        std::string           name;
+        size_t                count;
+        std::vector<Property> properties;
+        size_t                stride;     // record size in bytes, 0 if not fixed.
+        size_t                dataOffset; // from the start of the file.
+        size_t                dataSize;   // 0 if unknown (last variable size element).
+    };
+
+    protected:
+
+    MappedFile::Ptr      file_;
+    const uint8_t*       data_;
+    size_t               size_;
+    Format               format_;
+    std::vector<Element> elements_;
+
+    PlyFile(const std::string& path);
+
+    void parse_header();
+    void locate_elements();
+    const uint8_t* skip_record(const Element& element, const uint8_t* record) const;
+    bool fixed_triangles(const Element& element, size_t listIndex,
+                         size_t& triangleStride) const;
+    template <typename T>
+    void read_scalars(const std::string& element,
+                      const std::vector<std::string>& names,
+                      T* dst, size_t dstStride) const;
+
+    public:
+
+    static Ptr Open(const std::string& path) { return Ptr(new PlyFile(path)); }
+
+    const MappedFile&           file()      const { return *file_;    }
+    const std::string&          path()      const { return file_->path(); }
+    Format                      format()    const { return format_;   }
+    size_t                      file_size() const { return size_;     }
+    const std::vector<Element>& elements()  const { return elements_; }
+
+    const Element* element(const std::string& name) const;
+    const Property* property(const std::string& element,
+                             const std::string& name) const;
+    bool has_properties(const std::string& element,
+                        const std::vector<std::string>& names) const;
+
+    void read_floats(const std::string& element,
+                     const std::vector<std::string>& names,
+                     float* dst, size_t dstStride) const;
+    void read_doubles(const std::string& element,
+                      const std::vector<std::string>& names,
+                      double* dst, size_t dstStride) const;
+    size_t triangle_count(const std::string& element = "face") const;
+    void   read_triangles(uint32_t* dst, const std::string& element = "face") const;
+
+    static size_t type_size(Type type);
+};
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::display::PlyFile& ply);
+
+#endif //_DEF_RTAC_DISPLAY_PLY_FILE_H_
@@ -0,0 +1,116 @@
+#ifndef _DEF_RTAC_DISPLAY_POINT_OCTREE_H_
+#define _DEF_RTAC_DISPLAY_POINT_OCTREE_H_
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Point.h>
+
+#include <rtac_display/MappedFile.h>
+#include <rtac_display/views/Frustum.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Multi-resolution point cloud stored in an octree file (in the style of
+ * Potree, Schütz, "Potree: Rendering Large Point Clouds in Web Browsers",
+ * 2016).
+ *
+ * Each node holds a subset of the points of its cube : the points selected
+ * by a grid sampling of the cube (one point per cell, the closest to the
+ * cell center) are kept in the node, the other ones are passed to the
+ * children. The points of the nodes are disjoint, so drawing a node and its
+ * children adds detail to the parent without duplicating points. A node
+ * holds at most maxNodePoints points, which lets the renderer store nodes in
+ * fixed size slots of a GPU buffer (see PointOctreeRenderer).
+ *
+ * The octree is built offline by PointOctree::build and written to a file
+ * (header, node table in breadth-first order, points of each node in node
+ * order). An opened octree only reads the node table, the point data stays
+ * in a read-only memory mapping and is paged in from the disk when the
+ * points of a node are read (typically by the loader threads of the
+ * renderer).
+ *
+ * Positions are built from double precision input and stored relative to
+ * avoid losing precision with georeferenced (e.g. UTM) coordinates : the
+ * octree frame is centered on origin() (double), node centers are given in
+ * this frame and the points of a node are stored as float offsets from the
+ * node center. The stored offsets are smaller than the node size, so their
+ * precision increases with the depth of the node.
+ *
+ * The construction is in-core (see build for the memory usage), the number
+ * of input points is limited to MaxBuildPoints. Larger surveys have to be
+ * split in tiles built in separate octrees.
+ */
+class PointOctree
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<PointOctree>;
+    using ConstPtr = rtac::types::Handle<const PointOctree>;
+    using Point    = rtac::types::Point3<float>;  // offset from the node center.
+    using Position = rtac::types::Point3<double>; // input position.
+
+    static constexpr uint32_t FileVersion    = 2;
+    static constexpr uint32_t NoChild        = 0xffffffff;
+    static constexpr size_t   MaxBuildPoints = size_t(1) << 30;
+
+    struct Node {
+        float    center[3];   // in the octree frame (relative to origin()).
+        float    halfSize;
+        uint64_t pointOffset; // index of the first point of the node in the file.
+        uint32_t pointCount;
+        uint32_t firstChild;  // children are contiguous, in octant order.
+        uint8_t  childMask;   // bit i set if child of octant i exists (x:1, y:2, z:4).
+        uint8_t  childCount;
+        uint16_t depth;
+        uint32_t padding;
+    };
+
+    protected:
+
+    MappedFile::Ptr   file_;
+    std::vector<Node> nodes_;
+    const Point*      points_;
+    Position          origin_;
+    size_t            pointCount_;
+    uint32_t          maxNodePoints_;
+    float             spacing_; // grid sampling spacing at the root.
+
+    PointOctree(const std::string& path);
+
+    public:
+
+    static Ptr Open(const std::string& path) { return Ptr(new PointOctree(path)); }
+
+    static void build(const std::string& path, std::vector<Position> points,
+                      uint32_t maxNodePoints = 32768,
+                      unsigned int gridResolution = 128);
+    static void build_from_ply(const std::string& path, const std::string& plyPath,
+                               uint32_t maxNodePoints = 32768,
+                               unsigned int gridResolution = 128);
+
+    const std::string&       path()            const { return file_->path(); }
+    const Position&          origin()          const { return origin_;       }
+    const std::vector<Node>& nodes()           const { return nodes_;        }
+    const Node&              node(size_t i)    const { return nodes_[i];     }
+    size_t                   node_count()      const { return nodes_.size(); }
+    size_t                   point_count()     const { return pointCount_;   }
+    uint32_t                 max_node_points() const { return maxNodePoints_; }
+    float                    spacing()         const { return spacing_;      }
+    unsigned int             depth()           const;
+
+    const Point*   points(size_t node) const { return points_ + nodes_[node].pointOffset; }
+    Position       position(size_t node, size_t index) const;
+    BoundingSphere node_bounds(size_t node) const;
+    BoundingSphere bounds() const { return this->node_bounds(0); }
+};
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::display::PointOctree& octree);
+
+#endif //_DEF_RTAC_DISPLAY_POINT_OCTREE_H_
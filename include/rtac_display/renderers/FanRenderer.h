@@ -20,6 +20,25 @@
 
 namespace rtac { namespace display {
 
+/**
+ * Displays sonar-like data in a fan shape (polar coordinates).
+ *
+ * The fan is drawn as a tessellated annular sector mesh (see
+ * set_sector_subdivisions), rebuilt only when the geometry changes, so only
+ * the pixels covered by the fan are shaded.
+ *
+ * By default the polar coordinates of each fragment are computed in the
+ * fragment shader. When the lookup table mode is enabled
+ * (FanRenderer::enable_lookup_table), they are precomputed into a texture
+ * (bearing map included) which is only rebuilt when the geometry, the
+ * bearings or the screen size change. Per-frame work then reduces to a lookup
+ * table fetch and a data fetch per fragment.
+ *
+ * Data can be given as float, uint8_t, uint16_t or Half. Narrow types are
+ * uploaded as is (R8, R16 or R16F textures) and rescaled in the shader, which
+ * divides upload bandwidth and texture memory by 2 to 4. The value range is
+ * always expressed in sample units (e.g. [0,255] for uint8_t data).
+ */
 class FanRenderer : public Renderer
 {
     public:
@@ -40,6 +59,10 @@ class FanRenderer : public Renderer
     static const std::string& vertexShader;
     static const std::string& fragmentShader;
     static const std::string& fragmentShaderNonLinear;
+    static const std::string& fragmentShaderLookupTable;
+    static const std::string& lookupTableShader;
+
+    static constexpr unsigned int DefaultSectorSubdivisions = 32;
 
     enum class Direction : uint8_t {
         Left  = 0,
@@ -53,19 +76,32 @@ class FanRenderer : public Renderer
     GLTexture::Ptr data_;
     Colormap::Ptr  colormap_;
     Interval       valueRange_;
+    float          dataScale_; // normalized texture value to sample value.
     GLReductor     reductor_;
 
     Interval         angle_;
     Interval         range_;
     Rectangle        bounds_;
-    GLVector<Point4> corners_;
+    GLVector<Point4> corners_; // fan mesh (GL_TRIANGLES)
+    unsigned int     sectorSubdivisions_;
     Direction        direction_;
 
     GLTexture::Ptr bearingMap_;
     GLuint         linearBearingsProgram_;
     GLuint         nonlinearBearingsProgram_;
 
-    void compute_scale(const GLVector<float>& data);
+    // Polar coordinates lookup table (updated lazily on draw).
+    bool                   lookupTableEnabled_;
+    unsigned int           lookupTableResolution_; // 0 : screen resolution
+    mutable GLTexture::Ptr lookupTable_;
+    mutable bool           lookupTableDirty_;
+    GLuint                 lookupTableProgram_;
+    GLuint                 lookupTableBuildProgram_;
+
+    template <typename T>
+    void compute_scale(const GLVector<T>& data);
+    Shape lookup_table_shape(const Shape& screen) const;
+    void  update_lookup_table(const Shape& screen) const;
 
     FanRenderer(const GLContext::Ptr& context);
 
@@ -80,10 +116,14 @@ class FanRenderer : public Renderer
     void set_aperture(Interval angle);
     void set_range(Interval range);
     void set_direction(Direction dir) { direction_ = dir; }
+    void set_sector_subdivisions(unsigned int subdivisions);
+    unsigned int sector_subdivisions() const { return sectorSubdivisions_; }
 
     void set_data(const GLTexture::Ptr& tex);
-    void set_data(const Shape& shape, const float* data);
-    void set_data(const Shape& shape, const GLVector<float>& data,
+    template <typename T>
+    void set_data(const Shape& shape, const T* data);
+    template <typename T>
+    void set_data(const Shape& shape, const GLVector<T>& data,
                   bool computeScale = true);
 
     void set_bearings(unsigned int nBeams, const float* bearings,
@@ -91,14 +131,52 @@ class FanRenderer : public Renderer
     void enable_bearing_map();
     void disable_bearing_map();
 
+    void enable_lookup_table(unsigned int resolution = 0);
+    void disable_lookup_table();
+    bool lookup_table_enabled() const { return lookupTableEnabled_; }
+
     virtual void draw(const View::ConstPtr& view) const;
 
     Mat4 compute_view(const Shape& screen) const;
+    static Mat4 fit_view(const Rectangle& area, Direction direction,
+                         const Shape& screen);
+    static Interval normalized_aperture(Interval angle);
+    static std::vector<Point4> sector_mesh(const Interval& angle,
+                                           const Interval& range,
+                                           unsigned int subdivisions);
 
     GLTexture::Ptr      texture()       { return data_; }
     GLTexture::ConstPtr texture() const { return data_; }
+    const Interval&     value_range() const { return valueRange_; }
 };
 
+template <typename T>
+void FanRenderer::set_data(const Shape& shape, const T* data)
+{
+    data_->set_image(shape, data);
+    dataScale_ = normalization_factor(GLFormat<T>::Type);
+}
+
+template <typename T>
+void FanRenderer::set_data(const Shape& shape, const GLVector<T>& data,
+                           bool computeScale)
+{
+    data_->set_image(shape, data);
+    dataScale_ = normalization_factor(GLFormat<T>::Type);
+    if(computeScale)
+        this->compute_scale(data);
+}
+
+/**
+ * Sets the value range to the extrema of data (in sample units).
+ */
+template <typename T>
+void FanRenderer::compute_scale(const GLVector<T>& data)
+{
+    this->set_value_range({reductor_.min_value(data),
+                           reductor_.max_value(data)});
+}
+
 }; //namespace display
 }; //namespace rtac
 
@@ -41,6 +41,7 @@ class Frame : public Renderer
     void set_pose(const View3D::Pose& pose);
 
     virtual void draw(const View::ConstPtr& view) const;
+    virtual BoundingSphere world_bounds() const;
 };
 
 }; //namespace display
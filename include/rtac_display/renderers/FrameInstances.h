@@ -1,6 +1,8 @@
 #ifndef _DEF_RTAC_DISPLAY_RENDERER_FRAME_INSTANCES_H_
 #define _DEF_RTAC_DISPLAY_RENDERER_FRAME_INSTANCES_H_
 
+#include <vector>
+
 #include <rtac_base/types/Handle.h>
 
 #include <rtac_display/utils.h>
@@ -15,6 +17,16 @@ namespace rtac { namespace display {
 /**
  * Similar to base class Renderer, but draws a fram (x,y,z) at a specific
  * position.
+ *
+ * The poses are stored on the device in a compact format (quaternion and
+ * translation, 28 bytes per instance instead of 64 for a 4x4 matrix). Poses
+ * modified on the host side are tracked by blocks of DirtyBlockSize
+ * instances and only the modified blocks are uploaded at the next draw.
+ *
+ * The bounding sphere used for culling is recomputed from all the instances
+ * only after set_poses or clear_poses. add_pose and update_pose(s) grow it
+ * to include the modified frames (it may then be larger than needed, but
+ * stays conservative).
  */
 class FrameInstances : public Renderer
 {
@@ -25,28 +37,57 @@ class FrameInstances : public Renderer
 
     using Pose = View3D::Pose;
 
+    /**
+     * Pose of a single instance as uploaded on the device.
+     */
+    struct Instance {
+        float orientation[4]; // unit quaternion (x,y,z,w)
+        float translation[3];
+
+        static Instance from_pose(const Pose& pose);
+    };
+
+    static constexpr size_t DirtyBlockSize = 256;
+
     protected:
 
     static const std::string vertexShader;
     static const std::string fragmentShader;
 
     View3D::Pose                 globalPose_;
-    std::vector<Pose::Mat4>      poses_;
-    mutable GLVector<Pose::Mat4> deviceData_;
+    std::vector<Instance>        instances_;
+    mutable GLVector<Instance>   deviceData_;
+    mutable std::vector<uint8_t> dirtyBlocks_;
+    mutable bool                 dirty_;
+
+    mutable bool           boundsChanged_;
+    mutable BoundingSphere localBounds_; // bounds of all the frames in global pose frame.
 
     FrameInstances(const GLContext::Ptr& context,
                    const View3D::Pose& pose = View3D::Pose());
 
+    void mark_dirty(size_t offset, size_t count);
+    void grow_bounds(size_t offset, size_t count);
+    void upload_instances() const;
+
     public:
 
     static Ptr Create(const GLContext::Ptr& context,
                       const View3D::Pose& pose = View3D::Pose());
 
     void set_global_pose(const Pose& pose) { globalPose_ = pose; }
-    void add_pose(const Pose& pose) { poses_.push_back(pose.homogeneous_matrix()); }
+    void add_pose(const Pose& pose);
     void set_poses(const std::vector<Pose>& poses);
+    void update_pose(size_t index, const Pose& pose);
+    void update_poses(size_t offset, const std::vector<Pose>& poses);
+    void update_poses(const std::vector<size_t>& indices,
+                      const std::vector<Pose>& poses);
+    void clear_poses();
+
+    size_t size() const { return instances_.size(); }
 
     virtual void draw(const View::ConstPtr& view) const;
+    virtual BoundingSphere world_bounds() const;
 };
 
 }; //namespace display
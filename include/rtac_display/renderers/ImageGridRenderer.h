@@ -0,0 +1,213 @@
+#ifndef _DEF_RTAC_DISPLAY_IMAGE_GRID_RENDERER_H_
+#define _DEF_RTAC_DISPLAY_IMAGE_GRID_RENDERER_H_
+
+#include <iostream>
+#include <vector>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Bounds.h>
+
+#include <rtac_display/utils.h>
+#include <rtac_display/GLFormat.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/GLTexture.h>
+#include <rtac_display/GLTextureArray.h>
+#include <rtac_display/renderers/Renderer.h>
+#include <rtac_display/Colormap.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Displays a grid of images (video feeds...) in a single instanced draw call.
+ *
+ * All the feeds are stored in a single GL_TEXTURE_2D_ARRAY :
+ * - Layout::Array : all the feeds have the same shape, one layer per feed.
+ * - Layout::Atlas : feeds have different shapes and are packed in a single
+ *                   layer (shelf packing).
+ *
+ * Host uploads go through a small ring of pixel buffer objects (streaming
+ * upload) so set_feed returns as soon as the data is copied in driver memory
+ * and the transfer to the texture is asynchronous. Uploads from a GLVector
+ * are device to device copies.
+ *
+ * Per tile parameters (location in the texture array, colormap, value range)
+ * are stored in a shader storage buffer. Each tile can either be displayed as
+ * is or through one of the colormaps registered with add_colormap. Value
+ * ranges are expressed in sample units (as in ImageRenderer) and default to
+ * the full range of the data type.
+ *
+ * The grid fills the whole view. Tiles are laid out in row-major order from
+ * the top left corner and each image is fitted in its cell (aspect ratio is
+ * kept).
+ */
+class ImageGridRenderer : public Renderer
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<ImageGridRenderer>;
+    using ConstPtr = rtac::types::Handle<const ImageGridRenderer>;
+
+    using Shape    = View::Shape;
+    using Interval = rtac::types::Interval<float>;
+
+    static const std::string vertexShader;
+    static const std::string fragmentShader;
+
+    static constexpr unsigned int StagingBufferCount = 3;
+    static constexpr unsigned int ColormapSize       = 256;
+
+    enum class Layout : uint8_t {
+        Array = 0, // one texture layer per feed (all feeds have the same shape).
+        Atlas = 1, // all feeds packed in a single texture layer.
+    };
+
+    /**
+     * Per tile parameters, laid out as the std430 shader struct.
+     */
+    struct TileParameters {
+        float   uvOrigin[2];  // tile location in the texture layer.
+        float   uvSize[2];
+        float   imageSize[2]; // in pixels, for aspect ratio.
+        float   valueScaling[2];
+        int32_t layer;
+        int32_t colormap;     // row in the colormap table, -1 for none.
+        uint32_t hasData;
+        float   padding;
+    };
+
+    protected:
+
+    struct Feed {
+        Shape    shape;
+        Rect     area;  // location in the texture layer, in pixels.
+        unsigned int layer;
+        int      colormap;
+        Interval range;
+        bool     hasData;
+    };
+
+    std::vector<Feed>   feeds_;
+    Layout              layout_;
+    GLTextureArray::Ptr images_;
+    GLenum              scalarType_;
+    float               dataScale_;
+
+    std::vector<GLVector<uint8_t>> staging_;
+    unsigned int                   nextStaging_;
+
+    std::vector<float> colormapData_; // host copy of the colormap table.
+    GLTexture          colormaps_;
+
+    unsigned int columns_; // 0 for automatic.
+    float        spacing_;
+    bool         verticalFlip_;
+
+    mutable bool                     parametersChanged_;
+    mutable GLVector<TileParameters> parameters_;
+
+    ImageGridRenderer(const GLContext::Ptr& context);
+
+    Feed& feed(unsigned int index);
+    void check_index(unsigned int index) const;
+    void allocate(const std::vector<Shape>& shapes, GLint internalFormat,
+                  GLenum pixelFormat, GLenum scalarType);
+    void check_type(GLenum pixelFormat, GLenum scalarType) const;
+    void upload(Feed& feed, GLuint buffer, GLint alignment);
+    void update_parameters() const;
+    Shape grid_shape() const;
+
+    public:
+
+    static Ptr Create(const GLContext::Ptr& context);
+
+    template <typename T>
+    void reset(unsigned int feedCount, const Shape& shape);
+    template <typename T>
+    void reset(const std::vector<Shape>& shapes);
+
+    template <typename T>
+    void set_feed(unsigned int index, const T* data);
+    template <typename T>
+    void set_feed(unsigned int index, const GLVector<T>& data);
+
+    unsigned int add_colormap(const Colormap::Ptr& colormap);
+    void set_colormap(unsigned int feed, int colormap);
+    void set_value_range(unsigned int feed, const Interval& range);
+    void reset_value_range(unsigned int feed);
+
+    void set_columns(unsigned int columns);
+    void set_spacing(float pixels);
+    void set_vertical_flip(bool doFlip);
+
+    Layout       layout()         const { return layout_;       }
+    unsigned int feed_count()     const { return feeds_.size(); }
+    unsigned int colormap_count() const { return colormapData_.size() / (4*ColormapSize); }
+    Shape        feed_shape(unsigned int index) const;
+    Interval     value_range(unsigned int index) const;
+    GLTextureArray::ConstPtr images() const { return images_; }
+
+    virtual void draw(const View::ConstPtr& view) const;
+};
+
+/**
+ * Allocates feedCount feeds of the same shape (Layout::Array). Feed data is
+ * invalidated.
+ */
+template <typename T>
+void ImageGridRenderer::reset(unsigned int feedCount, const Shape& shape)
+{
+    this->reset<T>(std::vector<Shape>(feedCount, shape));
+}
+
+/**
+ * Allocates one feed per shape. Layout::Array is used if all shapes are
+ * identical, Layout::Atlas otherwise. Feed data is invalidated but the tile
+ * parameters (colormap, value range) are kept for existing feeds.
+ */
+template <typename T>
+void ImageGridRenderer::reset(const std::vector<Shape>& shapes)
+{
+    using Format = GLFormat<T>;
+    this->allocate(shapes, Format::InternalFormat, Format::PixelFormat,
+                   Format::Type);
+}
+
+/**
+ * Uploads a feed from host memory through the streaming buffers.
+ *
+ * @param data feed_shape(index).area() pixels, top row first (see
+ *             set_vertical_flip).
+ */
+template <typename T>
+void ImageGridRenderer::set_feed(unsigned int index, const T* data)
+{
+    this->check_type(GLFormat<T>::PixelFormat, GLFormat<T>::Type);
+    auto& f = this->feed(index);
+
+    // Round robin on the staging buffers : the buffer written here is not
+    // the source of the previous (possibly still pending) transfers.
+    auto& buffer = staging_[nextStaging_];
+    nextStaging_ = (nextStaging_ + 1) % staging_.size();
+    buffer.set_data(sizeof(T)*f.shape.area(), (const uint8_t*)data);
+
+    this->upload(f, buffer.gl_id(), GLTexture::unpack_alignment<T>(f.shape.width));
+}
+
+/**
+ * Uploads a feed from a GLVector (device to device copy).
+ */
+template <typename T>
+void ImageGridRenderer::set_feed(unsigned int index, const GLVector<T>& data)
+{
+    this->check_type(GLFormat<T>::PixelFormat, GLFormat<T>::Type);
+    auto& f = this->feed(index);
+    if(data.size() < f.shape.area()) {
+        throw std::runtime_error("ImageGridRenderer : too few data for feed shape.");
+    }
+    this->upload(f, data.gl_id(), GLTexture::unpack_alignment<T>(f.shape.width));
+}
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_IMAGE_GRID_RENDERER_H_
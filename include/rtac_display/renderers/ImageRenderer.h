@@ -2,6 +2,13 @@
 #define _DEF_RTAC_DISPLAY_IMAGE_RENDERER_H_
 
 #include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Bounds.h>
+
+#include <type_traits>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <sstream>
 
 #include <rtac_display/utils.h>
 #include <rtac_display/GLContext.h>
@@ -9,6 +16,7 @@
 #include <rtac_display/views/ImageView.h>
 #include <rtac_display/GLVector.h>
 #include <rtac_display/GLTexture.h>
+#include <rtac_display/GLReductor.h>
 #include <rtac_display/Colormap.h>
 
 #include <rtac_display/colormaps/Viridis.h>
@@ -26,6 +34,22 @@ namespace rtac { namespace display {
  * displaying a red-scaled image. (OpenGL always displays a full RGBA image.
  * Missing blue and green components are filled with 0, and missing alpha is
  * filled with 1).
+ *
+ * When a colormap is used, the first channel of the texture is mapped from a
+ * value range to the colormap. Single channel uint8_t, uint16_t and Half
+ * images are uploaded natively (no conversion to float) and rescaled in the
+ * shader. The value range is expressed in sample units and defaults to the
+ * full range of the texture type ([0,1] for float, [0,255] for uint8_t...).
+ * It can also be computed on the GPU from the image itself (extrema or
+ * percentiles, see RangeMode). Log or dB scaling, gamma and the color of NaN
+ * values are shader uniforms : changing the display contrast never requires
+ * the image to be uploaded again.
+ *
+ * Raw camera frames can also be given directly (set_bayer, set_nv12,
+ * set_i420, set_yuyv). The raw planes are uploaded as is (one or two
+ * channels textures) and converted to RGB in the fragment shader, which
+ * removes the CPU conversion and reduces the upload size. The colormap is
+ * ignored for these inputs.
  */
 class ImageRenderer : public Renderer
 {
@@ -36,24 +60,149 @@ class ImageRenderer : public Renderer
 
     using Mat4  = ImageView::Mat4;
     using Shape = ImageView::Shape;
+    using Interval = rtac::types::Interval<float>;
 
     static const std::string vertexShader;
     static const std::string fragmentShader;
     static const std::string colormapFragmentShader;
+    static const std::string bayerFragmentShader;
+    static const std::string yuvFragmentShader;
+    static const std::string rangeComputeShader;
+
+    static constexpr unsigned int HistogramSize = 256;
+
+    /**
+     * How the colormap value range is chosen. MinMax and Percentile ranges
+     * are computed on the GPU from the texture (no read back, no upload).
+     */
+    enum class RangeMode : uint8_t {
+        TypeRange  = 0, // full range of the texture type (default).
+        Fixed      = 1, // set with set_value_range.
+        MinMax     = 2, // image extrema.
+        Percentile = 3, // image percentiles (see set_percentiles).
+    };
+
+    /**
+     * Transform applied to the values before the value range. The value range
+     * is expressed in sample units for Linear and Log, in dB for Decibel.
+     */
+    enum class Scaling : uint8_t {
+        Linear  = 0,
+        Log     = 1, // log10(value)
+        Decibel = 2, // decibelFactor*log10(value)
+    };
+
+    enum class InputMode : uint8_t {
+        Texture = 0, // texture() is displayed as is (or colormapped).
+        Bayer   = 1,
+        NV12    = 2, // Y plane + interleaved UV plane (4:2:0).
+        I420    = 3, // Y plane + U plane + V plane (4:2:0).
+        YUYV    = 4, // packed Y0 U Y1 V (4:2:2).
+    };
+
+    // Color of the top left pixel of the 2x2 Bayer tile, then its right
+    // neighbor (RGGB : red at (0,0), green at (1,0)).
+    enum class BayerPattern : uint8_t {
+        RGGB = 0,
+        GRBG = 1,
+        GBRG = 2,
+        BGGR = 3,
+    };
+
+    enum class Demosaic : uint8_t {
+        Bilinear  = 0,
+        EdgeAware = 1, // directional green + gradient corrected red/blue.
+    };
+
+    enum class YUVStandard : uint8_t {
+        BT601 = 0,
+        BT709 = 1,
+    };
 
     protected:
+
+    // Uniform locations of a render program (queried once).
+    struct Locations {
+        GLint view;
+        GLint tex;
+        GLint colormap;
+        GLint dataScale;
+        GLint valueRange;
+        GLint scaling;
+        GLint decibelFactor;
+        GLint gamma;
+        GLint nanColor;
+        GLint gpuRange;
+        GLint chroma0;
+        GLint chroma1;
+        GLint bayerOffset;
+        GLint demosaic;
+        GLint rawScale;
+        GLint yuvLayout;
+        GLint yuvMatrix;
+        GLint yuvOffset;
+
+        static Locations query(GLuint program);
+    };
     
     GLTexture::Ptr texture_;
-    ImageView::Ptr imageView_;
     Colormap::Ptr  colormap_;
+    Interval       valueRange_;
+    RangeMode      rangeMode_;
+    GLReductor     reductor_;
+
+    // Colormap value transform (applied in the fragment shader).
+    Scaling      scaling_;
+    float        decibelFactor_;
+    float        gamma_;
+    Color::RGBAf nanColor_;
+
+    // GPU value range (min, max, sample count, range, histogram).
+    float                      percentiles_[2];
+    mutable bool               rangeChanged_; // image changed since last range.
+    mutable GLuint             rangeProgram_;
+    mutable GLVector<uint32_t> rangeBuffer_;
+    std::vector<uint32_t>      rangeReset_;
 
-    GLuint passThroughProgram_;
-    GLuint colormapProgram_;
+    GLuint    passThroughProgram_;
+    GLuint    colormapProgram_;
+    Locations passThroughLocations_;
+    Locations colormapLocations_;
 
     bool verticalFlip_;
 
+    // Raw camera inputs (texture_ holds the Y plane or the Bayer mosaic).
+    InputMode      inputMode_;
+    Shape          imageShape_;
+    GLTexture::Ptr chroma0_;
+    GLTexture::Ptr chroma1_;
+    BayerPattern   bayerPattern_;
+    Demosaic       demosaic_;
+    float          rawScale_;
+    float          yuvMatrix_[9]; // column major
+    float          yuvOffset_[3];
+    mutable GLuint    bayerProgram_;
+    mutable GLuint    yuvProgram_;
+    mutable Locations bayerLocations_;
+    mutable Locations yuvLocations_;
+
+    // Image quad (interleaved position and uv, GL_TRIANGLE_STRIP). Only
+    // updated when the texture shape or the flip flag change.
+    mutable GLVector<float> quad_;
+    mutable Shape           quadShape_;
+    mutable bool            quadFlip_;
+
     ImageRenderer(const GLContext::Ptr& context);
 
+    void update_quad() const;
+    void update_gpu_range() const;
+    bool uses_gpu_range() const;
+    Interval shader_range() const;
+    GLuint raw_program(const Locations*& locations) const;
+    void   set_chroma(GLTexture::Ptr& chroma, const Shape& shape,
+                      GLint internalFormat, GLenum pixelFormat,
+                      const uint8_t* data);
+
     public:
 
     static Ptr Create(const GLContext::Ptr& context);
@@ -69,10 +218,123 @@ class ImageRenderer : public Renderer
     bool uses_colormap() const;
     void set_vertical_flip(bool doFlip);
 
+    template <typename T>
+    void set_image(const Shape& shape, const T* data);
+    template <typename T>
+    void set_image(const Shape& shape, const GLVector<T>& data);
+    template <typename T>
+    void set_image(const Shape& shape, const GLVector<T>& data,
+                   bool computeRange);
+    template <typename T>
+    void compute_value_range(const GLVector<T>& data);
+    void set_value_range(const Interval& range);
+    void reset_value_range();
+    Interval value_range() const;
+    void set_range_mode(RangeMode mode);
+    void set_percentiles(float low, float high);
+    RangeMode range_mode() const { return rangeMode_; }
+
+    void set_scaling(Scaling scaling, float decibelFactor = 20.0f);
+    void set_gamma(float gamma);
+    void set_nan_color(const Color::RGBAf& color);
+    Scaling scaling() const { return scaling_; }
+    float   gamma()   const { return gamma_;   }
+
     void set_viridis_colormap();
     void set_gray_colormap();
+
+    template <typename T>
+    void set_bayer(const Shape& shape, const T* data,
+                   BayerPattern pattern = BayerPattern::RGGB,
+                   Demosaic method = Demosaic::Bilinear,
+                   unsigned int bitDepth = 8*sizeof(T));
+    void set_nv12(const Shape& shape, const uint8_t* data);
+    void set_i420(const Shape& shape, const uint8_t* data);
+    void set_yuyv(const Shape& shape, const uint8_t* data);
+    void set_yuv_standard(YUVStandard standard, bool fullRange = false);
+
+    InputMode input_mode() const { return inputMode_; }
+    Shape     image_shape() const;
 };
 
+/**
+ * Sets a raw Bayer mosaic image (uint8_t or uint16_t samples), demosaiced in
+ * the fragment shader.
+ *
+ * @param bitDepth number of significant bits of the samples (e.g. 12 for 12
+ *                 bits data stored in uint16_t), in [1, 8*sizeof(T)].
+ */
+template <typename T>
+void ImageRenderer::set_bayer(const Shape& shape, const T* data,
+                              BayerPattern pattern, Demosaic method,
+                              unsigned int bitDepth)
+{
+    static_assert(std::is_same<T,uint8_t>::value || std::is_same<T,uint16_t>::value,
+                  "Bayer data must be uint8_t or uint16_t");
+    if(bitDepth == 0 || bitDepth > 8*sizeof(T)) {
+        std::ostringstream oss;
+        oss << "ImageRenderer::set_bayer : invalid bit depth (" << bitDepth
+            << ", must be in [1," << 8*sizeof(T) << "])";
+        throw std::runtime_error(oss.str());
+    }
+    texture_->set_image(shape, data);
+    rangeChanged_ = true;
+    inputMode_    = InputMode::Bayer;
+    imageShape_   = shape;
+    bayerPattern_ = pattern;
+    demosaic_     = method;
+    rawScale_     = ((float)((1ul << 8*sizeof(T)) - 1)) / ((1ul << bitDepth) - 1);
+}
+
+template <typename T>
+void ImageRenderer::set_image(const Shape& shape, const T* data)
+{
+    texture_->set_image(shape, data);
+    inputMode_    = InputMode::Texture;
+    rangeChanged_ = true;
+}
+
+/**
+ * Uploads the image from a GLVector (device to device copy).
+ */
+template <typename T>
+void ImageRenderer::set_image(const Shape& shape, const GLVector<T>& data)
+{
+    texture_->set_image(shape, data);
+    inputMode_    = InputMode::Texture;
+    rangeChanged_ = true;
+}
+
+/**
+ * Uploads the image from a GLVector (device to device copy).
+ *
+ * @param computeRange if true, the value range is set to the extrema of data
+ *                     (single channel data only).
+ */
+template <typename T>
+void ImageRenderer::set_image(const Shape& shape, const GLVector<T>& data,
+                              bool computeRange)
+{
+    this->set_image(shape, data);
+    if(computeRange)
+        this->compute_value_range(data);
+}
+
+/**
+ * Sets the colormap value range to the extrema of data (converted to dB with
+ * Scaling::Decibel, as the fixed range is expressed in dB in this mode).
+ */
+template <typename T>
+void ImageRenderer::compute_value_range(const GLVector<T>& data)
+{
+    Interval range({reductor_.min_value(data), reductor_.max_value(data)});
+    if(scaling_ == Scaling::Decibel) {
+        range.min = decibelFactor_*std::log10(std::max(range.min, 1.0e-30f));
+        range.max = decibelFactor_*std::log10(std::max(range.max, 1.0e-30f));
+    }
+    this->set_value_range(range);
+}
+
 }; //namespace display
 }; //namespace rtac
 
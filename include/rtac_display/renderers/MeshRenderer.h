@@ -1,6 +1,8 @@
 #ifndef _DEF_RTAC_DISPLAY_MESH_RENDERER_H_
 #define _DEF_RTAC_DISPLAY_MESH_RENDERER_H_
 
+#include <vector>
+
 #include <rtac_base/types/common.h>
 #include <rtac_base/types/Handle.h>
 
@@ -34,6 +36,7 @@ class MeshRenderer : public Renderer
 
     protected:
 
+    static const std::string vertexDecoding;
     static const std::string vertexShaderSolid;
     static const std::string vertexShaderNormals;
     static const std::string vertexShaderDisplayNormals;
@@ -58,11 +61,36 @@ class MeshRenderer : public Renderer
     GLuint       displayNormalsProgram_;
     Color::RGBAf normalsColor_;
 
+    // draw parameters of the chunks of a split mesh (see GLMesh::split)
+    mutable std::vector<GLsizei> chunkCounts_;
+    mutable std::vector<void*>   chunkOffsets_;
+    mutable std::vector<GLint>   chunkBaseVertices_;
+    bool                 chunkCulling_;
+    mutable unsigned int drawnChunks_;
+    mutable unsigned int culledChunks_;
+
+    // level of detail selection (see GLMesh::generate_lods)
+    float                             lodThreshold_;  // in pixels
+    float                             lodHysteresis_;
+    mutable std::vector<unsigned int> lodLevels_;     // current level of each chunk
+    mutable std::vector<GLsizei>      lodCounts_;
+    mutable std::vector<void*>        lodOffsets_;
+    mutable std::vector<GLint>        lodBaseVertices_;
+    mutable size_t                    drawnTriangles_;
+
     protected:
 
     MeshRenderer(const GLContext::Ptr& context,
                  const Color::RGBAf& color = {1.0,1.0,1.0,1.0});
 
+    static void bind_attribute(GLuint index, const GLMesh::VertexAttribute& attribute);
+    void set_decoding_uniforms(GLuint program) const;
+    void draw_faces(const View::ConstPtr& view, const Mat4& viewMatrix,
+                    GLenum primitiveMode) const;
+    unsigned int select_lod(size_t index, const std::vector<GLMesh::Lod>& lods,
+                            const BoundingSphere& bounds, const Mat4& viewMatrix,
+                            float pixelScale, bool perspective) const;
+
     public:
 
     static Ptr Create(const GLContext::Ptr& context,
@@ -73,6 +101,7 @@ class MeshRenderer : public Renderer
     void set_texture(const GLTexture::ConstPtr& texture) { texture_ = texture; }
 
     virtual void draw(const View::ConstPtr& view) const;
+    virtual BoundingSphere world_bounds() const;
     void draw_solid(const View::ConstPtr& view, GLenum primitiveMode) const;
     void draw_normal_shading(const View::ConstPtr& view) const;
     void draw_textured(const View::ConstPtr& view) const;
@@ -86,6 +115,18 @@ class MeshRenderer : public Renderer
     void enable_normals_display()  { displayNormals_ = true; }
     void disable_normals_display() { displayNormals_ = false; }
     void set_normals_color(const Color::RGBAf& color) { normalsColor_ = color; }
+
+    void enable_chunk_culling()  { chunkCulling_ = true;  }
+    void disable_chunk_culling() { chunkCulling_ = false; }
+    unsigned int drawn_chunk_count()  const { return drawnChunks_;  }
+    unsigned int culled_chunk_count() const { return culledChunks_; }
+
+    void  set_lod_threshold(float pixels);
+    void  set_lod_hysteresis(float ratio);
+    float lod_threshold()  const { return lodThreshold_;  }
+    float lod_hysteresis() const { return lodHysteresis_; }
+    unsigned int lod_level(size_t chunk = 0) const;
+    size_t drawn_triangle_count() const { return drawnTriangles_; }
 };
 
 }; //namespace display
@@ -0,0 +1,201 @@
+#ifndef _DEF_RTAC_DISPLAY_MULTI_FAN_RENDERER_H_
+#define _DEF_RTAC_DISPLAY_MULTI_FAN_RENDERER_H_
+
+#include <iostream>
+#include <vector>
+
+#include <rtac_base/types/Handle.h>
+
+#include <rtac_display/GLFormat.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/GLTextureArray.h>
+#include <rtac_display/renderers/Renderer.h>
+#include <rtac_display/renderers/FanRenderer.h>
+#include <rtac_display/Colormap.h>
+#include <rtac_display/colormaps/Viridis.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Displays the data of several sonar heads, composited in a single draw call.
+ *
+ * Each sensor has its own 2D pose (position and heading in the display
+ * plane), aperture, range and optional bearing map. Sensor data is stored in
+ * a single GLTextureArray (one layer per sensor, all sensors must have the
+ * same data shape and type).
+ *
+ * The geometry drawn is the union of tight sector meshes (see
+ * FanRenderer::sector_mesh) instead of bounding rectangles. The highest bit
+ * of the stencil buffer ensures each pixel is shaded only once where the fans
+ * overlap (the other bits and the stencil state are preserved), and the
+ * fragment shader composites all the sensors covering the pixel according to
+ * the BlendMode.
+ *
+ * Sensor data follows the FanRenderer convention (texture width is the
+ * bearing dimension, height the range dimension).
+ */
+class MultiFanRenderer : public Renderer
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<MultiFanRenderer>;
+    using ConstPtr = rtac::types::Handle<const MultiFanRenderer>;
+
+    using Shape        = View::Shape;
+    using Mat4         = View::Mat4;
+    using Point4       = FanRenderer::Point4;
+    using Interval     = FanRenderer::Interval;
+    using Rectangle    = FanRenderer::Rectangle;
+    using Direction    = FanRenderer::Direction;
+    using Interpolator = FanRenderer::Interpolator;
+
+    static const std::string& fragmentShader;
+
+    static constexpr unsigned int BearingMapSize = 512;
+    static constexpr float        MaxSectorStep  = 5.0f*M_PI / 180.0f;
+
+    enum class BlendMode : uint32_t {
+        Max    = 0, // maximum of the overlapping sensors.
+        Mean   = 1, // mean of the overlapping sensors.
+        Latest = 2, // sensor with the most recent data.
+    };
+
+    /**
+     * Per sensor parameters, laid out as the std430 shader struct.
+     */
+    struct SensorParameters {
+        float    x, y;             // position in the display plane.
+        float    cosHeading, sinHeading;
+        float    angleMin, angleMax;
+        float    rangeMin, rangeMax;
+        int32_t  bearingMapLayer;  // -1 for linear bearings.
+        uint32_t stamp;            // data update counter, 0 if no data.
+        float    padding[2];
+    };
+
+    protected:
+
+    struct Sensor {
+        float    x, y, heading;
+        Interval angle;
+        Interval range;
+        bool     bearingMap;
+        uint32_t stamp;
+    };
+
+    std::vector<Sensor> sensors_;
+    uint32_t            stamp_;
+
+    GLTextureArray::Ptr data_;
+    GLenum              dataType_;
+    float               dataScale_;
+    GLTextureArray::Ptr bearingMaps_;
+
+    Colormap::Ptr colormap_;
+    Interval      valueRange_;
+    BlendMode     blendMode_;
+    Direction     direction_;
+
+    mutable bool                       geometryChanged_;   // mesh and bounds
+    mutable bool                       parametersChanged_; // sensor parameters
+    mutable Rectangle                  bounds_;
+    mutable GLVector<Point4>           mesh_;
+    mutable GLVector<SensorParameters> parameters_;
+
+    MultiFanRenderer(const GLContext::Ptr& context, unsigned int sensorCount);
+
+    Sensor& sensor(unsigned int index);
+    void update_geometry() const;
+    void update_parameters() const;
+    template <typename T>
+    void prepare_data(const Shape& shape);
+
+    public:
+
+    static Ptr Create(const GLContext::Ptr& context, unsigned int sensorCount);
+
+    void set_sensor_count(unsigned int sensorCount);
+    unsigned int sensor_count() const { return sensors_.size(); }
+
+    void set_pose(unsigned int sensor, float x, float y, float heading);
+    void set_geometry(unsigned int sensor, const Interval& angle,
+                      const Interval& range);
+    void set_geometry_degrees(unsigned int sensor, const Interval& angle,
+                              const Interval& range);
+    void set_bearings(unsigned int sensor, unsigned int nBeams,
+                      const float* bearings);
+    void disable_bearing_map(unsigned int sensor);
+
+    template <typename T>
+    void set_data(unsigned int sensor, const Shape& shape, const T* data);
+    template <typename T>
+    void set_data(unsigned int sensor, const Shape& shape,
+                  const GLVector<T>& data);
+
+    void set_value_range(Interval valueRange);
+    void set_blend_mode(BlendMode mode) { blendMode_ = mode; }
+    void set_direction(Direction dir)   { direction_ = dir;  }
+    void set_colormap(const Colormap::Ptr& colormap) { colormap_ = colormap; }
+
+    BlendMode blend_mode() const { return blendMode_; }
+    Rectangle bounds() const;
+
+    virtual void draw(const View::ConstPtr& view) const;
+};
+
+/**
+ * (Re)allocates the data texture array if the data shape or type changed.
+ * This invalidates the data of all the sensors.
+ */
+template <typename T>
+void MultiFanRenderer::prepare_data(const Shape& shape)
+{
+    if(data_->depth() == sensors_.size()
+       && data_->width()  == shape.width
+       && data_->height() == shape.height
+       && dataType_ == GLFormat<T>::Type) {
+        return;
+    }
+    data_->resize<T>(shape, sensors_.size());
+    data_->set_filter_mode(GLTextureArray::FilterMode::Linear);
+    data_->set_wrap_mode(GLTextureArray::WrapMode::Clamp);
+    dataType_  = GLFormat<T>::Type;
+    dataScale_ = normalization_factor(dataType_);
+    for(auto& s : sensors_) {
+        s.stamp = 0;
+    }
+    parametersChanged_ = true;
+}
+
+/**
+ * Uploads the data of a single sensor from host memory.
+ */
+template <typename T>
+void MultiFanRenderer::set_data(unsigned int sensor, const Shape& shape,
+                                const T* data)
+{
+    auto& s = this->sensor(sensor);
+    this->prepare_data<T>(shape);
+    data_->set_layer(sensor, data);
+    s.stamp = ++stamp_;
+    parametersChanged_ = true;
+}
+
+/**
+ * Uploads the data of a single sensor from a GLVector (device to device copy).
+ */
+template <typename T>
+void MultiFanRenderer::set_data(unsigned int sensor, const Shape& shape,
+                                const GLVector<T>& data)
+{
+    auto& s = this->sensor(sensor);
+    this->prepare_data<T>(shape);
+    data_->set_layer(sensor, data);
+    s.stamp = ++stamp_;
+    parametersChanged_ = true;
+}
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_MULTI_FAN_RENDERER_H_
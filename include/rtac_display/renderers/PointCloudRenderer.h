@@ -1,11 +1,57 @@
 #ifndef _DEF_RTAC_DISPLAY_RENDERERS_POINTCLOUD_RENDERER_H_
 #define _DEF_RTAC_DISPLAY_RENDERERS_POINTCLOUD_RENDERER_H_
 
+#include <map>
+#include <memory>
+#include <functional>
+
+#include <rtac_base/types/Bounds.h>
+
 #include <rtac_display/GLMesh.h>
+#include <rtac_display/GLFormat.h>
+#include <rtac_display/GLTexture.h>
+#include <rtac_display/GLFrameBuffer.h>
+#include <rtac_display/GLReductor.h>
+#include <rtac_display/GLVoxelGrid.h>
+#include <rtac_display/Colormap.h>
+#include <rtac_display/colormaps/Viridis.h>
 #include <rtac_display/renderers/MeshRenderer.h>
 
 namespace rtac { namespace display {
 
+/**
+ * MeshRenderer in Points mode, owning its mesh.
+ *
+ * Points can be colored by a scalar attribute (depth, intensity, time...)
+ * mapped through a Colormap in the vertex shader. Attributes are GLVectors
+ * with one value per point, of float, uint16_t, uint8_t or Half type
+ * (narrow types are read natively by the vertex shader, without conversion).
+ * Several attributes can be attached to the renderer, switching the
+ * displayed attribute only changes the bound buffer (no upload).
+ *
+ * Attribute value ranges are computed on the GPU (GLReductor) when the
+ * attribute is added or with update_range, or set by the user.
+ *
+ * The size of the points on screen is either fixed (in pixels), computed
+ * from a world space radius (splats getting larger when the camera gets
+ * closer), or adaptive (world space radius estimated from the point density
+ * so that neighbouring points touch on screen). Points can be drawn as round
+ * splats with a depth correction (each point is shaded as a small sphere in
+ * the depth buffer).
+ *
+ * Eye-dome lighting (EDL, Boucheny 2009) can be applied as a post-process :
+ * the points are drawn in an offscreen GLFrameBuffer, then composited with a
+ * shading computed from the depth differences with neighbouring pixels. This
+ * reveals the shape of the point cloud without normals and makes sparse
+ * clouds (lower point budgets) much more legible.
+ *
+ * When a point budget is set, clouds larger than the budget are decimated on
+ * the GPU with a voxel grid (GLVoxelGrid, one point kept per voxel). The
+ * voxel size is adjusted to the budget and the kept points are drawn through
+ * an index buffer, so the attributes are still valid without copy. The
+ * decimation is done again when the points are modified through points() or
+ * mesh() (or with update_decimation).
+ */
 class PointCloudRenderer : public MeshRenderer
 {
     public:
@@ -13,21 +59,81 @@ class PointCloudRenderer : public MeshRenderer
     using Ptr      = rtac::types::Handle<PointCloudRenderer>;
     using ConstPtr = rtac::types::Handle<const PointCloudRenderer>;
 
+    using Interval = rtac::types::Interval<float>;
+
+    enum class SizeMode {
+        Fixed,    // point size in pixels
+        World,    // splat radius in world units
+        Adaptive, // splat radius estimated from the point density
+    };
+
+    static const std::string vertexShaderPoints;
+    static const std::string fragmentShaderSplats;
+    static const std::string vertexShaderEdl;
+    static const std::string fragmentShaderEdl;
+
+    // The GLVector is shared with the caller and may be resized (or
+    // reallocated) after add_attribute : its buffer and size are read
+    // through these accessors at each draw.
+    struct ScalarAttribute {
+        std::shared_ptr<const void> data; // keeps the GLVector alive.
+        GLenum   type;
+        Interval range;
+        std::function<GLuint()> buffer;
+        std::function<size_t()> size;
+        std::function<Interval(const GLReductor&)> compute_range;
+    };
+
     protected:
 
     GLMesh::Ptr mutableMesh_;
 
+    std::map<std::string, ScalarAttribute> attributes_;
+    std::string   activeAttribute_; // empty : uniform color.
+    Colormap::Ptr colormap_;
+    GLReductor    reductor_;
+
+    SizeMode sizeMode_;
+    float    pointSize_;   // in pixels (SizeMode::Fixed)
+    float    splatRadius_; // in world units (SizeMode::World)
+    float    minPointSize_;
+    float    maxPointSize_;
+    bool     roundPoints_;
+    GLuint   pointProgram_;
+    GLuint   splatProgram_;
+
+    bool               edlEnabled_;
+    float              edlStrength_;
+    float              edlRadius_; // in pixels
+    GLuint             edlProgram_;
+    GLFrameBuffer::Ptr edlFrameBuffer_;
+    GLTexture::Ptr     edlColor_;
+    GLTexture::Ptr     edlDepth_;
+
+    GLVoxelGrid                voxelGrid_;
+    size_t                     pointBudget_; // 0 : no decimation
+    mutable bool               decimationDirty_;
+    mutable const GLMesh*      decimatedMesh_;
+    mutable size_t             decimatedVertexCount_;
+    mutable bool               decimated_;
+    mutable float              decimationVoxelSize_;
+    mutable GLVector<uint32_t> decimatedIndices_;
+    mutable size_t             drawnPoints_;
+
     // Making render mode protected
     using MeshRenderer::set_render_mode;
 
     PointCloudRenderer(const GLContext::Ptr& context,
-                       const Color::RGBAf& color = {1.0,1.0,1.0,1.0}) :
-        MeshRenderer(context, color),
-        mutableMesh_(GLMesh::Create())
-    {
-        mesh_ = mutableMesh_;
-        this->set_render_mode(MeshRenderer::Mode::Points);
-    }
+                       const Color::RGBAf& color = {1.0,1.0,1.0,1.0});
+
+    void add_attribute(const std::string& name, ScalarAttribute&& attribute,
+                       bool computeRange);
+    float adaptive_radius(size_t count) const;
+    void decimate() const;
+    void resize_edl_targets(const Shape& shape) const;
+    void draw_points(const View::ConstPtr& view, const ScalarAttribute* attribute) const;
+    void draw_eye_dome_lighting(const View::ConstPtr& view,
+                                const ScalarAttribute* attribute) const;
 
     public:
 
@@ -37,12 +143,118 @@ class PointCloudRenderer : public MeshRenderer
         return Ptr(new PointCloudRenderer(context, color));
     }
 
-    GLMesh::Ptr mesh() { return mutableMesh_; }
+    // Non-const accesses may modify the points : the decimation and the
+    // bounds of the mesh are computed again at the next draw.
+    GLMesh::Ptr mesh() { decimationDirty_ = true;
+                         mutableMesh_->invalidate_bounds();
+                         return mutableMesh_; }
+
+    GLVector<GLMesh::Point>&       points()       { decimationDirty_ = true;
+                                                    mutableMesh_->invalidate_bounds();
+                                                    return mutableMesh_->points(); }
+    const GLVector<GLMesh::Point>& points() const {
+        return static_cast<const GLMesh&>(*mutableMesh_).points();
+    }
+
+    template <typename T>
+    void add_attribute(const std::string& name,
+                       const rtac::types::Handle<const GLVector<T>>& data,
+                       bool computeRange = true);
+    template <typename T>
+    void add_attribute(const std::string& name,
+                       const rtac::types::Handle<GLVector<T>>& data,
+                       bool computeRange = true);
+    template <typename T>
+    void add_attribute(const std::string& name, const GLVector<T>& data,
+                       bool computeRange = true);
+    void remove_attribute(const std::string& name);
+    void clear_attributes();
+
+    void set_active_attribute(const std::string& name);
+    void set_range(const std::string& name, const Interval& range);
+    void update_range(const std::string& name);
+    void set_colormap(const Colormap::Ptr& colormap);
+
+    bool has_attribute(const std::string& name) const;
+    const ScalarAttribute& attribute(const std::string& name) const;
+    const std::string&     active_attribute() const { return activeAttribute_; }
+    Colormap::ConstPtr     colormap()         const { return colormap_;        }
+
+    void set_point_size(float pixels);
+    void set_splat_radius(float radius);
+    void set_adaptive_size();
+    void set_point_size_range(float minPixels, float maxPixels);
+    void set_round_points(bool round) { roundPoints_ = round; }
+    SizeMode size_mode()    const { return sizeMode_;    }
+    float    point_size()   const { return pointSize_;   }
+    float    splat_radius() const { return splatRadius_; }
+    bool     round_points() const { return roundPoints_; }
+
+    void enable_eye_dome_lighting(float strength = 1.0f, float radius = 1.4f);
+    void disable_eye_dome_lighting() { edlEnabled_ = false; }
+    bool eye_dome_lighting_enabled() const { return edlEnabled_; }
+
+    void   set_point_budget(size_t budget);
+    void   update_decimation() { decimationDirty_ = true; }
+    size_t point_budget()          const { return pointBudget_;         }
+    size_t drawn_point_count()     const { return drawnPoints_;         }
+    float  decimation_voxel_size() const { return decimationVoxelSize_; }
 
-    GLVector<GLMesh::Point>&       points()       { return mutableMesh_->points(); }
-    const GLVector<GLMesh::Point>& points() const { return mutableMesh_->points(); }
+    virtual void draw(const View::ConstPtr& view) const;
 };
 
+/**
+ * Attaches a scalar attribute to the points. The GLVector is shared with the
+ * caller (no copy). If its content is modified later, call update_range to
+ * update the value range.
+ *
+ * @param name         name of the attribute (replaces an attribute with the
+ *                     same name).
+ * @param data         one value per point.
+ * @param computeRange computes the value range on the GPU. Otherwise the
+ *                     range is the previous range of the attribute (or [0,1]).
+ */
+template <typename T>
+void PointCloudRenderer::add_attribute(const std::string& name,
+                                       const rtac::types::Handle<const GLVector<T>>& data,
+                                       bool computeRange)
+{
+    static_assert(GLFormat<T>::Size == 1, "Point attributes must be scalars");
+    if(!data) {
+        throw std::runtime_error("PointCloudRenderer::add_attribute : no data.");
+    }
+
+    ScalarAttribute attribute;
+    attribute.data   = data;
+    attribute.type   = GLFormat<T>::Type;
+    attribute.range  = Interval({0.0f,1.0f});
+    attribute.buffer = [data]() { return data->gl_id(); };
+    attribute.size   = [data]() { return data->size();  };
+    attribute.compute_range = [data](const GLReductor& reductor) {
+        return Interval({reductor.min_value(*data), reductor.max_value(*data)});
+    };
+    this->add_attribute(name, std::move(attribute), computeRange);
+}
+
+template <typename T>
+void PointCloudRenderer::add_attribute(const std::string& name,
+                                       const rtac::types::Handle<GLVector<T>>& data,
+                                       bool computeRange)
+{
+    this->add_attribute(name, rtac::types::Handle<const GLVector<T>>(data), computeRange);
+}
+
+/**
+ * Attaches a scalar attribute to the points. data is copied on the device
+ * (no host transfer).
+ */
+template <typename T>
+void PointCloudRenderer::add_attribute(const std::string& name, const GLVector<T>& data,
+                                       bool computeRange)
+{
+    this->add_attribute(name,
+        rtac::types::Handle<const GLVector<T>>(new GLVector<T>(data)), computeRange);
+}
 
 }; //namespace display
 }; //namespace rtac
@@ -0,0 +1,145 @@
+#ifndef _DEF_RTAC_DISPLAY_RENDERERS_POINT_OCTREE_RENDERER_H_
+#define _DEF_RTAC_DISPLAY_RENDERERS_POINT_OCTREE_RENDERER_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <rtac_base/types/Handle.h>
+
+#include <rtac_display/GLContext.h>
+#include <rtac_display/Color.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/PointOctree.h>
+#include <rtac_display/renderers/Renderer.h>
+#include <rtac_display/views/View3D.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Out-of-core renderer for point clouds stored in a PointOctree file.
+ *
+ * At each draw the visible nodes are selected by decreasing projected size,
+ * until the point budget is reached or until the nodes are smaller than the
+ * minimum node size on screen. The number of drawn points (and so the frame
+ * time) is bounded by the budget, whatever the size of the point cloud.
+ *
+ * Nodes are read from the file by loader threads (in priority order, the
+ * requests are updated at each draw) and uploaded in a pool of fixed size
+ * slots of a single GPU buffer (one slot holds PointOctree::max_node_points
+ * points). When the pool is full, the least recently drawn node is evicted.
+ * A node is drawn only if its parent is resident, the visible nodes are
+ * drawn with a single multi draw call.
+ *
+ * The pool holds the node-relative points of the file, the node center of
+ * each slot is added in the vertex shader. The points are drawn in the
+ * octree frame (centered on PointOctree::origin()), use set_pose to place
+ * this frame in the scene.
+ */
+class PointOctreeRenderer : public Renderer
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<PointOctreeRenderer>;
+    using ConstPtr = rtac::types::Handle<const PointOctreeRenderer>;
+
+    using Mat4  = View3D::Mat4;
+    using Pose  = View3D::Pose;
+    using Point = PointOctree::Point;
+
+    static const std::string vertexShader;
+    static const std::string fragmentShader;
+
+    static constexpr uint32_t NoNode = 0xffffffff;
+
+    protected:
+
+    struct SlotCenter {
+        float x, y, z, w;
+    };
+
+    struct LoadedNode {
+        uint32_t           node;
+        std::vector<Point> points;
+    };
+
+    PointOctree::ConstPtr octree_;
+    Pose                  pose_;
+    Color::RGBAf          color_;
+    float                 pointSize_;
+    size_t                pointBudget_;
+    float                 minNodeSize_; // in pixels
+
+    // GPU node pool
+    mutable GLVector<Point>       pool_;
+    mutable GLVector<SlotCenter>  slotCenters_;  // center of the node in each slot
+    size_t                        slotSize_;
+    mutable std::vector<uint32_t> nodeSlots_;    // slot of each node, NoNode if not resident
+    mutable std::vector<uint32_t> slotNodes_;    // node in each slot, NoNode if free
+    mutable std::vector<uint64_t> slotLastUsed_; // last frame the slot was drawn
+    mutable uint64_t              frameIndex_;
+    mutable size_t                residentCount_;
+
+    // node loading
+    mutable std::mutex              mutex_;
+    mutable std::condition_variable condition_;
+    mutable std::deque<uint32_t>    requests_;
+    mutable std::vector<uint8_t>    pending_; // requested or being loaded
+    mutable size_t                  pendingCount_;
+    mutable std::vector<LoadedNode> loaded_;
+    std::vector<std::thread>        loaders_;
+    bool                            stop_;
+
+    mutable std::vector<GLint>    drawFirsts_;
+    mutable std::vector<GLsizei>  drawCounts_;
+    mutable std::vector<uint32_t> wanted_;
+    mutable size_t                drawnPoints_;
+
+    PointOctreeRenderer(const GLContext::Ptr& context,
+                        const PointOctree::ConstPtr& octree,
+                        size_t poolSize,
+                        const Color::RGBAf& color);
+
+    void load_nodes();
+    void upload_loaded_nodes() const;
+    uint32_t acquire_slot() const;
+    void select_nodes(const View::ConstPtr& view, const Mat4& viewMatrix) const;
+    void request_nodes() const;
+
+    public:
+
+    static Ptr Create(const GLContext::Ptr& context,
+                      const PointOctree::ConstPtr& octree,
+                      size_t poolSize = 16000000,
+                      const Color::RGBAf& color = {1.0,1.0,1.0,1.0});
+    ~PointOctreeRenderer();
+
+    PointOctreeRenderer(const PointOctreeRenderer&)            = delete;
+    PointOctreeRenderer& operator=(const PointOctreeRenderer&) = delete;
+
+    void set_pose(const Pose& pose) { pose_ = pose; }
+    void set_color(const Color::RGBAf& color);
+    void set_point_size(float size);
+    void set_point_budget(size_t pointCount) { pointBudget_ = pointCount; }
+    void set_min_node_size(float pixels);
+
+    PointOctree::ConstPtr octree()        const { return octree_;      }
+    size_t                point_budget()  const { return pointBudget_; }
+    float                 min_node_size() const { return minNodeSize_; }
+
+    virtual void draw(const View::ConstPtr& view) const;
+    virtual BoundingSphere world_bounds() const;
+
+    size_t drawn_point_count()   const { return drawnPoints_;        }
+    size_t drawn_node_count()    const { return drawCounts_.size();  }
+    size_t resident_node_count() const { return residentCount_;      }
+    size_t slot_count()          const { return slotNodes_.size();   }
+    size_t pending_node_count()  const;
+};
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_RENDERERS_POINT_OCTREE_RENDERER_H_
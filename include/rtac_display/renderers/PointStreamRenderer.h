@@ -0,0 +1,114 @@
+#ifndef _DEF_RTAC_DISPLAY_RENDERERS_POINT_STREAM_RENDERER_H_
+#define _DEF_RTAC_DISPLAY_RENDERERS_POINT_STREAM_RENDERER_H_
+
+#include <vector>
+#include <deque>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Point.h>
+
+#include <rtac_display/GLContext.h>
+#include <rtac_display/Color.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/renderers/Renderer.h>
+#include <rtac_display/views/View3D.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Displays a live stream of points (e.g. lidar or sonar returns arriving in
+ * batches).
+ *
+ * Points are appended in a fixed capacity ring buffer on the device. Each
+ * batch is written with sub-range updates (at most two, when the batch wraps
+ * around the end of the buffer), so the cost of a push only depends on the
+ * batch size and the memory used stays bounded whatever the stream
+ * duration. When the buffer is full the oldest points are overwritten.
+ *
+ * Each point has a time stamp (the batch stamp or per-point stamps). When a
+ * fade duration is set, points fade out with their age and are dropped once
+ * older than the fade duration. The live points are always a contiguous
+ * range of the ring, drawn with at most two ranges.
+ */
+class PointStreamRenderer : public Renderer
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<PointStreamRenderer>;
+    using ConstPtr = rtac::types::Handle<const PointStreamRenderer>;
+
+    using Mat4  = View3D::Mat4;
+    using Pose  = View3D::Pose;
+    using Point = rtac::types::Point3<float>;
+
+    static const std::string vertexShader;
+    static const std::string fragmentShader;
+
+    protected:
+
+    struct Range {
+        size_t dst;   // index in the ring buffer
+        size_t src;   // index in the batch
+        size_t count;
+    };
+
+    struct Batch {
+        size_t end;   // total number of points pushed after this batch
+        double stamp; // newest stamp in the batch
+    };
+
+    GLVector<Point> points_;
+    GLVector<float> stamps_;  // relative to timeOrigin_
+    size_t          capacity_;
+    size_t          pushed_;  // points pushed since last clear
+    size_t          first_;   // oldest live point (counted like pushed_)
+    std::deque<Batch> batches_;
+    std::vector<float> stampBuffer_;
+
+    bool   hasTimeOrigin_;
+    double timeOrigin_;
+    double currentTime_;
+    float  fadeDuration_;
+
+    Pose         pose_;
+    Color::RGBAf color_;
+    float        pointSize_;
+
+    PointStreamRenderer(const GLContext::Ptr& context, size_t capacity,
+                        const Color::RGBAf& color);
+
+    unsigned int next_ranges(size_t count, Range* ranges);
+    const float* relative_stamps(size_t count, const double* stamps);
+    void end_batch(size_t count, double stamp);
+    void expire();
+
+    public:
+
+    static Ptr Create(const GLContext::Ptr& context, size_t capacity = 1000000,
+                      const Color::RGBAf& color = {1.0,1.0,1.0,1.0});
+
+    void push_points(size_t count, const Point* points, double stamp);
+    void push_points(size_t count, const Point* points, const double* stamps);
+    void push_points(const GLVector<Point>& points, double stamp);
+    void clear();
+    void set_capacity(size_t capacity);
+
+    void set_current_time(double time);
+    void set_fade_duration(float seconds);
+    void set_pose(const Pose& pose) { pose_ = pose; }
+    void set_color(const Color::RGBAf& color);
+    void set_point_size(float size);
+
+    size_t capacity()      const { return capacity_;       }
+    size_t size()          const { return pushed_ - first_; }
+    size_t pushed_count()  const { return pushed_;         }
+    double current_time()  const { return currentTime_;    }
+    float  fade_duration() const { return fadeDuration_;   }
+
+    virtual void draw(const View::ConstPtr& view) const;
+};
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_RENDERERS_POINT_STREAM_RENDERER_H_
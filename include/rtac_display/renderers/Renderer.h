@@ -6,6 +6,7 @@
 #include <rtac_display/utils.h>
 #include <rtac_display/GLContext.h>
 #include <rtac_display/views/View.h>
+#include <rtac_display/views/Frustum.h>
 
 namespace rtac { namespace display {
 
@@ -50,6 +51,7 @@ class Renderer
 
     const GLContext::Ptr context() const { return context_; }
     virtual void draw(const View::ConstPtr& view) const;
+    virtual BoundingSphere world_bounds() const;
 };
 
 }; //namespace display
@@ -0,0 +1,92 @@
+#ifndef _DEF_RTAC_DISPLAY_WATERFALL_RENDERER_H_
+#define _DEF_RTAC_DISPLAY_WATERFALL_RENDERER_H_
+
+#include <iostream>
+
+#include <rtac_base/types/Handle.h>
+
+#include <rtac_display/GLVector.h>
+#include <rtac_display/GLTextureArray.h>
+#include <rtac_display/renderers/FanRenderer.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Displays a history of sonar pings, either as a scrolling waterfall or as a
+ * fan with persistence of past pings.
+ *
+ * Pings are stored in a ring buffer of texture layers (GLTextureArray). Each
+ * new ping is written into a single layer and the shaders handle the
+ * wrap-around, so the upload cost of a ping does not depend on the history
+ * size.
+ *
+ * Ping data follows the FanRenderer convention : texture width is the bearing
+ * dimension, height the range dimension. Geometry and bearings are set with
+ * the FanRenderer methods. The fan mode always uses the FanRenderer lookup
+ * table.
+ */
+class WaterfallRenderer : public FanRenderer
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<WaterfallRenderer>;
+    using ConstPtr = rtac::types::Handle<const WaterfallRenderer>;
+
+    static const std::string& fragmentShaderHistory;
+    static const std::string& vertexShaderWaterfall;
+    static const std::string& fragmentShaderWaterfall;
+
+    enum class Mode : uint8_t {
+        Fan       = 0, // Current fan blended with decaying past fans.
+        Waterfall = 1, // One row per ping, most recent on top.
+    };
+
+    protected:
+
+    GLTextureArray::Ptr history_;
+    GLVector<float>     pingBuffer_; // host pings staging (value range computation)
+    unsigned int        historySize_;
+    unsigned int        newest_;    // layer of the most recent ping.
+    unsigned int        pingCount_; // number of valid layers.
+
+    Mode         mode_;
+    float        decay_;
+    unsigned int persistence_;
+    float        waterfallBearing_;
+
+    GLuint historyProgram_;
+    GLuint waterfallProgram_;
+
+    WaterfallRenderer(const GLContext::Ptr& context, unsigned int historySize);
+
+    unsigned int next_layer(const Shape& shape);
+    void draw_fan(const View::ConstPtr& view) const;
+    void draw_waterfall(const View::ConstPtr& view) const;
+
+    public:
+
+    static Ptr Create(const GLContext::Ptr& context, unsigned int historySize = 256);
+
+    void push_ping(const Shape& shape, const float* data,
+                   bool computeScale = true);
+    void push_ping(const Shape& shape, const GLVector<float>& data,
+                   bool computeScale = true);
+    void clear_history();
+    void set_history_size(unsigned int size);
+
+    void set_mode(Mode mode) { mode_ = mode; }
+    void set_decay(float decay, unsigned int persistence);
+    void set_waterfall_bearing(float normalizedBearing);
+
+    Mode         mode()         const { return mode_;        }
+    unsigned int history_size() const { return historySize_; }
+    unsigned int ping_count()   const { return pingCount_;   }
+    GLTextureArray::ConstPtr history() const { return history_; }
+
+    virtual void draw(const View::ConstPtr& view) const;
+};
+
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_WATERFALL_RENDERER_H_
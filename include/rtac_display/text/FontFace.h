@@ -3,34 +3,68 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <list>
+#include <unordered_map>
 
 #include <rtac_display/GLTexture.h>
 
 #include <rtac_display/text/freetype.h>
 #include <rtac_display/text/Glyph.h>
+#include <rtac_display/text/GlyphAtlas.h>
 
 namespace rtac { namespace display { namespace text {
 
+/**
+ * A font at a given size, with a cache of rasterized glyphs.
+ *
+ * Glyphs are identified by their unicode code point and are rasterized into
+ * the GlyphAtlas on first use. The cache is bounded by a memory budget, least
+ * recently used glyphs being evicted first (see FontFace::set_cache_budget).
+ */
 class FontFace : public std::enable_shared_from_this<FontFace>
 {
     public:
 
     using Ptr      = std::shared_ptr<FontFace>;
     using ConstPtr = std::shared_ptr<const FontFace>;
-    using GlyphMap = std::unordered_map<uint8_t, Glyph>;
+    using GlyphMap = std::unordered_map<uint32_t, Glyph>;
+
+    static constexpr size_t DefaultCacheBudget = 8*1024*1024;
 
     protected:
 
+    struct CacheEntry {
+        std::list<uint32_t>::iterator lru;
+        unsigned int                  slot;
+    };
+
     Library::Ptr   ft_;
     FT_Face        face_;
-    GlyphMap       glyphs_;
     FT_Render_Mode renderMode_;
+    unsigned int   distanceFieldSpread_; // 0 if distance field is disabled.
+    size_t         cacheBudget_;
+
+    // Glyph cache. Populated lazily from const accessors.
+    mutable GlyphMap                                 glyphs_;
+    mutable std::unordered_map<uint32_t, CacheEntry> cacheEntries_;
+    mutable std::list<uint32_t>                      lru_; // most recent first
+    mutable GlyphAtlas                               atlas_;
+    mutable uint64_t                                 generation_;
+
+    mutable std::vector<uint8_t> bitmapData_; // reused for bitmap conversions
 
     FontFace(const std::string& fontFilename,
              uint32_t faceIndex,
              const Library::Ptr& ftLibrary,
              FT_Render_Mode renderMode);
 
+    Shape glyph_cell_shape() const;
+    Rect  add_to_atlas(FT_GlyphSlot glyph, unsigned int slot) const;
+    Rect  add_distance_field_to_atlas(FT_GlyphSlot glyph, unsigned int slot) const;
+    const Glyph& load_glyph(uint32_t codePoint) const;
+    unsigned int cache_capacity() const;
+
     public:
 
     static Ptr Create(const std::string& fontFilename,
@@ -41,10 +75,15 @@ class FontFace : public std::enable_shared_from_this<FontFace>
     
     void set_char_size(float pt, FT_UInt screenDpi = 102);
     void set_pixel_size(FT_UInt size);
+    void enable_distance_field(FT_UInt rasterSize = 48, unsigned int spread = 8);
     void load_glyphs();
+    void set_cache_budget(size_t bytes);
+    size_t cache_budget() const;
+    uint64_t generation() const;
 
     const GlyphMap& glyphs() const;
-    const Glyph& glyph(uint8_t c) const;
+    const Glyph& glyph(uint32_t codePoint) const;
+    const GlyphAtlas& atlas() const;
     const FT_Face& face() const;
     
     // These return values in pixel (handle sub-pixels)
@@ -52,9 +91,12 @@ class FontFace : public std::enable_shared_from_this<FontFace>
     float descender() const;
     float baselineskip() const;
     float max_advance() const;
+    float pixel_size() const;
     FT_Render_Mode render_mode() const;
+    bool is_distance_field() const;
+    unsigned int distance_field_spread() const;
 
-    FT_Vector get_kerning(char left, char right) const;
+    FT_Vector get_kerning(uint32_t left, uint32_t right) const;
 };
 
 }; //namespace text
@@ -5,9 +5,8 @@
 
 #include <rtac_base/types/Point.h>
 
-#include <rtac_display/Color.h>
+#include <rtac_display/utils.h>
 #include <rtac_display/views/View.h>
-#include <rtac_display/GLTexture.h>
 #include <rtac_display/text/freetype.h>
 
 namespace rtac { namespace display { namespace text {
@@ -15,50 +14,37 @@ namespace rtac { namespace display { namespace text {
 // Forward declaration
 class FontFace;
 
+/**
+ * Metrics of a single glyph and location of its bitmap in the GlyphAtlas of
+ * its FontFace.
+ *
+ * The glyph does not own any OpenGL resource. All glyphs of a FontFace are
+ * stored in the same atlas texture.
+ */
 class Glyph
 {
     public:
-    
+
     // Only the FontFace type is allowed to create a new Glyph
     friend class FontFace;
 
     using Mat4 = View::Mat4;
 
-    static const std::string vertexShader;
-    static const std::string fragmentShaderFlat;
-    static const std::string fragmentShaderSubPix;
-
     protected:
-    
+
     types::Point2<float> bearing_;
     types::Point2<float> advance_;
     types::Point2<float> shape_;
-    mutable GLTexture    texture_;
-
-    GLuint renderProgramFlat_;
-    GLuint renderProgramSubPix_;
-    GLuint renderProgram_;
+    Rect                 atlasRect_;
 
-    Glyph(FT_GlyphSlot glyph);
-
-    void load_bitmap(FT_GlyphSlot glyph);
+    Glyph(FT_GlyphSlot glyph, const Rect& atlasRect);
 
     public:
 
-    // Disallowing Glyph copy
-    Glyph(const Glyph&)            = delete;
-    Glyph& operator=(const Glyph&) = delete;
-
-    Glyph(Glyph&& other);
-    Glyph& operator=(Glyph&& other);
-
-    types::Point2<float> bearing() const;
-    types::Point2<float> advance() const;
-    types::Point2<float> shape()   const;
-    const GLTexture&     texture() const;
-
-    void draw(const Mat4& mat = Mat4::Identity(),
-              const Color::RGBAf& color = {0,0,0,0}) const;
+    types::Point2<float> bearing()    const;
+    types::Point2<float> advance()    const;
+    types::Point2<float> shape()      const;
+    const Rect&          atlas_rect() const;
 };
 
 }; //namespace text
@@ -0,0 +1,67 @@
+#ifndef _DEF_RTAC_DISPLAY_TEXT_GLYPH_ATLAS_H_
+#define _DEF_RTAC_DISPLAY_TEXT_GLYPH_ATLAS_H_
+
+#include <iostream>
+#include <cstdint>
+
+#include <rtac_display/utils.h>
+#include <rtac_display/GLTexture.h>
+
+namespace rtac { namespace display { namespace text {
+
+/**
+ * Single texture holding the rasterized bitmaps of all the glyphs of a
+ * FontFace.
+ *
+ * The atlas is divided in a grid of cells of identical size (large enough to
+ * hold any glyph of the font at its current size). This allows all the text
+ * of a FontFace to be drawn from a single texture without any texture switch,
+ * and all the glyphs of a text block to be drawn in a single instanced draw
+ * call.
+ *
+ * Glyph locations are given in atlas pixels (not in normalized texture
+ * coordinates) so they stay valid when the atlas grows. Cells can be
+ * overwritten (see GlyphAtlas::set) so a glyph cache can recycle the cells of
+ * evicted glyphs.
+ */
+class GlyphAtlas
+{
+    public:
+
+    static constexpr unsigned int Columns = 16;
+    static constexpr unsigned int Padding = 1;
+
+    protected:
+
+    GLTexture             texture_;
+    GLTexture::FilterMode filterMode_;
+    Shape                 cellShape_;
+    unsigned int channels_;
+    unsigned int rows_;
+    unsigned int slotCount_;
+
+    void allocate(GLTexture& texture, unsigned int rows) const;
+    void grow();
+
+    public:
+
+    GlyphAtlas();
+
+    void reset(const Shape& cellShape, unsigned int channels,
+               unsigned int capacityHint = 128,
+               GLTexture::FilterMode filterMode = GLTexture::Nearest);
+    Rect add(const Shape& shape, const uint8_t* data);
+    Rect set(unsigned int slot, const Shape& shape, const uint8_t* data);
+
+    const GLTexture& texture()    const { return texture_;   }
+    Shape            cell_shape() const { return cellShape_; }
+    unsigned int     channels()   const { return channels_;  }
+    unsigned int     size()       const { return slotCount_; }
+    unsigned int     capacity()   const { return Columns*rows_; }
+};
+
+}; //namespace text
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_TEXT_GLYPH_ATLAS_H_
@@ -0,0 +1,161 @@
+#ifndef _DEF_RTAC_DISPLAY_TEXT_LABEL_LAYER_H_
+#define _DEF_RTAC_DISPLAY_TEXT_LABEL_LAYER_H_
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <rtac_display/utils.h>
+#include <rtac_display/GLContext.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/Color.h>
+#include <rtac_display/views/View.h>
+#include <rtac_display/renderers/Renderer.h>
+#include <rtac_display/text/FontFace.h>
+#include <rtac_display/text/TextRenderer.h>
+
+namespace rtac { namespace display { namespace text {
+
+/**
+ * Draws a large number of 3D anchored labels in a single draw call.
+ *
+ * Label strings are registered once with LabelLayer::add_text, which lays
+ * them out into glyph quads sampling the FontFace atlas. Labels are then
+ * given as a GLVector of Anchor (3D position, text id and color) which can be
+ * updated directly on the device.
+ *
+ * All the per-label work is done on the GPU with compute shaders :
+ * - projection and frustum culling,
+ * - screen-space overlap culling : the screen is divided into a grid of cells
+ *   and a label is hidden if a closer label covers one of its cells (greedy
+ *   and conservative),
+ * - far-to-near depth sorting of the remaining labels (bitonic sort),
+ * - generation of an indirect draw command.
+ *
+ * Labels are finally drawn with a single glDrawArraysIndirect call (one
+ * instance per label) without any CPU readback.
+ *
+ * LCD (subpixel) fonts are not supported. Use either a grayscale
+ * (FT_RENDER_MODE_NORMAL) or a distance field font.
+ */
+class LabelLayer : public Renderer
+{
+    public:
+
+    using Ptr       = rtac::types::Handle<LabelLayer>;
+    using ConstPtr  = rtac::types::Handle<const LabelLayer>;
+    using Mat4      = View::Mat4;
+    using Vec2      = types::Vector2<float>;
+    using GlyphQuad = TextRenderer::GlyphQuad;
+
+    /**
+     * A label to display. The layout matches the std430 layout of the
+     * shaders.
+     */
+    struct Anchor {
+        float        x, y, z;
+        uint32_t     textId; // as returned by LabelLayer::add_text
+        Color::RGBAf color;
+    };
+
+    // Device side types (std430 layout).
+    struct TextEntry {
+        uint32_t firstQuad;
+        uint32_t quadCount;
+        float    width;
+        float    height;
+    };
+    struct LabelState {
+        float origin[4]; // pixel position of the text origin, depth, sort key
+        float rect[4];   // screen rectangle in pixels
+    };
+    struct SortKey {
+        uint32_t key;
+        uint32_t index;
+    };
+    struct DrawCommand {
+        uint32_t count;
+        uint32_t instanceCount;
+        uint32_t first;
+        uint32_t baseInstance;
+    };
+
+    static const std::string vertexShader;
+    static const std::string fragmentShader;
+    static const std::string clearShader;
+    static const std::string projectShader;
+    static const std::string selectShader;
+    static const std::string sortShader;
+
+    static constexpr unsigned int BlockSize       = 256;
+    static constexpr unsigned int DefaultCellSize = 16;
+
+    protected:
+
+    FontFace::ConstPtr       font_;
+    std::vector<std::string> texts_;
+    GLVector<Anchor>         anchors_;
+
+    // Text layouts (updated lazily when the font glyph cache changes).
+    mutable std::vector<GlyphQuad> quads_;
+    mutable GLVector<GlyphQuad>    deviceQuads_;
+    mutable GLVector<TextEntry>    textEntries_;
+    mutable unsigned int           maxQuadCount_;
+    mutable uint64_t               layoutGeneration_;
+    mutable bool                   layoutChanged_;
+
+    // Per frame GPU data.
+    mutable GLVector<LabelState>  states_;
+    mutable GLVector<uint32_t>    grid_;
+    mutable GLVector<SortKey>     sortKeys_;
+    mutable GLVector<DrawCommand> command_;
+
+    Vec2         anchor_;
+    float        textSize_;
+    Color::RGBAf backColor_;
+    Color::RGBAf outlineColor_;
+    float        outlineWidth_;
+    bool         overlapCulling_;
+    unsigned int cellSize_;
+    float        margin_;
+
+    GLuint clearProgram_;
+    GLuint projectProgram_;
+    GLuint selectProgram_;
+    GLuint sortProgram_;
+
+    LabelLayer(const GLContext::Ptr& context, const FontFace::ConstPtr& font);
+
+    void update_layouts() const;
+    void compute_visible_labels(const View::ConstPtr& view) const;
+
+    public:
+
+    static Ptr Create(const GLContext::Ptr& context, const FontFace::ConstPtr& font);
+
+    uint32_t add_text(const std::string& text);
+    void clear_texts();
+
+    void set_anchors(unsigned int count, const Anchor* anchors);
+    void set_anchor(const std::string& desc);
+    void set_text_size(float pixels);
+    void set_back_color(const Color::RGBAf& color);
+    void set_outline(const Color::RGBAf& color, float width);
+    void set_overlap_culling(bool enable, unsigned int cellSize = DefaultCellSize,
+                             float margin = 0.0f);
+
+    FontFace::ConstPtr font() const { return font_; }
+    const std::vector<std::string>& texts() const { return texts_; }
+    GLVector<Anchor>&       anchors()       { return anchors_; }
+    const GLVector<Anchor>& anchors() const { return anchors_; }
+
+    float compute_scale() const;
+
+    virtual void draw(const View::ConstPtr& view) const;
+};
+
+}; //namespace text
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_TEXT_LABEL_LAYER_H_
@@ -4,16 +4,33 @@
 #include <iostream>
 #include <stdexcept>
 #include <cmath>
+#include <vector>
 
 #include <rtac_display/utils.h>
 #include <rtac_display/GLContext.h>
+#include <rtac_display/GLVector.h>
+#include <rtac_display/Color.h>
 #include <rtac_display/views/View.h>
 #include <rtac_display/renderers/Renderer.h>
 #include <rtac_display/text/FontFace.h>
 #include <rtac_display/text/Glyph.h>
+#include <rtac_display/text/utf8.h>
 
 namespace rtac { namespace display { namespace text {
 
+/**
+ * Draws a block of text anchored at a 2D or 3D position.
+ *
+ * The text is laid out on the CPU into a GLVector of glyph quads (one per
+ * character + one for the background) which all sample the GlyphAtlas of the
+ * FontFace. The whole text block is then drawn with a single instanced draw
+ * call without any offscreen rendering. Changing the text only re-uploads
+ * the glyph quads. The text is UTF-8 encoded.
+ *
+ * If the FontFace uses distance field glyphs (FontFace::enable_distance_field)
+ * the text can be scaled freely (set_text_size, set_world_size) and
+ * decorated with an outline and a halo, all from the same atlas.
+ */
 class TextRenderer : public Renderer
 {
     public:
@@ -22,28 +39,57 @@ class TextRenderer : public Renderer
     using ConstPtr = rtac::types::Handle<const TextRenderer>;
     using Mat4     = View::Mat4;
     using Vec2     = types::Vector2<float>;
+    using Vec3     = types::Vector3<float>;
     using Vec4     = types::Vector4<float>;
 
+    /**
+     * Per-instance vertex data. Positions are in pixels relative to the left
+     * end of the first baseline, atlas locations are in atlas pixels. A
+     * negative atlas width flags the background quad.
+     */
+    struct GlyphQuad {
+        float x, y, width, height;
+        float u, v, uWidth, vHeight;
+    };
+
     static const std::string vertexShader;
     static const std::string fragmentShaderFlat;
     static const std::string fragmentShaderSubPix;
+    static const std::string fragmentShaderSDF;
 
     protected:
-    
+
     FontFace::ConstPtr font_;
     std::string        text_;
-    GLTexture          texture_;
+    mutable Shape      textArea_;
+    mutable uint64_t   layoutGeneration_; // FontFace::generation at layout.
     Vec4               origin_; // full 3D space position.
     Vec2               anchor_;
     Color::RGBAf       textColor_;
     Color::RGBAf       backColor_;
 
+    // Distance field options (ignored with bitmap fonts).
+    float              textSize_;    // in pixels, 0 for font native size.
+    float              worldHeight_; // in world units, 0 to disable.
+    float              minPixels_;
+    float              maxPixels_;
+    Color::RGBAf       outlineColor_;
+    float              outlineWidth_;
+    Color::RGBAf       haloColor_;
+    float              haloWidth_;
+
+    mutable std::vector<GlyphQuad> quads_;
+    mutable GLVector<GlyphQuad>    deviceQuads_;
+
     GLuint renderProgramFlat_;
     GLuint renderProgramSubPix_;
-    
+    GLuint renderProgramSDF_;
+
     TextRenderer(const GLContext::Ptr& context,
                  const FontFace::ConstPtr& font);
 
+    void layout_glyphs() const;
+
     public:
 
     static Ptr Create(const GLContext::Ptr& context,
@@ -53,16 +99,26 @@ class TextRenderer : public Renderer
     void set_text_color(const Color::RGBAf& color, bool updateNow = true);
     void set_back_color(const Color::RGBAf& color, bool updateNow = true);
     void set_anchor(const std::string& desc);
+    void set_text_size(float pixels);
+    void set_world_size(float height, float minPixels = 0.0f,
+                        float maxPixels = 1.0e6f);
+    void set_outline(const Color::RGBAf& color, float width);
+    void set_halo(const Color::RGBAf& color, float width);
+
+    static void  parse_anchor(const std::string& desc, Vec2& anchor);
+    static Shape layout_text(const FontFace& font, const std::string& text,
+                             std::vector<GlyphQuad>& quads);
 
-    void update_texture();
-    Shape compute_text_area(const std::string& text);
+    void update_glyphs() const;
+    Shape compute_text_area(const std::string& text) const;
     float anchor_depth(const View::ConstPtr& view) const;
+    float compute_scale(const View::ConstPtr& view) const;
+    Vec3  compute_pixel_origin(const View::ConstPtr& view) const;
     std::array<Vec4,4> compute_corners(const View::ConstPtr& view) const;
 
     FontFace::ConstPtr font() const;
     const std::string& text() const;
-    const GLTexture&   texture() const;
-    Mat4 view_matrix() const;
+    const Shape&       text_area() const;
     Vec4& origin();
     const Vec4& origin() const;
     Vec2& anchor();
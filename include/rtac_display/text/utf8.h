@@ -0,0 +1,20 @@
+#ifndef _DEF_RTAC_DISPLAY_TEXT_UTF8_H_
+#define _DEF_RTAC_DISPLAY_TEXT_UTF8_H_
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+namespace rtac { namespace display { namespace text {
+
+// Code point substituted to invalid UTF-8 sequences.
+constexpr uint32_t ReplacementCharacter = 0xfffd;
+
+uint32_t       utf8_next(const std::string& text, size_t& pos);
+std::u32string utf8_decode(const std::string& text);
+
+}; //namespace text
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_TEXT_UTF8_H_
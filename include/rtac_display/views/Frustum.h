@@ -0,0 +1,75 @@
+#ifndef _DEF_RTAC_DISPLAY_FRUSTUM_H_
+#define _DEF_RTAC_DISPLAY_FRUSTUM_H_
+
+#include <iostream>
+#include <limits>
+
+#include <rtac_base/types/common.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Bounding sphere of a renderable object, used for visibility culling.
+ *
+ * A sphere with an infinite radius (the default) represents an object with
+ * unknown extent, which is never culled.
+ */
+struct BoundingSphere
+{
+    using Mat4    = rtac::types::Matrix4<float>;
+    using Vector3 = rtac::types::Vector3<float>;
+
+    Vector3 center;
+    float   radius;
+
+    BoundingSphere(const Vector3& c = Vector3::Zero(),
+                   float r = std::numeric_limits<float>::infinity()) :
+        center(c), radius(r)
+    {}
+
+    static BoundingSphere Infinite() { return BoundingSphere(); }
+
+    bool is_infinite() const { return !(radius < std::numeric_limits<float>::infinity()); }
+
+    BoundingSphere transformed(const Mat4& transform) const;
+    BoundingSphere merged(const BoundingSphere& other) const;
+};
+
+/**
+ * View frustum given by its 6 planes (left, right, bottom, top, near, far).
+ *
+ * The planes are extracted from a projection matrix (Gribb & Hartmann, "Fast
+ * Extraction of Viewing Frustum Planes from the World-View-Projection
+ * Matrix"). The planes are expressed in the input space of the matrix : a
+ * frustum extracted from View::view_matrix() is in world coordinates, a
+ * frustum extracted from view_matrix()*pose is in the local coordinates of an
+ * object at pose. Plane normals point towards the inside of the frustum.
+ */
+class Frustum
+{
+    public:
+
+    using Mat4    = rtac::types::Matrix4<float>;
+    using Vector3 = rtac::types::Vector3<float>;
+    using Vector4 = rtac::types::Vector4<float>;
+
+    protected:
+
+    Vector4 planes_[6];
+
+    public:
+
+    Frustum(const Mat4& viewMatrix = Mat4::Identity());
+
+    const Vector4& plane(unsigned int index) const { return planes_[index]; }
+
+    bool intersects(const Vector3& center, float radius) const;
+    bool intersects(const BoundingSphere& sphere) const;
+};
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::display::BoundingSphere& sphere);
+
+#endif //_DEF_RTAC_DISPLAY_FRUSTUM_H_
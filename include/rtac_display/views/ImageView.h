@@ -34,6 +34,7 @@ class ImageView : public View
     public:
 
     static Ptr New(const Shape& image = {1,1});
+    static Mat4 compute_projection(const Shape& screen, const Shape& image);
 
     ImageView(const Shape& image = {1,1});
     
@@ -9,6 +9,7 @@
 #include <rtac_base/types/Handle.h>
 
 #include <rtac_display/utils.h>
+#include <rtac_display/views/Frustum.h>
 
 namespace rtac { namespace display {
 
@@ -73,6 +74,7 @@ class View
 
     Mat4 projection_matrix() const;
     virtual Mat4 view_matrix() const;
+    Frustum frustum() const;
 
     Shape screen_size() const;
 
@@ -6,7 +6,10 @@ DrawingSurface::DrawingSurface(const GLContext::Ptr& context, const Shape& shape
     Renderer(context, "", ""),
     viewportOrigin_({0,0}),
     clearColor_({0,0,0,0}),
-    displayFlags_(FLAGS_NONE)
+    displayFlags_(FLAGS_NONE),
+    cullingEnabled_(true),
+    drawnCount_(0),
+    culledCount_(0)
 {}
 
 /**
@@ -82,10 +85,19 @@ void DrawingSurface::draw(const View::ConstPtr& view)
                shape.width, shape.height);
 
     this->handle_display_flags();
+    drawnCount_  = 0;
+    culledCount_ = 0;
     for(auto& item : renderItems_) {
-        if(item.first) {
-            item.first->draw(item.second);
+        if(!item.first) continue;
+        if(cullingEnabled_) {
+            auto bounds = item.first->world_bounds();
+            if(!bounds.is_infinite() && !item.second->frustum().intersects(bounds)) {
+                culledCount_++;
+                continue;
+            }
         }
+        item.first->draw(item.second);
+        drawnCount_++;
     }
     
     // Transparency rendering (as text background) must be renderered closest
@@ -1,5 +1,23 @@
 #include <rtac_display/GLMesh.h>
 
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <fstream>
+
+#include <rtac_display/MeshSimplifier.h>
+#include <rtac_display/PlyFile.h>
+#include <rtac_display/MappedFile.h>
+
+#ifdef RTAC_DISPLAY_LZ4 // cache compression is optional
+#include <lz4.h>
+#endif
+
 namespace rtac { namespace display {
 
 const unsigned int GLMesh::GroupSize = 128;
@@ -78,5 +96,1425 @@ void main()
 
 )");
 
+namespace {
+
+inline int16_t to_snorm16(float v)
+{
+    return (int16_t)std::lround(std::max(-1.0f, std::min(1.0f, v))*32767.0f);
+}
+
+inline uint32_t to_snorm10(float v)
+{
+    return ((uint32_t)std::lround(std::max(-1.0f, std::min(1.0f, v))*511.0f)) & 0x3ff;
+}
+
+/**
+ * Octahedral encoding of a unit vector (the sphere is projected on the
+ * octahedron |x|+|y|+|z| = 1, the lower half is folded on the upper one).
+ */
+inline void octahedral_encode(const GLMesh::Normal& n, float& u, float& v)
+{
+    float norm = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if(norm <= 0.0f) {
+        u = 0.0f; v = 0.0f;
+        return;
+    }
+    u = n.x / norm;
+    v = n.y / norm;
+    if(n.z < 0.0f) {
+        float uf = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float vf = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = uf; v = vf;
+    }
+}
+
+inline unsigned int align4(unsigned int size)
+{
+    return (size + 3) & ~3u;
+}
+
+/**
+ * Vertex cache optimization (Tom Forsyth, "Linear-Speed Vertex Cache
+ * Optimisation", 2006). Triangles are emitted greedily by decreasing score,
+ * the score of a vertex favouring vertices recently used (in a simulated LRU
+ * cache) and vertices with few remaining triangles.
+ *
+ * When no face touches the cache, the next face is taken from the remaining
+ * faces of the recently emitted vertices (dead-end stack) or, failing that,
+ * from a cursor over the faces not yet added, so the whole optimization stays
+ * linear. Triangle soups (no shared vertex) are left untouched.
+ */
+class VertexCacheOptimizer
+{
+    public:
+
+    static constexpr int CacheSize = 32;
+
+    protected:
+
+    std::vector<uint32_t> valence_;
+    std::vector<uint32_t> adjacencyOffsets_;
+    std::vector<uint32_t> adjacency_;  // remaining faces of each vertex
+    std::vector<int>      cachePosition_;
+    std::vector<float>    vertexScore_;
+    std::vector<float>    faceScore_;
+    std::vector<bool>     faceAdded_;
+    std::vector<uint32_t> deadEnd_;    // vertices of the emitted faces
+
+    static float score(int cachePosition, uint32_t valence)
+    {
+        if(valence == 0) return -1.0f;
+        float res = 0.0f;
+        if(cachePosition >= 0) {
+            if(cachePosition < 3) {
+                res = 0.75f; // last triangle, no bonus to avoid strips only.
+            }
+            else {
+                res = std::pow(1.0f - (float)(cachePosition - 3) / (CacheSize - 3), 1.5f);
+            }
+        }
+        return res + 2.0f / std::sqrt((float)valence);
+    }
+
+    public:
+
+    /**
+     * Reorders the triangles in indices (vertexCount vertices referenced).
+     */
+    void optimize(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        size_t faceCount = indices.size() / 3;
+        if(faceCount < 2) return;
+
+        valence_.assign(vertexCount, 0);
+        bool sharedVertices = false;
+        for(auto i : indices) {
+            sharedVertices |= valence_[i]++ > 0;
+        }
+        if(!sharedVertices) return; // nothing to gain from reordering.
+
+        adjacencyOffsets_.resize(vertexCount + 1);
+        adjacencyOffsets_[0] = 0;
+        for(uint32_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets_[v + 1] = adjacencyOffsets_[v] + valence_[v];
+        }
+        adjacency_.resize(indices.size());
+        std::vector<uint32_t> fill(adjacencyOffsets_.begin(), adjacencyOffsets_.end() - 1);
+        for(size_t f = 0; f < faceCount; f++) {
+            for(int k = 0; k < 3; k++) {
+                uint32_t v = indices[3*f + k];
+                adjacency_[fill[v]++] = f;
+            }
+        }
+
+        cachePosition_.assign(vertexCount, -1);
+        vertexScore_.resize(vertexCount);
+        for(uint32_t v = 0; v < vertexCount; v++) {
+            vertexScore_[v] = score(-1, valence_[v]);
+        }
+        faceScore_.resize(faceCount);
+        faceAdded_.assign(faceCount, false);
+        int64_t bestFace = 0;
+        for(size_t f = 0; f < faceCount; f++) {
+            faceScore_[f] = vertexScore_[indices[3*f]]
+                          + vertexScore_[indices[3*f + 1]]
+                          + vertexScore_[indices[3*f + 2]];
+            if(faceScore_[f] > faceScore_[bestFace]) bestFace = f;
+        }
+
+        std::vector<uint32_t> output(indices.size());
+        std::vector<uint32_t> cache, newCache;
+        cache.reserve(CacheSize + 3);
+        newCache.reserve(CacheSize + 3);
+        deadEnd_.clear();
+        size_t cursor = 0; // all the faces before cursor are added.
+
+        for(size_t n = 0; n < faceCount; n++) {
+            // No candidate in the cache neighbourhood : a remaining face of a
+            // recently used vertex, or the next face not added yet.
+            while(bestFace < 0 && !deadEnd_.empty()) {
+                uint32_t v = deadEnd_.back();
+                deadEnd_.pop_back();
+                if(valence_[v] > 0) {
+                    bestFace = adjacency_[adjacencyOffsets_[v]];
+                }
+            }
+            for(; bestFace < 0; cursor++) {
+                if(!faceAdded_[cursor]) {
+                    bestFace = cursor;
+                }
+            }
+            const uint32_t* face = &indices[3*bestFace];
+            faceAdded_[bestFace] = true;
+            std::memcpy(&output[3*n], face, 3*sizeof(uint32_t));
+            deadEnd_.insert(deadEnd_.end(), face, face + 3);
+
+            // Removing the face from the adjacency of its vertices.
+            for(int k = 0; k < 3; k++) {
+                uint32_t v = face[k];
+                uint32_t* adj = &adjacency_[adjacencyOffsets_[v]];
+                for(uint32_t i = 0; i < valence_[v]; i++) {
+                    if(adj[i] == (uint32_t)bestFace) {
+                        adj[i] = adj[valence_[v] - 1];
+                        break;
+                    }
+                }
+                valence_[v]--;
+            }
+
+            // New cache state : face vertices first, then previous content.
+            newCache.assign(face, face + 3);
+            for(auto v : cache) {
+                if(v != face[0] && v != face[1] && v != face[2])
+                    newCache.push_back(v);
+            }
+            for(size_t i = 0; i < newCache.size(); i++) {
+                uint32_t v = newCache[i];
+                cachePosition_[v] = i < (size_t)CacheSize ? (int)i : -1;
+                vertexScore_[v]   = score(cachePosition_[v], valence_[v]);
+            }
+
+            // Updating the score of the faces touching the cache.
+            bestFace = -1;
+            float best = -1.0f;
+            for(auto v : newCache) {
+                const uint32_t* adj = &adjacency_[adjacencyOffsets_[v]];
+                for(uint32_t i = 0; i < valence_[v]; i++) {
+                    uint32_t f = adj[i];
+                    faceScore_[f] = vertexScore_[indices[3*f]]
+                                  + vertexScore_[indices[3*f + 1]]
+                                  + vertexScore_[indices[3*f + 2]];
+                    if(faceScore_[f] > best) {
+                        best = faceScore_[f];
+                        bestFace = f;
+                    }
+                }
+            }
+
+            if(newCache.size() > (size_t)CacheSize)
+                newCache.resize(CacheSize);
+            std::swap(cache, newCache);
+        }
+        indices = std::move(output);
+    }
+};
+
+/**
+ * Faces of a chunk in GLMesh::split : indices are local to the chunk,
+ * vertices holds the corresponding global vertex indices.
+ */
+struct ChunkData {
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> indices;
+    size_t vertexOffset;
+    size_t indexOffset;
+};
+
+}; //namespace
+
+/**
+ * Converts the vertex attributes to a single interleaved buffer with the
+ * given attribute formats. Normals and uvs are packed only if there is one
+ * per point.
+ *
+ * Positions are quantized relative to the bounding box of the points
+ * (position_offset() and position_scale() give the decoding parameters).
+ *
+ * @param keepAttributes if false (default) the separate attribute buffers
+ *                       are released (faces are kept). Mesh modifiers
+ *                       (compute_normals, expand_vertices...) must be called
+ *                       before packing.
+ */
+void GLMesh::pack(const VertexFormat& format, bool keepAttributes)
+{
+    if(points_.size() == 0) {
+        throw std::runtime_error("GLMesh::pack : no points to pack.");
+    }
+    size_t count = points_.size();
+    bool withNormals = normals_.size() == count;
+    bool withUVs     = uvs_.size()     == count;
+
+    unsigned int positionSize = format.position == PositionFormat::Float32 ?
+                                3*sizeof(float) : 4*sizeof(uint16_t);
+    unsigned int normalSize = 0;
+    if(withNormals) {
+        normalSize = format.normal == NormalFormat::Float32 ? 3*sizeof(float) : 4;
+    }
+    unsigned int uvSize = 0;
+    if(withUVs) {
+        uvSize = format.uv == UVFormat::Float32 ? 2*sizeof(float) : 2*sizeof(Half);
+    }
+    unsigned int normalOffset = align4(positionSize);
+    unsigned int uvOffset     = align4(normalOffset + normalSize);
+    unsigned int stride       = align4(uvOffset + uvSize);
+
+    Point offset({0.0f,0.0f,0.0f}), scale({1.0f,1.0f,1.0f});
+    std::vector<uint8_t> data(stride*count, 0);
+    { // points mapped in this scope only
+        const auto& constPoints = points_;
+        auto pointsPtr = constPoints.map();
+        const Point* points = pointsPtr;
+
+        if(format.position == PositionFormat::Quantized16) {
+            Point pmin = points[0], pmax = points[0];
+            for(size_t i = 1; i < count; i++) {
+                pmin.x = std::min(pmin.x, points[i].x); pmax.x = std::max(pmax.x, points[i].x);
+                pmin.y = std::min(pmin.y, points[i].y); pmax.y = std::max(pmax.y, points[i].y);
+                pmin.z = std::min(pmin.z, points[i].z); pmax.z = std::max(pmax.z, points[i].z);
+            }
+            offset = pmin;
+            scale  = Point({std::max(pmax.x - pmin.x, 1.0e-20f),
+                            std::max(pmax.y - pmin.y, 1.0e-20f),
+                            std::max(pmax.z - pmin.z, 1.0e-20f)});
+        }
+
+        for(size_t i = 0; i < count; i++) {
+            uint8_t* v = data.data() + stride*i;
+            if(format.position == PositionFormat::Float32) {
+                std::memcpy(v, &points[i], sizeof(Point));
+            }
+            else {
+                uint16_t q[4] = {
+                    (uint16_t)std::lround(65535.0f*(points[i].x - offset.x) / scale.x),
+                    (uint16_t)std::lround(65535.0f*(points[i].y - offset.y) / scale.y),
+                    (uint16_t)std::lround(65535.0f*(points[i].z - offset.z) / scale.z),
+                    0};
+                std::memcpy(v, q, sizeof(q));
+            }
+        }
+    }
+
+    if(withNormals) {
+        const auto& constNormals = normals_;
+        auto normalsPtr = constNormals.map();
+        const Normal* normals = normalsPtr;
+        for(size_t i = 0; i < count; i++) {
+            uint8_t* v = data.data() + stride*i + normalOffset;
+            const Normal& n = normals[i];
+            if(format.normal == NormalFormat::Float32) {
+                std::memcpy(v, &n, sizeof(Normal));
+            }
+            else if(format.normal == NormalFormat::Octahedral16) {
+                float eu, ev;
+                octahedral_encode(n, eu, ev);
+                int16_t q[2] = {to_snorm16(eu), to_snorm16(ev)};
+                std::memcpy(v, q, sizeof(q));
+            }
+            else {
+                float norm = std::sqrt(n.x*n.x + n.y*n.y + n.z*n.z);
+                if(norm <= 0.0f) norm = 1.0f;
+                uint32_t q = to_snorm10(n.x / norm)
+                           | (to_snorm10(n.y / norm) << 10)
+                           | (to_snorm10(n.z / norm) << 20);
+                std::memcpy(v, &q, sizeof(q));
+            }
+        }
+    }
+
+    if(withUVs) {
+        const auto& constUVs = uvs_;
+        auto uvsPtr = constUVs.map();
+        const UV* uvs = uvsPtr;
+        for(size_t i = 0; i < count; i++) {
+            uint8_t* v = data.data() + stride*i + uvOffset;
+            if(format.uv == UVFormat::Float32) {
+                std::memcpy(v, &uvs[i], sizeof(UV));
+            }
+            else {
+                Half q[2] = {Half(uvs[i].x), Half(uvs[i].y)};
+                std::memcpy(v, q, sizeof(q));
+            }
+        }
+    }
+
+    vertices_.set_data(data.size(), data.data());
+    format_         = format;
+    packedCount_    = count;
+    packedNormals_  = withNormals;
+    packedUVs_      = withUVs;
+    stride_         = stride;
+    normalOffset_   = normalOffset;
+    uvOffset_       = uvOffset;
+    positionOffset_ = offset;
+    positionScale_  = scale;
+
+    if(!keepAttributes) {
+        points_  = GLVector<Point>();
+        normals_ = GLVector<Normal>();
+        uvs_     = GLVector<UV>();
+    }
+}
+
+/**
+ * Partitions the faces in chunks of at most maxVertices vertices indexed with
+ * 16 bits indices (chunk_indices() and chunks()).
+ *
+ * Faces are assigned to chunks greedily in their original order, so the
+ * spatial extent of the chunks depends on the face ordering of the input
+ * mesh (scanline, mesh files from most reconstruction tools...). Vertices
+ * shared between chunks are duplicated. The triangles of each chunk are then
+ * reordered for the vertex cache, the vertices are renumbered in order of
+ * first use and a bounding sphere is computed. This second step runs on all
+ * the available CPU cores.
+ *
+ * If the mesh has no faces, the points are taken as a triangle soup (as
+ * after compute_normals).
+ *
+ * @param keepFaces if true faces() is updated with the new vertex order (32
+ *                  bits indices), otherwise it is released.
+ */
+void GLMesh::split(unsigned int maxVertices, bool keepFaces)
+{
+    if(this->is_packed()) {
+        throw std::runtime_error("GLMesh::split : must be called before GLMesh::pack.");
+    }
+    if(maxVertices < 3 || maxVertices > MaxChunkVertices) {
+        std::ostringstream oss;
+        oss << "GLMesh::split : invalid chunk size (" << maxVertices
+            << ", must be in [3," << MaxChunkVertices << "])";
+        throw std::runtime_error(oss.str());
+    }
+    size_t pointCount = points_.size();
+    if(pointCount == 0 || (faces_.size() == 0 && (this->is_split() || pointCount % 3 != 0))) {
+        throw std::runtime_error("GLMesh::split : no faces to split.");
+    }
+    this->clear_lods();
+
+    std::vector<uint32_t> faces;
+    if(faces_.size() > 0) {
+        faces.resize(3*faces_.size());
+        const auto& constFaces = faces_;
+        auto facesPtr = constFaces.map();
+        const Face* f = facesPtr;
+        std::memcpy(faces.data(), f, sizeof(Face)*faces_.size());
+    }
+    else {
+        faces.resize(pointCount);
+        for(size_t i = 0; i < pointCount; i++) faces[i] = i;
+    }
+
+    // Greedy partition (sequential).
+    std::vector<ChunkData> chunks(1);
+    std::vector<int32_t> localIndex(pointCount, -1);
+    size_t vertexOffset = 0, indexOffset = 0;
+    chunks.back().vertexOffset = 0;
+    chunks.back().indexOffset  = 0;
+    for(size_t f = 0; f < faces.size(); f += 3) {
+        unsigned int newVertices = 0;
+        for(int k = 0; k < 3; k++) {
+            uint32_t v = faces[f + k];
+            if(v >= pointCount) {
+                std::ostringstream oss;
+                oss << "GLMesh::split : invalid vertex index " << v
+                    << " (" << pointCount << " points).";
+                throw std::runtime_error(oss.str());
+            }
+            if(localIndex[v] < 0 && (k == 0 || v != faces[f])
+                                 && (k <  2 || v != faces[f + 1]))
+                newVertices++;
+        }
+        if(chunks.back().vertices.size() + newVertices > maxVertices) {
+            for(auto v : chunks.back().vertices) localIndex[v] = -1;
+            vertexOffset += chunks.back().vertices.size();
+            indexOffset  += chunks.back().indices.size();
+            chunks.emplace_back();
+            chunks.back().vertexOffset = vertexOffset;
+            chunks.back().indexOffset  = indexOffset;
+        }
+        auto& chunk = chunks.back();
+        for(int k = 0; k < 3; k++) {
+            uint32_t v = faces[f + k];
+            if(localIndex[v] < 0) {
+                localIndex[v] = chunk.vertices.size();
+                chunk.vertices.push_back(v);
+            }
+            chunk.indices.push_back(localIndex[v]);
+        }
+    }
+    vertexOffset += chunks.back().vertices.size();
+    indexOffset  += chunks.back().indices.size();
+    faces.clear();
+    faces.shrink_to_fit();
+
+    // Reading the vertex attributes.
+    bool withNormals = normals_.size() == pointCount;
+    bool withUVs     = uvs_.size()     == pointCount;
+    std::vector<Point>  points(pointCount), newPoints(vertexOffset);
+    std::vector<Normal> normals, newNormals;
+    std::vector<UV>     uvs, newUVs;
+    {
+        const auto& constPoints = points_;
+        auto ptr = constPoints.map();
+        const Point* data = ptr;
+        std::memcpy(points.data(), data, sizeof(Point)*pointCount);
+    }
+    if(withNormals) {
+        normals.resize(pointCount);
+        newNormals.resize(vertexOffset);
+        const auto& constNormals = normals_;
+        auto ptr = constNormals.map();
+        const Normal* data = ptr;
+        std::memcpy(normals.data(), data, sizeof(Normal)*pointCount);
+    }
+    if(withUVs) {
+        uvs.resize(pointCount);
+        newUVs.resize(vertexOffset);
+        const auto& constUVs = uvs_;
+        auto ptr = constUVs.map();
+        const UV* data = ptr;
+        std::memcpy(uvs.data(), data, sizeof(UV)*pointCount);
+    }
+
+    // Per chunk processing (parallel).
+    std::vector<uint16_t> indices(indexOffset);
+    std::vector<Face>     newFaces(keepFaces ? indexOffset / 3 : 0);
+    chunks_.resize(chunks.size());
+
+    std::atomic<size_t> nextChunk(0);
+    auto process = [&]() {
+        VertexCacheOptimizer optimizer;
+        std::vector<int32_t> remap;
+        for(size_t c = nextChunk++; c < chunks.size(); c = nextChunk++) {
+            auto& chunk = chunks[c];
+            optimizer.optimize(chunk.indices, chunk.vertices.size());
+
+            // vertices renumbered in order of first use.
+            remap.assign(chunk.vertices.size(), -1);
+            uint32_t count = 0;
+            for(size_t j = 0; j < chunk.indices.size(); j++) {
+                uint32_t i = chunk.indices[j];
+                if(remap[i] < 0) {
+                    remap[i] = count;
+                    uint32_t src = chunk.vertices[i];
+                    uint32_t dst = chunk.vertexOffset + count;
+                    newPoints[dst] = points[src];
+                    if(withNormals) newNormals[dst] = normals[src];
+                    if(withUVs)     newUVs[dst]     = uvs[src];
+                    count++;
+                }
+                chunk.indices[j] = remap[i];
+                indices[chunk.indexOffset + j] = remap[i];
+            }
+            if(keepFaces) {
+                for(size_t f = 0; f < chunk.indices.size() / 3; f++) {
+                    newFaces[chunk.indexOffset / 3 + f] = Face({
+                        (uint32_t)(chunk.vertexOffset + chunk.indices[3*f]),
+                        (uint32_t)(chunk.vertexOffset + chunk.indices[3*f + 1]),
+                        (uint32_t)(chunk.vertexOffset + chunk.indices[3*f + 2])});
+                }
+            }
+
+            chunks_[c].indexOffset = chunk.indexOffset;
+            chunks_[c].indexCount  = chunk.indices.size();
+            chunks_[c].baseVertex  = chunk.vertexOffset;
+            chunks_[c].vertexCount = count;
+            chunks_[c].bounds      = compute_bounds(&newPoints[chunk.vertexOffset], count);
+
+            chunk.indices  = std::vector<uint32_t>();
+            chunk.vertices = std::vector<uint32_t>();
+        }
+    };
+
+    unsigned int threadCount = std::min<size_t>(chunks.size(),
+        std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(process);
+    }
+    process();
+    for(auto& w : workers) w.join();
+
+    points_.set_data(newPoints.size(), newPoints.data());
+    if(withNormals) normals_.set_data(newNormals.size(), newNormals.data());
+    else            normals_ = GLVector<Normal>();
+    if(withUVs) uvs_.set_data(newUVs.size(), newUVs.data());
+    else        uvs_ = GLVector<UV>();
+    chunkIndices_.set_data(indices.size(), indices.data());
+    bounds_ = compute_bounds(newPoints.data(), newPoints.size());
+    if(keepFaces) faces_.set_data(newFaces.size(), newFaces.data());
+    else          faces_ = GLVector<Face>();
+}
+
+/**
+ * Starts the generation of levelCount levels of detail on a worker thread.
+ * Each level is simplified from the previous one down to reduction times its
+ * number of faces (see MeshSimplifier). If the mesh is split, each chunk is
+ * simplified separately (in parallel) and gets its own chain of levels.
+ *
+ * The chain of a chunk (or of the mesh) stops early when the simplification
+ * stalls (the vertices on the chunk borders are never removed, so small
+ * chunks cannot be simplified indefinitely).
+ *
+ * The host data is read on the calling thread. The levels become available
+ * on the next call to update_lods after the worker has finished (see
+ * lods_pending and wait_lods). Modifying the faces or the points afterwards
+ * invalidates the levels, generate_lods must then be called again.
+ */
+void GLMesh::generate_lods(unsigned int levelCount, float reduction)
+{
+    if(reduction <= 0.0f || reduction >= 1.0f) {
+        std::ostringstream oss;
+        oss << "GLMesh::generate_lods : invalid reduction (" << reduction
+            << ", must be in ]0,1[)";
+        throw std::runtime_error(oss.str());
+    }
+    size_t pointCount = points_.size();
+    if(pointCount == 0) {
+        throw std::runtime_error("GLMesh::generate_lods : no points (generate_lods "
+                                 "must be called before GLMesh::pack).");
+    }
+    this->clear_lods();
+
+    std::vector<Point> points(pointCount);
+    {
+        const auto& constPoints = points_;
+        auto ptr = constPoints.map();
+        const Point* data = ptr;
+        std::memcpy(points.data(), data, sizeof(Point)*pointCount);
+    }
+
+    std::vector<uint32_t> indices;
+    if(this->is_split()) {
+        indices.resize(chunkIndices_.size());
+        const auto& constIndices = chunkIndices_;
+        auto ptr = constIndices.map();
+        const uint16_t* data = ptr;
+        for(size_t i = 0; i < indices.size(); i++) indices[i] = data[i];
+    }
+    else if(faces_.size() > 0) {
+        indices.resize(3*faces_.size());
+        const auto& constFaces = faces_;
+        auto ptr = constFaces.map();
+        const Face* data = ptr;
+        std::memcpy(indices.data(), data, sizeof(Face)*faces_.size());
+    }
+    else {
+        if(pointCount % 3 != 0) {
+            throw std::runtime_error("GLMesh::generate_lods : no faces to simplify.");
+        }
+        indices.resize(pointCount);
+        for(size_t i = 0; i < pointCount; i++) indices[i] = i;
+    }
+
+    pendingLods_ = std::async(std::launch::async, &GLMesh::build_lods,
+                              std::move(points), std::move(indices), chunks_,
+                              levelCount, reduction);
+}
+
+/**
+ * Worker side of generate_lods. If chunks is empty, indices are the faces of
+ * the whole mesh. Returns the chains of levels and their indices (relative
+ * to the chunk baseVertex for split meshes).
+ */
+GLMesh::LodData GLMesh::build_lods(std::vector<Point> points,
+                                   std::vector<uint32_t> indices,
+                                   std::vector<Chunk> chunks,
+                                   unsigned int levelCount, float reduction)
+{
+    if(chunks.size() == 0) {
+        Chunk whole;
+        whole.indexOffset = 0;
+        whole.indexCount  = indices.size();
+        whole.baseVertex  = 0;
+        whole.vertexCount = points.size();
+        chunks.push_back(whole);
+    }
+
+    std::vector<std::vector<Lod>>      lods(chunks.size());
+    std::vector<std::vector<uint32_t>> levelIndices(chunks.size());
+
+    std::atomic<size_t> nextChunk(0);
+    std::exception_ptr  error;
+    std::mutex          errorMutex;
+    auto process = [&]() {
+        for(size_t c = nextChunk++; c < chunks.size(); c = nextChunk++) {
+            const auto& chunk = chunks[c];
+            try {
+                MeshSimplifier simplifier(&points[chunk.baseVertex], chunk.vertexCount,
+                                          &indices[chunk.indexOffset], chunk.indexCount);
+                for(unsigned int level = 0; level < levelCount; level++) {
+                    size_t previous = simplifier.face_count();
+                    size_t target   = reduction*previous;
+                    if(target == 0) break;
+                    float levelError = simplifier.simplify(target);
+                    if(2*simplifier.face_count() > previous + target) {
+                        break; // stalled before half of the reduction.
+                    }
+
+                    auto res = simplifier.indices();
+                    lods[c].push_back(Lod({levelIndices[c].size(),
+                                           (uint32_t)res.size(), levelError}));
+                    levelIndices[c].insert(levelIndices[c].end(), res.begin(), res.end());
+                }
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if(!error) error = std::current_exception();
+            }
+        }
+    };
+
+    unsigned int threadCount = std::min<size_t>(chunks.size(),
+        std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(process);
+    }
+    process();
+    for(auto& w : workers) w.join();
+    if(error) std::rethrow_exception(error);
+
+    LodData res;
+    for(size_t c = 0; c < chunks.size(); c++) {
+        for(auto& lod : lods[c]) lod.indexOffset += res.indices.size();
+        res.indices.insert(res.indices.end(), levelIndices[c].begin(),
+                                              levelIndices[c].end());
+        levelIndices[c] = std::vector<uint32_t>();
+    }
+    res.lods = std::move(lods);
+    return res;
+}
+
+/**
+ * Uploads the levels of detail if their generation is finished. Must be
+ * called from the rendering thread (MeshRenderer calls it before each draw).
+ * Rethrows the exceptions raised during the generation.
+ *
+ * @return true if new levels were uploaded.
+ */
+bool GLMesh::update_lods() const
+{
+    if(!pendingLods_.valid() || pendingLods_.wait_for(std::chrono::seconds(0))
+                                != std::future_status::ready) {
+        return false;
+    }
+    LodData data = pendingLods_.get();
+    if(this->is_split()) {
+        std::vector<uint16_t> indices(data.indices.begin(), data.indices.end());
+        lodChunkIndices_.set_data(indices.size(), indices.data());
+    }
+    else {
+        lodIndices_.set_data(data.indices.size(), data.indices.data());
+    }
+    lods_ = std::move(data.lods);
+    return true;
+}
+
+/**
+ * Blocks until the levels of detail are generated and uploads them.
+ */
+void GLMesh::wait_lods() const
+{
+    if(pendingLods_.valid()) {
+        pendingLods_.wait();
+    }
+    this->update_lods();
+}
+
+/**
+ * Releases the levels of detail (waits for the worker if a generation is
+ * running).
+ */
+void GLMesh::clear_lods()
+{
+    if(pendingLods_.valid()) {
+        pendingLods_.wait();
+    }
+    pendingLods_     = std::future<LodData>();
+    lods_.clear();
+    lodIndices_      = GLVector<uint32_t>();
+    lodChunkIndices_ = GLVector<uint16_t>();
+}
+
+/**
+ * Largest number of levels of detail of a chunk (full resolution excluded).
+ */
+unsigned int GLMesh::lod_count() const
+{
+    size_t count = 0;
+    for(const auto& lods : lods_) count = std::max(count, lods.size());
+    return count;
+}
+
+/**
+ * Levels of detail of a chunk (or of the mesh if it is not split), from the
+ * finest to the coarsest. The full resolution faces are not included. Empty
+ * if no levels were generated.
+ */
+const std::vector<GLMesh::Lod>& GLMesh::lods(size_t chunk) const
+{
+    static const std::vector<Lod> empty;
+    if(chunk >= lods_.size()) return empty;
+    return lods_[chunk];
+}
+
+/**
+ * Bounding sphere of a set of points (centered on their bounding box).
+ */
+BoundingSphere GLMesh::compute_bounds(const Point* points, size_t count)
+{
+    if(count == 0) {
+        return BoundingSphere::Infinite();
+    }
+    Point pmin = points[0], pmax = points[0];
+    for(size_t i = 1; i < count; i++) {
+        pmin.x = std::min(pmin.x, points[i].x); pmax.x = std::max(pmax.x, points[i].x);
+        pmin.y = std::min(pmin.y, points[i].y); pmax.y = std::max(pmax.y, points[i].y);
+        pmin.z = std::min(pmin.z, points[i].z); pmax.z = std::max(pmax.z, points[i].z);
+    }
+    BoundingSphere::Vector3 center(0.5f*(pmin.x + pmax.x),
+                                   0.5f*(pmin.y + pmax.y),
+                                   0.5f*(pmin.z + pmax.z));
+    float radius2 = 0.0f;
+    for(size_t i = 0; i < count; i++) {
+        float dx = points[i].x - center(0), dy = points[i].y - center(1),
+              dz = points[i].z - center(2);
+        radius2 = std::max(radius2, dx*dx + dy*dy + dz*dz);
+    }
+    return BoundingSphere(center, std::sqrt(radius2));
+}
+
+/**
+ * Recomputes the bounding sphere from the points (read back from the
+ * device). Must be called after modifying the points for the mesh to be
+ * culled when out of view.
+ */
+void GLMesh::update_bounds()
+{
+    if(points_.size() == 0) {
+        bounds_ = BoundingSphere::Infinite();
+        return;
+    }
+    const auto& constPoints = points_;
+    auto ptr = constPoints.map();
+    bounds_ = compute_bounds(ptr, points_.size());
+}
+
+size_t GLMesh::vertex_count() const
+{
+    if(this->is_packed())
+        return packedCount_;
+    return points_.size();
+}
+
+bool GLMesh::has_normals() const
+{
+    if(this->is_packed())
+        return packedNormals_;
+    return normals_.size() > 0 && normals_.size() == points_.size();
+}
+
+bool GLMesh::has_uvs() const
+{
+    if(this->is_packed())
+        return packedUVs_;
+    return uvs_.size() > 0 && uvs_.size() == points_.size();
+}
+
+/**
+ * Size of all the buffers of the mesh on the device, in bytes.
+ */
+size_t GLMesh::memory_size() const
+{
+    return sizeof(Point)*points_.capacity()   + sizeof(Face)*faces_.capacity()
+         + sizeof(Normal)*normals_.capacity() + sizeof(UV)*uvs_.capacity()
+         + vertices_.capacity() + sizeof(uint16_t)*chunkIndices_.capacity()
+         + sizeof(uint32_t)*lodIndices_.capacity()
+         + sizeof(uint16_t)*lodChunkIndices_.capacity();
+}
+
+GLMesh::VertexAttribute GLMesh::position_attribute() const
+{
+    if(!this->is_packed())
+        return VertexAttribute({points_.gl_id(), 3, GL_FLOAT, GL_FALSE, 0, 0});
+    if(format_.position == PositionFormat::Float32)
+        return VertexAttribute({vertices_.gl_id(), 3, GL_FLOAT, GL_FALSE,
+                                (GLsizei)stride_, 0});
+    return VertexAttribute({vertices_.gl_id(), 3, GL_UNSIGNED_SHORT, GL_TRUE,
+                            (GLsizei)stride_, 0});
+}
+
+GLMesh::VertexAttribute GLMesh::normal_attribute() const
+{
+    if(!this->has_normals())
+        return VertexAttribute({0, 3, GL_FLOAT, GL_FALSE, 0, 0});
+    if(!this->is_packed())
+        return VertexAttribute({normals_.gl_id(), 3, GL_FLOAT, GL_FALSE, 0, 0});
+    switch(format_.normal) {
+        default:
+        case NormalFormat::Float32:
+            return VertexAttribute({vertices_.gl_id(), 3, GL_FLOAT, GL_FALSE,
+                                    (GLsizei)stride_, normalOffset_});
+        case NormalFormat::Octahedral16:
+            return VertexAttribute({vertices_.gl_id(), 2, GL_SHORT, GL_TRUE,
+                                    (GLsizei)stride_, normalOffset_});
+        case NormalFormat::Snorm10_10_10:
+            return VertexAttribute({vertices_.gl_id(), 4, GL_INT_2_10_10_10_REV,
+                                    GL_TRUE, (GLsizei)stride_, normalOffset_});
+    }
+}
+
+GLMesh::VertexAttribute GLMesh::uv_attribute() const
+{
+    if(!this->has_uvs())
+        return VertexAttribute({0, 2, GL_FLOAT, GL_FALSE, 0, 0});
+    if(!this->is_packed())
+        return VertexAttribute({uvs_.gl_id(), 2, GL_FLOAT, GL_FALSE, 0, 0});
+    if(format_.uv == UVFormat::Float32)
+        return VertexAttribute({vertices_.gl_id(), 2, GL_FLOAT, GL_FALSE,
+                                (GLsizei)stride_, uvOffset_});
+    return VertexAttribute({vertices_.gl_id(), 2, GL_HALF_FLOAT, GL_FALSE,
+                            (GLsizei)stride_, uvOffset_});
+}
+
+/**
+ * Loads a mesh from a .ply file (ascii or binary, see PlyFile).
+ *
+ * The file is memory mapped and parsed in parallel directly in the mapped
+ * device buffers. Normals (nx,ny,nz) and texture coordinates (u,v or s,t or
+ * texture_u,texture_v vertex properties, or a texCoords element) are loaded
+ * if present. Polygons are triangulated.
+ */
+GLMesh::Ptr GLMesh::from_ply(const std::string& path, bool transposeUVs)
+{
+    auto ply = PlyFile::Open(path);
+    auto vertex = ply->element("vertex");
+    if(!vertex || !ply->has_properties("vertex", {"x","y","z"})) {
+        throw std::runtime_error(
+            "Invalid ply file : No vertex defined in \"" + path + "\"");
+    }
+
+    auto mesh = Create();
+    {
+        mesh->points_.resize(vertex->count);
+        auto ptr = mesh->points_.map();
+        Point* data = ptr;
+        ply->read_floats("vertex", {"x","y","z"}, &data->x, 3);
+        mesh->bounds_ = compute_bounds(data, vertex->count);
+    }
+
+    if(ply->has_properties("vertex", {"nx","ny","nz"})) {
+        mesh->normals_.resize(vertex->count);
+        auto ptr = mesh->normals_.map(true);
+        Normal* data = ptr;
+        ply->read_floats("vertex", {"nx","ny","nz"}, &data->x, 3);
+    }
+
+    std::string uvElement = "vertex";
+    std::vector<std::string> uvNames;
+    for(auto names : std::vector<std::vector<std::string>>({{"u","v"}, {"s","t"},
+                                                            {"texture_u","texture_v"}})) {
+        if(ply->has_properties("vertex", names)) {
+            uvNames = names;
+            break;
+        }
+    }
+    if(uvNames.size() == 0 && ply->has_properties("texCoords", {"x","y"})) {
+        uvElement = "texCoords";
+        uvNames   = {"x","y"};
+    }
+    if(uvNames.size() > 0) {
+        if(transposeUVs) std::swap(uvNames[0], uvNames[1]);
+        mesh->uvs_.resize(ply->element(uvElement)->count);
+        auto ptr = mesh->uvs_.map(true);
+        UV* data = ptr;
+        ply->read_floats(uvElement, uvNames, &data->x, 2);
+    }
+
+    if(ply->element("face")) {
+        size_t count = ply->triangle_count("face");
+        mesh->faces_.resize(count);
+        if(count > 0) {
+            auto ptr = mesh->faces_.map(true);
+            Face* data = ptr;
+            ply->read_triangles(&data->x, "face");
+        }
+    }
+
+    return mesh;
+}
+
+namespace {
+
+/**
+ * Mesh cache file layout : a CacheHeader, followed by the payload sections
+ * (device buffers in this order : points, faces, normals, uvs, packed
+ * vertices, chunk indices, chunks, level of detail chain sizes, levels of
+ * detail, level of detail indices, level of detail chunk indices), each
+ * aligned on 16 bytes. If the cache is compressed, the payload is stored as
+ * independent LZ4 blocks of CacheBlockSize bytes (uncompressed) and the
+ * compressed size of each block is stored at blockTableOffset.
+ *
+ * All values are stored in host byte order (the cache is not meant to be
+ * portable, only fast to reload).
+ */
+struct CacheHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t compressed;
+    uint64_t sourceHash;
+    uint64_t payloadSize;
+    uint64_t blockCount;
+    uint64_t blockTableOffset;
+
+    uint64_t pointCount;
+    uint64_t faceCount;
+    uint64_t normalCount;
+    uint64_t uvCount;
+    uint64_t vertexBytes;
+    uint64_t packedCount;
+    uint8_t  positionFormat;
+    uint8_t  normalFormat;
+    uint8_t  uvFormat;
+    uint8_t  packedNormals;
+    uint8_t  packedUVs;
+    uint8_t  padding0[3];
+    uint32_t stride;
+    uint32_t normalOffset;
+    uint32_t uvOffset;
+    uint32_t padding1;
+    float    positionOffset[3];
+    float    positionScale[3];
+    float    bounds[4];
+
+    uint64_t chunkCount;
+    uint64_t chunkIndexCount;
+    uint64_t lodChainCount;
+    uint64_t lodCount;
+    uint64_t lodIndexCount;
+    uint64_t lodChunkIndexCount;
+};
+
+struct CacheChunk {
+    uint64_t indexOffset;
+    uint32_t indexCount;
+    int32_t  baseVertex;
+    uint32_t vertexCount;
+    float    bounds[4];
+    uint32_t padding;
+};
+
+struct CacheLod {
+    uint64_t indexOffset;
+    uint32_t indexCount;
+    float    error;
+};
+
+constexpr char   CacheMagic[8]  = {'R','T','A','C','M','S','H','\0'};
+constexpr size_t CacheAlignment = 16;
+constexpr size_t CacheBlockSize = 1 << 22;
+
+inline size_t cache_align(size_t size)
+{
+    return (size + CacheAlignment - 1) & ~(CacheAlignment - 1);
+}
+
+/**
+ * Writes the payload sections, optionally compressed by blocks.
+ */
+class CacheWriter
+{
+    protected:
+
+    std::ofstream&        os_;
+    bool                  compress_;
+    std::vector<char>     block_;
+    std::vector<char>     compressed_;
+    std::vector<uint32_t> blockSizes_;
+    size_t                written_; // uncompressed
+
+    void flush_block() {
+        #ifdef RTAC_DISPLAY_LZ4
+        compressed_.resize(LZ4_compressBound(block_.size()));
+        int size = LZ4_compress_default(block_.data(), compressed_.data(),
+                                        block_.size(), compressed_.size());
+        if(size <= 0) {
+            throw std::runtime_error("GLMesh::save_cache : LZ4 compression failed.");
+        }
+        os_.write(compressed_.data(), size);
+        blockSizes_.push_back(size);
+        #endif
+        block_.clear();
+    }
+
+    public:
+
+    CacheWriter(std::ofstream& os, bool compress) :
+        os_(os), compress_(compress), written_(0)
+    {
+        if(compress_) block_.reserve(CacheBlockSize);
+    }
+
+    void write(const void* data, size_t size) {
+        written_ += size;
+        if(!compress_) {
+            os_.write((const char*)data, size);
+            return;
+        }
+        const char* src = (const char*)data;
+        while(size > 0) {
+            size_t count = std::min(size, CacheBlockSize - block_.size());
+            block_.insert(block_.end(), src, src + count);
+            src  += count;
+            size -= count;
+            if(block_.size() == CacheBlockSize) this->flush_block();
+        }
+    }
+
+    void align() {
+        static const char zeros[CacheAlignment] = {0};
+        this->write(zeros, cache_align(written_) - written_);
+    }
+
+    template <typename T>
+    void write(const GLVector<T>& vector) {
+        if(vector.size() > 0) {
+            auto ptr = vector.map();
+            const T* data = ptr;
+            this->write(data, sizeof(T)*vector.size());
+        }
+        this->align();
+    }
+
+    void finish() {
+        if(block_.size() > 0) this->flush_block();
+    }
+
+    size_t written() const { return written_; }
+    const std::vector<uint32_t>& block_sizes() const { return blockSizes_; }
+};
+
+/**
+ * Reads the header of a cache file and checks its validity.
+ */
+bool read_cache_header(const MappedFile& file, uint64_t sourceHash, CacheHeader& header,
+                       std::string& error)
+{
+    if(file.size() < sizeof(CacheHeader)) {
+        error = "file too small";
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(CacheHeader));
+    if(std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0) {
+        error = "not a GLMesh cache file";
+        return false;
+    }
+    if(header.version != GLMesh::CacheVersion) {
+        error = "unsupported version " + std::to_string(header.version);
+        return false;
+    }
+    if(sourceHash != 0 && header.sourceHash != sourceHash) {
+        error = "source file changed";
+        return false;
+    }
+    if(header.compressed && !GLMesh::cache_compression_available()) {
+        error = "compressed cache (rtac_display was built without LZ4)";
+        return false;
+    }
+    size_t payloadOffset = cache_align(sizeof(CacheHeader));
+    if(!header.compressed && file.size() < payloadOffset + header.payloadSize) {
+        error = "truncated file";
+        return false;
+    }
+    if(header.compressed && file.size() < header.blockTableOffset
+                                          + sizeof(uint32_t)*header.blockCount) {
+        error = "truncated file";
+        return false;
+    }
+    return true;
+}
+
+}; //namespace
+
+bool GLMesh::cache_compression_available()
+{
+    #ifdef RTAC_DISPLAY_LZ4
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * Saves the mesh to a binary cache file, in its device layout. The levels of
+ * detail being generated are waited for.
+ *
+ * @param sourceHash hash of the file the mesh was loaded from (see
+ *                   MappedFile::hash), to detect outdated caches.
+ * @param compress   compresses the payload with LZ4 (rtac_display must be
+ *                   built with LZ4, see cache_compression_available).
+ */
+void GLMesh::save_cache(const std::string& path, uint64_t sourceHash, bool compress) const
+{
+    if(compress && !cache_compression_available()) {
+        throw std::runtime_error("GLMesh::save_cache : rtac_display was built without "
+                                 "LZ4, cannot compress.");
+    }
+    this->wait_lods();
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version        = CacheVersion;
+    header.compressed     = compress ? 1 : 0;
+    header.sourceHash     = sourceHash;
+    header.pointCount     = points_.size();
+    header.faceCount      = faces_.size();
+    header.normalCount    = normals_.size();
+    header.uvCount        = uvs_.size();
+    header.vertexBytes    = vertices_.size();
+    header.packedCount    = packedCount_;
+    header.positionFormat = (uint8_t)format_.position;
+    header.normalFormat   = (uint8_t)format_.normal;
+    header.uvFormat       = (uint8_t)format_.uv;
+    header.packedNormals  = packedNormals_;
+    header.packedUVs      = packedUVs_;
+    header.stride         = stride_;
+    header.normalOffset   = normalOffset_;
+    header.uvOffset       = uvOffset_;
+    header.positionOffset[0] = positionOffset_.x;
+    header.positionOffset[1] = positionOffset_.y;
+    header.positionOffset[2] = positionOffset_.z;
+    header.positionScale[0]  = positionScale_.x;
+    header.positionScale[1]  = positionScale_.y;
+    header.positionScale[2]  = positionScale_.z;
+    header.bounds[0] = bounds_.center(0);
+    header.bounds[1] = bounds_.center(1);
+    header.bounds[2] = bounds_.center(2);
+    header.bounds[3] = bounds_.radius;
+    header.chunkCount         = chunks_.size();
+    header.chunkIndexCount    = chunkIndices_.size();
+    header.lodChainCount      = lods_.size();
+    header.lodIndexCount      = lodIndices_.size();
+    header.lodChunkIndexCount = lodChunkIndices_.size();
+
+    std::vector<uint32_t> chainSizes;
+    std::vector<CacheLod> lods;
+    for(const auto& chain : lods_) {
+        chainSizes.push_back(chain.size());
+        for(const auto& lod : chain) {
+            lods.push_back(CacheLod({lod.indexOffset, lod.indexCount, lod.error}));
+        }
+    }
+    header.lodCount = lods.size();
+    std::vector<CacheChunk> chunks;
+    for(const auto& chunk : chunks_) {
+        chunks.push_back(CacheChunk({chunk.indexOffset, chunk.indexCount,
+                                     chunk.baseVertex, chunk.vertexCount,
+                                     {chunk.bounds.center(0), chunk.bounds.center(1),
+                                      chunk.bounds.center(2), chunk.bounds.radius}, 0}));
+    }
+
+    std::ofstream os(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if(!os.is_open()) {
+        throw std::runtime_error("GLMesh::save_cache : could not open file for writing "
+                                 + path);
+    }
+    std::vector<char> headerData(cache_align(sizeof(CacheHeader)), 0);
+    os.write(headerData.data(), headerData.size()); // written again at the end
+
+    CacheWriter writer(os, compress);
+    writer.write(points_);
+    writer.write(faces_);
+    writer.write(normals_);
+    writer.write(uvs_);
+    writer.write(vertices_);
+    writer.write(chunkIndices_);
+    writer.write(chunks.data(), sizeof(CacheChunk)*chunks.size());
+    writer.align();
+    writer.write(chainSizes.data(), sizeof(uint32_t)*chainSizes.size());
+    writer.align();
+    writer.write(lods.data(), sizeof(CacheLod)*lods.size());
+    writer.align();
+    writer.write(lodIndices_);
+    writer.write(lodChunkIndices_);
+    writer.finish();
+
+    header.payloadSize = writer.written();
+    if(compress) {
+        header.blockCount       = writer.block_sizes().size();
+        header.blockTableOffset = os.tellp();
+        os.write((const char*)writer.block_sizes().data(),
+                 sizeof(uint32_t)*writer.block_sizes().size());
+    }
+    std::memcpy(headerData.data(), &header, sizeof(header));
+    os.seekp(0);
+    os.write(headerData.data(), headerData.size());
+    if(!os.good()) {
+        throw std::runtime_error("GLMesh::save_cache : error while writing " + path);
+    }
+}
+
+/**
+ * Checks if a cache file exists, is readable by this version and was
+ * generated from a source file with the given hash (not checked if
+ * sourceHash is 0).
+ */
+bool GLMesh::cache_valid(const std::string& path, uint64_t sourceHash)
+{
+    try {
+        auto file = MappedFile::Open(path);
+        CacheHeader header;
+        std::string error;
+        return read_cache_header(*file, sourceHash, header, error);
+    }
+    catch(const std::runtime_error& e) {
+        return false;
+    }
+}
+
+/**
+ * Loads a mesh saved with save_cache. The file is memory mapped and the
+ * sections are uploaded directly from the mapping (compressed caches are
+ * decompressed by all the CPU cores in a host buffer first).
+ *
+ * @param sourceHash if not 0, the cache is rejected (an exception is thrown)
+ *                   if it was generated from another source.
+ */
+GLMesh::Ptr GLMesh::load_cache(const std::string& path, uint64_t sourceHash)
+{
+    auto file = MappedFile::Open(path);
+    CacheHeader header;
+    std::string error;
+    if(!read_cache_header(*file, sourceHash, header, error)) {
+        throw std::runtime_error("GLMesh::load_cache : invalid cache " + path
+                                 + " (" + error + ")");
+    }
+
+    const uint8_t* payload = file->data() + cache_align(sizeof(CacheHeader));
+    std::vector<uint8_t> decompressed;
+    #ifdef RTAC_DISPLAY_LZ4
+    if(header.compressed) {
+        decompressed.resize(header.payloadSize);
+        const uint32_t* blockSizes = (const uint32_t*)(file->data() + header.blockTableOffset);
+        std::vector<size_t> blockOffsets(header.blockCount + 1, 0);
+        for(size_t b = 0; b < header.blockCount; b++) {
+            blockOffsets[b + 1] = blockOffsets[b] + blockSizes[b];
+        }
+        if(payload + blockOffsets.back() > file->data() + header.blockTableOffset) {
+            throw std::runtime_error("GLMesh::load_cache : corrupted block table in " + path);
+        }
+        std::atomic<size_t> nextBlock(0);
+        std::atomic<bool>   failed(false);
+        auto process = [&]() {
+            for(size_t b = nextBlock++; b < header.blockCount; b = nextBlock++) {
+                size_t size = std::min<size_t>(CacheBlockSize,
+                                               header.payloadSize - b*CacheBlockSize);
+                int res = LZ4_decompress_safe((const char*)payload + blockOffsets[b],
+                                              (char*)decompressed.data() + b*CacheBlockSize,
+                                              blockSizes[b], size);
+                if(res != (int)size) failed = true;
+            }
+        };
+        unsigned int threadCount = std::min<size_t>(header.blockCount,
+            std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < threadCount; i++) {
+            workers.emplace_back(process);
+        }
+        process();
+        for(auto& w : workers) w.join();
+        if(failed) {
+            throw std::runtime_error("GLMesh::load_cache : corrupted compressed data in "
+                                     + path);
+        }
+        payload = decompressed.data();
+    }
+    #endif
+
+    size_t offset = 0;
+    auto section = [&](size_t size) {
+        const uint8_t* res = payload + offset;
+        offset += cache_align(size);
+        if(offset > cache_align(header.payloadSize)) {
+            throw std::runtime_error("GLMesh::load_cache : truncated payload in " + path);
+        }
+        return res;
+    };
+
+    auto mesh = Create();
+    mesh->points_.set_data(header.pointCount,
+        (const Point*)section(sizeof(Point)*header.pointCount));
+    mesh->faces_.set_data(header.faceCount,
+        (const Face*)section(sizeof(Face)*header.faceCount));
+    mesh->normals_.set_data(header.normalCount,
+        (const Normal*)section(sizeof(Normal)*header.normalCount));
+    mesh->uvs_.set_data(header.uvCount,
+        (const UV*)section(sizeof(UV)*header.uvCount));
+    mesh->vertices_.set_data(header.vertexBytes, section(header.vertexBytes));
+    mesh->chunkIndices_.set_data(header.chunkIndexCount,
+        (const uint16_t*)section(sizeof(uint16_t)*header.chunkIndexCount));
+
+    const CacheChunk* chunks = (const CacheChunk*)section(sizeof(CacheChunk)*header.chunkCount);
+    for(size_t c = 0; c < header.chunkCount; c++) {
+        const auto& chunk = chunks[c];
+        mesh->chunks_.push_back(Chunk({chunk.indexOffset, chunk.indexCount,
+            chunk.baseVertex, chunk.vertexCount,
+            BoundingSphere(BoundingSphere::Vector3(chunk.bounds[0], chunk.bounds[1],
+                                                   chunk.bounds[2]), chunk.bounds[3])}));
+    }
+
+    const uint32_t* chainSizes = (const uint32_t*)section(sizeof(uint32_t)*header.lodChainCount);
+    const CacheLod* lods = (const CacheLod*)section(sizeof(CacheLod)*header.lodCount);
+    size_t lodIndex = 0;
+    for(size_t c = 0; c < header.lodChainCount; c++) {
+        mesh->lods_.emplace_back();
+        for(uint32_t l = 0; l < chainSizes[c] && lodIndex < header.lodCount; l++, lodIndex++) {
+            mesh->lods_.back().push_back(Lod({lods[lodIndex].indexOffset,
+                                              lods[lodIndex].indexCount,
+                                              lods[lodIndex].error}));
+        }
+    }
+    mesh->lodIndices_.set_data(header.lodIndexCount,
+        (const uint32_t*)section(sizeof(uint32_t)*header.lodIndexCount));
+    mesh->lodChunkIndices_.set_data(header.lodChunkIndexCount,
+        (const uint16_t*)section(sizeof(uint16_t)*header.lodChunkIndexCount));
+
+    mesh->format_.position  = (PositionFormat)header.positionFormat;
+    mesh->format_.normal    = (NormalFormat)header.normalFormat;
+    mesh->format_.uv        = (UVFormat)header.uvFormat;
+    mesh->packedCount_      = header.packedCount;
+    mesh->packedNormals_    = header.packedNormals;
+    mesh->packedUVs_        = header.packedUVs;
+    mesh->stride_           = header.stride;
+    mesh->normalOffset_     = header.normalOffset;
+    mesh->uvOffset_         = header.uvOffset;
+    mesh->positionOffset_   = Point({header.positionOffset[0], header.positionOffset[1],
+                                     header.positionOffset[2]});
+    mesh->positionScale_    = Point({header.positionScale[0], header.positionScale[1],
+                                     header.positionScale[2]});
+    mesh->bounds_ = BoundingSphere(BoundingSphere::Vector3(header.bounds[0],
+                                                           header.bounds[1],
+                                                           header.bounds[2]),
+                                   header.bounds[3]);
+    return mesh;
+}
+
+/**
+ * Loads a .ply file through a cache file (cachePath, plyPath + ".cache" by
+ * default). The cache is used if it was generated from the same file (same
+ * hash, see MappedFile::hash). Otherwise the .ply file is loaded, the
+ * preprocess function is called on the mesh (split, generate_lods, pack...)
+ * and the cache is written.
+ */
+GLMesh::Ptr GLMesh::from_ply_cached(const std::string& plyPath,
+                                    const std::string& cachePath,
+                                    const std::function<void(GLMesh&)>& preprocess,
+                                    bool compress)
+{
+    std::string cache = cachePath.size() > 0 ? cachePath : plyPath + ".cache";
+    uint64_t sourceHash = MappedFile::Open(plyPath)->hash();
+    if(cache_valid(cache, sourceHash)) {
+        return load_cache(cache, sourceHash);
+    }
+
+    auto mesh = from_ply(plyPath);
+    if(preprocess) {
+        preprocess(*mesh);
+    }
+    mesh->save_cache(cache, sourceHash, compress && cache_compression_available());
+    return mesh;
+}
+
 }; //namespace display
 }; //namespace rtac
@@ -134,6 +134,58 @@ Typename operator(Typename lhs, Typename rhs) {
 }
 )");
 
+// Narrow types are read as packed 32-bit words (GLSL has no 8 or 16 bits
+// buffer types). If the input byte size is not a multiple of 4 the last word
+// is partially out of the buffer, but its out-of-bounds part is never used.
+const std::string GLReductor::UnpackShader = std::string(R"(
+#version 430 core
+
+#define BLOCK_SIZE 256
+
+layout(local_size_x = BLOCK_SIZE, local_size_y = 1) in;
+
+layout(location = 0) uniform uint N;
+
+layout(std430, binding = 0) readonly buffer inputBuffer
+{
+    uint inputData[];
+};
+layout(std430, binding = 1) writeonly buffer outputBuffer
+{
+    float outputData[];
+};
+
+float unpack_value(uint idx);
+
+void main()
+{
+    uint idx = gl_GlobalInvocationID.x;
+    if(idx < N) {
+        outputData[idx] = unpack_value(idx);
+    }
+}
+)");
+
+const std::string GLReductor::UnpackU8Function = std::string(R"(
+float unpack_value(uint idx)
+{
+    return float((inputData[idx >> 2] >> (8u*(idx & 3u))) & 0xffu);
+}
+)");
+
+const std::string GLReductor::UnpackU16Function = std::string(R"(
+float unpack_value(uint idx)
+{
+    return float((inputData[idx >> 1] >> (16u*(idx & 1u))) & 0xffffu);
+}
+)");
+
+const std::string GLReductor::UnpackHalfFunction = std::string(R"(
+float unpack_value(uint idx)
+{
+    return unpackHalf2x16(inputData[idx >> 1])[idx & 1u];
+}
+)");
 
 GLReductor::~GLReductor()
 {
@@ -166,5 +218,44 @@ GLuint GLReductor::add_program(const std::string& glslType, const std::string& o
     return program;
 }
 
+/**
+ * Returns (and compiles on first use) the program expanding a buffer of
+ * scalarType (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_HALF_FLOAT) to float.
+ */
+GLuint GLReductor::unpack_program(GLenum scalarType) const
+{
+    std::string name;
+    const std::string* function = nullptr;
+    switch(scalarType) {
+        default: {
+            std::ostringstream oss;
+            oss << "GLReductor : no unpack program for scalar type "
+                << scalarType << ".";
+            throw std::runtime_error(oss.str());
+            }
+            break;
+        case GL_UNSIGNED_BYTE:
+            name     = "uint8";
+            function = &UnpackU8Function;
+            break;
+        case GL_UNSIGNED_SHORT:
+            name     = "uint16";
+            function = &UnpackU16Function;
+            break;
+        case GL_HALF_FLOAT:
+            name     = "half";
+            function = &UnpackHalfFunction;
+            break;
+    }
+
+    auto program = this->program(name, "unpack");
+    if(program)
+        return program;
+
+    program = create_compute_program(UnpackShader + *function);
+    programs_[this->key(name, "unpack")] = program;
+    return program;
+}
+
 }; //namespace display
 }; //namespace rtac
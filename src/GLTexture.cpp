@@ -18,7 +18,8 @@ GLTexture::Ptr GLTexture::New()
 GLTexture::GLTexture() :
     shape_({0,0}),
     texId_(0),
-    format_(GL_RGBA)
+    format_(GL_RGBA),
+    scalarType_(GL_FLOAT)
 {
     this->init_texture();
     this->GLTexture::configure_texture();
@@ -32,14 +33,21 @@ GLTexture::~GLTexture()
 GLTexture::GLTexture(GLTexture&& other) :
     shape_ (std::move(other.shape_)),
     texId_ (std::exchange(other.texId_, 0)),
-    format_(other.format_)
+    format_(other.format_),
+    scalarType_(other.scalarType_)
 {}
 
 GLTexture& GLTexture::operator=(GLTexture&& other)
 {
+    if(&other == this) {
+        return *this;
+    }
+    this->delete_texture();
+
     shape_  = std::move(other.shape_);
     texId_  = std::exchange(other.texId_, 0);
-    format_ = other.format_;
+    format_     = other.format_;
+    scalarType_ = other.scalarType_;
 
     return *this;
 }
@@ -124,6 +132,19 @@ GLint GLTexture::format() const
     return format_;
 }
 
+/**
+ * Returns the scalar type of the last uploaded pixel data (GL_FLOAT,
+ * GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_HALF_FLOAT...).
+ *
+ * Integer data is stored in normalized formats and is read in [0,1] in the
+ * shaders. Use normalization_factor(scalar_type()) to retrieve the original
+ * sample values.
+ */
+GLenum GLTexture::scalar_type() const
+{
+    return scalarType_;
+}
+
 void GLTexture::bind(GLenum target)
 {
     glBindTexture(target, this->gl_id());
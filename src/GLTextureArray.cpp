@@ -0,0 +1,130 @@
+#include <rtac_display/GLTextureArray.h>
+
+namespace rtac { namespace display {
+
+/**
+ * @return a shared pointer to a newly created GLTextureArray.
+ */
+GLTextureArray::Ptr GLTextureArray::New()
+{
+    return Ptr(new GLTextureArray());
+}
+
+/**
+ * Contructor of GLTextureArray
+ *
+ * An OpenGL context must have been created beforehand.
+ */
+GLTextureArray::GLTextureArray() :
+    shape_({0,0}),
+    depth_(0),
+    texId_(0),
+    format_(GL_RGBA)
+{
+    this->init_texture();
+    this->set_filter_mode(FilterMode::Linear);
+    this->set_wrap_mode(WrapMode::ClampToEdge);
+}
+
+GLTextureArray::~GLTextureArray()
+{
+    this->delete_texture();
+}
+
+GLTextureArray::GLTextureArray(GLTextureArray&& other) :
+    shape_ (std::move(other.shape_)),
+    depth_ (std::exchange(other.depth_, 0)),
+    texId_ (std::exchange(other.texId_, 0)),
+    format_(other.format_)
+{}
+
+GLTextureArray& GLTextureArray::operator=(GLTextureArray&& other)
+{
+    if(&other == this) {
+        return *this;
+    }
+    this->delete_texture();
+
+    shape_  = std::move(other.shape_);
+    depth_  = std::exchange(other.depth_, 0);
+    texId_  = std::exchange(other.texId_, 0);
+    format_ = other.format_;
+
+    return *this;
+}
+
+void GLTextureArray::init_texture()
+{
+    if(!texId_)
+        glGenTextures(1, &texId_);
+}
+
+/**
+ * Free the OpenGL Texture Object.
+ *
+ * It is safe to call this function several times in a row.
+ */
+void GLTextureArray::delete_texture()
+{
+    if(texId_)
+        glDeleteTextures(1, &texId_);
+    texId_ = 0;
+    shape_ = Shape({0,0});
+    depth_ = 0;
+}
+
+/**
+ * Allocates the texture array without data initialization.
+ *
+ * @param shape          dimensions of each layer {width,height}.
+ * @param depth          number of layers.
+ * @param internalFormat OpenGL internal format of the texture.
+ * @param pixelFormat    pixel format of future uploads (GL_RED, GL_RGBA...).
+ * @param scalarType     scalar type of future uploads (GL_FLOAT...).
+ */
+void GLTextureArray::resize(const Shape& shape, unsigned int depth,
+                            GLint internalFormat, GLenum pixelFormat,
+                            GLenum scalarType)
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texId_);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat,
+                 shape.width, shape.height, depth, 0,
+                 pixelFormat, scalarType, nullptr);
+    GL_CHECK_LAST();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    shape_  = shape;
+    depth_  = depth;
+    format_ = pixelFormat;
+}
+
+void GLTextureArray::bind(GLenum target) const
+{
+    glBindTexture(target, texId_);
+}
+
+void GLTextureArray::unbind(GLenum target) const
+{
+    glBindTexture(target, 0);
+}
+
+void GLTextureArray::set_filter_mode(FilterMode mode)
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texId_);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, mode);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, mode);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void GLTextureArray::set_wrap_mode(WrapMode xyWrap)
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texId_);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, xyWrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, xyWrap);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+}; //namespace display
+}; //namespace rtac
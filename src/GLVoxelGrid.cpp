@@ -0,0 +1,560 @@
+#include <rtac_display/GLVoxelGrid.h>
+
+#include <sstream>
+#include <algorithm>
+
+namespace rtac { namespace display {
+
+/**
+ * Declarations shared by the decimation passes. Points are read as a float
+ * array (an array of vec3 has a 16 bytes stride in std430 layout). Work
+ * groups are dispatched on 2 dimensions to handle more than 65535*BLOCK_SIZE
+ * points (see GLVoxelGrid::dispatch).
+ *
+ * A voxel slot is claimed by writing the index of the inserted point + 1
+ * with an atomic compare and swap. If the slot is already taken by another
+ * voxel the next slot is tried (linear probing).
+ */
+const std::string GLVoxelGrid::CommonShader = std::string(R"(
+#version 430 core
+
+#define BLOCK_SIZE   256
+#define INVALID_SLOT 0xffffffffu
+
+#define MODE_FIRST         0u
+#define MODE_CENTROID      1u
+#define MODE_MAX_INTENSITY 2u
+
+layout(local_size_x = BLOCK_SIZE, local_size_y = 1) in;
+
+uniform uint  N;
+uniform uint  tableMask;
+uniform float voxelSize;
+uniform uint  mode;
+uniform uint  writePoints;
+uniform uint  writeIndices;
+
+layout(std430, binding = 0) readonly buffer pointBuffer         { float points[];        };
+layout(std430, binding = 1) readonly buffer intensityBuffer     { float intensities[];   };
+layout(std430, binding = 2)          buffer voxelPointBuffer    { uint  voxelPoints[];   };
+layout(std430, binding = 3)          buffer voxelOwnerBuffer    { uint  voxelOwners[];   };
+layout(std430, binding = 4)          buffer voxelMaxBuffer      { uint  voxelMax[];      };
+layout(std430, binding = 5)          buffer voxelSumBuffer      { uint  voxelSums[];     };
+layout(std430, binding = 6)          buffer offsetBuffer        { uint  offsets[];       };
+layout(std430, binding = 7) writeonly buffer outputPointBuffer  { float outputPoints[];  };
+layout(std430, binding = 8) writeonly buffer outputIndexBuffer  { uint  outputIndices[]; };
+
+uint point_index()
+{
+    uint group = gl_WorkGroupID.y*gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    return group*BLOCK_SIZE + gl_LocalInvocationID.x;
+}
+
+vec3 point(uint i)
+{
+    return vec3(points[3u*i], points[3u*i + 1u], points[3u*i + 2u]);
+}
+
+ivec3 voxel_of(uint i)
+{
+    return ivec3(floor(point(i) / voxelSize));
+}
+
+uint hash_voxel(ivec3 v)
+{
+    uint h = (uint(v.x)*73856093u) ^ (uint(v.y)*19349663u) ^ (uint(v.z)*83492791u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+uint insert_voxel(ivec3 v, uint i)
+{
+    uint slot = hash_voxel(v) & tableMask;
+    for(uint n = 0u; n <= tableMask; n++) {
+        uint previous = atomicCompSwap(voxelPoints[slot], 0u, i + 1u);
+        if(previous == 0u || all(equal(voxel_of(previous - 1u), v))) {
+            return slot;
+        }
+        slot = (slot + 1u) & tableMask;
+    }
+    return INVALID_SLOT;
+}
+
+uint find_voxel(ivec3 v)
+{
+    uint slot = hash_voxel(v) & tableMask;
+    for(uint n = 0u; n <= tableMask; n++) {
+        uint p = voxelPoints[slot];
+        if(p == 0u) {
+            return INVALID_SLOT;
+        }
+        if(all(equal(voxel_of(p - 1u), v))) {
+            return slot;
+        }
+        slot = (slot + 1u) & tableMask;
+    }
+    return INVALID_SLOT;
+}
+
+// float bits reordered such as the order of the keys is the order of the
+// values (allows atomicMax on floats).
+uint intensity_key(float f)
+{
+    uint u = floatBitsToUint(f);
+    return (u & 0x80000000u) != 0u ? ~u : (u | 0x80000000u);
+}
+)");
+
+/**
+ * Inserts the points in the hash table. In First and Centroid modes the
+ * owner of a voxel is the point with the lowest index (stored as ~index with
+ * atomicMax, the table is cleared with 0). The centroid is accumulated as
+ * fixed point positions relative to the voxel (12 bits per point, so a
+ * voxel can hold up to 2^20 points without overflow).
+ */
+const std::string GLVoxelGrid::InsertShader = CommonShader + std::string(R"(
+void main()
+{
+    uint i = point_index();
+    if(i >= N) return;
+
+    ivec3 v = voxel_of(i);
+    uint slot = insert_voxel(v, i);
+    if(slot == INVALID_SLOT) return;
+
+    if(mode == MODE_MAX_INTENSITY) {
+        atomicMax(voxelMax[slot], intensity_key(intensities[i]));
+        return;
+    }
+    atomicMax(voxelOwners[slot], ~i);
+    if(mode == MODE_CENTROID) {
+        uvec3 q = uvec3(clamp(4096.0f*(point(i) / voxelSize - vec3(v)),
+                              vec3(0.0f), vec3(4095.0f)));
+        atomicAdd(voxelSums[4u*slot],      1u);
+        atomicAdd(voxelSums[4u*slot + 1u], q.x);
+        atomicAdd(voxelSums[4u*slot + 2u], q.y);
+        atomicAdd(voxelSums[4u*slot + 3u], q.z);
+    }
+}
+)");
+
+/**
+ * MaxIntensity mode : the owner of a voxel is the point with the lowest
+ * index among the points with the maximum intensity.
+ */
+const std::string GLVoxelGrid::SelectShader = CommonShader + std::string(R"(
+void main()
+{
+    uint i = point_index();
+    if(i >= N) return;
+
+    uint slot = find_voxel(voxel_of(i));
+    if(slot == INVALID_SLOT) return;
+    if(intensity_key(intensities[i]) == voxelMax[slot]) {
+        atomicMax(voxelOwners[slot], ~i);
+    }
+}
+)");
+
+/**
+ * Flags the owner of each voxel (offsets has N + 1 elements, the last one
+ * gives the number of kept points after the scan).
+ */
+const std::string GLVoxelGrid::FlagShader = CommonShader + std::string(R"(
+void main()
+{
+    uint i = point_index();
+    if(i >= N) return;
+    if(i == 0u) {
+        offsets[N] = 0u;
+    }
+
+    uint slot = find_voxel(voxel_of(i));
+    offsets[i] = (slot != INVALID_SLOT && ~voxelOwners[slot] == i) ? 1u : 0u;
+}
+)");
+
+/**
+ * Writes the kept points at their scanned index.
+ */
+const std::string GLVoxelGrid::ScatterShader = CommonShader + std::string(R"(
+void main()
+{
+    uint i = point_index();
+    if(i >= N) return;
+
+    uint k = offsets[i];
+    if(offsets[i + 1u] == k) return;
+
+    if(writePoints != 0u) {
+        vec3 p = point(i);
+        if(mode == MODE_CENTROID) {
+            ivec3 v    = voxel_of(i);
+            uint  slot = find_voxel(v);
+            float count = float(voxelSums[4u*slot]);
+            vec3  sums  = vec3(voxelSums[4u*slot + 1u],
+                               voxelSums[4u*slot + 2u],
+                               voxelSums[4u*slot + 3u]);
+            p = (vec3(v) + (sums + 0.5f*count) / (4096.0f*count))*voxelSize;
+        }
+        outputPoints[3u*k]      = p.x;
+        outputPoints[3u*k + 1u] = p.y;
+        outputPoints[3u*k + 2u] = p.z;
+    }
+    if(writeIndices != 0u) {
+        outputIndices[k] = i;
+    }
+}
+)");
+
+/**
+ * Exclusive prefix sum of each block of BLOCK_SIZE elements (in place). The
+ * total of each block is written in blockSums.
+ */
+const std::string GLVoxelGrid::ScanShader = std::string(R"(
+#version 430 core
+
+#define BLOCK_SIZE 256
+
+layout(local_size_x = BLOCK_SIZE, local_size_y = 1) in;
+
+layout(location = 0) uniform uint N;
+
+layout(std430, binding = 0) buffer dataBuffer { uint data[];      };
+layout(std430, binding = 1) buffer sumBuffer  { uint blockSums[]; };
+
+shared uint s[BLOCK_SIZE];
+
+void main()
+{
+    uint group = gl_WorkGroupID.y*gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint idx   = group*BLOCK_SIZE + gl_LocalInvocationID.x;
+    uint l     = gl_LocalInvocationID.x;
+
+    uint value = idx < N ? data[idx] : 0u;
+    s[l] = value;
+    memoryBarrierShared();
+    barrier();
+    for(uint offset = 1u; offset < BLOCK_SIZE; offset <<= 1u) {
+        uint v = l >= offset ? s[l - offset] : 0u;
+        memoryBarrierShared();
+        barrier();
+        s[l] += v;
+        memoryBarrierShared();
+        barrier();
+    }
+
+    if(idx < N) {
+        data[idx] = s[l] - value;
+    }
+    if(l == BLOCK_SIZE - 1u && group*BLOCK_SIZE < N) {
+        blockSums[group] = s[l];
+    }
+}
+)");
+
+/**
+ * Adds the scanned block totals to the elements of each block.
+ */
+const std::string GLVoxelGrid::AddOffsetsShader = std::string(R"(
+#version 430 core
+
+#define BLOCK_SIZE 256
+
+layout(local_size_x = BLOCK_SIZE, local_size_y = 1) in;
+
+layout(location = 0) uniform uint N;
+
+layout(std430, binding = 0)          buffer dataBuffer { uint data[];      };
+layout(std430, binding = 1) readonly buffer sumBuffer  { uint blockSums[]; };
+
+void main()
+{
+    uint group = gl_WorkGroupID.y*gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint idx   = group*BLOCK_SIZE + gl_LocalInvocationID.x;
+    if(idx < N) {
+        data[idx] += blockSums[group];
+    }
+}
+)");
+
+GLVoxelGrid::GLVoxelGrid() :
+    insertProgram_(0),
+    selectProgram_(0),
+    flagProgram_(0),
+    scatterProgram_(0),
+    scanProgram_(0),
+    addOffsetsProgram_(0)
+{}
+
+GLVoxelGrid::~GLVoxelGrid()
+{
+    for(auto program : {insertProgram_, selectProgram_, flagProgram_,
+                        scatterProgram_, scanProgram_, addOffsetsProgram_}) {
+        if(program) {
+            glDeleteProgram(program);
+        }
+    }
+}
+
+/**
+ * Compiles the compute programs on first use (an OpenGL context must be
+ * current).
+ */
+void GLVoxelGrid::build_programs() const
+{
+    if(insertProgram_) return;
+
+    insertProgram_     = create_compute_program(InsertShader);
+    selectProgram_     = create_compute_program(SelectShader);
+    flagProgram_       = create_compute_program(FlagShader);
+    scatterProgram_    = create_compute_program(ScatterShader);
+    scanProgram_       = create_compute_program(ScanShader);
+    addOffsetsProgram_ = create_compute_program(AddOffsetsShader);
+}
+
+/**
+ * Dispatches blockCount work groups, on 2 dimensions if blockCount is above
+ * the minimum work group count guaranteed by OpenGL (65535). The shaders
+ * discard the extra work groups of the last row.
+ */
+void GLVoxelGrid::dispatch(size_t blockCount)
+{
+    size_t width = std::min<size_t>(blockCount, 65535);
+    glDispatchCompute(width, (blockCount + width - 1) / width, 1);
+}
+
+/**
+ * In place exclusive prefix sum of the first size elements of data (blocks
+ * are scanned independently, then the block totals are scanned recursively
+ * and added back to the blocks).
+ */
+void GLVoxelGrid::scan(GLVector<uint32_t>& data, size_t size, unsigned int level) const
+{
+    size_t blockCount = (size + BlockSize - 1) / BlockSize;
+    if(blockSums_.size() < 4) {
+        // Enough levels for 2^32 elements. Allocated once so the buffers are
+        // not moved during the recursion (data may be a blockSums_ element).
+        blockSums_.resize(4);
+    }
+    if(blockSums_[level].size() < blockCount) {
+        blockSums_[level].resize(blockCount);
+    }
+
+    glUseProgram(scanProgram_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, data.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, blockSums_[level].gl_id());
+    glUniform1ui(0, size);
+    dispatch(blockCount);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    if(blockCount > 1) {
+        this->scan(blockSums_[level], blockCount, level + 1);
+
+        glUseProgram(addOffsetsProgram_);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, data.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, blockSums_[level].gl_id());
+        glUniform1ui(0, size);
+        dispatch(blockCount);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+}
+
+static void clear_buffer(const GLVector<uint32_t>& buffer)
+{
+    uint32_t zero = 0;
+    buffer.bind(GL_SHADER_STORAGE_BUFFER);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0,
+                         sizeof(uint32_t)*buffer.size(),
+                         GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    buffer.unbind(GL_SHADER_STORAGE_BUFFER);
+}
+
+size_t GLVoxelGrid::run(const GLVector<Point>& input, const GLVector<float>* intensities,
+                        float voxelSize, Mode mode,
+                        GLVector<Point>* output, GLVector<uint32_t>* indices) const
+{
+    size_t N = input.size();
+    if(!(voxelSize > 0.0f)) {
+        std::ostringstream oss;
+        oss << "GLVoxelGrid : invalid voxel size (" << voxelSize << ")";
+        throw std::runtime_error(oss.str());
+    }
+    if(N >= 0xffffffff) {
+        throw std::runtime_error("GLVoxelGrid : too many points (32 bits indices).");
+    }
+    if(mode == Mode::MaxIntensity && (!intensities || intensities->size() < N)) {
+        throw std::runtime_error("GLVoxelGrid : one intensity per point is required.");
+    }
+    if(output == &input) {
+        throw std::runtime_error("GLVoxelGrid : cannot decimate in place.");
+    }
+    if(N == 0) {
+        if(output)  output->resize(0);
+        if(indices) indices->resize(0);
+        return 0;
+    }
+    this->build_programs();
+
+    // load factor at most 0.5 to keep the probe sequences short.
+    size_t tableSize = 1024;
+    while(tableSize < 2*N) tableSize <<= 1;
+
+    voxelPoints_.resize(tableSize);
+    voxelOwners_.resize(tableSize);
+    clear_buffer(voxelPoints_);
+    clear_buffer(voxelOwners_);
+    if(mode == Mode::Centroid) {
+        voxelSums_.resize(4*tableSize);
+        clear_buffer(voxelSums_);
+    }
+    else if(voxelSums_.size() == 0) {
+        voxelSums_.resize(4);
+    }
+    if(mode == Mode::MaxIntensity) {
+        voxelMax_.resize(tableSize);
+        clear_buffer(voxelMax_);
+    }
+    else if(voxelMax_.size() == 0) {
+        voxelMax_.resize(1);
+    }
+    offsets_.resize(N + 1);
+    keptCount_.resize(1);
+    // bound to the unused buffers (never accessed by the shaders).
+    if(dummy_.size() == 0) {
+        dummy_.resize(1);
+    }
+
+    // (the scan uses bindings 0 and 1, buffers are bound again after it)
+    auto bind_buffers = [&]() {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, input.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, intensities ? intensities->gl_id()
+                                                                  : dummy_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, voxelPoints_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, voxelOwners_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, voxelMax_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, voxelSums_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, offsets_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, output  ? output->gl_id()
+                                                              : dummy_.gl_id());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, indices ? indices->gl_id()
+                                                              : dummy_.gl_id());
+    };
+
+    size_t blockCount = (N + BlockSize - 1) / BlockSize;
+    auto run_pass = [&](GLuint program) {
+        // uniforms are set by name (unused ones are ignored).
+        glUseProgram(program);
+        glUniform1ui(glGetUniformLocation(program, "N"),            N);
+        glUniform1ui(glGetUniformLocation(program, "tableMask"),    tableSize - 1);
+        glUniform1f (glGetUniformLocation(program, "voxelSize"),    voxelSize);
+        glUniform1ui(glGetUniformLocation(program, "mode"),         (unsigned int)mode);
+        glUniform1ui(glGetUniformLocation(program, "writePoints"),  output  != nullptr);
+        glUniform1ui(glGetUniformLocation(program, "writeIndices"), indices != nullptr);
+        dispatch(blockCount);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    };
+
+    bind_buffers();
+    run_pass(insertProgram_);
+    if(mode == Mode::MaxIntensity) {
+        run_pass(selectProgram_);
+    }
+    run_pass(flagProgram_);
+
+    this->scan(offsets_, N + 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    keptCount_.copy_sub_data(0, offsets_, N, 1);
+    size_t kept;
+    {
+        auto p = keptCount_.map();
+        kept = p[0];
+    }
+
+    if(output)  output->resize(kept);
+    if(indices) indices->resize(kept);
+    if(kept > 0) {
+        bind_buffers(); // output and indices may have been reallocated.
+        run_pass(scatterProgram_);
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT
+                      | GL_BUFFER_UPDATE_BARRIER_BIT);
+    }
+
+    for(GLuint binding = 0; binding < 9; binding++) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    glUseProgram(0);
+    GL_CHECK_LAST();
+
+    return kept;
+}
+
+/**
+ * Decimates input with one point per voxel (Mode::First or Mode::Centroid).
+ *
+ * @param input     points to decimate.
+ * @param voxelSize size of the voxels (in the units of the points).
+ * @param output    decimated points (resized, must not be input).
+ *
+ * @return the number of points kept.
+ */
+size_t GLVoxelGrid::decimate(const GLVector<Point>& input, float voxelSize,
+                             GLVector<Point>& output, Mode mode) const
+{
+    if(mode == Mode::MaxIntensity) {
+        throw std::runtime_error("GLVoxelGrid : one intensity per point is required.");
+    }
+    return this->run(input, nullptr, voxelSize, mode, &output, nullptr);
+}
+
+/**
+ * Decimates input keeping the point with the highest intensity in each voxel
+ * (Mode::MaxIntensity).
+ */
+size_t GLVoxelGrid::decimate(const GLVector<Point>& input, const GLVector<float>& intensities,
+                             float voxelSize, GLVector<Point>& output) const
+{
+    return this->run(input, &intensities, voxelSize, Mode::MaxIntensity, &output, nullptr);
+}
+
+/**
+ * Indices of the first point of each voxel, in increasing order (no point is
+ * written). The indices can be used to draw or gather the per point
+ * attributes of the decimated cloud.
+ */
+size_t GLVoxelGrid::select(const GLVector<Point>& input, float voxelSize,
+                           GLVector<uint32_t>& indices) const
+{
+    return this->run(input, nullptr, voxelSize, Mode::First, nullptr, &indices);
+}
+
+/**
+ * Indices of the point with the highest intensity of each voxel, in
+ * increasing order.
+ */
+size_t GLVoxelGrid::select(const GLVector<Point>& input, const GLVector<float>& intensities,
+                           float voxelSize, GLVector<uint32_t>& indices) const
+{
+    return this->run(input, &intensities, voxelSize, Mode::MaxIntensity, nullptr, &indices);
+}
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, rtac::display::GLVoxelGrid::Mode mode)
+{
+    using Mode = rtac::display::GLVoxelGrid::Mode;
+    switch(mode) {
+        case Mode::First:        os << "First";        break;
+        case Mode::Centroid:     os << "Centroid";     break;
+        case Mode::MaxIntensity: os << "MaxIntensity"; break;
+    }
+    return os;
+}
@@ -0,0 +1,129 @@
+#include <rtac_display/MappedFile.h>
+
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace rtac { namespace display {
+
+namespace {
+
+constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+constexpr size_t   HashBlockSize = 1 << 22;
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t load64(const uint8_t* p)
+{
+    uint64_t res;
+    std::memcpy(&res, p, sizeof(res));
+    return res;
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+}; //namespace
+
+MappedFile::MappedFile(const std::string& path) :
+    path_(path),
+    fd_(-1),
+    data_(nullptr),
+    size_(0)
+{
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if(fd_ < 0) {
+        throw std::runtime_error("MappedFile : could not open file for reading " + path);
+    }
+    struct stat info;
+    if(::fstat(fd_, &info) != 0 || info.st_size == 0) {
+        ::close(fd_);
+        throw std::runtime_error("MappedFile : empty file or could not read size of " + path);
+    }
+    size_ = info.st_size;
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if(data == MAP_FAILED) {
+        ::close(fd_);
+        throw std::runtime_error("MappedFile : could not map file " + path);
+    }
+    data_ = (const uint8_t*)data;
+    ::madvise(data, size_, MADV_WILLNEED);
+}
+
+MappedFile::~MappedFile()
+{
+    if(data_) ::munmap((void*)data_, size_);
+    if(fd_ >= 0) ::close(fd_);
+}
+
+/**
+ * 64 bits non-cryptographic hash of a memory block (4 independent
+ * multiply-rotate lanes, same round and finalization as xxHash64, but not
+ * compatible with it).
+ */
+uint64_t MappedFile::hash(const uint8_t* data, size_t size, uint64_t seed)
+{
+    uint64_t lanes[4] = {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1};
+    size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+        for(int k = 0; k < 4; k++) {
+            lanes[k] = rotl(lanes[k] + load64(data + i + 8*k)*Prime2, 31)*Prime1;
+        }
+    }
+    uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7)
+               + rotl(lanes[2], 12) + rotl(lanes[3], 18) + size;
+    for(; i < size; i++) {
+        h = rotl(h ^ (data[i]*Prime3), 11)*Prime1;
+    }
+    return avalanche(h);
+}
+
+/**
+ * Hash of the whole file. Blocks of 4MiB are hashed in parallel, the block
+ * hashes are then combined in order.
+ */
+uint64_t MappedFile::hash() const
+{
+    size_t blockCount = (size_ + HashBlockSize - 1) / HashBlockSize;
+    std::vector<uint64_t> hashes(blockCount);
+
+    std::atomic<size_t> nextBlock(0);
+    auto process = [&]() {
+        for(size_t b = nextBlock++; b < blockCount; b = nextBlock++) {
+            size_t offset = b*HashBlockSize;
+            hashes[b] = hash(data_ + offset, std::min(HashBlockSize, size_ - offset), b);
+        }
+    };
+    unsigned int threadCount = std::min<size_t>(blockCount,
+        std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(process);
+    }
+    process();
+    for(auto& w : workers) w.join();
+
+    return hash((const uint8_t*)hashes.data(), sizeof(uint64_t)*blockCount, size_);
+}
+
+}; //namespace display
+}; //namespace rtac
@@ -0,0 +1,406 @@
+#include <rtac_display/MeshSimplifier.h>
+
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include <array>
+#include <limits>
+#include <cstring>
+
+namespace rtac { namespace display {
+
+void MeshSimplifier::Quadric::add_plane(double nx, double ny, double nz, double d,
+                                        double w)
+{
+    a[0] += w*nx*nx; a[1] += w*nx*ny; a[2] += w*nx*nz; a[3] += w*nx*d;
+                     a[4] += w*ny*ny; a[5] += w*ny*nz; a[6] += w*ny*d;
+                                      a[7] += w*nz*nz; a[8] += w*nz*d;
+                                                       a[9] += w*d*d;
+    weight += w;
+}
+
+void MeshSimplifier::Quadric::add(const Quadric& other)
+{
+    for(int i = 0; i < 10; i++) a[i] += other.a[i];
+    weight += other.weight;
+}
+
+/**
+ * Weighted sum of the squared distances of p to the planes of the quadric.
+ */
+double MeshSimplifier::Quadric::evaluate(const Point& p) const
+{
+    double x = p.x, y = p.y, z = p.z;
+    return   a[0]*x*x + 2.0*a[1]*x*y + 2.0*a[2]*x*z + 2.0*a[3]*x
+           + a[4]*y*y + 2.0*a[5]*y*z + 2.0*a[6]*y
+           + a[7]*z*z + 2.0*a[8]*z
+           + a[9];
+}
+
+/**
+ * @param points     vertex positions (must outlive the MeshSimplifier).
+ * @param pointCount number of vertices.
+ * @param indices    triangle list.
+ * @param indexCount number of indices (3 per face).
+ */
+MeshSimplifier::MeshSimplifier(const Point* points, size_t pointCount,
+                               const uint32_t* indices, size_t indexCount) :
+    points_(points),
+    inputFaces_(indices, indices + 3*(indexCount / 3)),
+    faces_(inputFaces_),
+    faceRemoved_(indexCount / 3, false),
+    vertexFaces_(pointCount),
+    quadrics_(pointCount),
+    locked_(pointCount, false),
+    removed_(pointCount, false),
+    versions_(pointCount, 0),
+    faceCount_(indexCount / 3),
+    maxError_(0.0)
+{
+    for(auto& q : quadrics_) {
+        std::fill(q.a, q.a + 10, 0.0);
+        q.weight = 0.0;
+    }
+    for(auto i : inputFaces_) {
+        if(i >= pointCount) {
+            throw std::out_of_range("MeshSimplifier : vertex index out of range.");
+        }
+    }
+    this->weld(pointCount);
+
+    // Face quadrics (area weighted) and edge use count to find the borders.
+    std::unordered_map<uint64_t, uint32_t> edges;
+    edges.reserve(faces_.size());
+    for(size_t f = 0; f < faceCount_; f++) {
+        const uint32_t* v = &faces_[3*f];
+        if(v[0] == v[1] || v[1] == v[2] || v[2] == v[0]) {
+            faceRemoved_[f] = true;
+            faceCount_--;
+            continue;
+        }
+        for(int k = 0; k < 3; k++) {
+            vertexFaces_[v[k]].push_back(f);
+            uint32_t a = std::min(v[k], v[(k + 1) % 3]);
+            uint32_t b = std::max(v[k], v[(k + 1) % 3]);
+            edges[(((uint64_t)a) << 32) | b]++;
+        }
+
+        const Point& p0 = points_[v[0]];
+        const Point& p1 = points_[v[1]];
+        const Point& p2 = points_[v[2]];
+        double ux = p1.x - p0.x, uy = p1.y - p0.y, uz = p1.z - p0.z;
+        double wx = p2.x - p0.x, wy = p2.y - p0.y, wz = p2.z - p0.z;
+        double nx = uy*wz - uz*wy, ny = uz*wx - ux*wz, nz = ux*wy - uy*wx;
+        double norm = std::sqrt(nx*nx + ny*ny + nz*nz);
+        if(norm <= 0.0) continue;
+        nx /= norm; ny /= norm; nz /= norm;
+        double d = -(nx*p0.x + ny*p0.y + nz*p0.z);
+        for(int k = 0; k < 3; k++) {
+            quadrics_[v[k]].add_plane(nx, ny, nz, d, 0.5*norm);
+        }
+    }
+    for(const auto& e : edges) {
+        if(e.second != 2) { // border or non-manifold edge
+            locked_[e.first >> 32]          = true;
+            locked_[e.first & 0xffffffffu] = true;
+        }
+    }
+
+    queue_.reserve(pointCount);
+    for(uint32_t v = 0; v < pointCount; v++) {
+        this->push_vertex(v, false);
+    }
+    std::make_heap(queue_.begin(), queue_.end());
+}
+
+/**
+ * Replaces the vertices in faces_ by the first input vertex with the same
+ * position. The other copies are not part of the simplification (removed).
+ */
+void MeshSimplifier::weld(size_t pointCount)
+{
+    struct PositionHash {
+        size_t operator()(const std::array<uint32_t,3>& k) const {
+            return (k[0]*73856093u) ^ (k[1]*19349663u) ^ (k[2]*83492791u);
+        }
+    };
+    auto key = [&](uint32_t v) {
+        // + 0.0f so that -0.0f and 0.0f are welded.
+        float x = points_[v].x + 0.0f, y = points_[v].y + 0.0f, z = points_[v].z + 0.0f;
+        std::array<uint32_t,3> k;
+        std::memcpy(&k[0], &x, sizeof(float));
+        std::memcpy(&k[1], &y, sizeof(float));
+        std::memcpy(&k[2], &z, sizeof(float));
+        return k;
+    };
+
+    welded_.resize(pointCount);
+    std::unordered_map<std::array<uint32_t,3>, uint32_t, PositionHash> positions;
+    positions.reserve(pointCount);
+    for(uint32_t v = 0; v < pointCount; v++) {
+        welded_[v] = positions.emplace(key(v), v).first->second;
+        if(welded_[v] != v) {
+            removed_[v] = true;
+        }
+    }
+
+    copyOffsets_.assign(pointCount + 1, 0);
+    for(uint32_t v = 0; v < pointCount; v++) {
+        copyOffsets_[welded_[v] + 1]++;
+    }
+    for(uint32_t v = 0; v < pointCount; v++) {
+        copyOffsets_[v + 1] += copyOffsets_[v];
+    }
+    copies_.resize(pointCount);
+    std::vector<uint32_t> fill(copyOffsets_.begin(), copyOffsets_.end() - 1);
+    for(uint32_t v = 0; v < pointCount; v++) {
+        copies_[fill[welded_[v]]++] = v;
+    }
+
+    copyFace_.assign(pointCount, std::numeric_limits<uint32_t>::max());
+    for(size_t i = 0; i < inputFaces_.size(); i++) {
+        if(copyFace_[inputFaces_[i]] == std::numeric_limits<uint32_t>::max()) {
+            copyFace_[inputFaces_[i]] = i / 3;
+        }
+        faces_[i] = welded_[inputFaces_[i]];
+    }
+}
+
+/**
+ * Non normalized normal of a face (3 vertex indices).
+ */
+void MeshSimplifier::face_normal(const uint32_t* face, double* n) const
+{
+    const Point& p0 = points_[face[0]];
+    const Point& p1 = points_[face[1]];
+    const Point& p2 = points_[face[2]];
+    double ux = p1.x - p0.x, uy = p1.y - p0.y, uz = p1.z - p0.z;
+    double wx = p2.x - p0.x, wy = p2.y - p0.y, wz = p2.z - p0.z;
+    n[0] = uy*wz - uz*wy; n[1] = uz*wx - ux*wz; n[2] = ux*wy - uy*wx;
+}
+
+/**
+ * Input vertex to use for a corner of a remaining face (see class
+ * documentation).
+ */
+uint32_t MeshSimplifier::output_vertex(size_t face, int corner) const
+{
+    uint32_t input  = inputFaces_[3*face + corner];
+    uint32_t welded = faces_[3*face + corner];
+    if(welded_[input] == welded) {
+        return input;
+    }
+
+    double n[3];
+    this->face_normal(&faces_[3*face], n);
+    uint32_t best    = welded;
+    double   bestDot = -std::numeric_limits<double>::infinity();
+    for(uint32_t i = copyOffsets_[welded]; i < copyOffsets_[welded + 1]; i++) {
+        uint32_t copy = copies_[i];
+        if(copyFace_[copy] == std::numeric_limits<uint32_t>::max()) continue;
+        double m[3];
+        this->face_normal(&inputFaces_[3*copyFace_[copy]], m);
+        double norm = std::sqrt(m[0]*m[0] + m[1]*m[1] + m[2]*m[2]);
+        if(norm <= 0.0) continue;
+        double dot = (n[0]*m[0] + n[1]*m[1] + n[2]*m[2]) / norm;
+        if(dot > bestDot) {
+            bestDot = dot;
+            best    = copy;
+        }
+    }
+    return best;
+}
+
+double MeshSimplifier::cost(uint32_t from, uint32_t to) const
+{
+    // quadrics_[to].evaluate(points_[to]) is not always 0 (vertex on a
+    // curved surface).
+    return std::max(0.0, quadrics_[from].evaluate(points_[to])
+                       + quadrics_[to].evaluate(points_[to]));
+}
+
+/**
+ * Unique neighbours of vertex (in neighbours_).
+ */
+void MeshSimplifier::find_neighbours(uint32_t vertex)
+{
+    neighbours_.clear();
+    for(auto f : vertexFaces_[vertex]) {
+        if(faceRemoved_[f]) continue;
+        for(int k = 0; k < 3; k++) {
+            uint32_t other = faces_[3*f + k];
+            if(other != vertex) neighbours_.push_back(other);
+        }
+    }
+    std::sort(neighbours_.begin(), neighbours_.end());
+    neighbours_.erase(std::unique(neighbours_.begin(), neighbours_.end()),
+                      neighbours_.end());
+}
+
+/**
+ * Queues vertex with the cost of its cheapest collapse. The queue holds a
+ * single entry per vertex (older entries are invalidated by the version
+ * number of the vertex).
+ */
+void MeshSimplifier::push_vertex(uint32_t vertex, bool updateHeap)
+{
+    versions_[vertex]++;
+    if(locked_[vertex] || removed_[vertex]) return;
+
+    this->find_neighbours(vertex);
+    double best = std::numeric_limits<double>::infinity();
+    for(auto other : neighbours_) {
+        best = std::min(best, this->cost(vertex, other));
+    }
+    if(neighbours_.size() == 0) return;
+
+    queue_.push_back(Collapse({best, vertex, versions_[vertex]}));
+    if(updateHeap) std::push_heap(queue_.begin(), queue_.end());
+}
+
+/**
+ * @return true if moving vertex from onto to flips one of the remaining
+ *         faces (or makes it degenerate).
+ */
+bool MeshSimplifier::flips(uint32_t from, uint32_t to) const
+{
+    for(auto f : vertexFaces_[from]) {
+        if(faceRemoved_[f]) continue;
+        const uint32_t* v = &faces_[3*f];
+        if(v[0] == to || v[1] == to || v[2] == to) continue; // removed by collapse
+
+        Point p[3], q[3];
+        for(int k = 0; k < 3; k++) {
+            p[k] = points_[v[k]];
+            q[k] = points_[v[k] == from ? to : v[k]];
+        }
+        auto normal = [](const Point* p, double* n) {
+            double ux = p[1].x - p[0].x, uy = p[1].y - p[0].y, uz = p[1].z - p[0].z;
+            double wx = p[2].x - p[0].x, wy = p[2].y - p[0].y, wz = p[2].z - p[0].z;
+            n[0] = uy*wz - uz*wy; n[1] = uz*wx - ux*wz; n[2] = ux*wy - uy*wx;
+        };
+        double n0[3], n1[3];
+        normal(p, n0);
+        normal(q, n1);
+        double d  = n0[0]*n1[0] + n0[1]*n1[1] + n0[2]*n1[2];
+        double l0 = n0[0]*n0[0] + n0[1]*n0[1] + n0[2]*n0[2];
+        double l1 = n1[0]*n1[0] + n1[1]*n1[1] + n1[2]*n1[2];
+        if(l1 <= 1.0e-12*l0 || d <= 0.2*std::sqrt(l0*l1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshSimplifier::collapse(uint32_t from, uint32_t to)
+{
+    for(auto f : vertexFaces_[from]) {
+        if(faceRemoved_[f]) continue;
+        uint32_t* v = &faces_[3*f];
+        if(v[0] == to || v[1] == to || v[2] == to) {
+            faceRemoved_[f] = true;
+            faceCount_--;
+            continue;
+        }
+        for(int k = 0; k < 3; k++) {
+            if(v[k] == from) v[k] = to;
+        }
+        vertexFaces_[to].push_back(f);
+    }
+    vertexFaces_[from].clear();
+    vertexFaces_[from].shrink_to_fit();
+    removed_[from] = true;
+    quadrics_[to].add(quadrics_[from]);
+
+    // Compacting the face list of to and updating the cost of to and of its
+    // neighbours (the cost of their collapse onto to has changed).
+    auto& faces = vertexFaces_[to];
+    faces.erase(std::remove_if(faces.begin(), faces.end(),
+                               [&](uint32_t f) { return faceRemoved_[f]; }),
+                faces.end());
+    this->find_neighbours(to);
+    std::vector<uint32_t> neighbours(neighbours_);
+    this->push_vertex(to);
+    for(auto v : neighbours) {
+        this->push_vertex(v);
+    }
+}
+
+/**
+ * Collapses edges by increasing cost until the face count is less or equal to
+ * targetFaceCount or no valid collapse is left.
+ *
+ * @return the geometric error of the mesh (see error()).
+ */
+float MeshSimplifier::simplify(size_t targetFaceCount)
+{
+    std::vector<std::pair<double,uint32_t>> candidates;
+    while(faceCount_ > targetFaceCount && queue_.size() > 0) {
+        std::pop_heap(queue_.begin(), queue_.end());
+        Collapse c = queue_.back();
+        queue_.pop_back();
+        if(removed_[c.vertex] || versions_[c.vertex] != c.version) {
+            continue; // outdated
+        }
+
+        // Trying the collapses of this vertex by increasing cost. If the
+        // cheapest valid one is more expensive than the next vertex in the
+        // queue, the vertex is queued again with this cost.
+        this->find_neighbours(c.vertex);
+        candidates.clear();
+        for(auto other : neighbours_) {
+            candidates.push_back(std::make_pair(this->cost(c.vertex, other), other));
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for(const auto& candidate : candidates) {
+            if(queue_.size() > 0 && candidate.first > queue_.front().cost) {
+                queue_.push_back(Collapse({candidate.first, c.vertex, c.version}));
+                std::push_heap(queue_.begin(), queue_.end());
+                break;
+            }
+            if(!this->flips(c.vertex, candidate.second)) {
+                double weight = quadrics_[c.vertex].weight
+                              + quadrics_[candidate.second].weight;
+                if(weight > 0.0) {
+                    maxError_ = std::max(maxError_, candidate.first / weight);
+                }
+                this->collapse(c.vertex, candidate.second);
+                break;
+            }
+        }
+        // No valid collapse : the vertex is queued again when its
+        // neighbourhood changes.
+    }
+    return this->error();
+}
+
+/**
+ * Estimation of the distance between the simplified surface and the
+ * original one, in mesh units. This is the largest root mean square distance
+ * (weighted by area) between a collapsed vertex and the planes of the
+ * original faces it replaces.
+ */
+float MeshSimplifier::error() const
+{
+    return std::sqrt(maxError_);
+}
+
+/**
+ * @return the remaining faces (indexing the original vertices).
+ */
+std::vector<uint32_t> MeshSimplifier::indices() const
+{
+    std::vector<uint32_t> res;
+    res.reserve(3*faceCount_);
+    for(size_t f = 0; f < faceRemoved_.size(); f++) {
+        if(!faceRemoved_[f]) {
+            for(int k = 0; k < 3; k++) {
+                res.push_back(this->output_vertex(f, k));
+            }
+        }
+    }
+    return res;
+}
+
+}; //namespace display
+}; //namespace rtac
@@ -0,0 +1,787 @@
+#include <rtac_display/PlyFile.h>
+
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <charconv>
+
+namespace rtac { namespace display {
+
+namespace {
+
+constexpr size_t NoOffset = std::numeric_limits<size_t>::max();
+constexpr size_t MinRecordsPerThread = 16384;
+constexpr size_t MinBytesPerThread   = 1 << 20;
+
+PlyFile::Type parse_type(const std::string& name)
+{
+    if(name == "char"   || name == "int8")    return PlyFile::Type::Int8;
+    if(name == "uchar"  || name == "uint8")   return PlyFile::Type::UInt8;
+    if(name == "short"  || name == "int16")   return PlyFile::Type::Int16;
+    if(name == "ushort" || name == "uint16")  return PlyFile::Type::UInt16;
+    if(name == "int"    || name == "int32")   return PlyFile::Type::Int32;
+    if(name == "uint"   || name == "uint32")  return PlyFile::Type::UInt32;
+    if(name == "float"  || name == "float32") return PlyFile::Type::Float32;
+    if(name == "double" || name == "float64") return PlyFile::Type::Float64;
+    throw std::runtime_error("PlyFile : unknown property type \"" + name + "\"");
+}
+
+template <typename T>
+inline T load(const uint8_t* p, bool swap)
+{
+    T res;
+    if(swap) {
+        uint8_t tmp[sizeof(T)];
+        for(size_t i = 0; i < sizeof(T); i++) tmp[i] = p[sizeof(T) - 1 - i];
+        std::memcpy(&res, tmp, sizeof(T));
+    }
+    else {
+        std::memcpy(&res, p, sizeof(T));
+    }
+    return res;
+}
+
+/**
+ * Reads a binary value of any PLY type and converts it to T.
+ */
+template <typename T>
+inline T read_value(const uint8_t* p, PlyFile::Type type, bool swap)
+{
+    switch(type) {
+        case PlyFile::Type::Int8:    return (T)load<int8_t>(p, swap);
+        case PlyFile::Type::UInt8:   return (T)load<uint8_t>(p, swap);
+        case PlyFile::Type::Int16:   return (T)load<int16_t>(p, swap);
+        case PlyFile::Type::UInt16:  return (T)load<uint16_t>(p, swap);
+        case PlyFile::Type::Int32:   return (T)load<int32_t>(p, swap);
+        case PlyFile::Type::UInt32:  return (T)load<uint32_t>(p, swap);
+        case PlyFile::Type::Float32: return (T)load<float>(p, swap);
+        default:
+        case PlyFile::Type::Float64: return (T)load<double>(p, swap);
+    }
+}
+
+/**
+ * Whitespace separated tokens of an ascii record (stops at the end of the
+ * line).
+ */
+struct AsciiCursor
+{
+    const char* p;
+    const char* end;
+
+    bool next(const char*& tokenBegin, const char*& tokenEnd) {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+        if(p >= end || *p == '\n') return false;
+        tokenBegin = p;
+        while(p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        tokenEnd = p;
+        return true;
+    }
+
+    double next_float() {
+        const char *b, *e;
+        if(!this->next(b, e)) throw std::runtime_error("PlyFile : truncated ascii record.");
+        char buffer[64];
+        size_t size = std::min<size_t>(e - b, sizeof(buffer) - 1);
+        std::memcpy(buffer, b, size);
+        buffer[size] = '\0';
+        return std::strtod(buffer, nullptr);
+    }
+
+    uint32_t next_uint() {
+        const char *b, *e;
+        if(!this->next(b, e)) throw std::runtime_error("PlyFile : truncated ascii record.");
+        uint32_t value = 0;
+        if(std::from_chars(b, e, value).ec != std::errc()) {
+            throw std::runtime_error("PlyFile : invalid integer in ascii record \""
+                                     + std::string(b, e) + "\"");
+        }
+        return value;
+    }
+
+    void skip() {
+        const char *b, *e;
+        if(!this->next(b, e)) throw std::runtime_error("PlyFile : truncated ascii record.");
+    }
+
+    void next_line() {
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        p = eol ? eol + 1 : end;
+    }
+
+    bool blank_line() const {
+        for(const char* c = p; c < end && *c != '\n'; c++) {
+            if(*c != ' ' && *c != '\t' && *c != '\r') return false;
+        }
+        return true;
+    }
+};
+
+unsigned int thread_count(size_t work, size_t minWorkPerThread)
+{
+    size_t count = std::max<size_t>(1, work / minWorkPerThread);
+    return std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+/**
+ * Calls f(threadIndex) on threadCount threads (including the calling
+ * thread). The first exception raised is rethrown once all threads are done.
+ */
+template <typename F>
+void run_parallel(unsigned int threadCount, F&& f)
+{
+    std::exception_ptr error;
+    std::mutex         errorMutex;
+    auto run = [&](unsigned int index) {
+        try {
+            f(index);
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if(!error) error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(run, i);
+    }
+    run(0);
+    for(auto& w : workers) w.join();
+    if(error) std::rethrow_exception(error);
+}
+
+/**
+ * Splits the ascii data of an element in threadCount byte ranges starting on
+ * line boundaries.
+ */
+std::vector<AsciiCursor> ascii_ranges(const uint8_t* data, size_t size,
+                                      unsigned int threadCount)
+{
+    const char* begin = (const char*)data;
+    const char* end   = begin + size;
+    std::vector<AsciiCursor> ranges(threadCount);
+    for(unsigned int t = 0; t < threadCount; t++) {
+        AsciiCursor& range = ranges[t];
+        range.p   = begin + (size*t) / threadCount;
+        range.end = end;
+        if(t > 0 && range.p[-1] != '\n') range.next_line();
+    }
+    for(unsigned int t = 0; t + 1 < threadCount; t++) {
+        ranges[t].end = ranges[t + 1].p; // ends on the next line start
+    }
+    return ranges;
+}
+
+}; //namespace
+
+PlyFile::PlyFile(const std::string& path) :
+    file_(MappedFile::Open(path)),
+    data_(file_->data()),
+    size_(file_->size()),
+    format_(Format::Ascii)
+{
+    this->parse_header();
+    this->locate_elements();
+}
+
+size_t PlyFile::type_size(Type type)
+{
+    switch(type) {
+        case Type::Int8:  case Type::UInt8:   return 1;
+        case Type::Int16: case Type::UInt16:  return 2;
+        case Type::Int32: case Type::UInt32:  case Type::Float32: return 4;
+        default:
+        case Type::Float64: return 8;
+    }
+}
+
+void PlyFile::parse_header()
+{
+    static const char endHeader[] = "end_header";
+    const char* begin = (const char*)data_;
+    const char* end   = begin + std::min<size_t>(size_, 1 << 20);
+    const char* h     = std::search(begin, end, endHeader, endHeader + sizeof(endHeader) - 1);
+    if(size_ < 4 || std::strncmp(begin, "ply", 3) != 0 || h == end) {
+        throw std::runtime_error("PlyFile : invalid PLY header in " + this->path());
+    }
+    const char* eol = (const char*)std::memchr(h, '\n', (begin + size_) - h);
+    if(!eol) {
+        throw std::runtime_error("PlyFile : no data after header in " + this->path());
+    }
+    size_t headerSize = (eol + 1) - begin;
+
+    std::istringstream header(std::string(begin, h));
+    std::string line;
+    bool hasFormat = false;
+    while(std::getline(header, line)) {
+        std::istringstream iss(line);
+        std::string keyword;
+        if(!(iss >> keyword)) continue;
+        if(keyword == "format") {
+            std::string format;
+            iss >> format;
+            if(format == "ascii")                     format_ = Format::Ascii;
+            else if(format == "binary_little_endian") format_ = Format::BinaryLittleEndian;
+            else if(format == "binary_big_endian")    format_ = Format::BinaryBigEndian;
+            else throw std::runtime_error("PlyFile : unknown format \"" + format + "\"");
+            hasFormat = true;
+        }
+        else if(keyword == "element") {
+            Element element;
+            if(!(iss >> element.name >> element.count)) {
+                throw std::runtime_error("PlyFile : invalid element declaration \""
+                                         + line + "\"");
+            }
+            element.stride     = 0;
+            element.dataOffset = 0;
+            element.dataSize   = 0;
+            elements_.push_back(element);
+        }
+        else if(keyword == "property") {
+            if(elements_.size() == 0) {
+                throw std::runtime_error("PlyFile : property declared before any element.");
+            }
+            Property property;
+            std::string type;
+            iss >> type;
+            if(type == "list") {
+                std::string countType;
+                iss >> countType >> type;
+                property.isList    = true;
+                property.countType = parse_type(countType);
+            }
+            else {
+                property.isList    = false;
+                property.countType = Type::UInt8;
+            }
+            property.type = parse_type(type);
+            if(!(iss >> property.name)) {
+                throw std::runtime_error("PlyFile : invalid property declaration \""
+                                         + line + "\"");
+            }
+            elements_.back().properties.push_back(property);
+        }
+        // comment, obj_info and ply lines are ignored.
+    }
+    if(!hasFormat) {
+        throw std::runtime_error("PlyFile : no format in header of " + this->path());
+    }
+
+    for(auto& element : elements_) {
+        size_t offset = 0;
+        for(auto& property : element.properties) {
+            property.offset = offset;
+            if(offset == NoOffset) continue;
+            if(property.isList) offset = NoOffset;
+            else                offset += type_size(property.type);
+        }
+        element.stride = (format_ == Format::Ascii || offset == NoOffset) ? 0 : offset;
+    }
+    if(elements_.size() > 0) {
+        elements_[0].dataOffset = headerSize;
+    }
+}
+
+/**
+ * Finds the start of the data of each element. This is immediate for binary
+ * elements with a fixed record size. Elements with list properties (and all
+ * ascii elements) followed by another element are scanned sequentially.
+ */
+void PlyFile::locate_elements()
+{
+    for(size_t i = 0; i < elements_.size(); i++) {
+        auto& element = elements_[i];
+        bool last = i + 1 == elements_.size();
+        if(element.stride > 0) {
+            element.dataSize = element.count*element.stride;
+        }
+        else if(last) {
+            element.dataSize = size_ - element.dataOffset;
+        }
+        else if(format_ == Format::Ascii) {
+            AsciiCursor cursor({(const char*)data_ + element.dataOffset,
+                                (const char*)data_ + size_});
+            for(size_t n = 0; n < element.count; n++) cursor.next_line();
+            element.dataSize = (const uint8_t*)cursor.p - (data_ + element.dataOffset);
+        }
+        else {
+            const uint8_t* p = data_ + element.dataOffset;
+            for(size_t n = 0; n < element.count; n++) p = this->skip_record(element, p);
+            element.dataSize = p - (data_ + element.dataOffset);
+        }
+        if(element.dataOffset + element.dataSize > size_) {
+            std::ostringstream oss;
+            oss << "PlyFile : truncated file " << this->path() << " (element \""
+                << element.name << "\")";
+            throw std::runtime_error(oss.str());
+        }
+        if(!last) {
+            elements_[i + 1].dataOffset = element.dataOffset + element.dataSize;
+        }
+    }
+}
+
+/**
+ * Returns the start of the next binary record.
+ */
+const uint8_t* PlyFile::skip_record(const Element& element, const uint8_t* record) const
+{
+    bool swap = format_ == Format::BinaryBigEndian;
+    const uint8_t* end = data_ + size_;
+    for(const auto& property : element.properties) {
+        if(property.isList) {
+            if(record + type_size(property.countType) > end) break;
+            size_t count = read_value<size_t>(record, property.countType, swap);
+            record += type_size(property.countType) + count*type_size(property.type);
+        }
+        else {
+            record += type_size(property.type);
+        }
+    }
+    if(record > end) {
+        throw std::runtime_error("PlyFile : truncated binary record in " + this->path());
+    }
+    return record;
+}
+
+const PlyFile::Element* PlyFile::element(const std::string& name) const
+{
+    for(const auto& element : elements_) {
+        if(element.name == name) return &element;
+    }
+    return nullptr;
+}
+
+const PlyFile::Property* PlyFile::property(const std::string& element,
+                                           const std::string& name) const
+{
+    auto e = this->element(element);
+    if(!e) return nullptr;
+    for(const auto& property : e->properties) {
+        if(property.name == name) return &property;
+    }
+    return nullptr;
+}
+
+bool PlyFile::has_properties(const std::string& element,
+                             const std::vector<std::string>& names) const
+{
+    for(const auto& name : names) {
+        auto p = this->property(element, name);
+        if(!p || p->isList) return false;
+    }
+    return true;
+}
+
+/**
+ * Reads scalar properties of an element as floats. The value of names[k] for
+ * record i is written in dst[dstStride*i + k] (dst must hold at least
+ * dstStride*element.count floats).
+ */
+void PlyFile::read_floats(const std::string& elementName,
+                          const std::vector<std::string>& names,
+                          float* dst, size_t dstStride) const
+{
+    this->read_scalars(elementName, names, dst, dstStride);
+}
+
+/**
+ * Same as read_floats, for properties which need double precision (for
+ * example georeferenced coordinates).
+ */
+void PlyFile::read_doubles(const std::string& elementName,
+                           const std::vector<std::string>& names,
+                           double* dst, size_t dstStride) const
+{
+    this->read_scalars(elementName, names, dst, dstStride);
+}
+
+template <typename T>
+void PlyFile::read_scalars(const std::string& elementName,
+                           const std::vector<std::string>& names,
+                           T* dst, size_t dstStride) const
+{
+    constexpr Type NativeType = sizeof(T) == sizeof(float) ? Type::Float32 : Type::Float64;
+
+    auto element = this->element(elementName);
+    if(!element) {
+        throw std::runtime_error("PlyFile : no element \"" + elementName + "\" in " + this->path());
+    }
+    // slots[j] : output component of property j (-1 if not read).
+    std::vector<int> slots(element->properties.size(), -1);
+    for(size_t k = 0; k < names.size(); k++) {
+        bool found = false;
+        for(size_t j = 0; j < element->properties.size(); j++) {
+            if(element->properties[j].name == names[k] && !element->properties[j].isList) {
+                slots[j] = k;
+                found    = true;
+            }
+        }
+        if(!found) {
+            throw std::runtime_error("PlyFile : no scalar property \"" + names[k]
+                                     + "\" in element \"" + elementName + "\"");
+        }
+    }
+
+    const uint8_t* data  = data_ + element->dataOffset;
+    size_t         count = element->count;
+    bool           swap  = format_ == Format::BinaryBigEndian;
+
+    if(format_ != Format::Ascii && element->stride > 0) {
+        size_t stride = element->stride;
+        unsigned int threadCount = thread_count(count, MinRecordsPerThread);
+        run_parallel(threadCount, [&](unsigned int t) {
+            size_t begin = (count*t) / threadCount, end = (count*(t + 1)) / threadCount;
+            for(size_t j = 0; j < slots.size(); j++) {
+                if(slots[j] < 0) continue;
+                const auto& property = element->properties[j];
+                const uint8_t* src = data + property.offset;
+                T* out = dst + slots[j];
+                if(property.type == NativeType && !swap) {
+                    for(size_t i = begin; i < end; i++) {
+                        std::memcpy(out + dstStride*i, src + stride*i, sizeof(T));
+                    }
+                }
+                else {
+                    for(size_t i = begin; i < end; i++) {
+                        out[dstStride*i] = read_value<T>(src + stride*i,
+                                                             property.type, swap);
+                    }
+                }
+            }
+        });
+    }
+    else if(format_ != Format::Ascii) {
+        // Variable size records (list properties) : sequential.
+        const uint8_t* record = data;
+        for(size_t i = 0; i < count; i++) {
+            const uint8_t* p = record;
+            for(size_t j = 0; j < slots.size(); j++) {
+                const auto& property = element->properties[j];
+                if(property.isList) {
+                    size_t n = read_value<size_t>(p, property.countType, swap);
+                    p += type_size(property.countType) + n*type_size(property.type);
+                    continue;
+                }
+                if(slots[j] >= 0) {
+                    dst[dstStride*i + slots[j]] = read_value<T>(p, property.type, swap);
+                }
+                p += type_size(property.type);
+            }
+            record = this->skip_record(*element, record);
+        }
+    }
+    else {
+        // Ascii : each thread counts the lines of its range, then parses
+        // them at the record index given by the prefix sum of the counts.
+        unsigned int threadCount = thread_count(element->dataSize, MinBytesPerThread);
+        auto ranges = ascii_ranges(data, element->dataSize, threadCount);
+        std::vector<size_t> firstRecord(threadCount + 1, 0);
+        run_parallel(threadCount, [&](unsigned int t) {
+            AsciiCursor cursor = ranges[t];
+            size_t lines = 0;
+            for(; cursor.p < cursor.end; cursor.next_line()) {
+                if(!cursor.blank_line()) lines++;
+            }
+            firstRecord[t + 1] = lines;
+        });
+        for(unsigned int t = 0; t < threadCount; t++) {
+            firstRecord[t + 1] += firstRecord[t];
+        }
+        if(firstRecord[threadCount] < count) {
+            throw std::runtime_error("PlyFile : truncated ascii element \""
+                                     + elementName + "\" in " + this->path());
+        }
+        run_parallel(threadCount, [&](unsigned int t) {
+            AsciiCursor cursor = ranges[t];
+            size_t i = firstRecord[t];
+            for(; cursor.p < cursor.end && i < count; cursor.next_line()) {
+                if(cursor.blank_line()) continue;
+                AsciiCursor record({cursor.p, cursor.end});
+                for(size_t j = 0; j < slots.size(); j++) {
+                    const auto& property = element->properties[j];
+                    if(property.isList) {
+                        uint32_t n = record.next_uint();
+                        for(uint32_t k = 0; k < n; k++) record.skip();
+                    }
+                    else if(slots[j] >= 0) {
+                        dst[dstStride*i + slots[j]] = record.next_float();
+                    }
+                    else {
+                        record.skip();
+                    }
+                }
+                i++;
+            }
+        });
+    }
+}
+
+/**
+ * Checks (in parallel) if all the records of a binary face element are
+ * triangles. They can then be read with a fixed record size
+ * (triangleStride).
+ */
+bool PlyFile::fixed_triangles(const Element& element, size_t listIndex,
+                              size_t& triangleStride) const
+{
+    for(size_t j = 0; j < element.properties.size(); j++) {
+        if(j != listIndex && element.properties[j].isList) return false;
+    }
+    const auto& list = element.properties[listIndex];
+    triangleStride = 0;
+    for(size_t j = 0; j < element.properties.size(); j++) {
+        if(j == listIndex)
+            triangleStride += type_size(list.countType) + 3*type_size(list.type);
+        else
+            triangleStride += type_size(element.properties[j].type);
+    }
+    size_t count = element.count;
+    if(element.dataSize < count*triangleStride
+       || (element.dataSize != count*triangleStride && &element != &elements_.back())) {
+        return false;
+    }
+
+    size_t countOffset = 0;
+    for(size_t j = 0; j < listIndex; j++) {
+        countOffset += type_size(element.properties[j].type);
+    }
+    const uint8_t* data = data_ + element.dataOffset + countOffset;
+    bool swap = format_ == Format::BinaryBigEndian;
+    unsigned int threadCount = thread_count(count, MinRecordsPerThread);
+    std::vector<uint8_t> valid(threadCount, 1);
+    run_parallel(threadCount, [&](unsigned int t) {
+        size_t begin = (count*t) / threadCount, end = (count*(t + 1)) / threadCount;
+        for(size_t i = begin; i < end; i++) {
+            if(read_value<uint32_t>(data + triangleStride*i, list.countType, swap) != 3) {
+                valid[t] = 0;
+                return;
+            }
+        }
+    });
+    return std::all_of(valid.begin(), valid.end(), [](uint8_t v) { return v != 0; });
+}
+
+namespace {
+
+size_t face_list_index(const PlyFile::Element& element)
+{
+    for(size_t j = 0; j < element.properties.size(); j++) {
+        const auto& name = element.properties[j].name;
+        if(element.properties[j].isList
+           && (name == "vertex_indices" || name == "vertex_index")) return j;
+    }
+    for(size_t j = 0; j < element.properties.size(); j++) {
+        if(element.properties[j].isList) return j;
+    }
+    throw std::runtime_error("PlyFile : no vertex index list in element \""
+                             + element.name + "\"");
+}
+
+}; //namespace
+
+/**
+ * Number of triangles in a face element once the polygons are triangulated
+ * (a polygon of n vertices gives n - 2 triangles).
+ */
+size_t PlyFile::triangle_count(const std::string& elementName) const
+{
+    auto element = this->element(elementName);
+    if(!element) return 0;
+    size_t listIndex = face_list_index(*element);
+    const auto& list = element->properties[listIndex];
+    bool swap = format_ == Format::BinaryBigEndian;
+
+    if(format_ != Format::Ascii) {
+        size_t triangleStride;
+        if(this->fixed_triangles(*element, listIndex, triangleStride)) {
+            return element->count;
+        }
+        size_t count = 0;
+        const uint8_t* record = data_ + element->dataOffset;
+        for(size_t i = 0; i < element->count; i++) {
+            const uint8_t* p = record;
+            for(size_t j = 0; j < listIndex; j++) {
+                p += type_size(element->properties[j].type);
+            }
+            size_t n = read_value<size_t>(p, list.countType, swap);
+            if(n >= 3) count += n - 2;
+            record = this->skip_record(*element, record);
+        }
+        return count;
+    }
+
+    unsigned int threadCount = thread_count(element->dataSize, MinBytesPerThread);
+    auto ranges = ascii_ranges(data_ + element->dataOffset, element->dataSize, threadCount);
+    std::vector<size_t> counts(threadCount, 0);
+    std::vector<size_t> records(threadCount, 0);
+    run_parallel(threadCount, [&](unsigned int t) {
+        AsciiCursor cursor = ranges[t];
+        for(; cursor.p < cursor.end; cursor.next_line()) {
+            if(cursor.blank_line()) continue;
+            AsciiCursor record({cursor.p, cursor.end});
+            for(size_t j = 0; j < listIndex; j++) record.skip();
+            uint32_t n = record.next_uint();
+            if(n >= 3) counts[t] += n - 2;
+            records[t]++;
+        }
+    });
+    // trailing lines after the last record are ignored.
+    size_t count = 0, recordCount = 0;
+    for(unsigned int t = 0; t < threadCount && recordCount < element->count; t++) {
+        if(recordCount + records[t] > element->count) {
+            // rare case (trailing data in the last range) : sequential count.
+            AsciiCursor cursor = ranges[t];
+            for(; cursor.p < cursor.end && recordCount < element->count; cursor.next_line()) {
+                if(cursor.blank_line()) continue;
+                AsciiCursor record({cursor.p, cursor.end});
+                for(size_t j = 0; j < listIndex; j++) record.skip();
+                uint32_t n = record.next_uint();
+                if(n >= 3) count += n - 2;
+                recordCount++;
+            }
+            break;
+        }
+        count       += counts[t];
+        recordCount += records[t];
+    }
+    return count;
+}
+
+/**
+ * Reads the faces of a face element as triangles (dst must hold
+ * 3*triangle_count(element) indices). Polygons are triangulated as fans.
+ */
+void PlyFile::read_triangles(uint32_t* dst, const std::string& elementName) const
+{
+    auto element = this->element(elementName);
+    if(!element) {
+        throw std::runtime_error("PlyFile : no element \"" + elementName + "\" in " + this->path());
+    }
+    size_t listIndex = face_list_index(*element);
+    const auto& list = element->properties[listIndex];
+    size_t indexSize = type_size(list.type);
+    bool   swap      = format_ == Format::BinaryBigEndian;
+    size_t count     = element->count;
+
+    if(format_ != Format::Ascii) {
+        size_t triangleStride;
+        if(this->fixed_triangles(*element, listIndex, triangleStride)) {
+            size_t indexOffset = type_size(list.countType);
+            for(size_t j = 0; j < listIndex; j++) {
+                indexOffset += type_size(element->properties[j].type);
+            }
+            const uint8_t* data = data_ + element->dataOffset + indexOffset;
+            unsigned int threadCount = thread_count(count, MinRecordsPerThread);
+            run_parallel(threadCount, [&](unsigned int t) {
+                size_t begin = (count*t) / threadCount, end = (count*(t + 1)) / threadCount;
+                if((list.type == Type::Int32 || list.type == Type::UInt32) && !swap) {
+                    for(size_t i = begin; i < end; i++) {
+                        std::memcpy(dst + 3*i, data + triangleStride*i, 3*sizeof(uint32_t));
+                    }
+                    return;
+                }
+                for(size_t i = begin; i < end; i++) {
+                    const uint8_t* p = data + triangleStride*i;
+                    dst[3*i]     = read_value<uint32_t>(p,               list.type, swap);
+                    dst[3*i + 1] = read_value<uint32_t>(p +   indexSize, list.type, swap);
+                    dst[3*i + 2] = read_value<uint32_t>(p + 2*indexSize, list.type, swap);
+                }
+            });
+            return;
+        }
+        // Polygons : sequential fan triangulation.
+        const uint8_t* record = data_ + element->dataOffset;
+        for(size_t i = 0; i < count; i++) {
+            const uint8_t* p = record;
+            for(size_t j = 0; j < listIndex; j++) {
+                p += type_size(element->properties[j].type);
+            }
+            size_t n = read_value<size_t>(p, list.countType, swap);
+            p += type_size(list.countType);
+            uint32_t first = read_value<uint32_t>(p, list.type, swap);
+            for(size_t k = 1; k + 1 < n; k++) {
+                dst[0] = first;
+                dst[1] = read_value<uint32_t>(p +       k*indexSize, list.type, swap);
+                dst[2] = read_value<uint32_t>(p + (k + 1)*indexSize, list.type, swap);
+                dst += 3;
+            }
+            record = this->skip_record(*element, record);
+        }
+        return;
+    }
+
+    // Ascii : triangle counts per range, then parsing at the prefix sum.
+    unsigned int threadCount = thread_count(element->dataSize, MinBytesPerThread);
+    auto ranges = ascii_ranges(data_ + element->dataOffset, element->dataSize, threadCount);
+    std::vector<size_t> firstTriangle(threadCount + 1, 0);
+    std::vector<size_t> firstRecord(threadCount + 1, 0);
+    run_parallel(threadCount, [&](unsigned int t) {
+        AsciiCursor cursor = ranges[t];
+        for(; cursor.p < cursor.end; cursor.next_line()) {
+            if(cursor.blank_line()) continue;
+            AsciiCursor record({cursor.p, cursor.end});
+            for(size_t j = 0; j < listIndex; j++) record.skip();
+            uint32_t n = record.next_uint();
+            if(n >= 3) firstTriangle[t + 1] += n - 2;
+            firstRecord[t + 1]++;
+        }
+    });
+    for(unsigned int t = 0; t < threadCount; t++) {
+        firstTriangle[t + 1] += firstTriangle[t];
+        firstRecord[t + 1]   += firstRecord[t];
+    }
+    if(firstRecord[threadCount] < count) {
+        throw std::runtime_error("PlyFile : truncated ascii element \""
+                                 + elementName + "\" in " + this->path());
+    }
+    run_parallel(threadCount, [&](unsigned int t) {
+        AsciiCursor cursor = ranges[t];
+        size_t    i   = firstRecord[t];
+        uint32_t* out = dst + 3*firstTriangle[t];
+        std::vector<uint32_t> polygon;
+        for(; cursor.p < cursor.end && i < count; cursor.next_line()) {
+            if(cursor.blank_line()) continue;
+            AsciiCursor record({cursor.p, cursor.end});
+            for(size_t j = 0; j < listIndex; j++) record.skip();
+            uint32_t n = record.next_uint();
+            polygon.resize(n);
+            for(uint32_t k = 0; k < n; k++) polygon[k] = record.next_uint();
+            for(uint32_t k = 1; k + 1 < n; k++) {
+                out[0] = polygon[0];
+                out[1] = polygon[k];
+                out[2] = polygon[k + 1];
+                out += 3;
+            }
+            i++;
+        }
+    });
+}
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::display::PlyFile& ply)
+{
+    using Format = rtac::display::PlyFile::Format;
+    os << "PlyFile " << ply.path() << " ("
+       << (ply.format() == Format::Ascii ? "ascii" :
+           ply.format() == Format::BinaryLittleEndian ? "binary little endian"
+                                                      : "binary big endian")
+       << ", " << ply.file_size() << " bytes)";
+    for(const auto& element : ply.elements()) {
+        os << "\n- " << element.name << " : " << element.count << " (";
+        for(size_t j = 0; j < element.properties.size(); j++) {
+            if(j > 0) os << ", ";
+            os << element.properties[j].name;
+            if(element.properties[j].isList) os << "[]";
+        }
+        os << ")";
+    }
+    return os;
+}
@@ -0,0 +1,491 @@
+#include <rtac_display/PointOctree.h>
+
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+#include <rtac_display/PlyFile.h>
+
+namespace rtac { namespace display {
+
+namespace {
+
+using Point    = PointOctree::Point;
+using Position = PointOctree::Position;
+using Node     = PointOctree::Node;
+
+struct OctreeHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t maxNodePoints;
+    uint64_t nodeCount;
+    uint64_t pointCount;
+    uint64_t nodeTableOffset;
+    uint64_t pointDataOffset;
+    float    spacing;
+    uint32_t padding;
+    double   origin[3]; // center of the root node.
+};
+
+constexpr char         OctreeMagic[8] = "RTACOCT";
+constexpr unsigned int MaxDepth       = 20;
+constexpr unsigned int ParallelLevels = 2;
+
+inline uint64_t align16(uint64_t offset)
+{
+    return (offset + 15) & ~uint64_t(15);
+}
+
+template <class F>
+void parallel_for(size_t count, F f)
+{
+    std::atomic<size_t> next(0);
+    auto process = [&]() {
+        for(size_t i = next++; i < count; i = next++) f(i);
+    };
+    unsigned int threadCount = std::min<size_t>(count,
+        std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(process);
+    }
+    process();
+    for(auto& w : workers) w.join();
+}
+
+struct BuildNode {
+    double       center[3];
+    double       halfSize;
+    unsigned int depth;
+    size_t       begin; // points of the subtree are in [begin, end) of the work array,
+    size_t       end;   // the points kept in the node are in [begin, begin + count).
+    size_t       count;
+    std::unique_ptr<BuildNode> children[8];
+};
+
+/**
+ * In-core octree construction. The points are reordered in place : after a
+ * node is split, the points it keeps are at the start of its range,
+ * followed by the points of each child in octant order.
+ */
+class OctreeBuilder
+{
+    protected:
+
+    std::vector<Position>& points_;
+    uint32_t               maxNodePoints_;
+    unsigned int           grid_;
+
+    public:
+
+    std::atomic<size_t> discarded_;
+
+    OctreeBuilder(std::vector<Position>& points, uint32_t maxNodePoints,
+                  unsigned int gridResolution) :
+        points_(points),
+        maxNodePoints_(maxNodePoints),
+        grid_(gridResolution),
+        discarded_(0)
+    {}
+
+    void split(BuildNode& node);
+    void build_subtree(BuildNode& node);
+    void build(BuildNode& root);
+};
+
+/**
+ * Selects the points kept in node (grid sampling, closest point to the
+ * center of each cell, at most maxNodePoints_) and distributes the others
+ * to the children octants (in-place bucket sort).
+ */
+void OctreeBuilder::split(BuildNode& node)
+{
+    size_t count = node.end - node.begin;
+    if(count <= maxNodePoints_) {
+        node.count = count;
+        return;
+    }
+    if(node.depth >= MaxDepth) {
+        // Only (quasi) duplicate points left at this depth.
+        node.count = maxNodePoints_;
+        discarded_ += count - maxNodePoints_;
+        return;
+    }
+
+    Position* points = points_.data() + node.begin;
+    double cellSize = 2.0*node.halfSize / grid_;
+    double origin[3] = {node.center[0] - node.halfSize,
+                        node.center[1] - node.halfSize,
+                        node.center[2] - node.halfSize};
+    auto cell = [&](double v, unsigned int dim) {
+        int i = (int)((v - origin[dim]) / cellSize);
+        return (unsigned int)std::max(0, std::min((int)grid_ - 1, i));
+    };
+
+    std::unordered_map<uint64_t, std::pair<size_t,double>> cells;
+    cells.reserve(std::min<size_t>(count, 4*(size_t)maxNodePoints_));
+    for(size_t i = 0; i < count; i++) {
+        const Position& p = points[i];
+        unsigned int ix = cell(p.x, 0), iy = cell(p.y, 1), iz = cell(p.z, 2);
+        double dx = origin[0] + (ix + 0.5)*cellSize - p.x;
+        double dy = origin[1] + (iy + 0.5)*cellSize - p.y;
+        double dz = origin[2] + (iz + 0.5)*cellSize - p.z;
+        double d  = dx*dx + dy*dy + dz*dz;
+        uint64_t key = ((uint64_t)ix*grid_ + iy)*grid_ + iz;
+        auto res = cells.emplace(key, std::make_pair(i, d));
+        if(!res.second && d < res.first->second.second) {
+            res.first->second = std::make_pair(i, d);
+        }
+    }
+    std::vector<size_t> kept;
+    kept.reserve(cells.size());
+    for(const auto& c : cells) {
+        kept.push_back(c.second.first);
+    }
+    std::sort(kept.begin(), kept.end());
+    if(kept.size() > maxNodePoints_) {
+        // Evenly subsampling the selected cells.
+        size_t n = 0;
+        for(size_t j = 0; j < kept.size(); j++) {
+            if(((j + 1)*maxNodePoints_) / kept.size() != (j*maxNodePoints_) / kept.size()) {
+                kept[n++] = kept[j];
+            }
+        }
+        kept.resize(n);
+    }
+
+    // bucket 0 : kept in node, bucket 1 + o : child of octant o.
+    std::vector<uint8_t> buckets(count);
+    for(size_t i = 0; i < count; i++) {
+        buckets[i] = 1 + (points[i].x >= node.center[0] ? 1 : 0)
+                       + (points[i].y >= node.center[1] ? 2 : 0)
+                       + (points[i].z >= node.center[2] ? 4 : 0);
+    }
+    for(auto i : kept) {
+        buckets[i] = 0;
+    }
+
+    size_t counts[9] = {0};
+    for(auto b : buckets) counts[b]++;
+    size_t next[9], ends[9];
+    next[0] = 0;
+    for(unsigned int b = 0; b < 9; b++) {
+        if(b > 0) next[b] = ends[b - 1];
+        ends[b] = next[b] + counts[b];
+    }
+    for(unsigned int b = 0; b < 9; b++) {
+        while(next[b] < ends[b]) {
+            uint8_t target = buckets[next[b]];
+            if(target == b) {
+                next[b]++;
+                continue;
+            }
+            std::swap(points[next[b]],  points[next[target]]);
+            std::swap(buckets[next[b]], buckets[next[target]]);
+            next[target]++;
+        }
+    }
+
+    node.count = counts[0];
+    size_t offset = node.begin + counts[0];
+    double h = 0.5*node.halfSize;
+    for(unsigned int o = 0; o < 8; o++) {
+        if(counts[o + 1] == 0) continue;
+        auto child = std::make_unique<BuildNode>();
+        child->center[0] = node.center[0] + ((o & 1) ? h : -h);
+        child->center[1] = node.center[1] + ((o & 2) ? h : -h);
+        child->center[2] = node.center[2] + ((o & 4) ? h : -h);
+        child->halfSize  = h;
+        child->depth     = node.depth + 1;
+        child->begin     = offset;
+        child->end       = offset + counts[o + 1];
+        child->count     = 0;
+        offset = child->end;
+        node.children[o] = std::move(child);
+    }
+}
+
+void OctreeBuilder::build_subtree(BuildNode& node)
+{
+    this->split(node);
+    for(auto& child : node.children) {
+        if(child) this->build_subtree(*child);
+    }
+}
+
+/**
+ * The first levels are split one after the other (each split being done in
+ * parallel over the nodes of the level), the remaining subtrees are then
+ * built in parallel.
+ */
+void OctreeBuilder::build(BuildNode& root)
+{
+    std::vector<BuildNode*> level({&root});
+    for(unsigned int l = 0; l < ParallelLevels; l++) {
+        parallel_for(level.size(), [&](size_t i) { this->split(*level[i]); });
+        std::vector<BuildNode*> nextLevel;
+        for(auto node : level) {
+            for(auto& child : node->children) {
+                if(child) nextLevel.push_back(child.get());
+            }
+        }
+        level = nextLevel;
+    }
+    parallel_for(level.size(), [&](size_t i) { this->build_subtree(*level[i]); });
+}
+
+}; //namespace
+
+PointOctree::PointOctree(const std::string& path) :
+    file_(MappedFile::Open(path)),
+    points_(nullptr),
+    origin_({0.0, 0.0, 0.0}),
+    pointCount_(0),
+    maxNodePoints_(0),
+    spacing_(0.0f)
+{
+    OctreeHeader header;
+    if(file_->size() < sizeof(header)) {
+        throw std::runtime_error("PointOctree : invalid octree file " + path);
+    }
+    std::memcpy(&header, file_->data(), sizeof(header));
+    if(std::memcmp(header.magic, OctreeMagic, sizeof(OctreeMagic)) != 0) {
+        throw std::runtime_error("PointOctree : invalid octree file " + path);
+    }
+    if(header.version != FileVersion) {
+        std::ostringstream oss;
+        oss << "PointOctree : unsupported octree file version (" << header.version
+            << ", expected " << FileVersion << ") " << path;
+        throw std::runtime_error(oss.str());
+    }
+    if(header.nodeCount == 0
+       || header.nodeTableOffset + sizeof(Node)*header.nodeCount > file_->size()
+       || header.pointDataOffset + sizeof(Point)*header.pointCount > file_->size())
+    {
+        throw std::runtime_error("PointOctree : truncated octree file " + path);
+    }
+
+    nodes_.resize(header.nodeCount);
+    std::memcpy(nodes_.data(), file_->data() + header.nodeTableOffset,
+                sizeof(Node)*nodes_.size());
+    points_        = (const Point*)(file_->data() + header.pointDataOffset);
+    origin_        = Position({header.origin[0], header.origin[1], header.origin[2]});
+    pointCount_    = header.pointCount;
+    maxNodePoints_ = header.maxNodePoints;
+    spacing_       = header.spacing;
+}
+
+/**
+ * Builds the octree of a point set and writes it to a file.
+ *
+ * The construction is done in memory (the points are reordered in place in
+ * the points vector, which can be moved in to avoid a copy) and uses about
+ * 32 bytes per point (a 1e9 points survey needs ~32GB of RAM). At most
+ * MaxBuildPoints points are accepted. Nodes are split until they hold at
+ * most maxNodePoints points. Nodes at the maximum depth (20 levels) keep at
+ * most maxNodePoints points, the remaining ones (duplicates) are discarded.
+ *
+ * The origin of the octree frame is the center of the bounding box of the
+ * points, the points are written as float offsets from their node center.
+ *
+ * @param path           output octree file.
+ * @param points         input points (absolute positions).
+ * @param maxNodePoints  maximum number of points in a node (size of the node
+ *                       slots of PointOctreeRenderer).
+ * @param gridResolution resolution of the sampling grid of a node. The
+ *                       sampling spacing of a node is its size divided by
+ *                       gridResolution.
+ */
+void PointOctree::build(const std::string& path, std::vector<Position> points,
+                        uint32_t maxNodePoints, unsigned int gridResolution)
+{
+    if(points.size() == 0) {
+        throw std::runtime_error("PointOctree::build : empty point set.");
+    }
+    if(points.size() > MaxBuildPoints) {
+        std::ostringstream oss;
+        oss << "PointOctree::build : too many points (" << points.size()
+            << ", in-core build is limited to " << MaxBuildPoints
+            << "). Split the point cloud in tiles.";
+        throw std::runtime_error(oss.str());
+    }
+    if(maxNodePoints == 0 || gridResolution == 0) {
+        throw std::runtime_error("PointOctree::build : invalid parameters.");
+    }
+
+    Position pmin = points[0], pmax = points[0];
+    for(const auto& p : points) {
+        pmin.x = std::min(pmin.x, p.x); pmax.x = std::max(pmax.x, p.x);
+        pmin.y = std::min(pmin.y, p.y); pmax.y = std::max(pmax.y, p.y);
+        pmin.z = std::min(pmin.z, p.z); pmax.z = std::max(pmax.z, p.z);
+    }
+
+    BuildNode root;
+    root.center[0] = 0.5*(pmin.x + pmax.x);
+    root.center[1] = 0.5*(pmin.y + pmax.y);
+    root.center[2] = 0.5*(pmin.z + pmax.z);
+    root.halfSize  = 0.5*std::max(pmax.x - pmin.x,
+                         std::max(pmax.y - pmin.y, pmax.z - pmin.z));
+    root.halfSize  = std::max(1.0e-6, 1.0001*root.halfSize);
+    root.depth     = 0;
+    root.begin     = 0;
+    root.end       = points.size();
+    root.count     = 0;
+
+    OctreeBuilder builder(points, maxNodePoints, gridResolution);
+    builder.build(root);
+
+    // Flattening the tree in breadth-first order.
+    std::vector<const BuildNode*> order({&root});
+    std::vector<Node> nodes;
+    uint64_t pointOffset = 0;
+    for(size_t i = 0; i < order.size(); i++) {
+        const BuildNode* b = order[i];
+        Node node;
+        std::memset(&node, 0, sizeof(node));
+        for(unsigned int k = 0; k < 3; k++) {
+            node.center[k] = b->center[k] - root.center[k];
+        }
+        node.halfSize    = b->halfSize;
+        node.pointOffset = pointOffset;
+        node.pointCount  = b->count;
+        node.firstChild  = NoChild;
+        node.depth       = b->depth;
+        for(unsigned int o = 0; o < 8; o++) {
+            if(!b->children[o]) continue;
+            if(node.childCount == 0) node.firstChild = order.size();
+            node.childMask |= 1 << o;
+            node.childCount++;
+            order.push_back(b->children[o].get());
+        }
+        pointOffset += node.pointCount;
+        nodes.push_back(node);
+    }
+
+    OctreeHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, OctreeMagic, sizeof(OctreeMagic));
+    header.version         = FileVersion;
+    header.maxNodePoints   = maxNodePoints;
+    header.nodeCount       = nodes.size();
+    header.pointCount      = pointOffset;
+    header.nodeTableOffset = align16(sizeof(header));
+    header.pointDataOffset = align16(header.nodeTableOffset + sizeof(Node)*nodes.size());
+    header.spacing         = 2.0*root.halfSize / gridResolution;
+    std::memcpy(header.origin, root.center, sizeof(header.origin));
+
+    std::ofstream f(path, std::ios::binary);
+    if(!f.is_open()) {
+        throw std::runtime_error("PointOctree::build : could not open file for writing "
+                                 + path);
+    }
+    static const char zeros[16] = {0};
+    f.write((const char*)&header, sizeof(header));
+    f.write(zeros, header.nodeTableOffset - sizeof(header));
+    f.write((const char*)nodes.data(), sizeof(Node)*nodes.size());
+    f.write(zeros, header.pointDataOffset - header.nodeTableOffset - sizeof(Node)*nodes.size());
+    // Offsets from the stored (float) node centers, so that origin + center
+    // + offset gives back the input position up to the offset precision.
+    std::vector<Point> offsets;
+    for(size_t i = 0; i < order.size(); i++) {
+        const Node& node = nodes[i];
+        const Position* src = points.data() + order[i]->begin;
+        offsets.resize(node.pointCount);
+        for(size_t j = 0; j < offsets.size(); j++) {
+            offsets[j].x = (src[j].x - root.center[0]) - node.center[0];
+            offsets[j].y = (src[j].y - root.center[1]) - node.center[1];
+            offsets[j].z = (src[j].z - root.center[2]) - node.center[2];
+        }
+        f.write((const char*)offsets.data(), sizeof(Point)*offsets.size());
+    }
+    if(!f) {
+        throw std::runtime_error("PointOctree::build : error while writing " + path);
+    }
+    if(builder.discarded_ > 0) {
+        std::cerr << "PointOctree::build : " << builder.discarded_
+                  << " duplicate points discarded." << std::endl;
+    }
+}
+
+/**
+ * Builds the octree of the vertices of a .ply file (see PointOctree::build).
+ * The positions are read in double precision. Files with more than
+ * MaxBuildPoints vertices are rejected before anything is allocated.
+ */
+void PointOctree::build_from_ply(const std::string& path, const std::string& plyPath,
+                                 uint32_t maxNodePoints, unsigned int gridResolution)
+{
+    std::vector<Position> points;
+    {
+        auto ply = PlyFile::Open(plyPath);
+        auto vertices = ply->element("vertex");
+        if(!vertices || !ply->has_properties("vertex", {"x","y","z"})) {
+            throw std::runtime_error("PointOctree::build_from_ply : no vertex positions in "
+                                     + plyPath);
+        }
+        if(vertices->count > MaxBuildPoints) {
+            std::ostringstream oss;
+            oss << "PointOctree::build_from_ply : too many vertices in " << plyPath
+                << " (" << vertices->count << ", in-core build is limited to "
+                << MaxBuildPoints << "). Split the point cloud in tiles.";
+            throw std::runtime_error(oss.str());
+        }
+        points.resize(vertices->count);
+        ply->read_doubles("vertex", {"x","y","z"}, &points.data()->x, 3);
+    }
+    PointOctree::build(path, std::move(points), maxNodePoints, gridResolution);
+}
+
+unsigned int PointOctree::depth() const
+{
+    unsigned int res = 0;
+    for(const auto& node : nodes_) {
+        res = std::max<unsigned int>(res, node.depth);
+    }
+    return res + 1;
+}
+
+/**
+ * Absolute position of a point of a node (origin + node center + offset).
+ */
+PointOctree::Position PointOctree::position(size_t node, size_t index) const
+{
+    const Node&  n = nodes_[node];
+    const Point& p = this->points(node)[index];
+    return Position({origin_.x + n.center[0] + p.x,
+                     origin_.y + n.center[1] + p.y,
+                     origin_.z + n.center[2] + p.z});
+}
+
+/**
+ * Bounding sphere of a node, in the octree frame (relative to origin()).
+ */
+BoundingSphere PointOctree::node_bounds(size_t node) const
+{
+    const Node& n = nodes_[node];
+    return BoundingSphere(BoundingSphere::Vector3(n.center[0], n.center[1], n.center[2]),
+                          std::sqrt(3.0f)*n.halfSize);
+}
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::display::PointOctree& octree)
+{
+    os << "PointOctree " << octree.path()
+       << "\n- points          : " << octree.point_count()
+       << "\n- nodes           : " << octree.node_count()
+       << "\n- depth           : " << octree.depth()
+       << "\n- max node points : " << octree.max_node_points()
+       << "\n- root spacing    : " << octree.spacing()
+       << "\n- origin          : " << octree.origin().x << " " << octree.origin().y
+       << " " << octree.origin().z
+       << "\n- bounds          : " << octree.bounds();
+    return os;
+}
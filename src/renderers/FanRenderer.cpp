@@ -52,7 +52,7 @@ void main()
         outColor = texture(colormap, vec2(value, 0.0f));
     }
     else {
-        outColor = texture(colormap, vec2(0.0f,0.0f));
+        discard;
     }
 }
 )");
@@ -95,7 +95,90 @@ void main()
         outColor = texture(colormap, vec2(value, 0.0f));
     }
     else {
-        outColor = texture(colormap, vec2(0.0f,0.0f));
+        discard;
+    }
+}
+)");
+
+/**
+ * Lookup table mode : the normalized (bearing, range) coordinates of the
+ * fragment are read from a precomputed texture. Negative values flag
+ * fragments outside of the fan.
+ */
+const std::string& FanRenderer::fragmentShaderLookupTable = std::string(R"(
+#version 430 core
+
+in      vec2 xyPos;
+uniform sampler2D fanData;
+uniform sampler2D colormap;
+uniform sampler2D lookupTable;
+
+uniform vec2 valueScaling;
+uniform vec4 lookupBounds;
+
+out vec4 outColor;
+
+void main()
+{
+    vec2 normalized = texture(lookupTable, (xyPos - lookupBounds.xy)
+                                         / (lookupBounds.zw - lookupBounds.xy)).xy;
+    if(normalized.x >= 0.0f) {
+        float value = valueScaling.x*texture(fanData,normalized).x + valueScaling.y;
+        outColor = texture(colormap, vec2(value, 0.0f));
+    }
+    else {
+        discard;
+    }
+}
+)");
+
+/**
+ * Fills the lookup table with the normalized (bearing, range) coordinates of
+ * each texel center (same computation as the fragment shaders).
+ */
+const std::string& FanRenderer::lookupTableShader = std::string(R"(
+#version 430 core
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(rg32f, binding = 0) writeonly uniform image2D lookupTable;
+uniform sampler2D bearingMap;
+
+uniform vec4 lookupBounds;
+uniform vec2 angleBounds;
+uniform vec2 rangeBounds;
+uniform bool useBearingMap;
+
+#define M_2PI 6.283185307179586
+
+void main()
+{
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size  = imageSize(lookupTable);
+    if(texel.x >= size.x || texel.y >= size.y) {
+        return;
+    }
+    vec2 xyPos = mix(lookupBounds.xy, lookupBounds.zw,
+                     (vec2(texel) + 0.5f) / vec2(size));
+
+    vec2 normalized;
+    normalized.x = atan(xyPos.y, xyPos.x);
+    if(normalized.x < angleBounds.x)
+        normalized.x += M_2PI;
+    normalized.x = (normalized.x  - angleBounds.x)
+                 / (angleBounds.y - angleBounds.x);
+    normalized.y = (length(xyPos) - rangeBounds.x)
+                 / (rangeBounds.y - rangeBounds.x);
+
+    if(normalized.x >= 0.0f && normalized.x <= 1.0f &&
+       normalized.y >= 0.0f && normalized.y <= 1.0f) {
+        if(useBearingMap) {
+            normalized.x = 1.0f - texture(bearingMap, vec2(normalized.x,0.0)).x;
+        }
+        imageStore(lookupTable, texel, vec4(normalized, 0.0f, 0.0f));
+    }
+    else {
+        imageStore(lookupTable, texel, vec4(-1.0f, -1.0f, 0.0f, 0.0f));
     }
 }
 )");
@@ -105,12 +188,18 @@ FanRenderer::FanRenderer(const GLContext::Ptr& context) :
     data_(GLTexture::New()),
     colormap_(colormap::Viridis()),
     valueRange_({0.0f,1.0f}),
+    dataScale_(1.0f),
     angle_({-M_PI, M_PI}),
     range_({0.0f,1.0f}),
-    corners_(6),
+    sectorSubdivisions_(DefaultSectorSubdivisions),
     direction_(Direction::Up),
     linearBearingsProgram_(renderProgram_),
-    nonlinearBearingsProgram_(create_render_program(vertexShader, fragmentShaderNonLinear))
+    nonlinearBearingsProgram_(create_render_program(vertexShader, fragmentShaderNonLinear)),
+    lookupTableEnabled_(false),
+    lookupTableResolution_(0),
+    lookupTableDirty_(true),
+    lookupTableProgram_(create_render_program(vertexShader, fragmentShaderLookupTable)),
+    lookupTableBuildProgram_(create_compute_program(lookupTableShader))
 {
     this->set_geometry(angle_, range_);
     data_->set_wrap_mode(GLTexture::WrapMode::Clamp);
@@ -136,12 +225,12 @@ void FanRenderer::set_geometry_degrees(const Interval& angle, const Interval& ra
                        range);
 }
 
-void FanRenderer::set_geometry(Interval angle, const Interval& range)
+/**
+ * Normalizes aperture bounds the way the shaders expect them (angle.min in
+ * [-pi,pi] and angle.max in ]angle.min, angle.min + 2pi]).
+ */
+FanRenderer::Interval FanRenderer::normalized_aperture(Interval angle)
 {
-    using Point2 = rtac::types::Point2<float>;
-
-    // Normalizing angle bounds
-    // (angle.min in [-pi,pi] and angle.max in ]angle.min, angle.min + 2pi])
     while(angle.max > angle.min + 2*M_PI) angle.max -= 2*M_PI;
     while(angle.max <= angle.min + 0.01f) angle.max += 2*M_PI;
     while(angle.min >  M_PI) {
@@ -152,6 +241,49 @@ void FanRenderer::set_geometry(Interval angle, const Interval& range)
         angle.min += 2*M_PI;
         angle.max += 2*M_PI;
     }
+    return angle;
+}
+
+/**
+ * Triangle list covering an annular sector.
+ *
+ * The arcs are approximated by subdivisions chords. The outer radius is
+ * increased to range.max / cos(dtheta/2) so the mesh contains the whole
+ * sector (the inner chords are inside the inner arc). Fragments outside the
+ * exact sector are still rejected by the fragment shaders.
+ */
+std::vector<FanRenderer::Point4> FanRenderer::sector_mesh(const Interval& angle,
+                                                          const Interval& range,
+                                                          unsigned int subdivisions)
+{
+    // At least one subdivision per quarter turn to keep the outer radius
+    // correction bounded.
+    subdivisions = std::max(subdivisions,
+        (unsigned int)std::ceil((angle.max - angle.min) / (0.5f*M_PI)));
+    subdivisions = std::max(1u, subdivisions);
+    float step   = (angle.max - angle.min) / subdivisions;
+    float rOuter = range.max / std::cos(0.5f*step);
+
+    std::vector<Point4> mesh;
+    mesh.reserve(6*subdivisions);
+    for(unsigned int i = 0; i < subdivisions; i++) {
+        float c0 = std::cos(angle.min + i*step),     s0 = std::sin(angle.min + i*step);
+        float c1 = std::cos(angle.min + (i+1)*step), s1 = std::sin(angle.min + (i+1)*step);
+        Point4 in0({range.min*c0, range.min*s0, 0.0f, 1.0f});
+        Point4 in1({range.min*c1, range.min*s1, 0.0f, 1.0f});
+        Point4 out0({rOuter*c0, rOuter*s0, 0.0f, 1.0f});
+        Point4 out1({rOuter*c1, rOuter*s1, 0.0f, 1.0f});
+        mesh.push_back(in0); mesh.push_back(out0); mesh.push_back(out1);
+        mesh.push_back(in0); mesh.push_back(out1); mesh.push_back(in1);
+    }
+    return mesh;
+}
+
+void FanRenderer::set_geometry(Interval angle, const Interval& range)
+{
+    using Point2 = rtac::types::Point2<float>;
+
+    angle = normalized_aperture(angle);
 
     // finding extermas of the fan display area.
     std::vector<Point2> poi;
@@ -194,7 +326,15 @@ void FanRenderer::set_geometry(Interval angle, const Interval& range)
 
     angle_ = angle;
     range_ = range;
+    lookupTableDirty_ = true;
 
+    if(sectorSubdivisions_ > 0) {
+        auto mesh = sector_mesh(angle_, range_, sectorSubdivisions_);
+        corners_.set_data(mesh.size(), mesh.data());
+        return;
+    }
+
+    corners_.resize(6);
     auto p = corners_.map();
     p[0] = Point4({bounds_.left,  bounds_.bottom, 0.0f, 1.0f});
     p[1] = Point4({bounds_.right, bounds_.bottom, 0.0f, 1.0f});
@@ -204,6 +344,19 @@ void FanRenderer::set_geometry(Interval angle, const Interval& range)
     p[5] = Point4({bounds_.left,  bounds_.top,    0.0f, 1.0f});
 }
 
+/**
+ * Sets the number of angular subdivisions of the fan mesh.
+ *
+ * Only the fragments covered by the mesh are shaded, so a tight mesh avoids
+ * shading the whole bounding rectangle of narrow fans. If 0, the bounding
+ * rectangle is drawn instead.
+ */
+void FanRenderer::set_sector_subdivisions(unsigned int subdivisions)
+{
+    sectorSubdivisions_ = subdivisions;
+    this->set_geometry(angle_, range_);
+}
+
 void FanRenderer::set_aperture(Interval angle)
 {
     this->set_geometry(angle, range_);
@@ -217,19 +370,7 @@ void FanRenderer::set_range(Interval range)
 void FanRenderer::set_data(const GLTexture::Ptr& tex)
 {
     data_ = tex;
-}
-
-void FanRenderer::set_data(const Shape& shape, const float* data)
-{
-    data_->set_image(shape, data);
-}
-
-void FanRenderer::set_data(const Shape& shape, const GLVector<float>& data,
-                           bool computeScale)
-{
-    data_->set_image(shape, data);
-    if(computeScale)
-        this->compute_scale(data);
+    dataScale_ = normalization_factor(tex->scalar_type());
 }
 
 void FanRenderer::set_bearings(unsigned int nBeams, const float* bearings,
@@ -268,45 +409,167 @@ void FanRenderer::enable_bearing_map()
 {
     if(bearingMap_)
         renderProgram_ = nonlinearBearingsProgram_;
+    lookupTableDirty_ = true;
 }
 
 void FanRenderer::disable_bearing_map()
 {
     renderProgram_ = linearBearingsProgram_;
+    lookupTableDirty_ = true;
+}
+
+/**
+ * Enables the polar coordinates lookup table mode.
+ *
+ * @param resolution size in texels of the largest side of the lookup table.
+ *                   If 0 (default), the lookup table matches the on-screen
+ *                   size of the fan (one texel per pixel) and is rebuilt when
+ *                   the screen size changes.
+ */
+void FanRenderer::enable_lookup_table(unsigned int resolution)
+{
+    lookupTableEnabled_    = true;
+    lookupTableResolution_ = resolution;
+    lookupTableDirty_      = true;
+}
+
+void FanRenderer::disable_lookup_table()
+{
+    lookupTableEnabled_ = false;
+    lookupTable_        = nullptr;
+}
+
+/**
+ * Size of the lookup table covering the fan bounds.
+ */
+FanRenderer::Shape FanRenderer::lookup_table_shape(const Shape& screen) const
+{
+    static constexpr unsigned int MaxSize = 8192;
+
+    float width  = bounds_.width();
+    float height = bounds_.height();
+    float texelsPerUnit;
+    if(lookupTableResolution_ > 0) {
+        texelsPerUnit = lookupTableResolution_ / std::max(width, height);
+    }
+    else {
+        // Same fit as in compute_view (the fan is rotated by 90 degrees in
+        // the Up and Down directions).
+        float screenWidth = width, screenHeight = height;
+        if(direction_ == Direction::Up || direction_ == Direction::Down) {
+            std::swap(screenWidth, screenHeight);
+        }
+        texelsPerUnit = std::min(screen.width  / screenWidth,
+                                 screen.height / screenHeight);
+    }
+    return Shape({std::max(1u, std::min(MaxSize, (unsigned int)std::ceil(texelsPerUnit*width))),
+                  std::max(1u, std::min(MaxSize, (unsigned int)std::ceil(texelsPerUnit*height)))});
+}
+
+/**
+ * Rebuilds the lookup table if the geometry, the bearings or the required
+ * size changed since the last build.
+ */
+void FanRenderer::update_lookup_table(const Shape& screen) const
+{
+    Shape shape = this->lookup_table_shape(screen);
+    bool resize = !lookupTable_
+               || lookupTable_->width()  != shape.width
+               || lookupTable_->height() != shape.height;
+    if(!resize && !lookupTableDirty_) {
+        return;
+    }
+
+    if(resize) {
+        if(!lookupTable_) {
+            lookupTable_ = GLTexture::New();
+        }
+        lookupTable_->set_image(shape, GL_RG32F, GL_RG, GL_FLOAT,
+                                (const float*)nullptr);
+        // Nearest filtering : interpolating between inside and outside
+        // texels (or across the angle discontinuity) would be meaningless.
+        lookupTable_->set_filter_mode(GLTexture::FilterMode::Nearest);
+        // The fan mesh slightly overshoots the lookup table bounds. Outside
+        // texels read as "outside of the fan".
+        lookupTable_->set_wrap_mode(GLTexture::WrapMode::ClampToBorder);
+        static const float border[] = {-1.0f, -1.0f, 0.0f, 0.0f};
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+    }
+
+    bool useBearingMap = renderProgram_ == nonlinearBearingsProgram_ && bearingMap_;
+
+    glUseProgram(lookupTableBuildProgram_);
+    glBindImageTexture(0, lookupTable_->gl_id(), 0, GL_FALSE, 0,
+                       GL_WRITE_ONLY, GL_RG32F);
+    glUniform4f(glGetUniformLocation(lookupTableBuildProgram_, "lookupBounds"),
+                bounds_.left, bounds_.bottom, bounds_.right, bounds_.top);
+    glUniform2f(glGetUniformLocation(lookupTableBuildProgram_, "angleBounds"),
+                angle_.min, angle_.max);
+    glUniform2f(glGetUniformLocation(lookupTableBuildProgram_, "rangeBounds"),
+                range_.min, range_.max);
+    glUniform1i(glGetUniformLocation(lookupTableBuildProgram_, "useBearingMap"),
+                useBearingMap);
+    if(useBearingMap) {
+        glUniform1i(glGetUniformLocation(lookupTableBuildProgram_, "bearingMap"), 0);
+        glActiveTexture(GL_TEXTURE0);
+        bearingMap_->bind(GL_TEXTURE_2D);
+    }
+
+    glDispatchCompute((shape.width + 15) / 16, (shape.height + 15) / 16, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    GL_CHECK_LAST();
+
+    lookupTableDirty_ = false;
 }
 
 FanRenderer::Mat4 FanRenderer::compute_view(const Shape& screen) const
+{
+    return fit_view(bounds_, direction_, screen);
+}
+
+/**
+ * View matrix fitting a 2D area on the screen, the fan axis (x axis) pointing
+ * towards direction.
+ */
+FanRenderer::Mat4 FanRenderer::fit_view(const Rectangle& area, Direction direction,
+                                        const Shape& screen)
 {
     Mat4 rotation = Mat4::Identity();
-    auto bounds = bounds_;
-    switch(direction_) {
+    auto bounds = area;
+    switch(direction) {
         case Direction::Left:
             rotation(0,0) = -1;
             rotation(1,1) = -1;
-            bounds.left   = -bounds_.right;
-            bounds.bottom = -bounds_.top;
-            bounds.right  = -bounds_.left;
-            bounds.top    = -bounds_.bottom;
+            bounds.left   = -area.right;
+            bounds.bottom = -area.top;
+            bounds.right  = -area.left;
+            bounds.top    = -area.bottom;
             break;
         case Direction::Up:
             rotation(0,0) = 0;
             rotation(1,1) = 0;
             rotation(1,0) = 1;
             rotation(0,1) = -1;
-            bounds.left   = -bounds_.top;
-            bounds.bottom =  bounds_.left;
-            bounds.right  = -bounds_.bottom;
-            bounds.top    =  bounds_.right;
+            bounds.left   = -area.top;
+            bounds.bottom =  area.left;
+            bounds.right  = -area.bottom;
+            bounds.top    =  area.right;
             break;
         case Direction::Down:
             rotation(0,0) = 0;
             rotation(1,1) = 0;
             rotation(1,0) = -1;
             rotation(0,1) = 1;
-            bounds.left   =  bounds_.bottom;
-            bounds.bottom = -bounds_.right;
-            bounds.right  =  bounds_.top;
-            bounds.top    = -bounds_.left;
+            bounds.left   =  area.bottom;
+            bounds.bottom = -area.right;
+            bounds.right  =  area.top;
+            bounds.top    = -area.left;
+            break;
+        case Direction::Right: // fan axis already along the screen x axis.
             break;
     }
     Point2 screenLL, screenUR;
@@ -329,48 +592,57 @@ FanRenderer::Mat4 FanRenderer::compute_view(const Shape& screen) const
     return View::from_corners(screenLL,screenUR)*rotation;
 }
 
-void FanRenderer::compute_scale(const GLVector<float>& data)
-{
-    this->set_value_range({reductor_.min(data),
-                           reductor_.max(data)});
-}
-
 void FanRenderer::draw(const View::ConstPtr& view) const
 {
     Mat4 mat = this->compute_view(view->screen_size());
 
-    glUseProgram(renderProgram_);
+    GLuint program = renderProgram_;
+    if(lookupTableEnabled_) {
+        this->update_lookup_table(view->screen_size());
+        program = lookupTableProgram_;
+    }
+
+    glUseProgram(program);
 
     corners_.bind(GL_ARRAY_BUFFER);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(0);
 
-    glUniformMatrix4fv(glGetUniformLocation(renderProgram_, "view"),
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"),
         1, GL_FALSE, mat.data());
 
-    glUniform2f(glGetUniformLocation(renderProgram_, "valueScaling"),
-                1.0f / (valueRange_.max - valueRange_.min),
+    // Normalized integer data is brought back to sample units before being
+    // mapped from valueRange_ to [0,1].
+    glUniform2f(glGetUniformLocation(program, "valueScaling"),
+                dataScale_ / (valueRange_.max - valueRange_.min),
                -valueRange_.min / (valueRange_.max - valueRange_.min));
-    glUniform2f(glGetUniformLocation(renderProgram_, "angleBounds"),
+    glUniform2f(glGetUniformLocation(program, "angleBounds"),
                 angle_.min, angle_.max);
-    glUniform2f(glGetUniformLocation(renderProgram_, "rangeBounds"),
+    glUniform2f(glGetUniformLocation(program, "rangeBounds"),
                 range_.min, range_.max);
 
-    glUniform1i(glGetUniformLocation(renderProgram_, "fanData"), 0);
+    glUniform1i(glGetUniformLocation(program, "fanData"), 0);
     glActiveTexture(GL_TEXTURE0);
     data_->bind(GL_TEXTURE_2D);
 
-    glUniform1i(glGetUniformLocation(renderProgram_, "colormap"), 1);
+    glUniform1i(glGetUniformLocation(program, "colormap"), 1);
     glActiveTexture(GL_TEXTURE1);
     colormap_->texture().bind(GL_TEXTURE_2D);
 
-    if(renderProgram_ == nonlinearBearingsProgram_ && bearingMap_) {
-        glUniform1i(glGetUniformLocation(renderProgram_, "bearingMap"), 2);
+    if(program == lookupTableProgram_) {
+        glUniform4f(glGetUniformLocation(program, "lookupBounds"),
+                    bounds_.left, bounds_.bottom, bounds_.right, bounds_.top);
+        glUniform1i(glGetUniformLocation(program, "lookupTable"), 2);
+        glActiveTexture(GL_TEXTURE2);
+        lookupTable_->bind(GL_TEXTURE_2D);
+    }
+    else if(program == nonlinearBearingsProgram_ && bearingMap_) {
+        glUniform1i(glGetUniformLocation(program, "bearingMap"), 2);
         glActiveTexture(GL_TEXTURE2);
         bearingMap_->bind(GL_TEXTURE_2D);
     }
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_TRIANGLES, 0, corners_.size());
 
     glEnableVertexAttribArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -91,6 +91,15 @@ void Frame::draw(const View::ConstPtr& view) const
     glLineWidth(lineWidth);
 }
 
+/**
+ * Sphere containing the three unit axes.
+ */
+BoundingSphere Frame::world_bounds() const
+{
+    return BoundingSphere(BoundingSphere::Vector3::Zero(), 1.0f)
+        .transformed(pose_.homogeneous_matrix());
+}
+
 }; //namespace display
 }; //namespace rtac
 
@@ -1,5 +1,8 @@
 #include <rtac_display/renderers/FrameInstances.h>
 
+#include <sstream>
+#include <cstddef>
+
 namespace rtac { namespace display {
 
 const std::string FrameInstances::vertexShader = std::string( R"(
@@ -7,14 +10,20 @@ const std::string FrameInstances::vertexShader = std::string( R"(
 
 layout(location=0) in vec3 point;
 layout(location=1) in vec3 color;
-layout(location=2) in mat4 pose; // takes locations 2,3,4,5
+layout(location=2) in vec4 orientation; // unit quaternion (x,y,z,w)
+layout(location=3) in vec3 translation;
 
 uniform mat4 view;
 out vec3 c;
 
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0f*cross(q.xyz, cross(q.xyz, v) + q.w*v);
+}
+
 void main()
 {
-    gl_Position = view*pose*vec4(point, 1.0f);
+    gl_Position = view*vec4(rotate(orientation, point) + translation, 1.0f);
     c = color;
 }
 )");
@@ -31,6 +40,16 @@ void main()
 }
 )");
 
+static_assert(sizeof(FrameInstances::Instance) == 7*sizeof(float),
+              "FrameInstances::Instance must be tightly packed");
+
+FrameInstances::Instance FrameInstances::Instance::from_pose(const Pose& pose)
+{
+    auto q = pose.orientation().normalized();
+    const auto& t = pose.translation();
+    return Instance({{q.x(), q.y(), q.z(), q.w()}, {t(0), t(1), t(2)}});
+}
+
 FrameInstances::Ptr FrameInstances::Create(const GLContext::Ptr& context,
                                            const View3D::Pose& pose)
 {
@@ -40,15 +59,164 @@ FrameInstances::Ptr FrameInstances::Create(const GLContext::Ptr& context,
 FrameInstances::FrameInstances(const GLContext::Ptr& context,
                                const View3D::Pose& pose) :
     Renderer(context, vertexShader, fragmentShader),
-    globalPose_(pose)
+    globalPose_(pose),
+    dirty_(false),
+    boundsChanged_(true)
 {}
 
+/**
+ * Flags the blocks containing the instances [offset, offset + count) for
+ * upload at the next draw.
+ */
+void FrameInstances::mark_dirty(size_t offset, size_t count)
+{
+    if(count == 0) return;
+
+    size_t blockCount = (instances_.size() + DirtyBlockSize - 1) / DirtyBlockSize;
+    if(dirtyBlocks_.size() < blockCount) {
+        dirtyBlocks_.resize(blockCount, 0);
+    }
+    size_t lastBlock = (offset + count - 1) / DirtyBlockSize;
+    for(size_t b = offset / DirtyBlockSize; b <= lastBlock; b++) {
+        dirtyBlocks_[b] = 1;
+    }
+    dirty_ = true;
+}
+
+/**
+ * Grows the cached bounds to include the frames [offset, offset + count)
+ * (nothing to do if the bounds are to be recomputed anyway).
+ */
+void FrameInstances::grow_bounds(size_t offset, size_t count)
+{
+    if(boundsChanged_) return;
+    for(size_t i = offset; i < offset + count; i++) {
+        BoundingSphere frame(Eigen::Map<const BoundingSphere::Vector3>(
+            instances_[i].translation), 1.0f);
+        localBounds_ = localBounds_.merged(frame);
+    }
+}
+
+void FrameInstances::add_pose(const Pose& pose)
+{
+    instances_.push_back(Instance::from_pose(pose));
+    this->mark_dirty(instances_.size() - 1, 1);
+    this->grow_bounds(instances_.size() - 1, 1);
+}
+
+/**
+ * Replaces all the poses (every instance is uploaded at the next draw).
+ */
 void FrameInstances::set_poses(const std::vector<Pose>& poses)
 {
-    poses_.resize(poses.size());
-    for(int i = 0; i < poses_.size(); i++) {
-        poses_[i] = poses[i].homogeneous_matrix();
+    instances_.resize(poses.size());
+    for(size_t i = 0; i < instances_.size(); i++) {
+        instances_[i] = Instance::from_pose(poses[i]);
+    }
+    boundsChanged_ = true;
+    this->mark_dirty(0, instances_.size());
+}
+
+/**
+ * Modifies a single pose. Only the block containing it is uploaded at the
+ * next draw.
+ */
+void FrameInstances::update_pose(size_t index, const Pose& pose)
+{
+    if(index >= instances_.size()) {
+        std::ostringstream oss;
+        oss << "FrameInstances::update_pose : index out of range ("
+            << index << " >= " << instances_.size() << ")";
+        throw std::runtime_error(oss.str());
     }
+    instances_[index] = Instance::from_pose(pose);
+    this->mark_dirty(index, 1);
+    this->grow_bounds(index, 1);
+}
+
+/**
+ * Modifies the contiguous poses [offset, offset + poses.size()).
+ */
+void FrameInstances::update_poses(size_t offset, const std::vector<Pose>& poses)
+{
+    if(offset + poses.size() > instances_.size()) {
+        std::ostringstream oss;
+        oss << "FrameInstances::update_poses : range out of bounds (["
+            << offset << ", " << offset + poses.size() << ") with "
+            << instances_.size() << " instances)";
+        throw std::runtime_error(oss.str());
+    }
+    for(size_t i = 0; i < poses.size(); i++) {
+        instances_[offset + i] = Instance::from_pose(poses[i]);
+    }
+    this->mark_dirty(offset, poses.size());
+    this->grow_bounds(offset, poses.size());
+}
+
+/**
+ * Modifies the poses at arbitrary indices (poses[i] is the new pose of the
+ * instance indices[i]).
+ */
+void FrameInstances::update_poses(const std::vector<size_t>& indices,
+                                  const std::vector<Pose>& poses)
+{
+    if(indices.size() != poses.size()) {
+        std::ostringstream oss;
+        oss << "FrameInstances::update_poses : size mismatch between indices ("
+            << indices.size() << ") and poses (" << poses.size() << ")";
+        throw std::runtime_error(oss.str());
+    }
+    for(size_t i = 0; i < indices.size(); i++) {
+        this->update_pose(indices[i], poses[i]);
+    }
+}
+
+void FrameInstances::clear_poses()
+{
+    instances_.clear();
+    dirtyBlocks_.clear();
+    dirty_         = false;
+    boundsChanged_ = true;
+}
+
+/**
+ * Uploads the modified instances. Consecutive dirty blocks are uploaded with
+ * a single sub-range write. The device buffer grows geometrically, so
+ * instances added one at a time do not trigger a full upload at each draw
+ * (a full upload happens only on reallocation).
+ */
+void FrameInstances::upload_instances() const
+{
+    size_t count = instances_.size();
+    if(deviceData_.size() != count) {
+        if(deviceData_.capacity() < count) {
+            deviceData_.resize(std::max(count, 2*deviceData_.capacity()));
+            deviceData_.set_data(count, instances_.data());
+            std::fill(dirtyBlocks_.begin(), dirtyBlocks_.end(), 0);
+            dirty_ = false;
+            return;
+        }
+        deviceData_.resize(count);
+    }
+    if(!dirty_) return;
+
+    size_t blockCount = std::min(dirtyBlocks_.size(),
+                                 (count + DirtyBlockSize - 1) / DirtyBlockSize);
+    for(size_t b = 0; b < blockCount;) {
+        if(!dirtyBlocks_[b]) {
+            b++;
+            continue;
+        }
+        size_t first = b;
+        while(b < blockCount && dirtyBlocks_[b]) {
+            b++;
+        }
+        size_t offset = first*DirtyBlockSize;
+        deviceData_.set_sub_data(offset, std::min(count, b*DirtyBlockSize) - offset,
+                                 instances_.data() + offset);
+    }
+    std::fill(dirtyBlocks_.begin(), dirtyBlocks_.end(), 0);
+    dirty_ = false;
 }
 
 void FrameInstances::draw(const View::ConstPtr& view) const
@@ -66,9 +234,8 @@ void FrameInstances::draw(const View::ConstPtr& view) const
                       0,0,1,
                       0,0,1};
 
-    if(deviceData_.size() < poses_.size()) {
-        deviceData_ = poses_;
-    }
+    this->upload_instances();
+    if(instances_.size() == 0) return;
 
     GLfloat lineWidth;
     glGetFloatv(GL_LINE_WIDTH, &lineWidth);
@@ -82,23 +249,15 @@ void FrameInstances::draw(const View::ConstPtr& view) const
     glEnableVertexAttribArray(1);
 
     deviceData_.bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 16*sizeof(float),
-                          (const void*)0);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                          (const void*)offsetof(Instance, orientation));
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 16*sizeof(float),
-                          (const void*)(4*sizeof(float)));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                          (const void*)offsetof(Instance, translation));
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 16*sizeof(float),
-                          (const void*)(8*sizeof(float)));
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 16*sizeof(float),
-                          (const void*)(12*sizeof(float)));
-    glEnableVertexAttribArray(5);
 
     glVertexAttribDivisor(2, 1);
     glVertexAttribDivisor(3, 1);
-    glVertexAttribDivisor(4, 1);
-    glVertexAttribDivisor(5, 1);
 
     View3D::Mat4 viewMatrix = view->view_matrix()*globalPose_.homogeneous_matrix();
     glUniformMatrix4fv(glGetUniformLocation(renderProgram_, "view"),
@@ -109,9 +268,10 @@ void FrameInstances::draw(const View::ConstPtr& view) const
     
     deviceData_.unbind(GL_ARRAY_BUFFER);
 
-    glDisableVertexAttribArray(5);
-    glDisableVertexAttribArray(4);
+    glVertexAttribDivisor(2, 0);
+    glVertexAttribDivisor(3, 0);
     glDisableVertexAttribArray(3);
+    glDisableVertexAttribArray(2);
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(0);
 
@@ -119,6 +279,35 @@ void FrameInstances::draw(const View::ConstPtr& view) const
     glLineWidth(lineWidth);
 }
 
+/**
+ * Sphere containing all the frames (unit axes).
+ */
+BoundingSphere FrameInstances::world_bounds() const
+{
+    if(instances_.size() == 0) {
+        return BoundingSphere::Infinite();
+    }
+    if(boundsChanged_) {
+        using Vector3 = BoundingSphere::Vector3;
+        Vector3 pmin = Eigen::Map<const Vector3>(instances_[0].translation);
+        Vector3 pmax = pmin;
+        for(const auto& instance : instances_) {
+            Eigen::Map<const Vector3> t(instance.translation);
+            pmin = pmin.cwiseMin(t);
+            pmax = pmax.cwiseMax(t);
+        }
+        Vector3 center = 0.5f*(pmin + pmax);
+        float radius = 0.0f;
+        for(const auto& instance : instances_) {
+            Eigen::Map<const Vector3> t(instance.translation);
+            radius = std::max(radius, (t - center).norm());
+        }
+        localBounds_   = BoundingSphere(center, radius + 1.0f);
+        boundsChanged_ = false;
+    }
+    return localBounds_.transformed(globalPose_.homogeneous_matrix());
+}
+
 }; //namespace display
 }; //namespace rtac
 
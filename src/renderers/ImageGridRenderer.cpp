@@ -0,0 +1,495 @@
+#include <rtac_display/renderers/ImageGridRenderer.h>
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#include <rtac_display/Color.h>
+
+namespace rtac { namespace display {
+
+/**
+ * One instance per tile, 4 vertices per tile (GL_TRIANGLE_STRIP). No vertex
+ * attributes : tile corners are generated from gl_VertexID.
+ */
+const std::string ImageGridRenderer::vertexShader = std::string(R"(
+#version 430 core
+
+struct TileParameters {
+    vec2  uvOrigin;
+    vec2  uvSize;
+    vec2  imageSize;
+    vec2  valueScaling;
+    int   layer;
+    int   colormap;
+    uint  hasData;
+    float padding;
+};
+
+layout(std430, binding = 0) readonly buffer tileBuffer
+{
+    TileParameters tiles[];
+};
+
+uniform vec2  screenSize;
+uniform ivec2 grid; // columns, rows
+uniform float spacing;
+uniform bool  verticalFlip;
+
+out vec2 uv;
+flat out int tile;
+
+void main()
+{
+    TileParameters t = tiles[gl_InstanceID];
+    if(t.hasData == 0u) {
+        // nothing to display, clipped.
+        gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+        uv   = vec2(0.0f);
+        tile = gl_InstanceID;
+        return;
+    }
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    ivec2 cell  = ivec2(gl_InstanceID % grid.x, grid.y - 1 - gl_InstanceID / grid.x);
+
+    vec2 cellSize   = (screenSize - spacing*vec2(grid + 1)) / vec2(grid);
+    vec2 cellOrigin = spacing + vec2(cell)*(cellSize + spacing);
+    vec2 size = min(cellSize.x / t.imageSize.x, cellSize.y / t.imageSize.y)
+              * t.imageSize;
+    vec2 p = cellOrigin + 0.5f*(cellSize - size) + corner*size;
+
+    gl_Position = vec4(2.0f*p / screenSize - 1.0f, 0.0f, 1.0f);
+    uv   = vec2(corner.x, verticalFlip ? 1.0f - corner.y : corner.y);
+    tile = gl_InstanceID;
+}
+)");
+
+/**
+ * Texture coordinates are clamped to the tile area so linear filtering does
+ * not bleed on the neighbor tiles of the atlas.
+ */
+const std::string ImageGridRenderer::fragmentShader = std::string(R"(
+#version 430 core
+
+struct TileParameters {
+    vec2  uvOrigin;
+    vec2  uvSize;
+    vec2  imageSize;
+    vec2  valueScaling;
+    int   layer;
+    int   colormap;
+    uint  hasData;
+    float padding;
+};
+
+layout(std430, binding = 0) readonly buffer tileBuffer
+{
+    TileParameters tiles[];
+};
+
+in vec2 uv;
+flat in int tile;
+
+uniform sampler2DArray images;
+uniform sampler2D      colormaps;
+uniform bool           grayscale;
+
+out vec4 outColor;
+
+void main()
+{
+    TileParameters t = tiles[tile];
+
+    vec2 halfTexel = 0.5f / vec2(textureSize(images, 0).xy);
+    vec2 p = clamp(t.uvOrigin + uv*t.uvSize,
+                   t.uvOrigin + halfTexel, t.uvOrigin + t.uvSize - halfTexel);
+    vec4 c = texture(images, vec3(p, t.layer));
+    if(grayscale) {
+        c = vec4(c.rrr, 1.0f);
+    }
+
+    if(t.colormap < 0) {
+        outColor = vec4(clamp(t.valueScaling.x*c.rgb + t.valueScaling.y, 0.0f, 1.0f),
+                        c.a);
+    }
+    else {
+        float v = clamp(t.valueScaling.x*c.r + t.valueScaling.y, 0.0f, 1.0f);
+        outColor = texture(colormaps,
+            vec2(v, (t.colormap + 0.5f) / textureSize(colormaps, 0).y));
+    }
+}
+)");
+
+ImageGridRenderer::ImageGridRenderer(const GLContext::Ptr& context) :
+    Renderer(context, vertexShader, fragmentShader),
+    layout_(Layout::Array),
+    images_(GLTextureArray::New()),
+    scalarType_(GL_FLOAT),
+    dataScale_(1.0f),
+    staging_(StagingBufferCount),
+    nextStaging_(0),
+    columns_(0),
+    spacing_(2.0f),
+    verticalFlip_(true), // More natural for CPU images
+    parametersChanged_(true)
+{}
+
+ImageGridRenderer::Ptr ImageGridRenderer::Create(const GLContext::Ptr& context)
+{
+    return Ptr(new ImageGridRenderer(context));
+}
+
+ImageGridRenderer::Feed& ImageGridRenderer::feed(unsigned int index)
+{
+    this->check_index(index);
+    return feeds_[index];
+}
+
+void ImageGridRenderer::check_index(unsigned int index) const
+{
+    if(index >= feeds_.size()) {
+        std::ostringstream oss;
+        oss << "ImageGridRenderer : invalid feed index " << index
+            << " (feed count is " << feeds_.size() << ").";
+        throw std::out_of_range(oss.str());
+    }
+}
+
+/**
+ * Allocates the texture array and computes the location of each feed in it.
+ */
+void ImageGridRenderer::allocate(const std::vector<Shape>& shapes,
+                                 GLint internalFormat, GLenum pixelFormat,
+                                 GLenum scalarType)
+{
+    if(shapes.size() == 0) {
+        throw std::runtime_error("ImageGridRenderer : feed count must be > 0.");
+    }
+    for(const auto& shape : shapes) {
+        if(shape.width == 0 || shape.height == 0) {
+            throw std::runtime_error("ImageGridRenderer : empty feed shape.");
+        }
+    }
+
+    Feed defaultFeed;
+    defaultFeed.colormap = -1;
+    defaultFeed.range    = Interval({0.0f, normalization_factor(scalarType)});
+    if(scalarType != scalarType_) {
+        // value ranges are in sample units, they are not valid anymore.
+        for(auto& f : feeds_) {
+            f.range = defaultFeed.range;
+        }
+    }
+    feeds_.resize(shapes.size(), defaultFeed);
+    for(unsigned int i = 0; i < shapes.size(); i++) {
+        feeds_[i].shape   = shapes[i];
+        feeds_[i].hasData = false;
+    }
+
+    bool sameShapes = std::all_of(shapes.begin(), shapes.end(),
+        [&](const Shape& s) {
+            return s.width == shapes[0].width && s.height == shapes[0].height;
+        });
+
+    Shape textureShape;
+    unsigned int depth;
+    if(sameShapes) {
+        GLint maxLayers;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        if(shapes.size() > (size_t)maxLayers) {
+            std::ostringstream oss;
+            oss << "ImageGridRenderer : too many feeds (" << shapes.size()
+                << ", max is " << maxLayers << ").";
+            throw std::runtime_error(oss.str());
+        }
+        layout_      = Layout::Array;
+        textureShape = shapes[0];
+        depth        = shapes.size();
+        for(unsigned int i = 0; i < feeds_.size(); i++) {
+            feeds_[i].area  = Rect({0, shapes[0].width, 0, shapes[0].height});
+            feeds_[i].layer = i;
+        }
+    }
+    else {
+        // Shelf packing : feeds sorted by decreasing height are placed left
+        // to right on rows (shelves) as high as their first feed.
+        std::vector<unsigned int> order(feeds_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+            return shapes[a].height > shapes[b].height;
+        });
+
+        size_t width = 0, area = 0;
+        for(const auto& shape : shapes) {
+            width = std::max(width, (size_t)shape.width);
+            area += shape.area();
+        }
+        width = std::max(width, (size_t)std::ceil(std::sqrt((double)area)));
+
+        size_t x = 0, y = 0, shelfHeight = 0;
+        for(auto i : order) {
+            const Shape& shape = shapes[i];
+            if(x + shape.width > width) {
+                y += shelfHeight;
+                x  = 0;
+                shelfHeight = 0;
+            }
+            feeds_[i].area  = Rect({x, x + shape.width, y, y + shape.height});
+            feeds_[i].layer = 0;
+            x += shape.width;
+            shelfHeight = std::max(shelfHeight, (size_t)shape.height);
+        }
+
+        GLint maxSize;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        if(width > (size_t)maxSize || y + shelfHeight > (size_t)maxSize) {
+            std::ostringstream oss;
+            oss << "ImageGridRenderer : feed atlas too large (" << width
+                << "x" << y + shelfHeight << ", max is " << maxSize << ").";
+            throw std::runtime_error(oss.str());
+        }
+        layout_      = Layout::Atlas;
+        textureShape = Shape({width, y + shelfHeight});
+        depth        = 1;
+    }
+
+    images_->resize(textureShape, depth, internalFormat, pixelFormat, scalarType);
+    images_->set_filter_mode(GLTextureArray::FilterMode::Linear);
+    images_->set_wrap_mode(GLTextureArray::WrapMode::Clamp);
+    scalarType_ = scalarType;
+    dataScale_  = normalization_factor(scalarType);
+
+    parametersChanged_ = true;
+}
+
+void ImageGridRenderer::check_type(GLenum pixelFormat, GLenum scalarType) const
+{
+    if(feeds_.size() == 0) {
+        throw std::runtime_error(
+            "ImageGridRenderer : feeds not allocated (call reset first).");
+    }
+    if(pixelFormat != (GLenum)images_->format() || scalarType != scalarType_) {
+        throw std::runtime_error(
+            "ImageGridRenderer : feed data type does not match the allocated type.");
+    }
+}
+
+/**
+ * Copies a feed from a pixel buffer object to its location in the texture
+ * array (asynchronous transfer).
+ */
+void ImageGridRenderer::upload(Feed& feed, GLuint buffer, GLint alignment)
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    images_->bind(GL_TEXTURE_2D_ARRAY);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+                    feed.area.left, feed.area.bottom, feed.layer,
+                    feed.shape.width, feed.shape.height, 1,
+                    images_->format(), scalarType_, 0);
+    GL_CHECK_LAST();
+    images_->unbind(GL_TEXTURE_2D_ARRAY);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if(!feed.hasData) {
+        feed.hasData = true;
+        parametersChanged_ = true;
+    }
+}
+
+/**
+ * Registers a colormap in the colormap table. The colormap is resampled to
+ * ColormapSize entries.
+ *
+ * @return the colormap index to be used with set_colormap.
+ */
+unsigned int ImageGridRenderer::add_colormap(const Colormap::Ptr& colormap)
+{
+    const GLTexture& texture = colormap->texture();
+    size_t width = texture.width();
+    std::vector<float> source(4*width*texture.height());
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, texture.gl_id());
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, source.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GL_CHECK_LAST();
+
+    // Same sampling as texture() with linear filtering on the first row.
+    for(unsigned int i = 0; i < ColormapSize; i++) {
+        float x  = std::min(std::max((i + 0.5f)*width / ColormapSize - 0.5f, 0.0f),
+                            (float)(width - 1));
+        size_t x0 = (size_t)x;
+        size_t x1 = std::min(x0 + 1, width - 1);
+        float  a  = x - x0;
+        for(unsigned int c = 0; c < 4; c++) {
+            colormapData_.push_back((1.0f - a)*source[4*x0 + c] + a*source[4*x1 + c]);
+        }
+    }
+
+    unsigned int count = this->colormap_count();
+    colormaps_.set_image({ColormapSize, count},
+                         (const Color::RGBAf*)colormapData_.data());
+    colormaps_.set_filter_mode(GLTexture::FilterMode::Linear);
+    colormaps_.set_wrap_mode(GLTexture::WrapMode::Clamp);
+
+    return count - 1;
+}
+
+/**
+ * Sets the colormap of a feed.
+ *
+ * @param colormap index returned by add_colormap, or -1 to display the feed
+ *                 as is.
+ */
+void ImageGridRenderer::set_colormap(unsigned int feed, int colormap)
+{
+    if(colormap >= (int)this->colormap_count()) {
+        std::ostringstream oss;
+        oss << "ImageGridRenderer : invalid colormap index " << colormap
+            << " (colormap count is " << this->colormap_count() << ").";
+        throw std::out_of_range(oss.str());
+    }
+    this->feed(feed).colormap = colormap < 0 ? -1 : colormap;
+    parametersChanged_ = true;
+}
+
+/**
+ * Sets the value range of a feed (in sample units).
+ */
+void ImageGridRenderer::set_value_range(unsigned int feed, const Interval& range)
+{
+    this->feed(feed).range = range;
+    parametersChanged_ = true;
+}
+
+/**
+ * Resets the value range of a feed to the full range of the data type.
+ */
+void ImageGridRenderer::reset_value_range(unsigned int feed)
+{
+    this->set_value_range(feed, Interval({0.0f, normalization_factor(scalarType_)}));
+}
+
+/**
+ * Sets the number of columns of the grid (0 for an automatic square-ish grid).
+ */
+void ImageGridRenderer::set_columns(unsigned int columns)
+{
+    columns_ = columns;
+}
+
+/**
+ * Sets the space between tiles in pixels.
+ */
+void ImageGridRenderer::set_spacing(float pixels)
+{
+    spacing_ = pixels;
+}
+
+void ImageGridRenderer::set_vertical_flip(bool doFlip)
+{
+    verticalFlip_ = doFlip;
+}
+
+ImageGridRenderer::Shape ImageGridRenderer::feed_shape(unsigned int index) const
+{
+    this->check_index(index);
+    return feeds_[index].shape;
+}
+
+ImageGridRenderer::Interval ImageGridRenderer::value_range(unsigned int index) const
+{
+    this->check_index(index);
+    return feeds_[index].range;
+}
+
+/**
+ * @return the grid dimensions {columns, rows}.
+ */
+ImageGridRenderer::Shape ImageGridRenderer::grid_shape() const
+{
+    size_t columns = columns_;
+    if(columns == 0) {
+        columns = (size_t)std::ceil(std::sqrt((double)feeds_.size()));
+    }
+    columns = std::max(std::min(columns, feeds_.size()), (size_t)1);
+    return Shape({columns, (feeds_.size() + columns - 1) / columns});
+}
+
+void ImageGridRenderer::update_parameters() const
+{
+    if(!parametersChanged_) {
+        return;
+    }
+
+    Shape textureShape = images_->shape();
+    std::vector<TileParameters> parameters(feeds_.size());
+    for(unsigned int i = 0; i < feeds_.size(); i++) {
+        const auto& f = feeds_[i];
+        auto& p = parameters[i];
+        p.uvOrigin[0]     = ((float)f.area.left)   / textureShape.width;
+        p.uvOrigin[1]     = ((float)f.area.bottom) / textureShape.height;
+        p.uvSize[0]       = ((float)f.shape.width)  / textureShape.width;
+        p.uvSize[1]       = ((float)f.shape.height) / textureShape.height;
+        p.imageSize[0]    = f.shape.width;
+        p.imageSize[1]    = f.shape.height;
+        p.valueScaling[0] =  dataScale_   / (f.range.max - f.range.min);
+        p.valueScaling[1] = -f.range.min / (f.range.max - f.range.min);
+        p.layer           = f.layer;
+        p.colormap        = f.colormap;
+        p.hasData         = f.hasData ? 1 : 0;
+        p.padding         = 0.0f;
+    }
+    parameters_.set_data(parameters.size(), parameters.data());
+    parametersChanged_ = false;
+}
+
+void ImageGridRenderer::draw(const View::ConstPtr& view) const
+{
+    if(feeds_.size() == 0) {
+        return;
+    }
+    this->update_parameters();
+
+    Shape screen = view->screen_size();
+    Shape grid   = this->grid_shape();
+
+    glUseProgram(renderProgram_);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, parameters_.gl_id());
+
+    glUniform2f(glGetUniformLocation(renderProgram_, "screenSize"),
+                screen.width, screen.height);
+    glUniform2i(glGetUniformLocation(renderProgram_, "grid"),
+                grid.width, grid.height);
+    glUniform1f(glGetUniformLocation(renderProgram_, "spacing"), spacing_);
+    glUniform1i(glGetUniformLocation(renderProgram_, "verticalFlip"), verticalFlip_);
+    glUniform1i(glGetUniformLocation(renderProgram_, "grayscale"),
+                images_->format() == GL_RED);
+
+    glUniform1i(glGetUniformLocation(renderProgram_, "images"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    images_->bind(GL_TEXTURE_2D_ARRAY);
+
+    glUniform1i(glGetUniformLocation(renderProgram_, "colormaps"), 1);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, colormaps_.gl_id());
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, feeds_.size());
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glUseProgram(0);
+
+    GL_CHECK_LAST();
+}
+
+}; //namespace display
+}; //namespace rtac
@@ -1,5 +1,9 @@
 #include <rtac_display/renderers/ImageRenderer.h>
 
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
 namespace rtac { namespace display {
 
 /**
@@ -43,7 +47,10 @@ void main()
 )");
 
 /**
- * Simply outputs the texture value at given texture coordinates.
+ * Maps the first channel of the texture from the value range to the colormap.
+ * dataScale undoes the normalization of integer textures. valueRange is
+ * expressed after scaling (log10 or dB). If gpuRange is set the range is read
+ * from the output of rangeComputeShader instead.
  */
 const std::string ImageRenderer::colormapFragmentShader = std::string(R"(
 #version 430 core
@@ -51,12 +58,298 @@ const std::string ImageRenderer::colormapFragmentShader = std::string(R"(
 in vec2 uv;
 uniform sampler2D tex;
 uniform sampler2D colormap;
+uniform float dataScale;
+uniform vec2  valueRange;
+uniform int   scaling; // 0 : linear, 1 : log10, 2 : decibels
+uniform float decibelFactor;
+uniform float gamma;
+uniform vec4  nanColor;
+uniform bool  gpuRange;
+
+layout(std430, binding = 0) readonly buffer rangeBuffer
+{
+    int  minKey;
+    int  maxKey;
+    uint count;
+    uint padding;
+    vec2 range;
+};
+
+out vec4 outColor;
+
+#define INV_LN10 0.4342944819032518
+
+void main()
+{
+    float value = texture(tex, uv).x;
+    if(isnan(value)) {
+        outColor = nanColor;
+        return;
+    }
+    value *= dataScale;
+    if(scaling == 1) {
+        value = INV_LN10*log(max(value, 1.0e-30f));
+    }
+    else if(scaling == 2) {
+        value = decibelFactor*INV_LN10*log(max(value, 1.0e-30f));
+    }
+
+    vec2 r = gpuRange ? range : valueRange;
+    value = clamp((value - r.x) / max(r.y - r.x, 1.0e-30f), 0.0f, 1.0f);
+    outColor = texture(colormap, vec2(pow(value, gamma), 0.0));
+}
+)");
+
+/**
+ * Computes the value range of the texture in 3 passes (stage uniform) :
+ * - 0 : extrema and count of the finite (scaled) values.
+ * - 1 : histogram of the values between the extrema.
+ * - 2 : final range (extrema or percentiles), single invocation.
+ * Floats are compared as ordered integers to use integer atomics.
+ */
+const std::string ImageRenderer::rangeComputeShader = std::string(R"(
+#version 430 core
+
+#define HISTOGRAM_SIZE 256
+#define INV_LN10 0.4342944819032518
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(std430, binding = 0) buffer rangeBuffer
+{
+    int  minKey;
+    int  maxKey;
+    uint count;
+    uint padding;
+    vec2 range;
+    uint histogram[HISTOGRAM_SIZE];
+};
+
+uniform sampler2D tex;
+uniform int   stage;
+uniform float dataScale;
+uniform int   scaling;
+uniform float decibelFactor;
+uniform bool  usePercentiles;
+uniform vec2  percentiles;
+
+shared int  localMin;
+shared int  localMax;
+shared uint localCount;
+shared uint localHistogram[HISTOGRAM_SIZE];
+
+int to_key(float v)
+{
+    int k = floatBitsToInt(v);
+    return k >= 0 ? k : k ^ 0x7fffffff;
+}
+
+float from_key(int k)
+{
+    return intBitsToFloat(k >= 0 ? k : k ^ 0x7fffffff);
+}
+
+float scaled_value(ivec2 p)
+{
+    float value = dataScale*texelFetch(tex, p, 0).x;
+    if(scaling == 1) {
+        value = INV_LN10*log(value);
+    }
+    else if(scaling == 2) {
+        value = decibelFactor*INV_LN10*log(value);
+    }
+    return value;
+}
+
+void finalize()
+{
+    if(count == 0u) {
+        range = vec2(0.0f, 1.0f);
+        return;
+    }
+    float vmin = from_key(minKey);
+    float vmax = from_key(maxKey);
+    if(!usePercentiles || vmax <= vmin) {
+        range = vec2(vmin, vmax);
+        return;
+    }
+
+    float binSize = (vmax - vmin) / HISTOGRAM_SIZE;
+    float lowTarget  = percentiles.x*count;
+    float highTarget = percentiles.y*count;
+    uint  cumulated = 0u;
+    int   low = -1, high = HISTOGRAM_SIZE - 1;
+    for(int i = 0; i < HISTOGRAM_SIZE; i++) {
+        cumulated += histogram[i];
+        if(low < 0 && cumulated > lowTarget) {
+            low = i;
+        }
+        if(cumulated >= highTarget) {
+            high = i;
+            break;
+        }
+    }
+    range = vec2(vmin + binSize*max(low, 0), vmin + binSize*(high + 1));
+}
+
+void main()
+{
+    uint index = gl_LocalInvocationIndex;
+    if(stage == 2) {
+        if(index == 0u && gl_WorkGroupID.xy == uvec2(0)) {
+            finalize();
+        }
+        return;
+    }
+
+    if(index == 0u) {
+        localMin   = 0x7fffffff;
+        localMax   = int(0x80000000);
+        localCount = 0u;
+    }
+    localHistogram[index] = 0u;
+    barrier();
+
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    if(all(lessThan(p, textureSize(tex, 0)))) {
+        float value = scaled_value(p);
+        if(!isnan(value) && !isinf(value)) {
+            if(stage == 0) {
+                int k = to_key(value);
+                atomicMin(localMin, k);
+                atomicMax(localMax, k);
+                atomicAdd(localCount, 1u);
+            }
+            else {
+                float vmin = from_key(minKey);
+                float vmax = from_key(maxKey);
+                int bin = int(HISTOGRAM_SIZE*(value - vmin) / max(vmax - vmin, 1.0e-30f));
+                atomicAdd(localHistogram[clamp(bin, 0, HISTOGRAM_SIZE - 1)], 1u);
+            }
+        }
+    }
+    barrier();
+
+    if(stage == 0) {
+        if(index == 0u && localCount > 0u) {
+            atomicMin(minKey, localMin);
+            atomicMax(maxKey, localMax);
+            atomicAdd(count, localCount);
+        }
+    }
+    else if(localHistogram[index] > 0u) {
+        atomicAdd(histogram[index], localHistogram[index]);
+    }
+}
+)");
+
+/**
+ * Demosaics a raw Bayer image. The mosaic is read with texelFetch (no
+ * filtering) and bayerOffset is the location of the red pixel in the 2x2
+ * tile. Edge aware mode interpolates green along the direction with the
+ * smallest gradient (Hamilton-Adams) and uses the gradient corrected filters
+ * of Malvar, He and Cutler for red and blue.
+ */
+const std::string ImageRenderer::bayerFragmentShader = std::string(R"(
+#version 430 core
+
+in vec2 uv;
+uniform sampler2D tex;
+uniform ivec2 bayerOffset;
+uniform int   demosaic;
+uniform float rawScale;
+
+out vec4 outColor;
+
+ivec2 size;
+ivec2 p;
+
+float raw(int dx, int dy)
+{
+    return rawScale*texelFetch(tex, clamp(p + ivec2(dx,dy), ivec2(0), size - 1), 0).x;
+}
+
+void main()
+{
+    size = textureSize(tex, 0);
+    p    = clamp(ivec2(uv*vec2(size)), ivec2(0), size - 1);
+    ivec2 parity = (p - bayerOffset) & 1; // (0,0) red, (1,1) blue, else green.
+
+    float c     = raw( 0, 0);
+    float h     = 0.5f *(raw(-1, 0) + raw(1, 0));
+    float v     = 0.5f *(raw( 0,-1) + raw(0, 1));
+    float cross = 0.5f *(h + v);
+    float diag  = 0.25f*(raw(-1,-1) + raw(1,-1) + raw(-1,1) + raw(1,1));
+
+    vec3 rgb;
+    if(demosaic == 0) {
+        if(parity.x == parity.y) {
+            // red or blue site
+            rgb = parity.x == 0 ? vec3(c, cross, diag) : vec3(diag, cross, c);
+        }
+        else {
+            // green site, red neighbors on the row if parity.x == 1.
+            rgb = parity.x == 1 ? vec3(h, c, v) : vec3(v, c, h);
+        }
+    }
+    else {
+        float h2 = raw(-2, 0) + raw(2, 0);
+        float v2 = raw( 0,-2) + raw(0, 2);
+        if(parity.x == parity.y) {
+            float gradH = abs(raw(-1,0) - raw(1,0)) + abs(2.0f*c - h2);
+            float gradV = abs(raw(0,-1) - raw(0,1)) + abs(2.0f*c - v2);
+            float gH = h + 0.25f*(2.0f*c - h2);
+            float gV = v + 0.25f*(2.0f*c - v2);
+            float g  = gradH < gradV ? gH : (gradV < gradH ? gV : 0.5f*(gH + gV));
+            float other = (6.0f*c + 8.0f*diag - 1.5f*(h2 + v2)) / 8.0f;
+            rgb = parity.x == 0 ? vec3(c, g, other) : vec3(other, g, c);
+        }
+        else {
+            float correction = 5.0f*c - 4.0f*diag;
+            float rowColor = (correction + 8.0f*h - h2 + 0.5f*v2) / 8.0f;
+            float colColor = (correction + 8.0f*v - v2 + 0.5f*h2) / 8.0f;
+            rgb = parity.x == 1 ? vec3(rowColor, c, colColor)
+                                : vec3(colColor, c, rowColor);
+        }
+    }
+    outColor = vec4(clamp(rgb, 0.0f, 1.0f), 1.0f);
+}
+)");
+
+/**
+ * Converts YUV planes to RGB. tex holds the Y plane (NV12, I420) or the
+ * packed YUYV texels (one RGBA texel for two pixels).
+ */
+const std::string ImageRenderer::yuvFragmentShader = std::string(R"(
+#version 430 core
+
+in vec2 uv;
+uniform sampler2D tex;
+uniform sampler2D chroma0;
+uniform sampler2D chroma1;
+uniform int  yuvLayout; // 0 : NV12, 1 : I420, 2 : YUYV
+uniform mat3 yuvMatrix;
+uniform vec3 yuvOffset;
 
 out vec4 outColor;
 
 void main()
 {
-    outColor = texture(colormap, vec2(texture(tex, uv).x, 0.0));
+    vec3 yuv;
+    if(yuvLayout == 0) {
+        yuv = vec3(texture(tex, uv).x, texture(chroma0, uv).xy);
+    }
+    else if(yuvLayout == 1) {
+        yuv = vec3(texture(tex, uv).x, texture(chroma0, uv).x, texture(chroma1, uv).x);
+    }
+    else {
+        ivec2 size  = textureSize(tex, 0);
+        int   x     = int(uv.x*2*size.x);
+        vec4  texel = texelFetch(tex, clamp(ivec2(x / 2, int(uv.y*size.y)),
+                                            ivec2(0), size - 1), 0);
+        yuv = vec3((x & 1) == 0 ? texel.x : texel.z, texel.y, texel.w);
+    }
+    outColor = vec4(clamp(yuvMatrix*(yuv - yuvOffset), 0.0f, 1.0f), 1.0f);
 }
 )");
 
@@ -78,11 +371,61 @@ ImageRenderer::Ptr ImageRenderer::Create(const GLContext::Ptr& context)
 ImageRenderer::ImageRenderer(const GLContext::Ptr& context) :
     Renderer(context, vertexShader, fragmentShader),
     texture_(GLTexture::New()),
-    imageView_(ImageView::New()),
+    valueRange_({0.0f,1.0f}),
+    rangeMode_(RangeMode::TypeRange),
+    scaling_(Scaling::Linear),
+    decibelFactor_(20.0f),
+    gamma_(1.0f),
+    nanColor_({0.0f,0.0f,0.0f,0.0f}),
+    percentiles_{0.01f, 0.99f},
+    rangeChanged_(true),
+    rangeProgram_(0),
     passThroughProgram_(this->renderProgram_),
     colormapProgram_(create_render_program(vertexShader, colormapFragmentShader)),
-    verticalFlip_(true) // More natural for CPU texture
-{}
+    passThroughLocations_(Locations::query(passThroughProgram_)),
+    colormapLocations_(Locations::query(colormapProgram_)),
+    verticalFlip_(true), // More natural for CPU texture
+    inputMode_(InputMode::Texture),
+    imageShape_({0,0}),
+    bayerPattern_(BayerPattern::RGGB),
+    demosaic_(Demosaic::Bilinear),
+    rawScale_(1.0f),
+    bayerProgram_(0),
+    yuvProgram_(0),
+    quad_(16),
+    quadShape_({0,0}),
+    quadFlip_(false)
+{
+    this->set_yuv_standard(YUVStandard::BT601);
+
+    rangeReset_.resize(6 + HistogramSize, 0);
+    rangeReset_[0] = 0x7fffffff; // minKey
+    rangeReset_[1] = 0x80000000; // maxKey
+}
+
+ImageRenderer::Locations ImageRenderer::Locations::query(GLuint program)
+{
+    Locations res;
+    res.view          = glGetUniformLocation(program, "view");
+    res.tex           = glGetUniformLocation(program, "tex");
+    res.colormap      = glGetUniformLocation(program, "colormap");
+    res.dataScale     = glGetUniformLocation(program, "dataScale");
+    res.valueRange    = glGetUniformLocation(program, "valueRange");
+    res.scaling       = glGetUniformLocation(program, "scaling");
+    res.decibelFactor = glGetUniformLocation(program, "decibelFactor");
+    res.gamma         = glGetUniformLocation(program, "gamma");
+    res.nanColor      = glGetUniformLocation(program, "nanColor");
+    res.gpuRange      = glGetUniformLocation(program, "gpuRange");
+    res.chroma0       = glGetUniformLocation(program, "chroma0");
+    res.chroma1       = glGetUniformLocation(program, "chroma1");
+    res.bayerOffset   = glGetUniformLocation(program, "bayerOffset");
+    res.demosaic      = glGetUniformLocation(program, "demosaic");
+    res.rawScale      = glGetUniformLocation(program, "rawScale");
+    res.yuvLayout     = glGetUniformLocation(program, "yuvLayout");
+    res.yuvMatrix     = glGetUniformLocation(program, "yuvMatrix");
+    res.yuvOffset     = glGetUniformLocation(program, "yuvOffset");
+    return res;
+}
 
 GLTexture::Ptr& ImageRenderer::texture()
 {
@@ -124,6 +467,192 @@ void ImageRenderer::set_vertical_flip(bool doFlip)
     verticalFlip_ = doFlip;
 }
 
+/**
+ * Sets the value range mapped to the colormap, in sample units (e.g. [0,255]
+ * for the full range of a uint8_t image), or in dB with Scaling::Decibel.
+ */
+void ImageRenderer::set_value_range(const Interval& range)
+{
+    if(fabs(range.max - range.min) < 1.0e-6)
+        return;
+    valueRange_ = range;
+    rangeMode_  = RangeMode::Fixed;
+}
+
+/**
+ * Goes back to the full range of the texture type.
+ */
+void ImageRenderer::reset_value_range()
+{
+    rangeMode_ = RangeMode::TypeRange;
+}
+
+/**
+ * Current value range. For MinMax and Percentile modes the range is read back
+ * from the GPU, which waits for the last range computation to complete (this
+ * is not needed for display).
+ */
+ImageRenderer::Interval ImageRenderer::value_range() const
+{
+    Interval range;
+    if(this->uses_gpu_range()) {
+        this->update_gpu_range();
+        auto p = rangeBuffer_.map();
+        std::memcpy(&range.min, &p[4], sizeof(float));
+        std::memcpy(&range.max, &p[5], sizeof(float));
+    }
+    else {
+        range = this->shader_range();
+    }
+    if(scaling_ == Scaling::Log) {
+        range.min = std::pow(10.0f, range.min);
+        range.max = std::pow(10.0f, range.max);
+    }
+    return range;
+}
+
+/**
+ * Sets how the value range is chosen. MinMax and Percentile ranges are
+ * computed on the GPU each time the image is changed through the set_image
+ * methods.
+ */
+void ImageRenderer::set_range_mode(RangeMode mode)
+{
+    rangeMode_    = mode;
+    rangeChanged_ = true;
+}
+
+/**
+ * Sets the fractions of the (finite) pixels below the low and the high bound
+ * of the value range in RangeMode::Percentile (default is 1% and 99%). The
+ * resolution is (max - min) / HistogramSize.
+ */
+void ImageRenderer::set_percentiles(float low, float high)
+{
+    if(low < 0.0f || high > 1.0f || low >= high) {
+        std::ostringstream oss;
+        oss << "ImageRenderer : invalid percentiles (" << low << ", " << high
+            << "), must verify 0 <= low < high <= 1.";
+        throw std::runtime_error(oss.str());
+    }
+    percentiles_[0] = low;
+    percentiles_[1] = high;
+    rangeChanged_   = true;
+}
+
+/**
+ * Sets the transform applied to the values before the value range.
+ *
+ * @param decibelFactor 20 for amplitudes (default), 10 for powers.
+ */
+void ImageRenderer::set_scaling(Scaling scaling, float decibelFactor)
+{
+    scaling_       = scaling;
+    decibelFactor_ = decibelFactor;
+    rangeChanged_  = true;
+}
+
+/**
+ * The normalized value (in [0,1]) is raised to the power gamma before the
+ * colormap lookup. gamma < 1 expands the low values.
+ */
+void ImageRenderer::set_gamma(float gamma)
+{
+    if(gamma <= 0.0f) {
+        std::ostringstream oss;
+        oss << "ImageRenderer : gamma must be > 0 (got " << gamma << ").";
+        throw std::runtime_error(oss.str());
+    }
+    gamma_ = gamma;
+}
+
+/**
+ * Color displayed for NaN values (transparent by default).
+ */
+void ImageRenderer::set_nan_color(const Color::RGBAf& color)
+{
+    nanColor_ = color;
+}
+
+bool ImageRenderer::uses_gpu_range() const
+{
+    return rangeMode_ == RangeMode::MinMax || rangeMode_ == RangeMode::Percentile;
+}
+
+/**
+ * Value range used by the colormap shader (after scaling) for the TypeRange
+ * and Fixed modes.
+ */
+ImageRenderer::Interval ImageRenderer::shader_range() const
+{
+    auto to_log = [](float v) { return std::log10(std::max(v, 1.0e-30f)); };
+    if(rangeMode_ == RangeMode::Fixed) {
+        if(scaling_ == Scaling::Log)
+            return Interval({to_log(valueRange_.min), to_log(valueRange_.max)});
+        return valueRange_;
+    }
+
+    float maxValue = normalization_factor(texture_->scalar_type());
+    if(scaling_ == Scaling::Linear) {
+        return Interval({0.0f, maxValue});
+    }
+    // 0 has no logarithm, starting at the smallest non-zero integer value
+    // (or 6 decades below the maximum for float textures).
+    float minValue = maxValue > 1.0f ? 1.0f : 1.0e-6f*maxValue;
+    float factor   = scaling_ == Scaling::Decibel ? decibelFactor_ : 1.0f;
+    return Interval({factor*to_log(minValue), factor*to_log(maxValue)});
+}
+
+/**
+ * Computes the value range of the current texture on the GPU (result stays
+ * in rangeBuffer_). Only done if the image or the range parameters changed.
+ */
+void ImageRenderer::update_gpu_range() const
+{
+    if(!rangeChanged_ || !this->uses_gpu_range()) {
+        return;
+    }
+    if(!rangeProgram_) {
+        rangeProgram_ = create_compute_program(rangeComputeShader);
+    }
+    rangeBuffer_.set_data(rangeReset_.size(), rangeReset_.data());
+
+    Shape shape = texture_->shape();
+    glUseProgram(rangeProgram_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rangeBuffer_.gl_id());
+    glUniform1i(glGetUniformLocation(rangeProgram_, "tex"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture_->gl_id());
+
+    glUniform1f(glGetUniformLocation(rangeProgram_, "dataScale"),
+                normalization_factor(texture_->scalar_type()));
+    glUniform1i(glGetUniformLocation(rangeProgram_, "scaling"), (int)scaling_);
+    glUniform1f(glGetUniformLocation(rangeProgram_, "decibelFactor"), decibelFactor_);
+    glUniform1i(glGetUniformLocation(rangeProgram_, "usePercentiles"),
+                rangeMode_ == RangeMode::Percentile);
+    glUniform2f(glGetUniformLocation(rangeProgram_, "percentiles"),
+                percentiles_[0], percentiles_[1]);
+
+    GLint stage = glGetUniformLocation(rangeProgram_, "stage");
+    unsigned int stageCount = rangeMode_ == RangeMode::Percentile ? 2 : 1;
+    for(unsigned int i = 0; i < stageCount; i++) {
+        glUniform1i(stage, i);
+        glDispatchCompute((shape.width + 15) / 16, (shape.height + 15) / 16, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    glUniform1i(stage, 2);
+    glDispatchCompute(1, 1, 1);
+    // the result is read by the render shader and mapped by value_range.
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glUseProgram(0);
+    GL_CHECK_LAST();
+
+    rangeChanged_ = false;
+}
+
 void ImageRenderer::set_viridis_colormap()
 {
     this->set_colormap(colormap::Viridis());
@@ -137,60 +666,242 @@ void ImageRenderer::set_gray_colormap()
 
 
 /**
- * Generate screen coordinates of corner of image and displays the image.
+ * Size of the displayed image in pixels (differs from the texture size for
+ * packed raw formats).
+ */
+ImageRenderer::Shape ImageRenderer::image_shape() const
+{
+    if(inputMode_ == InputMode::Texture)
+        return texture_->shape();
+    return imageShape_;
+}
+
+void ImageRenderer::set_chroma(GLTexture::Ptr& chroma, const Shape& shape,
+                               GLint internalFormat, GLenum pixelFormat,
+                               const uint8_t* data)
+{
+    if(!chroma) {
+        chroma = GLTexture::New();
+        chroma->set_wrap_mode(GLTexture::WrapMode::Clamp);
+    }
+    chroma->set_image(shape, internalFormat, pixelFormat, GL_UNSIGNED_BYTE, data);
+}
+
+/**
+ * Sets a NV12 frame : full resolution Y plane followed by a half resolution
+ * interleaved UV plane.
+ */
+void ImageRenderer::set_nv12(const Shape& shape, const uint8_t* data)
+{
+    Shape chromaShape({(shape.width + 1) / 2, (shape.height + 1) / 2});
+    texture_->set_image(shape, GL_R8, GL_RED, GL_UNSIGNED_BYTE, data);
+    this->set_chroma(chroma0_, chromaShape, GL_RG8, GL_RG, data + shape.area());
+    inputMode_  = InputMode::NV12;
+    imageShape_ = shape;
+}
+
+/**
+ * Sets a I420 frame : full resolution Y plane followed by half resolution U
+ * and V planes.
+ */
+void ImageRenderer::set_i420(const Shape& shape, const uint8_t* data)
+{
+    Shape chromaShape({(shape.width + 1) / 2, (shape.height + 1) / 2});
+    texture_->set_image(shape, GL_R8, GL_RED, GL_UNSIGNED_BYTE, data);
+    this->set_chroma(chroma0_, chromaShape, GL_R8, GL_RED, data + shape.area());
+    this->set_chroma(chroma1_, chromaShape, GL_R8, GL_RED,
+                     data + shape.area() + chromaShape.area());
+    inputMode_  = InputMode::I420;
+    imageShape_ = shape;
+}
+
+/**
+ * Sets a packed YUYV (YUY2) frame. The width must be even.
+ */
+void ImageRenderer::set_yuyv(const Shape& shape, const uint8_t* data)
+{
+    if(shape.width % 2) {
+        std::ostringstream oss;
+        oss << "ImageRenderer : YUYV image width must be even (got "
+            << shape.width << ").";
+        throw std::runtime_error(oss.str());
+    }
+    texture_->set_image({shape.width / 2, shape.height},
+                        GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    inputMode_  = InputMode::YUYV;
+    imageShape_ = shape;
+}
+
+/**
+ * Sets the YUV to RGB conversion.
+ *
+ * @param fullRange if false (default), video range is assumed (Y in
+ *                  [16,235], U and V in [16,240]).
+ */
+void ImageRenderer::set_yuv_standard(YUVStandard standard, bool fullRange)
+{
+    float kr, kb; // R and B luma weights
+    if(standard == YUVStandard::BT709) {
+        kr = 0.2126f; kb = 0.0722f;
+    }
+    else {
+        kr = 0.299f;  kb = 0.114f;
+    }
+    float kg = 1.0f - kr - kb;
+
+    float yScale = fullRange ? 1.0f : 255.0f / 219.0f;
+    float cScale = fullRange ? 1.0f : 255.0f / 224.0f;
+
+    // column major : columns are the Y, U and V contributions to RGB.
+    float m[9] = {yScale, yScale, yScale,
+                  0.0f, -cScale*2.0f*(1.0f - kb)*kb / kg, cScale*2.0f*(1.0f - kb),
+                  cScale*2.0f*(1.0f - kr), -cScale*2.0f*(1.0f - kr)*kr / kg, 0.0f};
+    std::copy(m, m + 9, yuvMatrix_);
+
+    yuvOffset_[0] = fullRange ? 0.0f : 16.0f / 255.0f;
+    yuvOffset_[1] = 128.0f / 255.0f;
+    yuvOffset_[2] = 128.0f / 255.0f;
+}
+
+/**
+ * Returns the program for the current raw input mode (compiled on first use).
+ */
+GLuint ImageRenderer::raw_program(const Locations*& locations) const
+{
+    if(inputMode_ == InputMode::Bayer) {
+        if(!bayerProgram_) {
+            bayerProgram_   = create_render_program(vertexShader, bayerFragmentShader);
+            bayerLocations_ = Locations::query(bayerProgram_);
+        }
+        locations = &bayerLocations_;
+        return bayerProgram_;
+    }
+    if(!yuvProgram_) {
+        yuvProgram_   = create_render_program(vertexShader, yuvFragmentShader);
+        yuvLocations_ = Locations::query(yuvProgram_);
+    }
+    locations = &yuvLocations_;
+    return yuvProgram_;
+}
+
+/**
+ * Rebuilds the image quad if the image shape or the flip flag changed.
+ */
+void ImageRenderer::update_quad() const
+{
+    Shape shape = this->image_shape();
+    if(shape.width == quadShape_.width && shape.height == quadShape_.height
+       && verticalFlip_ == quadFlip_) {
+        return;
+    }
+
+    float w = shape.width, h = shape.height;
+    float v0 = verticalFlip_ ? 0.0f : 1.0f;
+    float v1 = 1.0f - v0;
+    const float vertices[] = {0.0f, 0.0f, 0.0f, v0,
+                              w,    0.0f, 1.0f, v0,
+                              0.0f, h,    0.0f, v1,
+                              w,    h,    1.0f, v1};
+    quad_.set_data(16, vertices);
+
+    quadShape_ = shape;
+    quadFlip_  = verticalFlip_;
+}
+
+/**
+ * Displays the image. The steady state path (unchanged texture shape) makes
+ * no allocation and no uniform location query.
  */
 void ImageRenderer::draw(const View::ConstPtr& view) const
 {
-    imageView_->set_screen_size(view->screen_size());
-    imageView_->set_image_shape(texture_->shape());
-
-    static const float uvNoFlip[] = {0.0, 0.0,
-                                     1.0, 0.0,
-                                     1.0, 1.0,
-                                     0.0, 1.0};
-    static const float uvFlip[] = {0.0, 1.0,
-                                   1.0, 1.0,
-                                   1.0, 0.0,
-                                   0.0, 0.0};
-    unsigned int indexes[] = {0, 1, 2,
-                              0, 2, 3};
-    std::vector<float> vertices(8);
-    vertices[0] = 0.0f;                    vertices[1] = 0.0f;
-    vertices[2] = texture_->shape().width; vertices[3] = 0.0f;
-    vertices[4] = texture_->shape().width; vertices[5] = texture_->shape().height;
-    vertices[6] = 0.0f;                    vertices[7] = texture_->shape().height;
-    
+    this->update_quad();
 
+    GLuint program = renderProgram_;
+    const Locations* locations = this->uses_colormap() ? &colormapLocations_
+                                                       : &passThroughLocations_;
+    if(inputMode_ != InputMode::Texture) {
+        program = this->raw_program(locations);
+    }
+    Mat4 projection = ImageView::compute_projection(view->screen_size(),
+                                                    this->image_shape());
+
+    if(inputMode_ == InputMode::Texture && this->uses_colormap()) {
+        this->update_gpu_range();
+    }
 
-    glUseProgram(renderProgram_);
+    glUseProgram(program);
 
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, vertices.data());
+    quad_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), 0);
     glEnableVertexAttribArray(0);
-    if(verticalFlip_)
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, uvNoFlip);
-    else
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, uvFlip);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float),
+                          (const void*)(2*sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glUniformMatrix4fv(glGetUniformLocation(renderProgram_, "view"),
-        1, GL_FALSE, imageView_->view_matrix().data());
+    glUniformMatrix4fv(locations->view, 1, GL_FALSE, projection.data());
 
-
-    glUniform1i(glGetUniformLocation(renderProgram_, "tex"), 0);
+    glUniform1i(locations->tex, 0);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture_->gl_id());
     
-    if(this->uses_colormap()) {
-        glUniform1i(glGetUniformLocation(renderProgram_, "colormap"), 1);
+    if(inputMode_ == InputMode::Bayer) {
+        static const int offsets[4][2] = {{0,0}, {1,0}, {0,1}, {1,1}};
+        glUniform2i(locations->bayerOffset, offsets[(int)bayerPattern_][0],
+                                            offsets[(int)bayerPattern_][1]);
+        glUniform1i(locations->demosaic, (int)demosaic_);
+        glUniform1f(locations->rawScale, rawScale_);
+    }
+    else if(inputMode_ != InputMode::Texture) {
+        int layout = inputMode_ == InputMode::NV12 ? 0 :
+                     inputMode_ == InputMode::I420 ? 1 : 2;
+        glUniform1i(locations->yuvLayout, layout);
+        glUniformMatrix3fv(locations->yuvMatrix, 1, GL_FALSE, yuvMatrix_);
+        glUniform3fv(locations->yuvOffset, 1, yuvOffset_);
+        if(inputMode_ != InputMode::YUYV) {
+            glUniform1i(locations->chroma0, 1);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, chroma0_->gl_id());
+        }
+        if(inputMode_ == InputMode::I420) {
+            glUniform1i(locations->chroma1, 2);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, chroma1_->gl_id());
+        }
+    }
+    else if(this->uses_colormap()) {
+        glUniform1f(locations->dataScale,
+                    normalization_factor(texture_->scalar_type()));
+        glUniform1i(locations->scaling, (int)scaling_);
+        glUniform1f(locations->decibelFactor, decibelFactor_);
+        glUniform1f(locations->gamma, gamma_);
+        glUniform4fv(locations->nanColor, 1, (const float*)&nanColor_);
+        glUniform1i(locations->gpuRange, this->uses_gpu_range());
+        if(this->uses_gpu_range()) {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, rangeBuffer_.gl_id());
+        }
+        else {
+            Interval range = this->shader_range();
+            glUniform2f(locations->valueRange, range.min, range.max);
+        }
+        glUniform1i(locations->colormap, 1);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, colormap_->texture().gl_id());
     }
      
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, indexes);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     
+    if(inputMode_ == InputMode::I420) {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     glUseProgram(0);
 
@@ -2,6 +2,35 @@
 
 namespace rtac { namespace display {
 
+/**
+ * Decoding of the compressed vertex formats of GLMesh (see GLMesh::pack).
+ * Quantized positions are read as normalized values in [0,1] and scaled to
+ * the mesh bounding box (positionOffset = 0 and positionScale = 1 for float
+ * positions). Octahedral normals are read as normalized values in [-1,1] in
+ * the xy components.
+ */
+const std::string MeshRenderer::vertexDecoding = std::string( R"(
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+uniform bool octahedralNormals;
+
+vec3 decode_position(vec3 p)
+{
+    return p*positionScale + positionOffset;
+}
+
+vec3 decode_normal(vec3 n)
+{
+    if(!octahedralNormals)
+        return n;
+    vec3 res = vec3(n.xy, 1.0f - abs(n.x) - abs(n.y));
+    float t = max(-res.z, 0.0f);
+    res.x += (res.x >= 0.0f) ? -t : t;
+    res.y += (res.y >= 0.0f) ? -t : t;
+    return normalize(res);
+}
+)");
+
 const std::string MeshRenderer::vertexShaderSolid = std::string( R"(
 #version 430 core
 
@@ -11,10 +40,10 @@ uniform mat4 view;
 uniform vec4 color;
 
 out vec4 c;
-
+)") + vertexDecoding + std::string(R"(
 void main()
 {
-    gl_Position = view*vec4(point, 1.0f);
+    gl_Position = view*vec4(decode_position(point), 1.0f);
     c = color;
 }
 )");
@@ -29,11 +58,11 @@ uniform mat4 view;
 uniform vec4 color;
 
 out vec4 c;
-
+)") + vertexDecoding + std::string(R"(
 void main()
 {
-    gl_Position = view*vec4(point, 1.0f);
-    vec3 tmp = normalize((view*vec4(n, 0.0f)).xyz);
+    gl_Position = view*vec4(decode_position(point), 1.0f);
+    vec3 tmp = normalize((view*vec4(decode_normal(n), 0.0f)).xyz);
     c = abs(tmp.z)*color;
     //c = 0.5f*(1.0f - tmp.z)*color;
 }
@@ -51,10 +80,10 @@ uniform mat4 view;
 uniform vec4 color;
 
 out vec4 c;
-
+)") + vertexDecoding + std::string(R"(
 void main()
 {
-    gl_Position = view*vec4(point + nLenght*n, 1.0f);
+    gl_Position = view*vec4(decode_position(point) + nLenght*decode_normal(n), 1.0f);
     c = color;
 }
 )");
@@ -80,10 +109,10 @@ in vec2 uvIn;
 uniform mat4 view;
 
 out vec2 uv;
-
+)") + vertexDecoding + std::string(R"(
 void main()
 {
-    gl_Position = view*vec4(point, 1.0f);
+    gl_Position = view*vec4(decode_position(point), 1.0f);
     uv = uvIn;
 }
 )");
@@ -115,11 +144,11 @@ uniform mat4 view;
 
 out float c;
 out vec2  uv;
-
+)") + vertexDecoding + std::string(R"(
 void main()
 {
-    gl_Position = view*vec4(point, 1.0f);
-    c = abs(normalize((view*vec4(n, 0.0f)).xyz).z);
+    gl_Position = view*vec4(decode_position(point), 1.0f);
+    c = abs(normalize((view*vec4(decode_normal(n), 0.0f)).xyz).z);
     uv = uvIn;
 }
 )");
@@ -159,7 +188,13 @@ MeshRenderer::MeshRenderer(const GLContext::Ptr& context,
                                                  fragmentShaderTexturedNormal)),
     displayNormals_(false),
     displayNormalsProgram_(create_render_program(vertexShaderDisplayNormals, fragmentShaderSolid)),
-    normalsColor_({0.0f,0.0f,1.0f,1.0f})
+    normalsColor_({0.0f,0.0f,1.0f,1.0f}),
+    chunkCulling_(true),
+    drawnChunks_(0),
+    culledChunks_(0),
+    lodThreshold_(1.0f),
+    lodHysteresis_(0.25f),
+    drawnTriangles_(0)
 {}
 
 void MeshRenderer::set_color(const Color::RGBAf& color)
@@ -170,6 +205,221 @@ void MeshRenderer::set_color(const Color::RGBAf& color)
     color_.a = std::max(0.0f, std::min(1.0f, color.a));
 }
 
+/**
+ * Sets the maximum screen space error of the levels of detail of the mesh
+ * (see GLMesh::generate_lods), in pixels. The coarsest level with a
+ * projected error below this threshold is drawn. A threshold of 0 disables
+ * the levels of detail.
+ */
+void MeshRenderer::set_lod_threshold(float pixels)
+{
+    lodThreshold_ = std::max(0.0f, pixels);
+}
+
+/**
+ * Hysteresis of the level of detail selection, relative to the threshold.
+ * A coarser level is selected only when its projected error is below
+ * threshold*(1 - ratio) to avoid popping back and forth between two levels
+ * when the camera moves around the switching distance.
+ */
+void MeshRenderer::set_lod_hysteresis(float ratio)
+{
+    lodHysteresis_ = std::max(0.0f, std::min(1.0f, ratio));
+}
+
+/**
+ * Level of detail used in the last draw for a chunk (or for the mesh if it
+ * is not split). 0 is the full resolution mesh.
+ */
+unsigned int MeshRenderer::lod_level(size_t chunk) const
+{
+    if(chunk >= lodLevels_.size()) return 0;
+    return lodLevels_[chunk];
+}
+
+/**
+ * Binds a vertex attribute described by GLMesh (separate float buffer or
+ * interleaved packed buffer).
+ */
+void MeshRenderer::bind_attribute(GLuint index, const GLMesh::VertexAttribute& attribute)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+    glVertexAttribPointer(index, attribute.size, attribute.type, attribute.normalized,
+                          attribute.stride, (const void*)attribute.offset);
+    glEnableVertexAttribArray(index);
+}
+
+void MeshRenderer::set_decoding_uniforms(GLuint program) const
+{
+    GLMesh::Point offset({0.0f,0.0f,0.0f}), scale({1.0f,1.0f,1.0f});
+    bool octahedral = false;
+    if(mesh_->is_packed()) {
+        if(mesh_->vertex_format().position == GLMesh::PositionFormat::Quantized16) {
+            offset = mesh_->position_offset();
+            scale  = mesh_->position_scale();
+        }
+        octahedral = mesh_->vertex_format().normal == GLMesh::NormalFormat::Octahedral16;
+    }
+    glUniform3f(glGetUniformLocation(program, "positionOffset"),
+                offset.x, offset.y, offset.z);
+    glUniform3f(glGetUniformLocation(program, "positionScale"),
+                scale.x, scale.y, scale.z);
+    glUniform1i(glGetUniformLocation(program, "octahedralNormals"), octahedral);
+}
+
+/**
+ * World space bounding sphere of the mesh (infinite if the mesh bounds are
+ * unknown, see GLMesh::bounds).
+ */
+BoundingSphere MeshRenderer::world_bounds() const
+{
+    if(!mesh_) {
+        return BoundingSphere::Infinite();
+    }
+    return mesh_->bounds().transformed(pose_.homogeneous_matrix());
+}
+
+/**
+ * Selects the level of detail of a chunk (or of the mesh) from the projected
+ * screen space error of the levels. The error of a level (in mesh units) is
+ * projected at the point of the bounding sphere closest to the camera
+ * (pixelScale converts a length in normalized device coordinates at w = 1 to
+ * pixels).
+ *
+ * The level is refined as soon as its error exceeds the threshold, and made
+ * coarser only when the error of the coarser level is below the threshold
+ * reduced by the hysteresis ratio.
+ */
+unsigned int MeshRenderer::select_lod(size_t index, const std::vector<GLMesh::Lod>& lods,
+                                      const BoundingSphere& bounds, const Mat4& viewMatrix,
+                                      float pixelScale, bool perspective) const
+{
+    unsigned int level = std::min<size_t>(lodLevels_[index], lods.size());
+    if(lodThreshold_ <= 0.0f || lods.size() == 0 || bounds.is_infinite()) {
+        lodLevels_[index] = 0;
+        return 0;
+    }
+
+    float w = viewMatrix.row(3).head<3>().dot(bounds.center) + viewMatrix(3,3);
+    if(perspective) {
+        w -= bounds.radius;
+    }
+    if(w <= 1.0e-6f) {
+        // camera inside the bounding sphere : full resolution.
+        lodLevels_[index] = 0;
+        return 0;
+    }
+    float scale = pixelScale / w;
+    auto pixelError = [&](unsigned int l) {
+        return l == 0 ? 0.0f : scale*lods[l - 1].error;
+    };
+
+    if(pixelError(level) > lodThreshold_) {
+        while(level > 0 && pixelError(level) > lodThreshold_) level--;
+    }
+    else {
+        while(level < lods.size()
+              && pixelError(level + 1) <= lodThreshold_*(1.0f - lodHysteresis_)) {
+            level++;
+        }
+    }
+    lodLevels_[index] = level;
+    return level;
+}
+
+/**
+ * Issues the draw call for the faces of the mesh : one multi draw with 16
+ * bits indices if the mesh is split in chunks (two if some chunks are drawn
+ * with a level of detail), a single indexed draw otherwise (or a non-indexed
+ * draw if the mesh has no faces).
+ *
+ * Chunks outside of the view frustum are skipped (the frustum is extracted
+ * from viewMatrix, which includes the mesh pose, so the test is done in mesh
+ * coordinates). The level of detail of the visible chunks is selected with
+ * select_lod.
+ */
+void MeshRenderer::draw_faces(const View::ConstPtr& view, const Mat4& viewMatrix,
+                              GLenum primitiveMode) const
+{
+    mesh_->update_lods();
+
+    Mat4 projection = view->projection_matrix();
+    float pixelScale = 0.5f*view->screen_size().height*std::abs(projection(1,1));
+    bool perspective = projection(3,3) == 0.0f;
+
+    drawnTriangles_ = 0;
+    if(mesh_->is_split()) {
+        const auto& chunks = mesh_->chunks();
+        Frustum frustum(viewMatrix);
+        chunkCounts_.clear();
+        chunkOffsets_.clear();
+        chunkBaseVertices_.clear();
+        lodCounts_.clear();
+        lodOffsets_.clear();
+        lodBaseVertices_.clear();
+        lodLevels_.resize(chunks.size(), 0);
+        for(size_t c = 0; c < chunks.size(); c++) {
+            const auto& chunk = chunks[c];
+            if(chunkCulling_ && !frustum.intersects(chunk.bounds)) continue;
+            unsigned int level = this->select_lod(c, mesh_->lods(c), chunk.bounds,
+                                                  viewMatrix, pixelScale, perspective);
+            if(level == 0) {
+                chunkCounts_.push_back(chunk.indexCount);
+                chunkOffsets_.push_back((void*)(sizeof(uint16_t)*chunk.indexOffset));
+                chunkBaseVertices_.push_back(chunk.baseVertex);
+            }
+            else {
+                const auto& lod = mesh_->lods(c)[level - 1];
+                lodCounts_.push_back(lod.indexCount);
+                lodOffsets_.push_back((void*)(sizeof(uint16_t)*lod.indexOffset));
+                lodBaseVertices_.push_back(chunk.baseVertex);
+            }
+            drawnTriangles_ += (level == 0 ? chunk.indexCount
+                                           : mesh_->lods(c)[level - 1].indexCount) / 3;
+        }
+        drawnChunks_  = chunkCounts_.size() + lodCounts_.size();
+        culledChunks_ = chunks.size() - drawnChunks_;
+
+        if(chunkCounts_.size() > 0) {
+            mesh_->chunk_indices().bind(GL_ELEMENT_ARRAY_BUFFER);
+            glMultiDrawElementsBaseVertex(primitiveMode, chunkCounts_.data(),
+                                          GL_UNSIGNED_SHORT, chunkOffsets_.data(),
+                                          chunkCounts_.size(), chunkBaseVertices_.data());
+        }
+        if(lodCounts_.size() > 0) {
+            mesh_->lod_chunk_indices().bind(GL_ELEMENT_ARRAY_BUFFER);
+            glMultiDrawElementsBaseVertex(primitiveMode, lodCounts_.data(),
+                                          GL_UNSIGNED_SHORT, lodOffsets_.data(),
+                                          lodCounts_.size(), lodBaseVertices_.data());
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    lodLevels_.resize(1, 0);
+    unsigned int level = this->select_lod(0, mesh_->lods(), mesh_->bounds(),
+                                          viewMatrix, pixelScale, perspective);
+    if(level > 0) {
+        const auto& lod = mesh_->lods()[level - 1];
+        mesh_->lod_indices().bind(GL_ELEMENT_ARRAY_BUFFER);
+        glDrawElements(primitiveMode, lod.indexCount, GL_UNSIGNED_INT,
+                       (void*)(sizeof(uint32_t)*lod.indexOffset));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        drawnTriangles_ = lod.indexCount / 3;
+    }
+    else if(mesh_->faces().size() == 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glDrawArrays(primitiveMode, 0, mesh_->vertex_count());
+        drawnTriangles_ = mesh_->vertex_count() / 3;
+    }
+    else {
+        mesh_->faces().bind(GL_ELEMENT_ARRAY_BUFFER);
+        glDrawElements(primitiveMode, 3*mesh_->faces().size(), GL_UNSIGNED_INT, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        drawnTriangles_ = mesh_->faces().size();
+    }
+}
+
 void MeshRenderer::draw(const View::ConstPtr& view) const
 {
     if(!mesh_) return;
@@ -204,24 +454,20 @@ void MeshRenderer::draw_solid(const View::ConstPtr& view, GLenum primitiveMode)
 {
     glUseProgram(solidRender_);
     
-    mesh_->points().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
+    this->bind_attribute(0, mesh_->position_attribute());
 
     View3D::Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
     glUniformMatrix4fv(glGetUniformLocation(solidRender_, "view"),
         1, GL_FALSE, viewMatrix.data());
+    this->set_decoding_uniforms(solidRender_);
     glUniform4fv(glGetUniformLocation(solidRender_, "color"),
         1, reinterpret_cast<const float*>(&color_));
 
-    if(mesh_->faces().size() == 0 || primitiveMode == GL_POINTS) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glDrawArrays(primitiveMode, 0, mesh_->points().size());
+    if(primitiveMode == GL_POINTS) {
+        glDrawArrays(primitiveMode, 0, mesh_->vertex_count());
     }
     else {
-        mesh_->faces().bind(GL_ELEMENT_ARRAY_BUFFER);
-        glDrawElements(primitiveMode, 3*mesh_->faces().size(), GL_UNSIGNED_INT, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        this->draw_faces(view, viewMatrix, primitiveMode);
     }
 
     glDisableVertexAttribArray(0);
@@ -232,34 +478,23 @@ void MeshRenderer::draw_solid(const View::ConstPtr& view, GLenum primitiveMode)
 
 void MeshRenderer::draw_normal_shading(const View::ConstPtr& view) const
 {
-    if(mesh_->normals().size() == 0) {
+    if(!mesh_->has_normals()) {
         this->draw_solid(view, GL_TRIANGLES);
         return;
     }
     glUseProgram(normalShading_);
     
-    mesh_->points().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-    mesh_->normals().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(1);
+    this->bind_attribute(0, mesh_->position_attribute());
+    this->bind_attribute(1, mesh_->normal_attribute());
 
     View3D::Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
     glUniformMatrix4fv(glGetUniformLocation(normalShading_, "view"),
         1, GL_FALSE, viewMatrix.data());
+    this->set_decoding_uniforms(normalShading_);
     glUniform4fv(glGetUniformLocation(normalShading_, "color"),
         1, reinterpret_cast<const float*>(&color_));
 
-    if(mesh_->faces().size() == 0) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, mesh_->points().size());
-    }
-    else {
-        mesh_->faces().bind(GL_ELEMENT_ARRAY_BUFFER);
-        glDrawElements(GL_TRIANGLES, 3*mesh_->faces().size(), GL_UNSIGNED_INT, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    }
+    this->draw_faces(view, viewMatrix, GL_TRIANGLES);
 
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(0);
@@ -270,35 +505,24 @@ void MeshRenderer::draw_normal_shading(const View::ConstPtr& view) const
 
 void MeshRenderer::draw_textured(const View::ConstPtr& view) const
 {
-    if(!texture_ || mesh_->uvs().size() != mesh_->points().size()) {
+    if(!texture_ || !mesh_->has_uvs()) {
         this->draw_normal_shading(view);
         return;
     }
     glUseProgram(texturedShading_);
     
-    mesh_->points().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-    mesh_->uvs().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(1);
+    this->bind_attribute(0, mesh_->position_attribute());
+    this->bind_attribute(1, mesh_->uv_attribute());
 
     View3D::Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
     glUniformMatrix4fv(glGetUniformLocation(texturedShading_, "view"),
         1, GL_FALSE, viewMatrix.data());
+    this->set_decoding_uniforms(texturedShading_);
     glUniform1i(glGetUniformLocation(texturedShading_, "texIn"), 0);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture_->gl_id());
 
-    if(mesh_->faces().size() == 0) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, mesh_->points().size());
-    }
-    else {
-        mesh_->faces().bind(GL_ELEMENT_ARRAY_BUFFER);
-        glDrawElements(GL_TRIANGLES, 3*mesh_->faces().size(), GL_UNSIGNED_INT, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    }
+    this->draw_faces(view, viewMatrix, GL_TRIANGLES);
 
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(0);
@@ -309,39 +533,25 @@ void MeshRenderer::draw_textured(const View::ConstPtr& view) const
 
 void MeshRenderer::draw_textured_normal(const View::ConstPtr& view) const
 {
-    if(!texture_ || mesh_->uvs().size()     != mesh_->points().size()
-                 || mesh_->normals().size() != mesh_->points().size()) {
+    if(!texture_ || !mesh_->has_uvs() || !mesh_->has_normals()) {
         this->draw_textured(view);
         return;
     }
     glUseProgram(texturedNormalShading_);
     
-    mesh_->points().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
-    mesh_->normals().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(1);
-    mesh_->uvs().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(2);
+    this->bind_attribute(0, mesh_->position_attribute());
+    this->bind_attribute(1, mesh_->normal_attribute());
+    this->bind_attribute(2, mesh_->uv_attribute());
 
     View3D::Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
     glUniformMatrix4fv(glGetUniformLocation(texturedNormalShading_, "view"),
         1, GL_FALSE, viewMatrix.data());
+    this->set_decoding_uniforms(texturedNormalShading_);
     glUniform1i(glGetUniformLocation(texturedNormalShading_, "texIn"), 0);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture_->gl_id());
 
-    if(mesh_->faces().size() == 0) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, mesh_->points().size());
-    }
-    else {
-        mesh_->faces().bind(GL_ELEMENT_ARRAY_BUFFER);
-        glDrawElements(GL_TRIANGLES, 3*mesh_->faces().size(), GL_UNSIGNED_INT, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    }
+    this->draw_faces(view, viewMatrix, GL_TRIANGLES);
 
     glDisableVertexAttribArray(2);
     glDisableVertexAttribArray(1);
@@ -355,17 +565,13 @@ void MeshRenderer::draw_normals(const View::ConstPtr& view) const
 {
     static constexpr const float nLength[2] = {0.1f,1.0f};
 
-    if(mesh_->normals().size() != mesh_->points().size()) return;
+    if(!mesh_->has_normals()) return;
 
     glUseProgram(displayNormalsProgram_);
     
-    mesh_->points().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(0);
+    this->bind_attribute(0, mesh_->position_attribute());
 
-    mesh_->normals().bind(GL_ARRAY_BUFFER);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-    glEnableVertexAttribArray(1);
+    this->bind_attribute(1, mesh_->normal_attribute());
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, nLength);
@@ -377,10 +583,11 @@ void MeshRenderer::draw_normals(const View::ConstPtr& view) const
     View3D::Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
     glUniformMatrix4fv(glGetUniformLocation(displayNormalsProgram_, "view"),
         1, GL_FALSE, viewMatrix.data());
+    this->set_decoding_uniforms(displayNormalsProgram_);
     glUniform4fv(glGetUniformLocation(displayNormalsProgram_, "color"),
         1, reinterpret_cast<const float*>(&normalsColor_));
     
-    glDrawArraysInstanced(GL_LINES, 0, 2, 2*mesh_->points().size());
+    glDrawArraysInstanced(GL_LINES, 0, 2, 2*mesh_->vertex_count());
 
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(0);
@@ -0,0 +1,424 @@
+#include <rtac_display/renderers/MultiFanRenderer.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Composites all the sensors covering the fragment. Early fragment tests are
+ * forced so the stencil test rejects fragments already shaded by the sector
+ * of another sensor before the (costly) shader runs.
+ */
+const std::string& MultiFanRenderer::fragmentShader = std::string(R"(
+#version 430 core
+
+layout(early_fragment_tests) in;
+
+in vec2 xyPos;
+
+struct SensorParameters {
+    vec2  position;
+    vec2  heading; // (cos, sin)
+    vec2  angleBounds;
+    vec2  rangeBounds;
+    int   bearingMapLayer;
+    uint  stamp;
+    vec2  padding;
+};
+
+layout(std430, binding = 0) readonly buffer sensorBuffer
+{
+    SensorParameters sensors[];
+};
+
+uniform sampler2DArray fanData;
+uniform sampler2DArray bearingMaps;
+uniform sampler2D      colormap;
+
+uniform uint sensorCount;
+uniform uint blendMode;
+uniform vec2 valueScaling;
+
+out vec4 outColor;
+
+#define M_2PI 6.283185307179586
+
+#define BLEND_MAX    0u
+#define BLEND_MEAN   1u
+#define BLEND_LATEST 2u
+
+void main()
+{
+    float result = 0.0f;
+    uint  count  = 0;
+    uint  latest = 0;
+
+    for(uint i = 0; i < sensorCount; i++) {
+        if(sensors[i].stamp == 0)
+            continue;
+
+        // fragment position in the sensor frame.
+        vec2 p = xyPos - sensors[i].position;
+        p = vec2( sensors[i].heading.x*p.x + sensors[i].heading.y*p.y,
+                 -sensors[i].heading.y*p.x + sensors[i].heading.x*p.y);
+
+        vec2 angleBounds = sensors[i].angleBounds;
+        vec2 rangeBounds = sensors[i].rangeBounds;
+        vec2 normalized;
+        normalized.x = atan(p.y, p.x);
+        if(normalized.x < angleBounds.x)
+            normalized.x += M_2PI;
+        normalized.x = (normalized.x  - angleBounds.x)
+                     / (angleBounds.y - angleBounds.x);
+        normalized.y = (length(p) - rangeBounds.x)
+                     / (rangeBounds.y - rangeBounds.x);
+        if(normalized.x < 0.0f || normalized.x > 1.0f ||
+           normalized.y < 0.0f || normalized.y > 1.0f) {
+            continue;
+        }
+
+        if(sensors[i].bearingMapLayer >= 0) {
+            normalized.x = 1.0f - texture(bearingMaps,
+                vec3(normalized.x, 0.0f, sensors[i].bearingMapLayer)).x;
+        }
+        float value = valueScaling.x*texture(fanData, vec3(normalized, i)).x
+                    + valueScaling.y;
+
+        if(blendMode == BLEND_MAX) {
+            result = count == 0 ? value : max(result, value);
+        }
+        else if(blendMode == BLEND_MEAN) {
+            result += value;
+        }
+        else if(sensors[i].stamp > latest) {
+            result = value;
+            latest = sensors[i].stamp;
+        }
+        count++;
+    }
+
+    if(count == 0) {
+        discard;
+    }
+    if(blendMode == BLEND_MEAN) {
+        result /= count;
+    }
+    outColor = texture(colormap, vec2(result, 0.0f));
+}
+)");
+
+MultiFanRenderer::MultiFanRenderer(const GLContext::Ptr& context,
+                                   unsigned int sensorCount) :
+    Renderer(context, FanRenderer::vertexShader, fragmentShader),
+    stamp_(0),
+    data_(GLTextureArray::New()),
+    dataType_(GL_FLOAT),
+    dataScale_(1.0f),
+    bearingMaps_(GLTextureArray::New()),
+    colormap_(colormap::Viridis()),
+    valueRange_({0.0f,1.0f}),
+    blendMode_(BlendMode::Max),
+    direction_(Direction::Up),
+    geometryChanged_(true),
+    parametersChanged_(true)
+{
+    this->set_sensor_count(sensorCount);
+}
+
+MultiFanRenderer::Ptr MultiFanRenderer::Create(const GLContext::Ptr& context,
+                                               unsigned int sensorCount)
+{
+    return Ptr(new MultiFanRenderer(context, sensorCount));
+}
+
+MultiFanRenderer::Sensor& MultiFanRenderer::sensor(unsigned int index)
+{
+    if(index >= sensors_.size()) {
+        std::ostringstream oss;
+        oss << "MultiFanRenderer : invalid sensor index " << index
+            << " (sensor count is " << sensors_.size() << ").";
+        throw std::out_of_range(oss.str());
+    }
+    return sensors_[index];
+}
+
+/**
+ * Sets the number of sensors. Sensor parameters are kept for already existing
+ * sensors but all the sensor data is invalidated.
+ */
+void MultiFanRenderer::set_sensor_count(unsigned int sensorCount)
+{
+    if(sensorCount == 0) {
+        throw std::runtime_error("MultiFanRenderer : sensor count must be > 0.");
+    }
+    Sensor defaultSensor;
+    defaultSensor.x          = 0.0f;
+    defaultSensor.y          = 0.0f;
+    defaultSensor.heading    = 0.0f;
+    defaultSensor.angle      = FanRenderer::normalized_aperture({-M_PI, M_PI});
+    defaultSensor.range      = Interval({0.0f,1.0f});
+    defaultSensor.bearingMap = false;
+    defaultSensor.stamp      = 0;
+    sensors_.resize(sensorCount, defaultSensor);
+
+    bearingMaps_->resize<float>({BearingMapSize, 1}, sensorCount);
+    bearingMaps_->set_filter_mode(GLTextureArray::FilterMode::Linear);
+    bearingMaps_->set_wrap_mode(GLTextureArray::WrapMode::Clamp);
+    for(auto& s : sensors_) {
+        s.bearingMap = false; // bearing maps were reallocated.
+        s.stamp      = 0;
+    }
+    data_->resize<float>({1,1}, sensorCount);
+    dataType_  = GL_FLOAT;
+    dataScale_ = 1.0f;
+
+    geometryChanged_   = true;
+    parametersChanged_ = true;
+}
+
+/**
+ * Sets the pose of a sensor in the display plane.
+ *
+ * @param heading direction of the sensor axis (x axis of the sensor data) in
+ *                radians.
+ */
+void MultiFanRenderer::set_pose(unsigned int sensor, float x, float y, float heading)
+{
+    auto& s = this->sensor(sensor);
+    s.x       = x;
+    s.y       = y;
+    s.heading = heading;
+    geometryChanged_   = true;
+    parametersChanged_ = true;
+}
+
+void MultiFanRenderer::set_geometry(unsigned int sensor, const Interval& angle,
+                                    const Interval& range)
+{
+    auto& s = this->sensor(sensor);
+    s.angle = FanRenderer::normalized_aperture(angle);
+    s.range = range;
+    geometryChanged_   = true;
+    parametersChanged_ = true;
+}
+
+void MultiFanRenderer::set_geometry_degrees(unsigned int sensor,
+                                            const Interval& angle,
+                                            const Interval& range)
+{
+    this->set_geometry(sensor, {(float)(angle.min * M_PI / 180.0f),
+                                (float)(angle.max * M_PI / 180.0f)},
+                       range);
+}
+
+/**
+ * Sets non-linearly spaced bearings for a sensor (same as
+ * FanRenderer::set_bearings). The sensor aperture is set to the bearing
+ * bounds.
+ */
+void MultiFanRenderer::set_bearings(unsigned int sensor, unsigned int nBeams,
+                                    const float* bearings)
+{
+    auto& s = this->sensor(sensor);
+
+    Interpolator::Vector x0(nBeams);
+    Interpolator::Vector y0(nBeams);
+    for(size_t i = 0; i < nBeams; i++) {
+        x0[i] = ((float)i) / (nBeams - 1);
+        y0[i] = bearings[i];
+    }
+
+    Interpolator::Vector b(BearingMapSize);
+    for(size_t i = 0; i < BearingMapSize; i++) {
+        b[i] = ((bearings[nBeams-1] - bearings[0])*i) / (BearingMapSize - 1)
+             + bearings[0];
+    }
+
+    Interpolator interp(y0,x0);
+    auto ib = interp(b);
+    bearingMaps_->set_layer(sensor, ib.data());
+
+    s.bearingMap = true;
+    this->set_geometry(sensor, {bearings[0], bearings[nBeams-1]}, s.range);
+}
+
+void MultiFanRenderer::disable_bearing_map(unsigned int sensor)
+{
+    this->sensor(sensor).bearingMap = false;
+    parametersChanged_ = true;
+}
+
+/**
+ * Sets the value range (in sample units) mapped to the colormap.
+ */
+void MultiFanRenderer::set_value_range(Interval valueRange)
+{
+    if(fabs(valueRange.max - valueRange.min) < 1.0e-6)
+        return;
+    valueRange_ = valueRange;
+}
+
+/**
+ * Bounding rectangle of all the sensor sectors in the display plane.
+ */
+MultiFanRenderer::Rectangle MultiFanRenderer::bounds() const
+{
+    this->update_geometry();
+    return bounds_;
+}
+
+/**
+ * Rebuilds the union of the sensor sector meshes (in the display plane).
+ */
+void MultiFanRenderer::update_geometry() const
+{
+    if(!geometryChanged_) {
+        return;
+    }
+
+    std::vector<Point4> mesh;
+    for(const auto& s : sensors_) {
+        unsigned int subdivisions = std::ceil((s.angle.max - s.angle.min)
+                                              / MaxSectorStep);
+        auto sector = FanRenderer::sector_mesh(s.angle, s.range, subdivisions);
+        float c = std::cos(s.heading), sn = std::sin(s.heading);
+        for(auto p : sector) {
+            mesh.push_back(Point4({c*p.x - sn*p.y + s.x,
+                                   sn*p.x + c*p.y + s.y, 0.0f, 1.0f}));
+        }
+    }
+
+    bounds_.left   = mesh[0].x;
+    bounds_.right  = mesh[0].x;
+    bounds_.bottom = mesh[0].y;
+    bounds_.top    = mesh[0].y;
+    for(auto p : mesh) {
+        bounds_.left   = std::min(bounds_.left,   p.x);
+        bounds_.right  = std::max(bounds_.right,  p.x);
+        bounds_.bottom = std::min(bounds_.bottom, p.y);
+        bounds_.top    = std::max(bounds_.top,    p.y);
+    }
+
+    mesh_.set_data(mesh.size(), mesh.data());
+    geometryChanged_ = false;
+}
+
+void MultiFanRenderer::update_parameters() const
+{
+    if(!parametersChanged_) {
+        return;
+    }
+
+    std::vector<SensorParameters> parameters(sensors_.size());
+    for(unsigned int i = 0; i < sensors_.size(); i++) {
+        const auto& s = sensors_[i];
+        auto& p = parameters[i];
+        p.x               = s.x;
+        p.y               = s.y;
+        p.cosHeading      = std::cos(s.heading);
+        p.sinHeading      = std::sin(s.heading);
+        p.angleMin        = s.angle.min;
+        p.angleMax        = s.angle.max;
+        p.rangeMin        = s.range.min;
+        p.rangeMax        = s.range.max;
+        p.bearingMapLayer = s.bearingMap ? i : -1;
+        p.stamp           = s.stamp;
+    }
+    parameters_.set_data(parameters.size(), parameters.data());
+    parametersChanged_ = false;
+}
+
+void MultiFanRenderer::draw(const View::ConstPtr& view) const
+{
+    this->update_geometry();
+    this->update_parameters();
+
+    Mat4 mat = FanRenderer::fit_view(bounds_, direction_, view->screen_size());
+
+    // Each pixel is shaded by the first sector covering it only. Only the
+    // highest stencil bit is used (glClear honors the stencil write mask),
+    // the lower bits of the bound framebuffer are left untouched and the
+    // stencil state is restored after drawing.
+    GLboolean stencilTest = glIsEnabled(GL_STENCIL_TEST);
+    GLint stencilClear, stencilFunc[2], stencilRef[2], stencilValueMask[2],
+          stencilWriteMask[2], stencilFail[2], stencilDepthFail[2], stencilPass[2];
+    glGetIntegerv(GL_STENCIL_CLEAR_VALUE,                &stencilClear);
+    glGetIntegerv(GL_STENCIL_FUNC,                       &stencilFunc[0]);
+    glGetIntegerv(GL_STENCIL_REF,                        &stencilRef[0]);
+    glGetIntegerv(GL_STENCIL_VALUE_MASK,                 &stencilValueMask[0]);
+    glGetIntegerv(GL_STENCIL_WRITEMASK,                  &stencilWriteMask[0]);
+    glGetIntegerv(GL_STENCIL_FAIL,                       &stencilFail[0]);
+    glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL,            &stencilDepthFail[0]);
+    glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS,            &stencilPass[0]);
+    glGetIntegerv(GL_STENCIL_BACK_FUNC,                  &stencilFunc[1]);
+    glGetIntegerv(GL_STENCIL_BACK_REF,                   &stencilRef[1]);
+    glGetIntegerv(GL_STENCIL_BACK_VALUE_MASK,            &stencilValueMask[1]);
+    glGetIntegerv(GL_STENCIL_BACK_WRITEMASK,             &stencilWriteMask[1]);
+    glGetIntegerv(GL_STENCIL_BACK_FAIL,                  &stencilFail[1]);
+    glGetIntegerv(GL_STENCIL_BACK_PASS_DEPTH_FAIL,       &stencilDepthFail[1]);
+    glGetIntegerv(GL_STENCIL_BACK_PASS_DEPTH_PASS,       &stencilPass[1]);
+
+    const GLuint sectorBit = 0x80;
+    glStencilMask(sectorBit);
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+    glEnable(GL_STENCIL_TEST);
+    glStencilFunc(GL_EQUAL, 0, sectorBit);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT);
+
+    glUseProgram(renderProgram_);
+
+    mesh_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+
+    glUniformMatrix4fv(glGetUniformLocation(renderProgram_, "view"),
+        1, GL_FALSE, mat.data());
+    glUniform2f(glGetUniformLocation(renderProgram_, "valueScaling"),
+                dataScale_ / (valueRange_.max - valueRange_.min),
+               -valueRange_.min / (valueRange_.max - valueRange_.min));
+    glUniform1ui(glGetUniformLocation(renderProgram_, "sensorCount"),
+                 sensors_.size());
+    glUniform1ui(glGetUniformLocation(renderProgram_, "blendMode"),
+                 (uint32_t)blendMode_);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, parameters_.gl_id());
+
+    glUniform1i(glGetUniformLocation(renderProgram_, "fanData"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    data_->bind(GL_TEXTURE_2D_ARRAY);
+
+    glUniform1i(glGetUniformLocation(renderProgram_, "bearingMaps"), 1);
+    glActiveTexture(GL_TEXTURE1);
+    bearingMaps_->bind(GL_TEXTURE_2D_ARRAY);
+
+    glUniform1i(glGetUniformLocation(renderProgram_, "colormap"), 2);
+    glActiveTexture(GL_TEXTURE2);
+    colormap_->texture().bind(GL_TEXTURE_2D);
+
+    glDrawArrays(GL_TRIANGLES, 0, mesh_.size());
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+
+    if(!stencilTest) {
+        glDisable(GL_STENCIL_TEST);
+    }
+    const GLenum faces[2] = {GL_FRONT, GL_BACK};
+    for(int i = 0; i < 2; i++) {
+        glStencilFuncSeparate(faces[i], stencilFunc[i], stencilRef[i], stencilValueMask[i]);
+        glStencilOpSeparate(faces[i], stencilFail[i], stencilDepthFail[i], stencilPass[i]);
+        glStencilMaskSeparate(faces[i], stencilWriteMask[i]);
+    }
+    glClearStencil(stencilClear);
+
+    GL_CHECK_LAST();
+}
+
+}; //namespace display
+}; //namespace rtac
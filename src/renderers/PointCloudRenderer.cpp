@@ -0,0 +1,634 @@
+#include <rtac_display/renderers/PointCloudRenderer.h>
+
+#include <cmath>
+#include <sstream>
+
+namespace rtac { namespace display {
+
+namespace {
+
+// maximum number of voxel grid passes of a decimation.
+constexpr unsigned int MaxDecimationPasses = 32;
+
+}; //namespace
+
+/**
+ * Points colored either with a uniform color or with a scalar attribute
+ * mapped to the colormap (valueScaling maps the value to [0,1]).
+ *
+ * The point size in pixels is computed from worldRadius (0 for a fixed size)
+ * and clamped to sizeRange. The radius in world units of the displayed point
+ * is forwarded to the fragment shader for the splat depth correction.
+ *
+ * MeshRenderer::vertexDecoding is appended when the program is created (it
+ * is defined in another translation unit).
+ */
+const std::string PointCloudRenderer::vertexShaderPoints = std::string( R"(
+#version 430 core
+
+layout(location = 0) in vec3  point;
+layout(location = 1) in float value;
+
+uniform mat4  view;
+uniform vec4  color;
+uniform bool  colormapped;
+uniform vec2  valueScaling;
+uniform sampler2D colormap;
+uniform float worldRadius;
+uniform vec2  sizeRange;
+uniform float pixelScale;
+
+out vec4 c;
+flat out float radius;
+flat out vec4  clipPosition;
+
+vec3 decode_position(vec3 p);
+
+void main()
+{
+    gl_Position = view*vec4(decode_position(point), 1.0f);
+    if(colormapped) {
+        float v = clamp(valueScaling.x*value + valueScaling.y, 0.0f, 1.0f);
+        c = textureLod(colormap, vec2(v, 0.5f), 0.0f);
+    }
+    else {
+        c = color;
+    }
+
+    float w = max(gl_Position.w, 1.0e-6f);
+    float size = clamp(2.0f*worldRadius*pixelScale / w, sizeRange.x, sizeRange.y);
+    gl_PointSize = size;
+    radius       = 0.5f*size*w / pixelScale;
+    clipPosition = gl_Position;
+}
+)");
+
+/**
+ * Round splats : fragments outside of the disk are discarded and the depth
+ * of the others is moved towards the camera as on a sphere of the point
+ * radius (depthAxis is the eye space z axis in clip space).
+ */
+const std::string PointCloudRenderer::fragmentShaderSplats = std::string(R"(
+#version 430 core
+
+in vec4 c;
+flat in float radius;
+flat in vec4  clipPosition;
+
+uniform vec4 depthAxis;
+
+out vec4 outColor;
+
+void main()
+{
+    vec2  d  = 2.0f*gl_PointCoord - 1.0f;
+    float r2 = dot(d, d);
+    if(r2 > 1.0f)
+        discard;
+    vec4 p = clipPosition + radius*sqrt(1.0f - r2)*depthAxis;
+    gl_FragDepth = 0.5f*(p.z / p.w) + 0.5f;
+    outColor = c;
+}
+)");
+
+/**
+ * Full screen triangle (no vertex buffer).
+ */
+const std::string PointCloudRenderer::vertexShaderEdl = std::string( R"(
+#version 430 core
+
+out vec2 uv;
+
+void main()
+{
+    const vec2 corners[3] = vec2[3](vec2(-1.0f,-1.0f), vec2(3.0f,-1.0f), vec2(-1.0f,3.0f));
+    gl_Position = vec4(corners[gl_VertexID], 0.0f, 1.0f);
+    uv = 0.5f*corners[gl_VertexID] + 0.5f;
+}
+)");
+
+/**
+ * Eye-dome lighting. The obscurance of a pixel is the sum of the log depth
+ * differences with its 8 neighbours at edlRadius pixels (neighbours further
+ * away only). The depth is linearized with the projection matrix
+ * coefficients in depthParams (P22, P23, P32, P33). The depth buffer is
+ * written so the points are composited with the rest of the scene.
+ */
+const std::string PointCloudRenderer::fragmentShaderEdl = std::string(R"(
+#version 430 core
+
+in  vec2 uv;
+out vec4 outColor;
+
+uniform sampler2D colorTexture;
+uniform sampler2D depthTexture;
+uniform vec2  texelSize;
+uniform float edlStrength;
+uniform float edlRadius;
+uniform vec4  depthParams;
+
+float log_depth(float d)
+{
+    float ndc = 2.0f*d - 1.0f;
+    float z = (depthParams.y - ndc*depthParams.w) / (ndc*depthParams.z - depthParams.x);
+    return log2(max(-z, 1.0e-6f));
+}
+
+void main()
+{
+    float depth = texture(depthTexture, uv).r;
+    if(depth >= 1.0f)
+        discard;
+    float center = log_depth(depth);
+
+    const vec2 neighbours[8] = vec2[8](
+        vec2( 1.0f, 0.0f), vec2( 0.7071f, 0.7071f), vec2(0.0f, 1.0f), vec2(-0.7071f, 0.7071f),
+        vec2(-1.0f, 0.0f), vec2(-0.7071f,-0.7071f), vec2(0.0f,-1.0f), vec2( 0.7071f,-0.7071f));
+    float sum = 0.0f;
+    for(int i = 0; i < 8; i++) {
+        float d = texture(depthTexture, uv + edlRadius*texelSize*neighbours[i]).r;
+        if(d < 1.0f) {
+            sum += max(0.0f, center - log_depth(d));
+        }
+    }
+    float shade = exp(-300.0f*edlStrength*sum / 8.0f);
+
+    vec4 c = texture(colorTexture, uv);
+    outColor = vec4(shade*c.rgb, c.a);
+    gl_FragDepth = depth;
+}
+)");
+
+PointCloudRenderer::PointCloudRenderer(const GLContext::Ptr& context,
+                                       const Color::RGBAf& color) :
+    MeshRenderer(context, color),
+    mutableMesh_(GLMesh::Create()),
+    colormap_(colormap::Viridis()),
+    sizeMode_(SizeMode::Fixed),
+    pointSize_(1.0f),
+    splatRadius_(0.01f),
+    minPointSize_(1.0f),
+    maxPointSize_(32.0f),
+    roundPoints_(false),
+    pointProgram_(create_render_program(vertexShaderPoints + vertexDecoding,
+                                        fragmentShaderSolid)),
+    splatProgram_(create_render_program(vertexShaderPoints + vertexDecoding,
+                                        fragmentShaderSplats)),
+    edlEnabled_(false),
+    edlStrength_(1.0f),
+    edlRadius_(1.4f),
+    edlProgram_(create_render_program(vertexShaderEdl, fragmentShaderEdl)),
+    edlFrameBuffer_(GLFrameBuffer::Create()),
+    edlColor_(GLTexture::New()),
+    edlDepth_(GLTexture::New()),
+    pointBudget_(0),
+    decimationDirty_(true),
+    decimatedMesh_(nullptr),
+    decimatedVertexCount_(0),
+    decimated_(false),
+    decimationVoxelSize_(0.0f),
+    drawnPoints_(0)
+{
+    mesh_ = mutableMesh_;
+    this->set_render_mode(MeshRenderer::Mode::Points);
+
+    edlColor_->set_filter_mode(GLTexture::Nearest);
+    edlColor_->set_wrap_mode(GLTexture::ClampToEdge);
+    edlDepth_->set_filter_mode(GLTexture::Nearest);
+    edlDepth_->set_wrap_mode(GLTexture::ClampToEdge);
+}
+
+void PointCloudRenderer::add_attribute(const std::string& name,
+                                       ScalarAttribute&& attribute,
+                                       bool computeRange)
+{
+    auto it = attributes_.find(name);
+    if(it != attributes_.end()) {
+        attribute.range = it->second.range;
+    }
+    attributes_[name] = std::move(attribute);
+    if(computeRange) {
+        this->update_range(name);
+    }
+}
+
+void PointCloudRenderer::remove_attribute(const std::string& name)
+{
+    attributes_.erase(name);
+    if(activeAttribute_ == name) {
+        activeAttribute_.clear();
+    }
+}
+
+void PointCloudRenderer::clear_attributes()
+{
+    attributes_.clear();
+    activeAttribute_.clear();
+}
+
+/**
+ * Selects the attribute used to color the points. An empty name draws the
+ * points with the uniform color.
+ */
+void PointCloudRenderer::set_active_attribute(const std::string& name)
+{
+    if(name.size() > 0 && !this->has_attribute(name)) {
+        std::ostringstream oss;
+        oss << "PointCloudRenderer : no attribute named '" << name << "'";
+        throw std::runtime_error(oss.str());
+    }
+    activeAttribute_ = name;
+}
+
+/**
+ * Sets the value range of an attribute mapped to the colormap (in attribute
+ * units, uint8_t and uint16_t values are not normalized).
+ */
+void PointCloudRenderer::set_range(const std::string& name, const Interval& range)
+{
+    if(std::abs(range.max - range.min) < 1.0e-6) {
+        return;
+    }
+    auto it = attributes_.find(name);
+    if(it == attributes_.end()) {
+        std::ostringstream oss;
+        oss << "PointCloudRenderer : no attribute named '" << name << "'";
+        throw std::runtime_error(oss.str());
+    }
+    it->second.range = range;
+}
+
+/**
+ * Sets the value range of an attribute to its extrema (computed on the GPU).
+ */
+void PointCloudRenderer::update_range(const std::string& name)
+{
+    auto it = attributes_.find(name);
+    if(it == attributes_.end()) {
+        std::ostringstream oss;
+        oss << "PointCloudRenderer : no attribute named '" << name << "'";
+        throw std::runtime_error(oss.str());
+    }
+    if(it->second.size() == 0) return;
+    this->set_range(name, it->second.compute_range(reductor_));
+}
+
+void PointCloudRenderer::set_colormap(const Colormap::Ptr& colormap)
+{
+    if(colormap) {
+        colormap_ = colormap;
+    }
+}
+
+bool PointCloudRenderer::has_attribute(const std::string& name) const
+{
+    return attributes_.find(name) != attributes_.end();
+}
+
+const PointCloudRenderer::ScalarAttribute&
+PointCloudRenderer::attribute(const std::string& name) const
+{
+    auto it = attributes_.find(name);
+    if(it == attributes_.end()) {
+        std::ostringstream oss;
+        oss << "PointCloudRenderer : no attribute named '" << name << "'";
+        throw std::runtime_error(oss.str());
+    }
+    return it->second;
+}
+
+/**
+ * Fixed point size in pixels.
+ */
+void PointCloudRenderer::set_point_size(float pixels)
+{
+    pointSize_ = std::max(1.0f, pixels);
+    sizeMode_  = SizeMode::Fixed;
+}
+
+/**
+ * Points are drawn as splats with a constant radius in world units (the
+ * size on screen is clamped to the point size range).
+ */
+void PointCloudRenderer::set_splat_radius(float radius)
+{
+    splatRadius_ = std::max(0.0f, radius);
+    sizeMode_    = SizeMode::World;
+}
+
+/**
+ * The splat radius is estimated from the mean spacing of the points, such
+ * as neighbouring points touch on screen whatever the distance to the
+ * camera (the size on screen is clamped to the point size range).
+ *
+ * The spacing is computed from the bounds of the mesh, assuming the points
+ * are sampled on a surface (lidar, photogrammetry...).
+ */
+void PointCloudRenderer::set_adaptive_size()
+{
+    sizeMode_ = SizeMode::Adaptive;
+}
+
+/**
+ * Bounds of the point size on screen in World and Adaptive modes (pixels).
+ */
+void PointCloudRenderer::set_point_size_range(float minPixels, float maxPixels)
+{
+    minPointSize_ = std::max(1.0f, minPixels);
+    maxPointSize_ = std::max(minPointSize_, maxPixels);
+}
+
+/**
+ * Enables the eye-dome lighting post-process.
+ *
+ * @param strength strength of the shading (1 is a good start, higher values
+ *                 darken the edges).
+ * @param radius   distance in pixels of the neighbours used to compute the
+ *                 shading.
+ */
+void PointCloudRenderer::enable_eye_dome_lighting(float strength, float radius)
+{
+    edlStrength_ = std::max(0.0f, strength);
+    edlRadius_   = std::max(1.0f, radius);
+    edlEnabled_  = true;
+}
+
+/**
+ * Maximum number of points drawn. Larger clouds are decimated with a voxel
+ * grid on the GPU. 0 disables the decimation.
+ */
+void PointCloudRenderer::set_point_budget(size_t budget)
+{
+    pointBudget_     = budget;
+    decimationDirty_ = true;
+}
+
+/**
+ * Mean spacing of count points (half of it) assuming the points are sampled
+ * on a surface filling the bounding sphere of the mesh. The bounds of the
+ * owned mesh are updated if they were invalidated (see GLMesh::points).
+ */
+float PointCloudRenderer::adaptive_radius(size_t count) const
+{
+    if(mesh_->bounds().is_infinite() && mesh_ == mutableMesh_) {
+        mutableMesh_->update_bounds();
+    }
+    const auto& bounds = mesh_->bounds();
+    if(bounds.is_infinite() || count == 0) {
+        return 0.0f;
+    }
+    return 0.5f*bounds.radius*std::sqrt(M_PI / count);
+}
+
+/**
+ * Selects the points drawn under the point budget (one point per voxel). The
+ * first voxel size assumes the points are sampled on a surface filling the
+ * bounding sphere of the mesh, it is then adjusted from the number of points
+ * kept until the budget is met (and at least 70% used). After 8 iterations
+ * the voxel size is only increased, until the budget is met. The number of
+ * passes is bounded : in degenerate cases the budget may be exceeded.
+ *
+ * Packed meshes (see GLMesh::pack) are not decimated.
+ */
+void PointCloudRenderer::decimate() const
+{
+    size_t count = mesh_->vertex_count();
+    decimationDirty_      = false;
+    decimatedMesh_        = mesh_.get();
+    decimatedVertexCount_ = count;
+    decimated_            = false;
+    drawnPoints_          = count;
+    if(pointBudget_ == 0 || count <= pointBudget_
+       || mesh_->is_packed() || mesh_->points().size() < count) {
+        return;
+    }
+
+    if(mesh_->bounds().is_infinite() && mesh_ == mutableMesh_) {
+        mutableMesh_->update_bounds();
+    }
+    const auto& bounds = mesh_->bounds();
+    if(bounds.is_infinite()) {
+        return;
+    }
+
+    // The voxel size must stay positive (coincident points give a null
+    // radius, and any positive voxel size then keeps a single point).
+    float minVoxelSize = 1.0e-6f*std::max(1.0f,
+        bounds.center.cwiseAbs().maxCoeff() + bounds.radius);
+    float  voxelSize    = std::max(minVoxelSize,
+                                   bounds.radius*(float)std::sqrt(M_PI / pointBudget_));
+    float  selectedSize = voxelSize;
+    size_t kept         = count;
+    for(unsigned int i = 0; i < MaxDecimationPasses; i++) {
+        kept = voxelGrid_.select(mesh_->points(), voxelSize, decimatedIndices_);
+        selectedSize = voxelSize;
+        if(kept <= pointBudget_ && (kept >= 0.7f*pointBudget_ || i >= 7)) {
+            break;
+        }
+        float ratio = std::sqrt((float)kept / pointBudget_);
+        voxelSize *= kept > pointBudget_ ? std::max(1.1f, 1.05f*ratio)
+                                         : std::max(0.5f, ratio);
+        voxelSize  = std::max(minVoxelSize, voxelSize);
+    }
+
+    decimated_           = true;
+    decimationVoxelSize_ = selectedSize;
+    drawnPoints_         = kept;
+}
+
+void PointCloudRenderer::draw(const View::ConstPtr& view) const
+{
+    if(!mesh_) return;
+
+    if(decimationDirty_ || decimatedMesh_ != mesh_.get()
+       || decimatedVertexCount_ != mesh_->vertex_count()) {
+        this->decimate();
+    }
+
+    const ScalarAttribute* attribute = nullptr;
+    if(activeAttribute_.size() > 0) {
+        attribute = &attributes_.at(activeAttribute_);
+    }
+
+    if(edlEnabled_) {
+        this->draw_eye_dome_lighting(view, attribute);
+    }
+    else {
+        this->draw_points(view, attribute);
+    }
+
+    if(displayNormals_)
+        this->draw_normals(view);
+}
+
+/**
+ * Draws the points with the uniform color (attribute is nullptr) or colored
+ * by a scalar attribute.
+ */
+void PointCloudRenderer::draw_points(const View::ConstPtr& view,
+                                     const ScalarAttribute* attribute) const
+{
+    // decimated points are drawn through indices in the full cloud.
+    size_t count = mesh_->vertex_count();
+    size_t attributeSize = attribute ? attribute->size() : count;
+    bool decimated = decimated_ && attributeSize >= count;
+    if(decimated) {
+        count = drawnPoints_;
+    }
+    else {
+        count = std::min(count, attributeSize);
+    }
+    if(count == 0) return;
+
+    GLuint program = roundPoints_ ? splatProgram_ : pointProgram_;
+    glUseProgram(program);
+
+    this->bind_attribute(0, mesh_->position_attribute());
+    if(attribute) {
+        glBindBuffer(GL_ARRAY_BUFFER, attribute->buffer());
+        glVertexAttribPointer(1, 1, attribute->type, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(1);
+
+        glUniform2f(glGetUniformLocation(program, "valueScaling"),
+                    1.0f / (attribute->range.max - attribute->range.min),
+                   -attribute->range.min / (attribute->range.max - attribute->range.min));
+        glUniform1i(glGetUniformLocation(program, "colormap"), 0);
+        glActiveTexture(GL_TEXTURE0);
+        colormap_->texture().bind(GL_TEXTURE_2D);
+    }
+    glUniform1i(glGetUniformLocation(program, "colormapped"), attribute != nullptr);
+    glUniform4fv(glGetUniformLocation(program, "color"),
+        1, reinterpret_cast<const float*>(&color_));
+
+    View3D::Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"),
+        1, GL_FALSE, viewMatrix.data());
+    this->set_decoding_uniforms(program);
+
+    // point size (see select_lod for pixelScale)
+    Mat4  projection = view->projection_matrix();
+    float pixelScale = 0.5f*view->screen_size().height*std::abs(projection(1,1));
+    float worldRadius = 0.0f;
+    float minSize = pointSize_, maxSize = pointSize_;
+    if(sizeMode_ != SizeMode::Fixed) {
+        worldRadius = sizeMode_ == SizeMode::World ? splatRadius_
+                                                   : this->adaptive_radius(count);
+        minSize = minPointSize_;
+        maxSize = maxPointSize_;
+    }
+    glUniform1f(glGetUniformLocation(program, "worldRadius"), worldRadius);
+    glUniform2f(glGetUniformLocation(program, "sizeRange"), minSize, maxSize);
+    glUniform1f(glGetUniformLocation(program, "pixelScale"), std::max(pixelScale, 1.0e-6f));
+    glUniform4f(glGetUniformLocation(program, "depthAxis"),
+                projection(0,2), projection(1,2), projection(2,2), projection(3,2));
+
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    if(decimated) {
+        decimatedIndices_.bind(GL_ELEMENT_ARRAY_BUFFER);
+        glDrawElements(GL_POINTS, count, GL_UNSIGNED_INT, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+    else {
+        glDrawArrays(GL_POINTS, 0, count);
+    }
+    glDisable(GL_PROGRAM_POINT_SIZE);
+
+    if(attribute) {
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDisableVertexAttribArray(1);
+    }
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(0);
+}
+
+/**
+ * (Re)allocates the offscreen color and depth targets of the eye-dome
+ * lighting pass.
+ */
+void PointCloudRenderer::resize_edl_targets(const Shape& shape) const
+{
+    if(edlColor_->width() == shape.width && edlColor_->height() == shape.height) {
+        return;
+    }
+    edlColor_->set_image<uint8_t>(shape, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    edlDepth_->set_image<float>(shape, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT,
+                                GL_FLOAT, nullptr);
+
+    edlFrameBuffer_->bind(GL_DRAW_FRAMEBUFFER);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, edlColor_->gl_id(), 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                           GL_TEXTURE_2D, edlDepth_->gl_id(), 0);
+    GLenum status = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER);
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+        std::ostringstream oss;
+        oss << "PointCloudRenderer : incomplete eye-dome lighting framebuffer ("
+            << status << ")";
+        throw std::runtime_error(oss.str());
+    }
+}
+
+/**
+ * Draws the points in the offscreen framebuffer then composites them in the
+ * current framebuffer with the eye-dome lighting shading. The framebuffer
+ * binding, viewport and clear color are restored afterwards.
+ */
+void PointCloudRenderer::draw_eye_dome_lighting(const View::ConstPtr& view,
+                                                const ScalarAttribute* attribute) const
+{
+    GLint   framebuffer;
+    GLint   viewport[4];
+    GLfloat clearColor[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    if(viewport[2] <= 0 || viewport[3] <= 0) return;
+
+    this->resize_edl_targets(Shape({(size_t)viewport[2], (size_t)viewport[3]}));
+
+    edlFrameBuffer_->bind(GL_DRAW_FRAMEBUFFER);
+    glViewport(0, 0, viewport[2], viewport[3]);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    this->draw_points(view, attribute);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    glUseProgram(edlProgram_);
+
+    Mat4 projection = view->projection_matrix();
+    glUniform2f(glGetUniformLocation(edlProgram_, "texelSize"),
+                1.0f / viewport[2], 1.0f / viewport[3]);
+    glUniform1f(glGetUniformLocation(edlProgram_, "edlStrength"), edlStrength_);
+    glUniform1f(glGetUniformLocation(edlProgram_, "edlRadius"),   edlRadius_);
+    glUniform4f(glGetUniformLocation(edlProgram_, "depthParams"),
+                projection(2,2), projection(2,3), projection(3,2), projection(3,3));
+
+    glUniform1i(glGetUniformLocation(edlProgram_, "colorTexture"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    edlColor_->bind(GL_TEXTURE_2D);
+    glUniform1i(glGetUniformLocation(edlProgram_, "depthTexture"), 1);
+    glActiveTexture(GL_TEXTURE1);
+    edlDepth_->bind(GL_TEXTURE_2D);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if(!depthTest) {
+        glDisable(GL_DEPTH_TEST);
+    }
+
+    glUseProgram(0);
+}
+
+}; //namespace display
+}; //namespace rtac
@@ -0,0 +1,379 @@
+#include <rtac_display/renderers/PointOctreeRenderer.h>
+
+#include <queue>
+#include <limits>
+
+namespace rtac { namespace display {
+
+namespace {
+
+// maximum number of nodes requested to the loaders at each draw.
+constexpr size_t MaxRequests = 64;
+// maximum number of points uploaded in the node pool at each draw.
+constexpr size_t MaxUploadPoints = 2000000;
+
+}; //namespace
+
+const std::string PointOctreeRenderer::vertexShader = std::string( R"(
+#version 430 core
+
+layout(location = 0) in vec3 point; // offset from the node center.
+
+layout(std430, binding = 0) readonly buffer SlotCenters {
+    vec4 slotCenters[];
+};
+
+uniform mat4 view;
+uniform vec4 color;
+uniform int  slotSize;
+
+out vec4 c;
+
+void main()
+{
+    vec3 center = slotCenters[gl_VertexID / slotSize].xyz;
+    gl_Position = view*vec4(center + point, 1.0f);
+    c = color;
+}
+)");
+
+const std::string PointOctreeRenderer::fragmentShader = std::string(R"(
+#version 430 core
+
+in vec4 c;
+out vec4 outColor;
+
+void main()
+{
+    outColor = c;
+}
+)");
+
+/**
+ * Creates a new PointOctreeRenderer.
+ *
+ * @param octree   octree to render.
+ * @param poolSize size of the GPU node pool, in points. The pool holds
+ *                 poolSize / octree->max_node_points() nodes. It should be
+ *                 significantly larger than the point budget (nodes are
+ *                 rarely full) to keep the visible nodes resident.
+ * @param color    color of the points.
+ */
+PointOctreeRenderer::Ptr PointOctreeRenderer::Create(const GLContext::Ptr& context,
+                                                     const PointOctree::ConstPtr& octree,
+                                                     size_t poolSize,
+                                                     const Color::RGBAf& color)
+{
+    return Ptr(new PointOctreeRenderer(context, octree, poolSize, color));
+}
+
+PointOctreeRenderer::PointOctreeRenderer(const GLContext::Ptr& context,
+                                         const PointOctree::ConstPtr& octree,
+                                         size_t poolSize,
+                                         const Color::RGBAf& color) :
+    Renderer(context, vertexShader, fragmentShader),
+    octree_(octree),
+    color_(color),
+    pointSize_(1.0f),
+    pointBudget_(4000000),
+    minNodeSize_(50.0f),
+    slotSize_(0),
+    frameIndex_(0),
+    residentCount_(0),
+    pendingCount_(0),
+    stop_(false),
+    drawnPoints_(0)
+{
+    if(!octree_) {
+        throw std::runtime_error("PointOctreeRenderer : no octree given.");
+    }
+    slotSize_ = octree_->max_node_points();
+    size_t slotCount = std::max<size_t>(1, poolSize / slotSize_);
+    pool_.resize(slotCount*slotSize_);
+    slotCenters_.resize(slotCount);
+
+    nodeSlots_.assign(octree_->node_count(), NoNode);
+    slotNodes_.assign(slotCount, NoNode);
+    slotLastUsed_.assign(slotCount, 0);
+    pending_.assign(octree_->node_count(), 0);
+
+    unsigned int loaderCount = std::max(1u, std::min(4u,
+        std::thread::hardware_concurrency() / 2));
+    for(unsigned int i = 0; i < loaderCount; i++) {
+        loaders_.emplace_back(&PointOctreeRenderer::load_nodes, this);
+    }
+}
+
+PointOctreeRenderer::~PointOctreeRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for(auto& loader : loaders_) {
+        loader.join();
+    }
+}
+
+void PointOctreeRenderer::set_color(const Color::RGBAf& color)
+{
+    color_.r = std::max(0.0f, std::min(1.0f, color.r));
+    color_.g = std::max(0.0f, std::min(1.0f, color.g));
+    color_.b = std::max(0.0f, std::min(1.0f, color.b));
+    color_.a = std::max(0.0f, std::min(1.0f, color.a));
+}
+
+void PointOctreeRenderer::set_point_size(float size)
+{
+    pointSize_ = std::max(1.0f, size);
+}
+
+/**
+ * Nodes with a projected bounding sphere radius below this size (in pixels)
+ * are not drawn. Lower values give denser (and more expensive) renders, up
+ * to the point budget.
+ */
+void PointOctreeRenderer::set_min_node_size(float pixels)
+{
+    minNodeSize_ = std::max(0.0f, pixels);
+}
+
+size_t PointOctreeRenderer::pending_node_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pendingCount_;
+}
+
+BoundingSphere PointOctreeRenderer::world_bounds() const
+{
+    return octree_->bounds().transformed(pose_.homogeneous_matrix());
+}
+
+/**
+ * Loader thread : reads the requested nodes from the octree file (this is
+ * where the file pages are read from the disk) into host buffers, which are
+ * uploaded to the node pool at the next draw.
+ */
+void PointOctreeRenderer::load_nodes()
+{
+    while(true) {
+        uint32_t node;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return stop_ || !requests_.empty(); });
+            if(stop_) return;
+            node = requests_.front();
+            requests_.pop_front();
+        }
+
+        LoadedNode loaded;
+        loaded.node = node;
+        const Point* points = octree_->points(node);
+        loaded.points.assign(points, points + octree_->node(node).pointCount);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        loaded_.push_back(std::move(loaded));
+    }
+}
+
+/**
+ * Returns a free slot of the node pool, evicting the least recently drawn
+ * node if the pool is full. Nodes drawn in the previous frame are not
+ * evicted (NoNode is returned if all the slots are in use).
+ */
+uint32_t PointOctreeRenderer::acquire_slot() const
+{
+    uint32_t oldest = NoNode;
+    for(uint32_t s = 0; s < slotNodes_.size(); s++) {
+        if(slotNodes_[s] == NoNode) {
+            return s;
+        }
+        if(oldest == NoNode || slotLastUsed_[s] < slotLastUsed_[oldest]) {
+            oldest = s;
+        }
+    }
+    if(oldest == NoNode || slotLastUsed_[oldest] + 1 >= frameIndex_) {
+        return NoNode;
+    }
+    nodeSlots_[slotNodes_[oldest]] = NoNode;
+    slotNodes_[oldest] = NoNode;
+    residentCount_--;
+    return oldest;
+}
+
+/**
+ * Uploads the nodes read by the loader threads since the last draw (at most
+ * MaxUploadPoints points per draw to bound the frame time, remaining nodes
+ * are uploaded at the next draws).
+ */
+void PointOctreeRenderer::upload_loaded_nodes() const
+{
+    std::vector<LoadedNode> loaded;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = 0, pointCount = 0;
+        while(count < loaded_.size() && pointCount < MaxUploadPoints) {
+            pointCount += loaded_[count].points.size();
+            pending_[loaded_[count].node] = 0;
+            count++;
+        }
+        pendingCount_ -= count;
+        loaded.insert(loaded.end(), std::make_move_iterator(loaded_.begin()),
+                      std::make_move_iterator(loaded_.begin() + count));
+        loaded_.erase(loaded_.begin(), loaded_.begin() + count);
+    }
+    if(loaded.size() == 0) return;
+
+    for(const auto& node : loaded) {
+        if(nodeSlots_[node.node] != NoNode) continue;
+        uint32_t slot = this->acquire_slot();
+        if(slot == NoNode) continue; // pool too small, will be requested again.
+        pool_.set_sub_data(slotSize_*slot, node.points.size(), node.points.data());
+        const float* center = octree_->node(node.node).center;
+        SlotCenter slotCenter = {center[0], center[1], center[2], 0.0f};
+        slotCenters_.set_sub_data(slot, 1, &slotCenter);
+        nodeSlots_[node.node] = slot;
+        slotNodes_[slot]      = node.node;
+        slotLastUsed_[slot]   = frameIndex_;
+        residentCount_++;
+    }
+}
+
+/**
+ * Selects the nodes to draw : visible nodes are traversed by decreasing
+ * projected size (radius of their bounding sphere in pixels) until the
+ * point budget is reached. The children of a node are traversed only if
+ * the node is resident. Visible non-resident nodes are collected in wanted_
+ * in priority order.
+ */
+void PointOctreeRenderer::select_nodes(const View::ConstPtr& view,
+                                       const Mat4& viewMatrix) const
+{
+    drawFirsts_.clear();
+    drawCounts_.clear();
+    wanted_.clear();
+    drawnPoints_ = 0;
+
+    Frustum frustum(viewMatrix);
+    Mat4 projection  = view->projection_matrix();
+    float pixelScale = 0.5f*view->screen_size().height*std::abs(projection(1,1));
+    bool perspective = projection(3,3) == 0.0f;
+    auto screen_size = [&](const BoundingSphere& bounds) {
+        float w = viewMatrix.row(3).head<3>().dot(bounds.center) + viewMatrix(3,3);
+        if(perspective) {
+            w -= bounds.radius;
+        }
+        if(w <= 1.0e-6f) {
+            // camera inside the bounding sphere.
+            return std::numeric_limits<float>::infinity();
+        }
+        return pixelScale*bounds.radius / w;
+    };
+
+    std::priority_queue<std::pair<float,uint32_t>> queue;
+    if(frustum.intersects(octree_->bounds())) {
+        queue.emplace(std::numeric_limits<float>::infinity(), 0);
+    }
+    while(!queue.empty()) {
+        uint32_t index = queue.top().second;
+        queue.pop();
+        const auto& node = octree_->node(index);
+        if(drawnPoints_ + node.pointCount > pointBudget_) {
+            break;
+        }
+
+        uint32_t slot = nodeSlots_[index];
+        if(slot == NoNode) {
+            if(wanted_.size() < MaxRequests) {
+                wanted_.push_back(index);
+            }
+            continue;
+        }
+        slotLastUsed_[slot] = frameIndex_;
+        drawFirsts_.push_back(slotSize_*slot);
+        drawCounts_.push_back(node.pointCount);
+        drawnPoints_ += node.pointCount;
+
+        for(uint32_t c = 0; c < node.childCount; c++) {
+            BoundingSphere bounds = octree_->node_bounds(node.firstChild + c);
+            if(!frustum.intersects(bounds)) continue;
+            float size = screen_size(bounds);
+            if(size < minNodeSize_) continue;
+            queue.emplace(size, node.firstChild + c);
+        }
+    }
+}
+
+/**
+ * Replaces the pending requests of the loader threads by the nodes wanted
+ * in the last draw (nodes already being loaded are not requested again).
+ * No more nodes than the number of slots which can be evicted are requested,
+ * so nodes are not read again and again when the pool is full.
+ */
+void PointOctreeRenderer::request_nodes() const
+{
+    size_t available = 0;
+    for(uint32_t s = 0; s < slotNodes_.size(); s++) {
+        if(slotNodes_[s] == NoNode || slotLastUsed_[s] < frameIndex_) {
+            available++;
+        }
+    }
+    if(wanted_.size() > available) {
+        wanted_.resize(available);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto node : requests_) {
+            pending_[node] = 0;
+        }
+        pendingCount_ -= requests_.size();
+        requests_.clear();
+        for(auto node : wanted_) {
+            if(pending_[node]) continue;
+            pending_[node] = 1;
+            pendingCount_++;
+            requests_.push_back(node);
+        }
+    }
+    condition_.notify_all();
+}
+
+void PointOctreeRenderer::draw(const View::ConstPtr& view) const
+{
+    frameIndex_++;
+    this->upload_loaded_nodes();
+
+    Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
+    this->select_nodes(view, viewMatrix);
+    this->request_nodes();
+    if(drawCounts_.size() == 0) return;
+
+    glUseProgram(renderProgram_);
+
+    pool_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+
+    glUniformMatrix4fv(glGetUniformLocation(renderProgram_, "view"),
+        1, GL_FALSE, viewMatrix.data());
+    glUniform4fv(glGetUniformLocation(renderProgram_, "color"),
+        1, reinterpret_cast<const float*>(&color_));
+    glUniform1i(glGetUniformLocation(renderProgram_, "slotSize"), slotSize_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, slotCenters_.gl_id());
+
+    glPointSize(pointSize_);
+    glMultiDrawArrays(GL_POINTS, drawFirsts_.data(), drawCounts_.data(),
+                      drawCounts_.size());
+    glPointSize(1.0f);
+
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+    glUseProgram(0);
+}
+
+}; //namespace display
+}; //namespace rtac
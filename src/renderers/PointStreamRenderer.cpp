@@ -0,0 +1,322 @@
+#include <rtac_display/renderers/PointStreamRenderer.h>
+
+#include <limits>
+
+namespace rtac { namespace display {
+
+/**
+ * Points older than fadeDuration are moved outside of the clip volume.
+ */
+const std::string PointStreamRenderer::vertexShader = std::string( R"(
+#version 430 core
+
+layout(location = 0) in vec3  point;
+layout(location = 1) in float stamp;
+
+uniform mat4  view;
+uniform vec4  color;
+uniform float now;
+uniform float fadeDuration;
+
+out vec4 c;
+
+void main()
+{
+    gl_Position = view*vec4(point, 1.0f);
+    float alpha = 1.0f;
+    if(fadeDuration > 0.0f) {
+        alpha = 1.0f - (now - stamp) / fadeDuration;
+        if(alpha <= 0.0f) {
+            gl_Position = vec4(0.0f, 0.0f, 2.0f, 1.0f);
+        }
+    }
+    c = vec4(color.rgb, color.a*clamp(alpha, 0.0f, 1.0f));
+}
+)");
+
+const std::string PointStreamRenderer::fragmentShader = std::string(R"(
+#version 430 core
+
+in vec4 c;
+out vec4 outColor;
+
+void main()
+{
+    outColor = c;
+}
+)");
+
+/**
+ * Creates a new PointStreamRenderer.
+ *
+ * @param capacity maximum number of points displayed (size of the ring
+ *                 buffer).
+ * @param color    color of the points.
+ */
+PointStreamRenderer::Ptr PointStreamRenderer::Create(const GLContext::Ptr& context,
+                                                     size_t capacity,
+                                                     const Color::RGBAf& color)
+{
+    return Ptr(new PointStreamRenderer(context, capacity, color));
+}
+
+PointStreamRenderer::PointStreamRenderer(const GLContext::Ptr& context,
+                                         size_t capacity,
+                                         const Color::RGBAf& color) :
+    Renderer(context, vertexShader, fragmentShader),
+    capacity_(0),
+    pushed_(0),
+    first_(0),
+    hasTimeOrigin_(false),
+    timeOrigin_(0.0),
+    currentTime_(-std::numeric_limits<double>::infinity()),
+    fadeDuration_(0.0f),
+    color_(color),
+    pointSize_(1.0f)
+{
+    this->set_capacity(capacity);
+}
+
+/**
+ * Sets the size of the ring buffer (clears the displayed points).
+ */
+void PointStreamRenderer::set_capacity(size_t capacity)
+{
+    capacity_ = std::max<size_t>(1, capacity);
+    points_.resize(capacity_);
+    stamps_.resize(capacity_);
+    this->clear();
+}
+
+void PointStreamRenderer::clear()
+{
+    pushed_ = 0;
+    first_  = 0;
+    batches_.clear();
+    hasTimeOrigin_ = false;
+    currentTime_   = -std::numeric_limits<double>::infinity();
+}
+
+/**
+ * Computes where a batch of count points is written in the ring buffer (one
+ * range, or two if the batch wraps around the end of the buffer). If the
+ * batch is larger than the buffer, only its last points are written.
+ */
+unsigned int PointStreamRenderer::next_ranges(size_t count, Range* ranges)
+{
+    size_t skip  = count > capacity_ ? count - capacity_ : 0;
+    size_t start = (pushed_ + skip) % capacity_;
+    size_t n     = count - skip;
+
+    ranges[0] = Range({start, skip, std::min(n, capacity_ - start)});
+    if(ranges[0].count == n) {
+        return 1;
+    }
+    ranges[1] = Range({0, skip + ranges[0].count, n - ranges[0].count});
+    return 2;
+}
+
+/**
+ * Stamps are stored in single precision on the device, relative to the
+ * first stamp received since the last clear (keeps a ~1ms resolution for
+ * streams lasting hours, whatever the time origin of the stamps).
+ */
+const float* PointStreamRenderer::relative_stamps(size_t count, const double* stamps)
+{
+    if(!hasTimeOrigin_) {
+        timeOrigin_    = stamps[0];
+        hasTimeOrigin_ = true;
+    }
+    stampBuffer_.resize(count);
+    for(size_t i = 0; i < count; i++) {
+        stampBuffer_[i] = stamps[i] - timeOrigin_;
+    }
+    return stampBuffer_.data();
+}
+
+void PointStreamRenderer::end_batch(size_t count, double stamp)
+{
+    pushed_ += count;
+    first_   = std::max(first_, pushed_ - std::min(pushed_, capacity_));
+    batches_.push_back(Batch({pushed_, stamp}));
+    currentTime_ = std::max(currentTime_, stamp);
+    this->expire();
+}
+
+/**
+ * Drops the oldest batches, either overwritten by newer points or older
+ * than the fade duration.
+ */
+void PointStreamRenderer::expire()
+{
+    while(!batches_.empty()) {
+        const auto& batch = batches_.front();
+        if(batch.end > first_ && !(fadeDuration_ > 0.0f
+                                   && batch.stamp < currentTime_ - fadeDuration_)) {
+            break;
+        }
+        first_ = std::max(first_, batch.end);
+        batches_.pop_front();
+    }
+}
+
+/**
+ * Appends a batch of points from host memory, all with the same time stamp
+ * (in seconds, any time origin).
+ */
+void PointStreamRenderer::push_points(size_t count, const Point* points, double stamp)
+{
+    if(count == 0) return;
+
+    Range ranges[2];
+    unsigned int rangeCount = this->next_ranges(count, ranges);
+    if(!hasTimeOrigin_) {
+        timeOrigin_    = stamp;
+        hasTimeOrigin_ = true;
+    }
+    stampBuffer_.assign(count - ranges[0].src, stamp - timeOrigin_);
+    for(unsigned int i = 0; i < rangeCount; i++) {
+        points_.set_sub_data(ranges[i].dst, ranges[i].count, points + ranges[i].src);
+        stamps_.set_sub_data(ranges[i].dst, ranges[i].count,
+                             stampBuffer_.data() + ranges[i].src - ranges[0].src);
+    }
+    this->end_batch(count, stamp);
+}
+
+/**
+ * Appends a batch of points from host memory with a time stamp for each
+ * point (in seconds, any time origin).
+ */
+void PointStreamRenderer::push_points(size_t count, const Point* points,
+                                      const double* stamps)
+{
+    if(count == 0) return;
+
+    Range ranges[2];
+    unsigned int rangeCount = this->next_ranges(count, ranges);
+    const float* relative = this->relative_stamps(count - ranges[0].src,
+                                                  stamps + ranges[0].src);
+    double newest = stamps[0];
+    for(size_t i = 0; i < count; i++) {
+        newest = std::max(newest, stamps[i]);
+    }
+    for(unsigned int i = 0; i < rangeCount; i++) {
+        points_.set_sub_data(ranges[i].dst, ranges[i].count, points + ranges[i].src);
+        stamps_.set_sub_data(ranges[i].dst, ranges[i].count,
+                             relative + ranges[i].src - ranges[0].src);
+    }
+    this->end_batch(count, newest);
+}
+
+/**
+ * Appends a batch of points already on the device (device to device copy).
+ */
+void PointStreamRenderer::push_points(const GLVector<Point>& points, double stamp)
+{
+    size_t count = points.size();
+    if(count == 0) return;
+
+    Range ranges[2];
+    unsigned int rangeCount = this->next_ranges(count, ranges);
+    if(!hasTimeOrigin_) {
+        timeOrigin_    = stamp;
+        hasTimeOrigin_ = true;
+    }
+    stampBuffer_.assign(count - ranges[0].src, stamp - timeOrigin_);
+    for(unsigned int i = 0; i < rangeCount; i++) {
+        points_.copy_sub_data(ranges[i].dst, points, ranges[i].src, ranges[i].count);
+        stamps_.set_sub_data(ranges[i].dst, ranges[i].count,
+                             stampBuffer_.data() + ranges[i].src - ranges[0].src);
+    }
+    this->end_batch(count, stamp);
+}
+
+/**
+ * Sets the current time used for the fade out (by default the newest stamp
+ * received). Allows points to keep fading between two batches.
+ */
+void PointStreamRenderer::set_current_time(double time)
+{
+    currentTime_ = time;
+    this->expire();
+}
+
+/**
+ * Points fade out linearly with their age and are removed once older than
+ * seconds. 0 disables the fade out (points are only removed when
+ * overwritten).
+ */
+void PointStreamRenderer::set_fade_duration(float seconds)
+{
+    fadeDuration_ = std::max(0.0f, seconds);
+    this->expire();
+}
+
+void PointStreamRenderer::set_color(const Color::RGBAf& color)
+{
+    color_.r = std::max(0.0f, std::min(1.0f, color.r));
+    color_.g = std::max(0.0f, std::min(1.0f, color.g));
+    color_.b = std::max(0.0f, std::min(1.0f, color.b));
+    color_.a = std::max(0.0f, std::min(1.0f, color.a));
+}
+
+void PointStreamRenderer::set_point_size(float size)
+{
+    pointSize_ = std::max(1.0f, size);
+}
+
+void PointStreamRenderer::draw(const View::ConstPtr& view) const
+{
+    size_t count = this->size();
+    if(count == 0) return;
+
+    // live points are [first_, pushed_), at most two ranges in the ring.
+    GLint   firsts[2];
+    GLsizei counts[2];
+    GLsizei rangeCount = 1;
+    firsts[0] = first_ % capacity_;
+    counts[0] = std::min(count, capacity_ - firsts[0]);
+    if((size_t)counts[0] < count) {
+        firsts[1] = 0;
+        counts[1] = count - counts[0];
+        rangeCount = 2;
+    }
+
+    glUseProgram(renderProgram_);
+
+    points_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+    stamps_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(1);
+
+    Mat4 viewMatrix = view->view_matrix()*pose_.homogeneous_matrix();
+    glUniformMatrix4fv(glGetUniformLocation(renderProgram_, "view"),
+        1, GL_FALSE, viewMatrix.data());
+    glUniform4fv(glGetUniformLocation(renderProgram_, "color"),
+        1, reinterpret_cast<const float*>(&color_));
+    glUniform1f(glGetUniformLocation(renderProgram_, "now"),
+                currentTime_ - timeOrigin_);
+    glUniform1f(glGetUniformLocation(renderProgram_, "fadeDuration"), fadeDuration_);
+
+    if(fadeDuration_ > 0.0f) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    glPointSize(pointSize_);
+    glMultiDrawArrays(GL_POINTS, firsts, counts, rangeCount);
+    glPointSize(1.0f);
+    if(fadeDuration_ > 0.0f) {
+        glDisable(GL_BLEND);
+    }
+
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(0);
+}
+
+}; //namespace display
+}; //namespace rtac
@@ -121,6 +121,17 @@ void Renderer::draw(const View::ConstPtr& view) const
     glLineWidth(lineWidth);
 }
 
+/**
+ * Bounding volume of the drawn object in world coordinates, used by
+ * DrawingSurface to skip renderers outside of the view frustum. The default
+ * is an infinite sphere (never culled). Subclasses drawing a bounded object
+ * should reimplement this.
+ */
+BoundingSphere Renderer::world_bounds() const
+{
+    return BoundingSphere::Infinite();
+}
+
 }; //namespace display
 }; //namespace rtac
 
@@ -0,0 +1,302 @@
+#include <rtac_display/renderers/WaterfallRenderer.h>
+
+namespace rtac { namespace display {
+
+/**
+ * Fan with persistence : the displayed value is the maximum over the last
+ * pings of the normalized ping value weighted by decay^age.
+ */
+const std::string& WaterfallRenderer::fragmentShaderHistory = std::string(R"(
+#version 430 core
+
+in      vec2 xyPos;
+uniform sampler2DArray history;
+uniform sampler2D colormap;
+uniform sampler2D lookupTable;
+
+uniform vec2  valueScaling;
+uniform vec4  lookupBounds;
+uniform int   newest;
+uniform int   layerCount;
+uniform int   pingCount;
+uniform int   persistence;
+uniform float decay;
+
+out vec4 outColor;
+
+void main()
+{
+    vec2 normalized = texture(lookupTable, (xyPos - lookupBounds.xy)
+                                         / (lookupBounds.zw - lookupBounds.xy)).xy;
+    if(normalized.x < 0.0f) {
+        discard;
+    }
+    if(pingCount == 0) {
+        outColor = texture(colormap, vec2(0.0f,0.0f));
+        return;
+    }
+
+    float value  = 0.0f;
+    float weight = 1.0f;
+    int   count  = min(persistence, pingCount);
+    for(int age = 0; age < count; age++) {
+        int layer = (newest - age + layerCount) % layerCount;
+        float v = valueScaling.x*texture(history, vec3(normalized, layer)).x
+                + valueScaling.y;
+        value   = max(value, weight*clamp(v, 0.0f, 1.0f));
+        weight *= decay;
+    }
+    outColor = texture(colormap, vec2(value, 0.0f));
+}
+)");
+
+/**
+ * Full viewport quad (4 vertices triangle strip).
+ */
+const std::string& WaterfallRenderer::vertexShaderWaterfall = std::string(R"(
+#version 430 core
+
+out vec2 uv;
+
+void main()
+{
+    uv = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = vec4(2.0f*uv - 1.0f, 0.0f, 1.0f);
+}
+)");
+
+/**
+ * Waterfall : range along the horizontal axis, one row per ping with the
+ * most recent ping on top.
+ */
+const std::string& WaterfallRenderer::fragmentShaderWaterfall = std::string(R"(
+#version 430 core
+
+in vec2 uv;
+uniform sampler2DArray history;
+uniform sampler2D colormap;
+
+uniform vec2  valueScaling;
+uniform int   newest;
+uniform int   layerCount;
+uniform int   pingCount;
+uniform float bearing;
+
+out vec4 outColor;
+
+void main()
+{
+    int age = min(int((1.0f - uv.y)*layerCount), layerCount - 1);
+    if(age >= pingCount) {
+        outColor = texture(colormap, vec2(0.0f,0.0f));
+        return;
+    }
+    int layer = (newest - age + layerCount) % layerCount;
+    float value = valueScaling.x*texture(history, vec3(bearing, uv.x, layer)).x
+                + valueScaling.y;
+    outColor = texture(colormap, vec2(value, 0.0f));
+}
+)");
+
+WaterfallRenderer::WaterfallRenderer(const GLContext::Ptr& context,
+                                     unsigned int historySize) :
+    FanRenderer(context),
+    history_(GLTextureArray::New()),
+    historySize_(std::max(1u, historySize)),
+    newest_(0),
+    pingCount_(0),
+    mode_(Mode::Fan),
+    decay_(0.8f),
+    persistence_(1),
+    waterfallBearing_(0.5f),
+    historyProgram_(create_render_program(vertexShader, fragmentShaderHistory)),
+    waterfallProgram_(create_render_program(vertexShaderWaterfall,
+                                            fragmentShaderWaterfall))
+{
+    this->enable_lookup_table();
+}
+
+WaterfallRenderer::Ptr WaterfallRenderer::Create(const GLContext::Ptr& context,
+                                                 unsigned int historySize)
+{
+    return Ptr(new WaterfallRenderer(context, historySize));
+}
+
+/**
+ * Returns the ring buffer layer where to write a new ping. The history is
+ * reallocated (and cleared) if the ping shape changed.
+ */
+unsigned int WaterfallRenderer::next_layer(const Shape& shape)
+{
+    if(history_->width()  != shape.width
+    || history_->height() != shape.height
+    || history_->depth()  != historySize_)
+    {
+        history_->resize<float>(shape, historySize_);
+        pingCount_ = 0;
+        newest_    = historySize_ - 1;
+    }
+    newest_    = (newest_ + 1) % historySize_;
+    pingCount_ = std::min(pingCount_ + 1, historySize_);
+    return newest_;
+}
+
+/**
+ * Adds a ping from host memory. Only this ping is uploaded.
+ *
+ * If computeScale is true, the ping is uploaded in a device buffer first so
+ * that its value range is computed on the GPU (see FanRenderer::compute_scale),
+ * then copied to the history.
+ */
+void WaterfallRenderer::push_ping(const Shape& shape, const float* data,
+                                  bool computeScale)
+{
+    if(!computeScale) {
+        history_->set_layer(this->next_layer(shape), data);
+        return;
+    }
+    pingBuffer_.set_data(shape.area(), data);
+    this->push_ping(shape, pingBuffer_, true);
+}
+
+/**
+ * Adds a ping from device memory (device to device copy of this ping only).
+ */
+void WaterfallRenderer::push_ping(const Shape& shape, const GLVector<float>& data,
+                                  bool computeScale)
+{
+    history_->set_layer(this->next_layer(shape), data);
+    if(computeScale)
+        this->compute_scale(data);
+}
+
+void WaterfallRenderer::clear_history()
+{
+    pingCount_ = 0;
+}
+
+/**
+ * Sets the number of pings kept in the history (clears the history).
+ */
+void WaterfallRenderer::set_history_size(unsigned int size)
+{
+    historySize_ = std::max(1u, size);
+    if(history_->depth() > 0) {
+        history_->resize<float>(history_->shape(), historySize_);
+    }
+    pingCount_ = 0;
+    newest_    = historySize_ - 1;
+}
+
+/**
+ * Persistence of past fans in Mode::Fan.
+ *
+ * @param decay       weight factor applied to a ping at each new ping (in
+ *                    [0,1]).
+ * @param persistence number of pings blended (1 displays the last ping only).
+ */
+void WaterfallRenderer::set_decay(float decay, unsigned int persistence)
+{
+    decay_       = std::max(0.0f, std::min(1.0f, decay));
+    persistence_ = std::max(1u, persistence);
+}
+
+/**
+ * Bearing displayed in Mode::Waterfall, normalized in [0,1] along the ping
+ * bearing dimension (irrelevant for single beam pings).
+ */
+void WaterfallRenderer::set_waterfall_bearing(float normalizedBearing)
+{
+    waterfallBearing_ = std::max(0.0f, std::min(1.0f, normalizedBearing));
+}
+
+void WaterfallRenderer::draw(const View::ConstPtr& view) const
+{
+    if(mode_ == Mode::Waterfall) {
+        this->draw_waterfall(view);
+    }
+    else {
+        this->draw_fan(view);
+    }
+}
+
+void WaterfallRenderer::draw_fan(const View::ConstPtr& view) const
+{
+    Mat4 mat = this->compute_view(view->screen_size());
+    this->update_lookup_table(view->screen_size());
+
+    glUseProgram(historyProgram_);
+
+    corners_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+
+    glUniformMatrix4fv(glGetUniformLocation(historyProgram_, "view"),
+        1, GL_FALSE, mat.data());
+
+    glUniform2f(glGetUniformLocation(historyProgram_, "valueScaling"),
+                1.0f / (valueRange_.max - valueRange_.min),
+               -valueRange_.min / (valueRange_.max - valueRange_.min));
+    glUniform4f(glGetUniformLocation(historyProgram_, "lookupBounds"),
+                bounds_.left, bounds_.bottom, bounds_.right, bounds_.top);
+    glUniform1i(glGetUniformLocation(historyProgram_, "newest"),      newest_);
+    glUniform1i(glGetUniformLocation(historyProgram_, "layerCount"),  historySize_);
+    glUniform1i(glGetUniformLocation(historyProgram_, "pingCount"),   pingCount_);
+    glUniform1i(glGetUniformLocation(historyProgram_, "persistence"), persistence_);
+    glUniform1f(glGetUniformLocation(historyProgram_, "decay"),       decay_);
+
+    glUniform1i(glGetUniformLocation(historyProgram_, "history"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    history_->bind(GL_TEXTURE_2D_ARRAY);
+
+    glUniform1i(glGetUniformLocation(historyProgram_, "colormap"), 1);
+    glActiveTexture(GL_TEXTURE1);
+    colormap_->texture().bind(GL_TEXTURE_2D);
+
+    glUniform1i(glGetUniformLocation(historyProgram_, "lookupTable"), 2);
+    glActiveTexture(GL_TEXTURE2);
+    lookupTable_->bind(GL_TEXTURE_2D);
+
+    glDrawArrays(GL_TRIANGLES, 0, corners_.size());
+
+    glDisableVertexAttribArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glUseProgram(0);
+
+    GL_CHECK_LAST();
+}
+
+void WaterfallRenderer::draw_waterfall(const View::ConstPtr& view) const
+{
+    glUseProgram(waterfallProgram_);
+
+    glUniform2f(glGetUniformLocation(waterfallProgram_, "valueScaling"),
+                1.0f / (valueRange_.max - valueRange_.min),
+               -valueRange_.min / (valueRange_.max - valueRange_.min));
+    glUniform1i(glGetUniformLocation(waterfallProgram_, "newest"),     newest_);
+    glUniform1i(glGetUniformLocation(waterfallProgram_, "layerCount"), historySize_);
+    glUniform1i(glGetUniformLocation(waterfallProgram_, "pingCount"),  pingCount_);
+    glUniform1f(glGetUniformLocation(waterfallProgram_, "bearing"),    waterfallBearing_);
+
+    glUniform1i(glGetUniformLocation(waterfallProgram_, "history"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    history_->bind(GL_TEXTURE_2D_ARRAY);
+
+    glUniform1i(glGetUniformLocation(waterfallProgram_, "colormap"), 1);
+    glActiveTexture(GL_TEXTURE1);
+    colormap_->texture().bind(GL_TEXTURE_2D);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glUseProgram(0);
+
+    GL_CHECK_LAST();
+}
+
+}; //namespace display
+}; //namespace rtac
@@ -1,5 +1,8 @@
 #include <rtac_display/text/FontFace.h>
 
+#include <cstring>
+#include <cmath>
+
 namespace rtac { namespace display { namespace text {
 
 FontFace::FontFace(const std::string& fontFilename,
@@ -7,7 +10,10 @@ FontFace::FontFace(const std::string& fontFilename,
                    const Library::Ptr& ftLibrary,
                    FT_Render_Mode renderMode) :
     ft_(ftLibrary),
-    renderMode_(renderMode)
+    renderMode_(renderMode),
+    distanceFieldSpread_(0),
+    cacheBudget_(DefaultCacheBudget),
+    generation_(0)
 {
     if(FT_New_Face(*ft_, fontFilename.c_str(), faceIndex, &face_)) {
         std::ostringstream oss;
@@ -59,35 +65,357 @@ void FontFace::set_pixel_size(FT_UInt size)
     this->load_glyphs();
 }
 
+/**
+ * Switches the face to signed distance field glyphs.
+ *
+ * Glyphs are rasterized once at rasterSize pixels and converted to a signed
+ * distance field stored in the atlas. The atlas can then be sampled with
+ * linear filtering and rendered crisp at any scale (see
+ * TextRenderer::set_text_size and TextRenderer::set_world_size), and supports
+ * outline and halo effects. There is no need to reload the font (or to create
+ * several FontFace) to display text at different sizes.
+ *
+ * @param rasterSize pixel size of the rasterized glyphs. Text is still crisp
+ *                   when magnified several times this size.
+ * @param spread     maximum encoded distance to a glyph contour (in raster
+ *                   pixels). Limits the maximum outline + halo width.
+ */
+void FontFace::enable_distance_field(FT_UInt rasterSize, unsigned int spread)
+{
+    if(spread == 0) {
+        throw std::runtime_error(
+            "FontFace::enable_distance_field : spread must be at least 1");
+    }
+    renderMode_          = FT_RENDER_MODE_NORMAL;
+    distanceFieldSpread_ = spread;
+    this->set_pixel_size(rasterSize);
+}
+
+/**
+ * Squared euclidean distance transform of a 1D sampled function
+ * (Felzenszwalb & Huttenlocher). v and z are scratch buffers of size n and
+ * n + 1.
+ */
+static void distance_transform_1d(float* f, unsigned int n, unsigned int stride,
+                                  float* d, int* v, float* z)
+{
+    static constexpr float Inf = 1.0e20f;
+    int k = 0;
+    v[0] = 0;
+    z[0] = -Inf;
+    z[1] =  Inf;
+    for(int q = 1; q < (int)n; q++) {
+        float s = ((f[q*stride] + q*q) - (f[v[k]*stride] + v[k]*v[k]))
+                / (2*q - 2*v[k]);
+        while(s <= z[k]) {
+            k--;
+            s = ((f[q*stride] + q*q) - (f[v[k]*stride] + v[k]*v[k]))
+              / (2*q - 2*v[k]);
+        }
+        k++;
+        v[k]   = q;
+        z[k]   = s;
+        z[k+1] = Inf;
+    }
+    k = 0;
+    for(int q = 0; q < (int)n; q++) {
+        while(z[k+1] < q) k++;
+        d[q] = (q - v[k])*(q - v[k]) + f[v[k]*stride];
+    }
+    for(unsigned int q = 0; q < n; q++) {
+        f[q*stride] = d[q];
+    }
+}
+
+/**
+ * In-place squared euclidean distance transform of a W x H grid (grid values
+ * must be 0 on seed pixels and a large value elsewhere).
+ */
+static void distance_transform_2d(std::vector<float>& grid, unsigned int W, unsigned int H)
+{
+    unsigned int N = std::max(W,H);
+    std::vector<float> d(N);
+    std::vector<int>   v(N);
+    std::vector<float> z(N + 1);
+    for(unsigned int w = 0; w < W; w++) {
+        distance_transform_1d(grid.data() + w, H, W, d.data(), v.data(), z.data());
+    }
+    for(unsigned int h = 0; h < H; h++) {
+        distance_transform_1d(grid.data() + W*h, W, 1, d.data(), v.data(), z.data());
+    }
+}
+
+/**
+ * Converts a rendered grayscale glyph into a signed distance field and
+ * uploads it into the atlas.
+ *
+ * The field is encoded on 8 bits : 128 is the glyph contour, 255 is spread
+ * pixels inside the glyph, 0 spread pixels outside. The bitmap is padded by
+ * spread pixels on each side.
+ */
+Rect FontFace::add_distance_field_to_atlas(FT_GlyphSlot glyph, unsigned int slot) const
+{
+    static constexpr float Inf = 1.0e20f;
+
+    const FT_Bitmap& bitmap = glyph->bitmap;
+    if(bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+        std::ostringstream oss;
+        oss << "FontFace::add_distance_field_to_atlas error : pixel type "
+            << (int)bitmap.pixel_mode << " not implemented.";
+        throw std::runtime_error(oss.str());
+    }
+    if(bitmap.width == 0 || bitmap.rows == 0) {
+        return atlas_.set(slot, {0,0}, nullptr);
+    }
+
+    unsigned int S = distanceFieldSpread_;
+    unsigned int W = bitmap.width + 2*S;
+    unsigned int H = bitmap.rows  + 2*S;
+
+    // distance to inside pixels and distance to outside pixels.
+    std::vector<float> toInside(W*H, Inf);
+    std::vector<float> toOutside(W*H, 0.0f);
+    for(unsigned int h = 0; h < bitmap.rows; h++) {
+        for(unsigned int w = 0; w < bitmap.width; w++) {
+            if(bitmap.buffer[bitmap.pitch*h + w] > 127) {
+                toInside [W*(h + S) + w + S] = 0.0f;
+                toOutside[W*(h + S) + w + S] = Inf;
+            }
+        }
+    }
+    distance_transform_2d(toInside,  W, H);
+    distance_transform_2d(toOutside, W, H);
+
+    bitmapData_.resize(W*H);
+    float scale = 127.0f / S;
+    for(unsigned int i = 0; i < W*H; i++) {
+        float d = std::sqrt(toOutside[i]) - std::sqrt(toInside[i]);
+        bitmapData_[i] = (uint8_t)std::max(0.0f, std::min(255.0f,
+                                           std::round(128.0f + scale*d)));
+    }
+
+    return atlas_.set(slot, {W,H}, bitmapData_.data());
+}
+
+/**
+ * Size of a GlyphAtlas cell large enough to hold any glyph of the face at its
+ * current size.
+ */
+Shape FontFace::glyph_cell_shape() const
+{
+    const auto& metrics = face_->size->metrics;
+    float width  = metrics.max_advance / 64.0f;
+    float height = metrics.height      / 64.0f;
+    if(FT_IS_SCALABLE(face_)) {
+        width  = std::max(width,  FT_MulFix(face_->bbox.xMax - face_->bbox.xMin,
+                                            metrics.x_scale) / 64.0f);
+        height = std::max(height, FT_MulFix(face_->bbox.yMax - face_->bbox.yMin,
+                                            metrics.y_scale) / 64.0f);
+    }
+    // The LCD filter widens glyph bitmaps by one pixel on each side.
+    // Distance field bitmaps are padded by the spread on each side.
+    size_t margin = 2 + 2*GlyphAtlas::Padding + 2*distanceFieldSpread_;
+    return Shape({(size_t)std::ceil(width)  + margin,
+                  (size_t)std::ceil(height) + margin});
+}
+
+/**
+ * Uploads the bitmap of a rendered glyph into the atlas.
+ *
+ * @param slot atlas cell to write to (see GlyphAtlas::set).
+ *
+ * @return the location of the glyph bitmap in the atlas.
+ */
+Rect FontFace::add_to_atlas(FT_GlyphSlot glyph, unsigned int slot) const
+{
+    const FT_Bitmap& bitmap = glyph->bitmap;
+    switch(bitmap.pixel_mode) {
+        default: {
+            std::ostringstream oss;
+            oss << "FontFace::add_to_atlas error : pixel type "
+                << (int)bitmap.pixel_mode << " not implemented.";
+            throw std::runtime_error(oss.str());
+            }
+            break;
+        case FT_PIXEL_MODE_GRAY: {
+            unsigned int W = bitmap.width;
+            unsigned int H = bitmap.rows;
+            if(bitmap.pitch == (int)W) {
+                return atlas_.set(slot, {W,H}, bitmap.buffer);
+            }
+            bitmapData_.resize(W*H);
+            auto itIn = bitmap.buffer;
+            for(unsigned int h = 0; h < H; h++) {
+                std::memcpy(bitmapData_.data() + W*h, itIn, W);
+                itIn += bitmap.pitch;
+            }
+            return atlas_.set(slot, {W,H}, bitmapData_.data());
+            }
+            break;
+        case FT_PIXEL_MODE_LCD: {
+            unsigned int W = bitmap.width / 3;
+            unsigned int H = bitmap.rows;
+            bitmapData_.resize(4*W*H);
+            auto itIn  = bitmap.buffer;
+            auto itOut = bitmapData_.begin();
+            for(unsigned int h = 0; h < H; h++) {
+                for(unsigned int w = 0; w < W; w++) {
+                    *(itOut++) = itIn[3*w];
+                    *(itOut++) = itIn[3*w + 1];
+                    *(itOut++) = itIn[3*w + 2];
+                    *(itOut++) = 255;
+                }
+                itIn += bitmap.pitch;
+            }
+            return atlas_.set(slot, {W,H}, bitmapData_.data());
+            }
+            break;
+    }
+}
+
+/**
+ * Clears the glyph cache and resizes the atlas for the current font size.
+ *
+ * Glyphs are not rasterized here but on first use (see FontFace::glyph).
+ * Called automatically when the font size changes.
+ */
 void FontFace::load_glyphs()
 {
     glyphs_.clear();
+    cacheEntries_.clear();
+    lru_.clear();
     if(FT_Library_SetLcdFilter(*ft_, FT_LCD_FILTER_DEFAULT)) {
         throw std::runtime_error("Subpixel rendering is disabled");
     }
-    for(uint8_t c = 0; c < 128; c++) {
-        //if(FT_Load_Char(face_, c, FT_LOAD_DEFAULT)) {
-        if(FT_Load_Char(face_, c, FT_LOAD_FORCE_AUTOHINT)) {
-            std::cerr << "rtac_display error : failed to load glyph '"
-                      << c << "'" << std::endl;
-        }
-        if(FT_Render_Glyph(face_->glyph, renderMode_)) {
-            std::cerr << "rtac_display error : failed to render glyph '"
-                      << c << "'" << std::endl;
-        }
+    if(this->is_distance_field()) {
+        atlas_.reset(this->glyph_cell_shape(), 1, 128, GLTexture::Linear);
+    }
+    else {
+        atlas_.reset(this->glyph_cell_shape(),
+                     renderMode_ == FT_RENDER_MODE_LCD ? 4 : 1);
+    }
+    generation_++;
+}
+
+/**
+ * Maximum number of glyphs the cache can hold within its memory budget.
+ */
+unsigned int FontFace::cache_capacity() const
+{
+    Shape cell = atlas_.cell_shape();
+    size_t cellSize = std::max<size_t>(1, cell.area()*atlas_.channels());
+    return std::max<size_t>(GlyphAtlas::Columns, cacheBudget_ / cellSize);
+}
+
+/**
+ * Sets the maximum amount of atlas memory used by the glyph cache (in bytes).
+ *
+ * When the cache is full, the least recently used glyph is evicted and its
+ * atlas cell is reused. The budget should be large enough to hold all the
+ * distinct glyphs displayed at the same time. Otherwise glyphs are
+ * rasterized again on each frame.
+ */
+void FontFace::set_cache_budget(size_t bytes)
+{
+    cacheBudget_ = bytes;
+    // Evicting glyphs now if the new budget is smaller.
+    if(glyphs_.size() > this->cache_capacity()) {
+        this->load_glyphs();
+    }
+}
+
+size_t FontFace::cache_budget() const
+{
+    return cacheBudget_;
+}
+
+/**
+ * Generation of the glyph cache. Incremented each time a cached glyph is
+ * evicted or the cache is cleared (i.e. each time previously returned glyph
+ * atlas locations become invalid). A text layout must be recomputed if the
+ * generation changed since it was computed.
+ */
+uint64_t FontFace::generation() const
+{
+    return generation_;
+}
+
+/**
+ * Rasterizes a glyph and inserts it in the cache, evicting the least
+ * recently used glyph if the cache is full.
+ */
+const Glyph& FontFace::load_glyph(uint32_t codePoint) const
+{
+    if(FT_Load_Char(face_, codePoint, FT_LOAD_FORCE_AUTOHINT)) {
+        std::cerr << "rtac_display error : failed to load glyph U+"
+                  << std::hex << codePoint << std::dec
+                  << ". Using missing glyph." << std::endl;
+        FT_Load_Glyph(face_, 0, FT_LOAD_FORCE_AUTOHINT);
+    }
+    if(FT_Render_Glyph(face_->glyph, renderMode_)) {
+        std::cerr << "rtac_display error : failed to render glyph U+"
+                  << std::hex << codePoint << std::dec << std::endl;
+    }
+
+    unsigned int slot = atlas_.size();
+    if(glyphs_.size() >= this->cache_capacity()) {
+        uint32_t evicted = lru_.back();
+        slot = cacheEntries_.at(evicted).slot;
+        lru_.pop_back();
+        cacheEntries_.erase(evicted);
+        glyphs_.erase(evicted);
+        generation_++;
+    }
 
-        glyphs_.emplace(std::make_pair(c, Glyph(face_->glyph)));
+    auto res = glyphs_.emplace(std::make_pair(codePoint,
+        this->is_distance_field() ?
+            Glyph(face_->glyph, this->add_distance_field_to_atlas(face_->glyph, slot)) :
+            Glyph(face_->glyph, this->add_to_atlas(face_->glyph, slot))));
+    Glyph& glyph = res.first->second;
+    if(this->is_distance_field()) {
+        glyph.bearing_.x -= distanceFieldSpread_;
+        glyph.bearing_.y += distanceFieldSpread_;
     }
+
+    lru_.push_front(codePoint);
+    cacheEntries_.emplace(std::make_pair(codePoint,
+                                         CacheEntry({lru_.begin(), slot})));
+    return glyph;
 }
 
+/**
+ * @return the glyphs currently held in the cache.
+ */
 const FontFace::GlyphMap& FontFace::glyphs() const
 {
     return glyphs_;
 }
 
-const Glyph& FontFace::glyph(uint8_t c) const
+/**
+ * Returns the glyph of a unicode code point, rasterizing it into the atlas if
+ * it is not already cached. Characters not provided by the font are rendered
+ * with the font missing glyph.
+ *
+ * The returned reference is valid until the next call to glyph() or until
+ * the font size changes.
+ */
+const Glyph& FontFace::glyph(uint32_t codePoint) const
+{
+    auto it = cacheEntries_.find(codePoint);
+    if(it == cacheEntries_.end()) {
+        return this->load_glyph(codePoint);
+    }
+    // Marking the glyph as most recently used.
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return glyphs_.at(codePoint);
+}
+
+/**
+ * @return the atlas texture holding the bitmaps of all cached glyphs.
+ */
+const GlyphAtlas& FontFace::atlas() const
 {
-    return glyphs_.at(c);
+    return atlas_;
 }
 
 const FT_Face& FontFace::face() const
@@ -118,14 +446,48 @@ float FontFace::max_advance() const
     return face_->size->metrics.max_advance / 64.0f;
 }
 
+/**
+ * @return the nominal pixel size of the rasterized glyphs. All metrics
+ *         (advance, bearing, atlas bitmaps) are expressed at this size.
+ */
+float FontFace::pixel_size() const
+{
+    return face_->size->metrics.y_ppem;
+}
+
 FT_Render_Mode FontFace::render_mode() const
 {
     return renderMode_;
 }
 
-FT_Vector FontFace::get_kerning(char left, char right) const
+/**
+ * @return true if glyphs are stored as signed distance fields (see
+ *         FontFace::enable_distance_field).
+ */
+bool FontFace::is_distance_field() const
+{
+    return distanceFieldSpread_ > 0;
+}
+
+/**
+ * @return the maximum distance to a glyph contour encoded in the distance
+ *         field (in raster pixels).
+ */
+unsigned int FontFace::distance_field_spread() const
+{
+    return distanceFieldSpread_;
+}
+
+/**
+ * Kerning to apply between two consecutive characters (in 26.6 fixed point
+ * pixels, grid fitted). Null if the font has no kerning information.
+ */
+FT_Vector FontFace::get_kerning(uint32_t left, uint32_t right) const
 {
     FT_Vector kerning({0,0});
+    if(!FT_HAS_KERNING(face_)) {
+        return kerning;
+    }
 
     auto leftIndex  = FT_Get_Char_Index(face_, left);
     auto rightIndex = FT_Get_Char_Index(face_, right);
@@ -136,8 +498,9 @@ FT_Vector FontFace::get_kerning(char left, char right) const
 
     if(FT_Get_Kerning(face_, leftIndex, rightIndex,
                       FT_KERNING_DEFAULT, &kerning)) {
-        std::cerr << "Unable to get kerning info for ("
-                  << left << "," << right << ")" << std::endl;
+        std::cerr << "Unable to get kerning info for (U+"
+                  << std::hex << left << ",U+" << right << std::dec
+                  << ")" << std::endl;
         return kerning;
     }
 
@@ -147,4 +510,3 @@ FT_Vector FontFace::get_kerning(char left, char right) const
 }; //namespace text
 }; //namespace display
 }; //namespace rtac
-
@@ -0,0 +1,167 @@
+#include <rtac_display/text/GlyphAtlas.h>
+
+#include <vector>
+
+namespace rtac { namespace display { namespace text {
+
+GlyphAtlas::GlyphAtlas() :
+    filterMode_(GLTexture::Nearest),
+    cellShape_({0,0}),
+    channels_(1),
+    rows_(0),
+    slotCount_(0)
+{}
+
+/**
+ * Allocates an empty texture able to hold rows*Columns cells.
+ */
+void GlyphAtlas::allocate(GLTexture& texture, unsigned int rows) const
+{
+    Shape shape({Columns*cellShape_.width, rows*cellShape_.height});
+    switch(channels_) {
+        default: {
+            std::ostringstream oss;
+            oss << "GlyphAtlas error : unsupported channel count ("
+                << channels_ << ").";
+            throw std::runtime_error(oss.str());
+            }
+            break;
+        case 1:
+            texture.set_image(shape, GL_R8, GL_RED, GL_UNSIGNED_BYTE,
+                              (const uint8_t*)nullptr);
+            break;
+        case 4:
+            texture.set_image(shape, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE,
+                              (const uint8_t*)nullptr);
+            break;
+    }
+    texture.set_filter_mode(filterMode_);
+    texture.set_wrap_mode(GLTexture::ClampToEdge);
+    texture.unbind(GL_TEXTURE_2D);
+}
+
+/**
+ * Doubles the number of rows of the atlas. Already uploaded glyphs are copied
+ * on the device and keep their location.
+ */
+void GlyphAtlas::grow()
+{
+    GLTexture texture;
+    this->allocate(texture, 2*rows_);
+    glCopyImageSubData(texture_.gl_id(), GL_TEXTURE_2D, 0, 0, 0, 0,
+                       texture.gl_id(),  GL_TEXTURE_2D, 0, 0, 0, 0,
+                       texture_.width(), texture_.height(), 1);
+    GL_CHECK_LAST();
+
+    texture_ = std::move(texture);
+    rows_   *= 2;
+}
+
+/**
+ * Clears the atlas and reallocate it for a new cell size.
+ *
+ * @param cellShape    size of a cell in pixels (padding included).
+ * @param channels     number of 8-bit channels per pixel (1 for grayscale
+ *                     glyphs, 4 for subpixel (LCD) glyphs).
+ * @param capacityHint expected number of glyphs.
+ * @param filterMode   texture filtering (Nearest for bitmaps rendered at
+ *                     their native size, Linear for distance fields).
+ */
+void GlyphAtlas::reset(const Shape& cellShape, unsigned int channels,
+                       unsigned int capacityHint,
+                       GLTexture::FilterMode filterMode)
+{
+    filterMode_ = filterMode;
+    cellShape_  = cellShape;
+    channels_  = channels;
+    rows_      = std::max(1u, (capacityHint + Columns - 1) / Columns);
+    slotCount_ = 0;
+    this->allocate(texture_, rows_);
+}
+
+/**
+ * Uploads a glyph bitmap into the first free cell of the atlas.
+ *
+ * @param shape size of the bitmap in pixels.
+ * @param data  tightly packed bitmap data (channels() bytes per pixel, first
+ *              row is the top of the glyph).
+ *
+ * @return the location of the bitmap in the atlas, in pixels.
+ */
+Rect GlyphAtlas::add(const Shape& shape, const uint8_t* data)
+{
+    return this->set(slotCount_, shape, data);
+}
+
+/**
+ * Uploads a glyph bitmap into a given cell of the atlas.
+ *
+ * @param slot  index of the cell. Either an already used cell (its previous
+ *              content is cleared) or size() to append a new cell.
+ * @param shape size of the bitmap in pixels.
+ * @param data  tightly packed bitmap data (channels() bytes per pixel, first
+ *              row is the top of the glyph).
+ *
+ * @return the location of the bitmap in the atlas, in pixels.
+ */
+Rect GlyphAtlas::set(unsigned int slot, const Shape& shape, const uint8_t* data)
+{
+    if(slot > slotCount_) {
+        std::ostringstream oss;
+        oss << "GlyphAtlas error : invalid slot " << slot
+            << " (atlas size is " << slotCount_ << ").";
+        throw std::runtime_error(oss.str());
+    }
+    bool overwrite = slot < slotCount_;
+    if(!overwrite) {
+        if(slotCount_ >= this->capacity()) {
+            this->grow();
+        }
+        slotCount_++;
+    }
+
+    size_t left   = (slot % Columns)*cellShape_.width  + Padding;
+    size_t bottom = (slot / Columns)*cellShape_.height + Padding;
+    size_t width  = std::min(shape.width,  cellShape_.width  - 2*Padding);
+    size_t height = std::min(shape.height, cellShape_.height - 2*Padding);
+    if(width < shape.width || height < shape.height) {
+        std::cerr << "GlyphAtlas warning : glyph bitmap " << shape
+                  << " does not fit in atlas cell " << cellShape_
+                  << ". It will be cropped." << std::endl;
+    }
+    Rect rect({left, left + width, bottom, bottom + height});
+    if(!overwrite && (width == 0 || height == 0 || !data)) {
+        return rect;
+    }
+
+    GLenum format = channels_ == 1 ? GL_RED : GL_RGBA;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, texture_.gl_id());
+
+    if(overwrite) {
+        // Clearing the whole cell so the previous glyph does not bleed into
+        // the new one when the atlas is linearly filtered.
+        std::vector<uint8_t> zeros(channels_*cellShape_.area(), 0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, left - Padding, bottom - Padding,
+                        cellShape_.width, cellShape_.height,
+                        format, GL_UNSIGNED_BYTE, zeros.data());
+    }
+    if(width > 0 && height > 0 && data) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, shape.width);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.left, rect.bottom, width, height,
+                        format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GL_CHECK_LAST();
+
+    return rect;
+}
+
+}; //namespace text
+}; //namespace display
+}; //namespace rtac
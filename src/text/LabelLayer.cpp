@@ -0,0 +1,653 @@
+#include <rtac_display/text/LabelLayer.h>
+
+namespace rtac { namespace display { namespace text {
+
+/**
+ * One instance per visible label (in far-to-near order), 6 vertices per glyph
+ * quad. Labels with less glyphs than the longest text emit degenerate
+ * triangles for the missing quads.
+ */
+const std::string LabelLayer::vertexShader = std::string( R"(
+#version 430 core
+
+struct Anchor     { vec3 position; uint textId; vec4 color; };
+struct TextEntry  { uint firstQuad; uint quadCount; vec2 size; };
+struct LabelState { vec4 origin; vec4 rect; };
+struct GlyphQuad  { vec4 rect; vec4 atlasRect; };
+
+layout(std430, binding = 0) readonly buffer Anchors    { Anchor     anchors[];  };
+layout(std430, binding = 1) readonly buffer TextEntries{ TextEntry  texts[];    };
+layout(std430, binding = 2) readonly buffer States     { LabelState states[];   };
+layout(std430, binding = 3) readonly buffer SortKeys   { uvec2      sortKeys[]; };
+layout(std430, binding = 4) readonly buffer GlyphQuads { GlyphQuad  quads[];    };
+
+uniform vec2  screenSize;
+uniform float scale;
+uniform sampler2D atlas;
+
+out vec2 uv;
+flat out vec4 textColor;
+flat out int  isBackground;
+
+const uint cornerIndices[6] = uint[6](0u, 1u, 2u, 2u, 1u, 3u);
+
+void main()
+{
+    uint label = sortKeys[gl_InstanceID].y;
+    Anchor     a = anchors[label];
+    LabelState s = states[label];
+    TextEntry  t = texts[a.textId];
+
+    uint q = uint(gl_VertexID) / 6u;
+    if(q >= t.quadCount) {
+        // degenerate triangle, clipped.
+        gl_Position  = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+        uv           = vec2(0.0f);
+        textColor    = vec4(0.0f);
+        isBackground = 0;
+        return;
+    }
+
+    uint      c     = cornerIndices[uint(gl_VertexID) % 6u];
+    vec2      corner = vec2(c & 1u, c >> 1u);
+    GlyphQuad g      = quads[t.firstQuad + q];
+
+    vec2 p = s.origin.xy + scale*(g.rect.xy + corner*g.rect.zw);
+    gl_Position = vec4(2.0f*p / screenSize - 1.0f, s.origin.z, 1.0f);
+
+    // Atlas bitmaps are stored top row first.
+    uv = (g.atlasRect.xy + vec2(corner.x, 1.0f - corner.y)*g.atlasRect.zw)
+       / vec2(textureSize(atlas, 0));
+    textColor    = a.color;
+    isBackground = g.atlasRect.z < 0.0f ? 1 : 0;
+}
+)");
+
+/**
+ * Grayscale or distance field glyphs (same decoding as TextRenderer).
+ */
+const std::string LabelLayer::fragmentShader = std::string(R"(
+#version 430 core
+
+in vec2 uv;
+flat in vec4 textColor;
+flat in int  isBackground;
+
+uniform sampler2D atlas;
+uniform vec4  backColor;
+uniform bool  distanceField;
+uniform float spread;
+uniform float scale;
+uniform vec4  outlineColor;
+uniform float outlineWidth;
+
+out vec4 outColor;
+
+void main()
+{
+    if(isBackground != 0) {
+        outColor = backColor;
+        return;
+    }
+    if(!distanceField) {
+        outColor = vec4(textColor.rgb, textColor.a*texture(atlas, uv).x);
+        return;
+    }
+
+    float d = (255.0f*texture(atlas, uv).x - 128.0f) / 127.0f * spread * scale;
+    float fill    = clamp(d + 0.5f, 0.0f, 1.0f);
+    float outline = outlineWidth > 0.0f ?
+                    clamp(d + outlineWidth + 0.5f, 0.0f, 1.0f) : 0.0f;
+
+    vec4  front = vec4(textColor.rgb, textColor.a*fill);
+    vec4  back  = vec4(outlineColor.rgb, outlineColor.a*outline);
+    float alpha = front.a + back.a*(1.0f - front.a);
+    if(alpha <= 0.0f) {
+        discard;
+    }
+    outColor = vec4((front.rgb*front.a + back.rgb*back.a*(1.0f - front.a)) / alpha,
+                    alpha);
+}
+)");
+
+/**
+ * Resets the overlap grid, the sort keys and the indirect draw command.
+ */
+const std::string LabelLayer::clearShader = std::string(R"(
+#version 430 core
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) writeonly buffer Grid     { uint  grid[];     };
+layout(std430, binding = 1) writeonly buffer SortKeys { uvec2 sortKeys[]; };
+layout(std430, binding = 2) writeonly buffer Command  {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+uniform uint gridSize;
+uniform uint sortSize;
+uniform uint vertexCount;
+
+void main()
+{
+    uint idx = gl_GlobalInvocationID.x;
+    if(idx < gridSize) {
+        grid[idx] = 0xffffffffu;
+    }
+    if(idx < sortSize) {
+        // key 0 : sorted last (after all valid labels).
+        sortKeys[idx] = uvec2(0u, 0u);
+    }
+    if(idx == 0) {
+        count         = vertexCount;
+        instanceCount = 0u;
+        first         = 0u;
+        baseInstance  = 0u;
+    }
+}
+)");
+
+/**
+ * Projects the labels, culls those outside the view and writes the depth key
+ * of the remaining labels in all the grid cells they cover (closest wins).
+ *
+ * Sort keys are the bits of the normalized depth in [0,1], which have the
+ * same ordering as the depth itself. Key 0 flags a culled label.
+ */
+const std::string LabelLayer::projectShader = std::string(R"(
+#version 430 core
+
+layout(local_size_x = 256) in;
+
+struct Anchor     { vec3 position; uint textId; vec4 color; };
+struct TextEntry  { uint firstQuad; uint quadCount; vec2 size; };
+struct LabelState { vec4 origin; vec4 rect; };
+
+layout(std430, binding = 0) readonly  buffer Anchors    { Anchor     anchors[]; };
+layout(std430, binding = 1) readonly  buffer TextEntries{ TextEntry  texts[];   };
+layout(std430, binding = 2) writeonly buffer States     { LabelState states[];  };
+layout(std430, binding = 3)           buffer Grid       { uint       grid[];    };
+
+uniform mat4  view;
+uniform vec2  screenSize;
+uniform vec2  anchor;
+uniform float scale;
+uniform float ascender;
+uniform uint  labelCount;
+uniform uint  textCount;
+uniform bool  overlapCulling;
+uniform float cellSize;
+uniform ivec2 gridShape;
+uniform float margin;
+
+void main()
+{
+    uint idx = gl_GlobalInvocationID.x;
+    if(idx >= labelCount) {
+        return;
+    }
+
+    LabelState culled = LabelState(vec4(0.0f), vec4(0.0f));
+    Anchor a = anchors[idx];
+    if(a.textId >= textCount) {
+        states[idx] = culled;
+        return;
+    }
+    vec4 clip = view*vec4(a.position, 1.0f);
+    if(clip.w <= 0.0f) {
+        states[idx] = culled;
+        return;
+    }
+    vec3 ndc = clip.xyz / clip.w;
+    if(ndc.z < -1.0f || ndc.z > 1.0f) {
+        states[idx] = culled;
+        return;
+    }
+
+    vec2 size = scale*texts[a.textId].size;
+    vec2 p    = round(0.5f*(ndc.xy + 1.0f)*screenSize - anchor*size);
+    vec4 rect = vec4(p, p + size);
+    if(rect.z < 0.0f || rect.w < 0.0f
+       || rect.x > screenSize.x || rect.y > screenSize.y) {
+        states[idx] = culled;
+        return;
+    }
+
+    uint key = max(floatBitsToUint(0.5f*ndc.z + 0.5f), 1u);
+    states[idx] = LabelState(
+        vec4(p.x, p.y + size.y - scale*ascender, ndc.z, uintBitsToFloat(key)),
+        rect);
+
+    if(overlapCulling) {
+        ivec4 cells = clamp(ivec4(floor((rect + vec4(-margin, -margin, margin, margin))
+                                        / cellSize)),
+                            ivec4(0), ivec4(gridShape - 1, gridShape - 1));
+        for(int y = cells.y; y <= cells.w; y++) {
+            for(int x = cells.x; x <= cells.z; x++) {
+                atomicMin(grid[gridShape.x*y + x], key);
+            }
+        }
+    }
+}
+)");
+
+/**
+ * A label is kept if no closer label covers any of its cells. Kept labels are
+ * appended to the sort keys and counted in the indirect draw command.
+ */
+const std::string LabelLayer::selectShader = std::string(R"(
+#version 430 core
+
+layout(local_size_x = 256) in;
+
+struct LabelState { vec4 origin; vec4 rect; };
+
+layout(std430, binding = 0) readonly  buffer States   { LabelState states[];   };
+layout(std430, binding = 1) readonly  buffer Grid     { uint       grid[];     };
+layout(std430, binding = 2) writeonly buffer SortKeys { uvec2      sortKeys[]; };
+layout(std430, binding = 3)           buffer Command  {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+uniform uint  labelCount;
+uniform bool  overlapCulling;
+uniform float cellSize;
+uniform ivec2 gridShape;
+uniform float margin;
+
+void main()
+{
+    uint idx = gl_GlobalInvocationID.x;
+    if(idx >= labelCount) {
+        return;
+    }
+    LabelState s = states[idx];
+    uint key = floatBitsToUint(s.origin.w);
+    if(key == 0u) {
+        return;
+    }
+
+    if(overlapCulling) {
+        ivec4 cells = clamp(ivec4(floor((s.rect + vec4(-margin, -margin, margin, margin))
+                                        / cellSize)),
+                            ivec4(0), ivec4(gridShape - 1, gridShape - 1));
+        for(int y = cells.y; y <= cells.w; y++) {
+            for(int x = cells.x; x <= cells.z; x++) {
+                if(grid[gridShape.x*y + x] < key) {
+                    return;
+                }
+            }
+        }
+    }
+
+    uint dst = atomicAdd(instanceCount, 1u);
+    sortKeys[dst] = uvec2(key, idx);
+}
+)");
+
+/**
+ * One step of a bitonic sort of the sort keys in decreasing key order
+ * (far-to-near). The size of the sequence must be a power of 2.
+ */
+const std::string LabelLayer::sortShader = std::string(R"(
+#version 430 core
+
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer SortKeys { uvec2 sortKeys[]; };
+
+uniform uint sortSize;
+uniform uint blockSize;   // size of the bitonic sequences being merged.
+uniform uint stride;      // distance between compared elements.
+
+void main()
+{
+    uint idx   = gl_GlobalInvocationID.x;
+    uint other = idx ^ stride;
+    if(idx >= sortSize || other <= idx) {
+        return;
+    }
+
+    uvec2 a = sortKeys[idx];
+    uvec2 b = sortKeys[other];
+    bool decreasing = (idx & blockSize) == 0u;
+    if(decreasing ? (a.x < b.x) : (a.x > b.x)) {
+        sortKeys[idx]   = b;
+        sortKeys[other] = a;
+    }
+}
+)");
+
+LabelLayer::LabelLayer(const GLContext::Ptr& context,
+                       const FontFace::ConstPtr& font) :
+    Renderer(context, vertexShader, fragmentShader),
+    font_(font),
+    maxQuadCount_(0),
+    layoutGeneration_(0),
+    layoutChanged_(false),
+    command_(1),
+    anchor_({0.5f, 0.0f}),
+    textSize_(0.0f),
+    backColor_({0,0,0,0}),
+    outlineColor_({0,0,0,1}),
+    outlineWidth_(0.0f),
+    overlapCulling_(true),
+    cellSize_(DefaultCellSize),
+    margin_(0.0f),
+    clearProgram_  (create_compute_program(clearShader)),
+    projectProgram_(create_compute_program(projectShader)),
+    selectProgram_ (create_compute_program(selectShader)),
+    sortProgram_   (create_compute_program(sortShader))
+{
+    if(!font_) {
+        std::ostringstream oss;
+        oss << "Error rtac_display::text::LabelLayer : "
+            << "Invalid font face pointer.";
+        throw std::runtime_error(oss.str());
+    }
+    if(font_->render_mode() != FT_RENDER_MODE_NORMAL) {
+        std::ostringstream oss;
+        oss << "Error rtac_display::text::LabelLayer : "
+            << "only FT_RENDER_MODE_NORMAL and distance field fonts are "
+            << "supported (font render mode is " << font_->render_mode() << ").";
+        throw std::runtime_error(oss.str());
+    }
+}
+
+LabelLayer::Ptr LabelLayer::Create(const GLContext::Ptr& context,
+                                   const FontFace::ConstPtr& font)
+{
+    return Ptr(new LabelLayer(context, font));
+}
+
+/**
+ * Registers a new label string (UTF-8).
+ *
+ * @return the text id to be used in LabelLayer::Anchor::textId.
+ */
+uint32_t LabelLayer::add_text(const std::string& text)
+{
+    texts_.push_back(text);
+    layoutChanged_ = true;
+    return texts_.size() - 1;
+}
+
+void LabelLayer::clear_texts()
+{
+    texts_.clear();
+    layoutChanged_ = true;
+}
+
+/**
+ * Uploads labels from host memory. Labels can also be written directly on
+ * the device through LabelLayer::anchors().
+ */
+void LabelLayer::set_anchors(unsigned int count, const Anchor* anchors)
+{
+    if(count == 0) {
+        anchors_.resize(0);
+        return;
+    }
+    anchors_.set_data(count, anchors);
+}
+
+/**
+ * Position of the labels relative to their anchor point ("center",
+ * "top left", "bottom"...). Default is centered above the anchor point.
+ */
+void LabelLayer::set_anchor(const std::string& desc)
+{
+    TextRenderer::parse_anchor(desc, anchor_);
+}
+
+/**
+ * Sets the on-screen text size in pixels (distance field fonts only, 0 for
+ * the font native size).
+ */
+void LabelLayer::set_text_size(float pixels)
+{
+    textSize_ = std::max(0.0f, pixels);
+}
+
+void LabelLayer::set_back_color(const Color::RGBAf& color)
+{
+    backColor_ = color;
+}
+
+/**
+ * Outline around the glyphs (distance field fonts only).
+ *
+ * @param width outline width in screen pixels (0 to disable).
+ */
+void LabelLayer::set_outline(const Color::RGBAf& color, float width)
+{
+    outlineColor_ = color;
+    outlineWidth_ = std::max(0.0f, width);
+}
+
+/**
+ * Enables or disables screen-space overlap culling.
+ *
+ * @param cellSize size of the culling grid cells in pixels. Smaller cells
+ *                 are more accurate but more expensive.
+ * @param margin   minimum space to keep around labels (in pixels).
+ */
+void LabelLayer::set_overlap_culling(bool enable, unsigned int cellSize, float margin)
+{
+    overlapCulling_ = enable;
+    cellSize_       = std::max(1u, cellSize);
+    margin_         = std::max(0.0f, margin);
+}
+
+/**
+ * Ratio between the on-screen text size and the size of the glyphs in the
+ * font atlas.
+ */
+float LabelLayer::compute_scale() const
+{
+    if(!font_->is_distance_field() || textSize_ <= 0.0f
+       || font_->pixel_size() <= 0.0f) {
+        return 1.0f;
+    }
+    return textSize_ / font_->pixel_size();
+}
+
+/**
+ * Lays out all the registered texts into a single glyph quad buffer. Only
+ * performed when texts were added or when the font glyph cache was modified.
+ */
+void LabelLayer::update_layouts() const
+{
+    if(!layoutChanged_ && layoutGeneration_ == font_->generation()) {
+        return;
+    }
+
+    std::vector<TextEntry> entries(texts_.size());
+    // Fetching glyphs may evict others from the font cache. Laying out again
+    // if glyphs used by the texts were evicted during the layout.
+    for(int attempt = 0; attempt < 2; attempt++) {
+        uint64_t generation = font_->generation();
+
+        quads_.clear();
+        maxQuadCount_ = 0;
+        for(unsigned int i = 0; i < texts_.size(); i++) {
+            entries[i].firstQuad = quads_.size();
+            Shape area = TextRenderer::layout_text(*font_, texts_[i], quads_);
+            entries[i].quadCount = quads_.size() - entries[i].firstQuad;
+            entries[i].width     = area.width;
+            entries[i].height    = area.height;
+            maxQuadCount_ = std::max(maxQuadCount_, entries[i].quadCount);
+        }
+
+        layoutGeneration_ = font_->generation();
+        if(layoutGeneration_ == generation) {
+            break;
+        }
+        if(attempt > 0) {
+            std::cerr << "LabelLayer warning : the font glyph cache is too "
+                      << "small for the label texts (see "
+                      << "FontFace::set_cache_budget)." << std::endl;
+        }
+    }
+
+    if(entries.size() > 0) {
+        deviceQuads_.set_data(quads_.size(), quads_.data());
+        textEntries_.set_data(entries.size(), entries.data());
+    }
+    layoutChanged_ = false;
+}
+
+/**
+ * Runs the culling and sorting compute passes. The result is the sorted list
+ * of visible labels in sortKeys_ and their count in the indirect draw
+ * command.
+ */
+void LabelLayer::compute_visible_labels(const View::ConstPtr& view) const
+{
+    unsigned int labelCount = anchors_.size();
+    Shape        screen     = view->screen_size();
+
+    int gridWidth  = (screen.width  + cellSize_ - 1) / cellSize_;
+    int gridHeight = (screen.height + cellSize_ - 1) / cellSize_;
+    unsigned int gridSize = std::max(1, gridWidth*gridHeight);
+    unsigned int sortSize = 1;
+    while(sortSize < labelCount) sortSize <<= 1;
+
+    if(states_.size() < labelCount) states_.resize(labelCount);
+    if(grid_.size()   < gridSize)   grid_.resize(gridSize);
+    if(sortKeys_.size() < sortSize) sortKeys_.resize(sortSize);
+
+    // clearing
+    glUseProgram(clearProgram_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, grid_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sortKeys_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, command_.gl_id());
+    glUniform1ui(glGetUniformLocation(clearProgram_, "gridSize"), gridSize);
+    glUniform1ui(glGetUniformLocation(clearProgram_, "sortSize"), sortSize);
+    glUniform1ui(glGetUniformLocation(clearProgram_, "vertexCount"), 6*maxQuadCount_);
+    glDispatchCompute((std::max(gridSize, sortSize) + BlockSize - 1) / BlockSize, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // projection and overlap grid
+    Mat4 viewMatrix = view->view_matrix();
+    glUseProgram(projectProgram_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, anchors_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, textEntries_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, states_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, grid_.gl_id());
+    glUniformMatrix4fv(glGetUniformLocation(projectProgram_, "view"),
+                       1, GL_FALSE, viewMatrix.data());
+    glUniform2f(glGetUniformLocation(projectProgram_, "screenSize"),
+                screen.width, screen.height);
+    glUniform2fv(glGetUniformLocation(projectProgram_, "anchor"), 1, anchor_.data());
+    glUniform1f(glGetUniformLocation(projectProgram_, "scale"), this->compute_scale());
+    glUniform1f(glGetUniformLocation(projectProgram_, "ascender"), font_->ascender());
+    glUniform1ui(glGetUniformLocation(projectProgram_, "labelCount"), labelCount);
+    glUniform1ui(glGetUniformLocation(projectProgram_, "textCount"), texts_.size());
+    glUniform1i(glGetUniformLocation(projectProgram_, "overlapCulling"), overlapCulling_);
+    glUniform1f(glGetUniformLocation(projectProgram_, "cellSize"), cellSize_);
+    glUniform2i(glGetUniformLocation(projectProgram_, "gridShape"), gridWidth, gridHeight);
+    glUniform1f(glGetUniformLocation(projectProgram_, "margin"), margin_);
+    glDispatchCompute((labelCount + BlockSize - 1) / BlockSize, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // visible labels selection
+    glUseProgram(selectProgram_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, states_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, grid_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, sortKeys_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, command_.gl_id());
+    glUniform1ui(glGetUniformLocation(selectProgram_, "labelCount"), labelCount);
+    glUniform1i(glGetUniformLocation(selectProgram_, "overlapCulling"), overlapCulling_);
+    glUniform1f(glGetUniformLocation(selectProgram_, "cellSize"), cellSize_);
+    glUniform2i(glGetUniformLocation(selectProgram_, "gridShape"), gridWidth, gridHeight);
+    glUniform1f(glGetUniformLocation(selectProgram_, "margin"), margin_);
+    glDispatchCompute((labelCount + BlockSize - 1) / BlockSize, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // far-to-near bitonic sort
+    glUseProgram(sortProgram_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sortKeys_.gl_id());
+    glUniform1ui(glGetUniformLocation(sortProgram_, "sortSize"), sortSize);
+    GLint blockSizeLocation = glGetUniformLocation(sortProgram_, "blockSize");
+    GLint strideLocation    = glGetUniformLocation(sortProgram_, "stride");
+    for(unsigned int blockSize = 2; blockSize <= sortSize; blockSize <<= 1) {
+        for(unsigned int stride = blockSize >> 1; stride > 0; stride >>= 1) {
+            glUniform1ui(blockSizeLocation, blockSize);
+            glUniform1ui(strideLocation, stride);
+            glDispatchCompute((sortSize + BlockSize - 1) / BlockSize, 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+    }
+
+    for(unsigned int i = 0; i < 4; i++) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+    glUseProgram(0);
+    GL_CHECK_LAST();
+}
+
+void LabelLayer::draw(const View::ConstPtr& view) const
+{
+    this->update_layouts();
+    if(anchors_.size() == 0 || texts_.size() == 0 || maxQuadCount_ == 0) {
+        return;
+    }
+
+    this->compute_visible_labels(view);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    Shape screen = view->screen_size();
+    float scale  = this->compute_scale();
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(renderProgram_);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, anchors_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, textEntries_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, states_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, sortKeys_.gl_id());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, deviceQuads_.gl_id());
+
+    glUniform2f(glGetUniformLocation(renderProgram_, "screenSize"),
+                screen.width, screen.height);
+    glUniform1f(glGetUniformLocation(renderProgram_, "scale"), scale);
+    glUniform4fv(glGetUniformLocation(renderProgram_, "backColor"), 1,
+                 (const float*)&backColor_);
+    glUniform1i(glGetUniformLocation(renderProgram_, "distanceField"),
+                font_->is_distance_field());
+    glUniform1f(glGetUniformLocation(renderProgram_, "spread"),
+                font_->distance_field_spread());
+    glUniform4fv(glGetUniformLocation(renderProgram_, "outlineColor"), 1,
+                 (const float*)&outlineColor_);
+    glUniform1f(glGetUniformLocation(renderProgram_, "outlineWidth"), outlineWidth_);
+
+    glUniform1i(glGetUniformLocation(renderProgram_, "atlas"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, font_->atlas().texture().gl_id());
+
+    command_.bind(GL_DRAW_INDIRECT_BUFFER);
+    glDrawArraysIndirect(GL_TRIANGLES, 0);
+    command_.unbind(GL_DRAW_INDIRECT_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    for(unsigned int i = 0; i < 5; i++) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, 0);
+    }
+    glUseProgram(0);
+    glDisable(GL_BLEND);
+
+    GL_CHECK_LAST();
+}
+
+}; //namespace text
+}; //namespace display
+}; //namespace rtac
@@ -3,56 +3,146 @@
 namespace rtac { namespace display { namespace text {
 
 /**
- * Point position computed on CPU side. 
+ * Draws one glyph quad per instance as a 4 vertices triangle strip. The quad
+ * position is given in pixels relative to the text origin, which is itself
+ * given in pixels (already projected and snapped to the pixel grid on CPU
+ * side). scale is the ratio between the on-screen text size and the size of
+ * the glyphs in the atlas (always 1 for bitmap fonts).
  */
 const std::string TextRenderer::vertexShader = std::string( R"(
 #version 430 core
 
-in vec4 point;
-in vec2 uvIn;
+layout(location = 0) in vec4 glyphRect;
+layout(location = 1) in vec4 atlasRect;
+
+uniform vec3 origin;
+uniform vec2 screenSize;
+uniform float scale;
+uniform sampler2D atlas;
+
 out vec2 uv;
+flat out int isBackground;
 
 void main()
 {
-    gl_Position = point;
-    uv = uvIn;
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 p = origin.xy + scale*(glyphRect.xy + corner*glyphRect.zw);
+    gl_Position = vec4(2.0f*p / screenSize - 1.0f, origin.z, 1.0f);
+
+    // Atlas bitmaps are stored top row first.
+    uv = (atlasRect.xy + vec2(corner.x, 1.0f - corner.y)*atlasRect.zw)
+       / vec2(textureSize(atlas, 0));
+    isBackground = atlasRect.z < 0.0f ? 1 : 0;
 }
 )");
 
 /**
- * Simply outputs the texture value at given texture coordinates.
+ * Grayscale glyphs : the atlas value is used as the text alpha.
  */
 const std::string TextRenderer::fragmentShaderFlat = std::string(R"(
 #version 430 core
 
 in vec2 uv;
-uniform sampler2D tex;
+flat in int isBackground;
+
+uniform sampler2D atlas;
+uniform vec4 color;
+uniform vec4 backColor;
 
 out vec4 outColor;
 
 void main()
 {
-    outColor = texture(tex, uv);
+    if(isBackground != 0) {
+        outColor = backColor;
+    }
+    else {
+        outColor = vec4(color.rgb, color.a*texture(atlas, uv).x);
+    }
 }
 )");
 
 /**
- * Simply outputs the texture value at given texture coordinates.
+ * Subpixel (LCD) glyphs : the atlas value is a per-channel blending mask
+ * (dual source blending).
  */
 const std::string TextRenderer::fragmentShaderSubPix = std::string(R"(
 #version 430 core
 
 in vec2 uv;
-uniform sampler2D tex;
+flat in int isBackground;
+
+uniform sampler2D atlas;
 uniform vec4 color;
+uniform vec4 backColor;
 
 layout(location = 0, index = 0) out vec4 outColor;
 layout(location = 0, index = 1) out vec4 outMask;
 
 void main()
 {
-    outColor = color;
-    outMask  = color.a*texture(tex, uv);
+    if(isBackground != 0) {
+        outColor = backColor;
+        outMask  = vec4(backColor.a);
+    }
+    else {
+        outColor = color;
+        outMask  = color.a*texture(atlas, uv);
+    }
+}
+)");
+
+/**
+ * Distance field glyphs. The atlas value is decoded into a signed distance to
+ * the glyph contour in screen pixels (positive inside). Fill, outline and
+ * halo are antialiased over one screen pixel whatever the text scale. The
+ * outline and the halo are limited to the distance field spread.
+ */
+const std::string TextRenderer::fragmentShaderSDF = std::string(R"(
+#version 430 core
+
+in vec2 uv;
+flat in int isBackground;
+
+uniform sampler2D atlas;
+uniform vec4  color;
+uniform vec4  backColor;
+uniform float spread;
+uniform float scale;
+uniform vec4  outlineColor;
+uniform float outlineWidth;
+uniform vec4  haloColor;
+uniform float haloWidth;
+
+out vec4 outColor;
+
+vec4 over(vec4 front, vec4 back)
+{
+    float a = front.a + back.a*(1.0f - front.a);
+    if(a <= 0.0f)
+        return vec4(0.0f);
+    return vec4((front.rgb*front.a + back.rgb*back.a*(1.0f - front.a)) / a, a);
+}
+
+void main()
+{
+    if(isBackground != 0) {
+        outColor = backColor;
+        return;
+    }
+
+    float d = (255.0f*texture(atlas, uv).x - 128.0f) / 127.0f * spread * scale;
+
+    float fill    = clamp(d + 0.5f, 0.0f, 1.0f);
+    float outline = outlineWidth > 0.0f ?
+                    clamp(d + outlineWidth + 0.5f, 0.0f, 1.0f) : 0.0f;
+    float halo    = haloWidth > 0.0f ?
+                    smoothstep(-outlineWidth - haloWidth, -outlineWidth, d) : 0.0f;
+
+    vec4 c = vec4(haloColor.rgb, haloColor.a*halo);
+    c = over(vec4(outlineColor.rgb, outlineColor.a*outline), c);
+    c = over(vec4(color.rgb, color.a*fill), c);
+    outColor = c;
 }
 )");
 
@@ -60,12 +150,23 @@ TextRenderer::TextRenderer(const GLContext::Ptr& context,
                            const FontFace::ConstPtr& font) :
     Renderer(context, vertexShader, fragmentShaderFlat),
     font_(font),
+    textArea_({0,0}),
+    layoutGeneration_(0),
     origin_({0,0,0,1}),
     anchor_({0,1.0f}),
     textColor_({0,0,0}),
     backColor_({0,0,0,0}),
+    textSize_(0.0f),
+    worldHeight_(0.0f),
+    minPixels_(0.0f),
+    maxPixels_(1.0e6f),
+    outlineColor_({0,0,0,1}),
+    outlineWidth_(0.0f),
+    haloColor_({0,0,0,0.5}),
+    haloWidth_(0.0f),
     renderProgramFlat_(renderProgram_),
-    renderProgramSubPix_(create_render_program(vertexShader, fragmentShaderSubPix))
+    renderProgramSubPix_(create_render_program(vertexShader, fragmentShaderSubPix)),
+    renderProgramSDF_(create_render_program(vertexShader, fragmentShaderSDF))
 {
     if(!font_) {
         std::ostringstream oss;
@@ -88,158 +189,264 @@ void TextRenderer::set_text(const std::string& text, bool updateNow)
 {
     text_ = text;
     if(updateNow)
-        this->update_texture();
+        this->update_glyphs();
 }
 
-void TextRenderer::set_text_color(const Color::RGBAf& color, bool updateNow)
+/**
+ * The colors are shader uniforms, applied at the next draw. updateNow is
+ * ignored (kept for source compatibility).
+ */
+void TextRenderer::set_text_color(const Color::RGBAf& color, bool /*updateNow*/)
 {
     textColor_ = color;
-    if(updateNow)
-        this->update_texture();
 }
 
-void TextRenderer::set_back_color(const Color::RGBAf& color, bool updateNow)
+void TextRenderer::set_back_color(const Color::RGBAf& color, bool /*updateNow*/)
 {
     backColor_ = color;
-    if(updateNow)
-        this->update_texture();
+}
+
+/**
+ * Sets the on-screen text size in pixels (distance field fonts only).
+ *
+ * @param pixels height of the text em square in pixels. 0 restores the font
+ *               native size.
+ */
+void TextRenderer::set_text_size(float pixels)
+{
+    textSize_    = std::max(0.0f, pixels);
+    worldHeight_ = 0.0f;
+}
+
+/**
+ * Sizes the text in world units (distance field fonts only).
+ *
+ * The text scales with the distance to the camera like any other 3D object,
+ * but its on-screen size is clamped to [minPixels, maxPixels] so the label
+ * stays readable when far away and does not hide the scene when close.
+ *
+ * @param height    height of the text em square in world units. 0 disables
+ *                  world sizing (back to set_text_size behavior).
+ * @param minPixels minimum on-screen em size in pixels.
+ * @param maxPixels maximum on-screen em size in pixels.
+ */
+void TextRenderer::set_world_size(float height, float minPixels, float maxPixels)
+{
+    worldHeight_ = std::max(0.0f, height);
+    minPixels_   = std::max(0.0f, minPixels);
+    maxPixels_   = std::max(minPixels_, maxPixels);
+}
+
+/**
+ * Draws an outline around the glyphs (distance field fonts only).
+ *
+ * @param width outline width in screen pixels (0 to disable). Limited by the
+ *              FontFace distance field spread.
+ */
+void TextRenderer::set_outline(const Color::RGBAf& color, float width)
+{
+    outlineColor_ = color;
+    outlineWidth_ = std::max(0.0f, width);
+}
+
+/**
+ * Draws a soft halo around the glyphs (and outline), mostly useful to keep
+ * labels readable over a busy background (distance field fonts only).
+ *
+ * @param width halo width in screen pixels (0 to disable). Limited by the
+ *              FontFace distance field spread.
+ */
+void TextRenderer::set_halo(const Color::RGBAf& color, float width)
+{
+    haloColor_ = color;
+    haloWidth_ = std::max(0.0f, width);
 }
 
 void TextRenderer::set_anchor(const std::string& desc)
+{
+    parse_anchor(desc, anchor_);
+}
+
+/**
+ * Updates a text anchor from a description such as "top left", "center" or
+ * "bottom right". Unspecified directions are left unchanged.
+ */
+void TextRenderer::parse_anchor(const std::string& desc, Vec2& anchor)
 {
     if(desc.find("center") != std::string::npos) {
-        anchor_(0) = 0.5f;
-        anchor_(1) = 0.5f;
+        anchor(0) = 0.5f;
+        anchor(1) = 0.5f;
         return;
     }
     if(desc.find("left") != std::string::npos) {
-        anchor_(0) = 0.0f;
+        anchor(0) = 0.0f;
     }
     else if(desc.find("right") != std::string::npos) {
-        anchor_(0) = 1.0f;
+        anchor(0) = 1.0f;
     }
     if(desc.find("top") != std::string::npos) {
-        anchor_(1) = 1.0f;
+        anchor(1) = 1.0f;
     }
     else if(desc.find("bottom") != std::string::npos) {
-        anchor_(1) = 0.0f;
+        anchor(1) = 0.0f;
     }
 }
 
-Shape TextRenderer::compute_text_area(const std::string& text)
+/**
+ * @return true if a code point has no visible glyph (control characters).
+ */
+static bool is_control(uint32_t c)
+{
+    return c < 32 || (c >= 127 && c < 160);
+}
+
+/**
+ * Computes the size of a text block in pixels (at the font native size),
+ * kerning included.
+ */
+Shape TextRenderer::compute_text_area(const std::string& text) const
 {
     if(!font_ || text.size() == 0)
         return Shape({0,0});
 
     int lineCount = 1;
     float maxWidth = 0.0f, currentWidth = 0.0f;
-    for(auto c : text) {
+    uint32_t previous = 0;
+    size_t pos = 0;
+    while(pos < text.size()) {
+        uint32_t c = utf8_next(text, pos);
         if(c == '\n') {
             lineCount++;
             maxWidth = std::max(maxWidth, currentWidth);
             currentWidth = 0.0f;
+            previous = 0;
             continue;
         }
-        if(c < 32 || c == 127) {
-            // non-printable characters
+        if(is_control(c)) {
             continue;
         }
-        try {
-            currentWidth += font_->glyph(c).advance().x;
-        }
-        catch(const std::out_of_range&) {
-            currentWidth += font_->glyph('\n').advance().x;
+        if(previous) {
+            currentWidth += font_->get_kerning(previous, c).x / 64.0f;
         }
+        currentWidth += font_->glyph(c).advance().x;
+        previous = c;
     }
     maxWidth = std::max(maxWidth, currentWidth);
     return Shape({(size_t)(4*(((int)maxWidth + 3) / 4)),
                   (size_t)(lineCount * font_->baselineskip())});
 }
 
-void TextRenderer::update_texture()
+/**
+ * Lays out the text into glyph quads and uploads them to the device.
+ *
+ * The text is decoded as UTF-8 and glyphs are fetched from the FontFace glyph
+ * cache (rasterized on first use). The first quad is the text background.
+ * This is the only operation to be performed when the text changes. It is
+ * also performed automatically on draw if glyphs were evicted from the font
+ * cache since the last layout.
+ */
+void TextRenderer::update_glyphs() const
 {
-    Shape textArea = this->compute_text_area(text_);
-    std::cout << "Text area size : " << textArea << std::endl;
-    texture_.resize<types::Point4<float>>(textArea);
-    texture_.bind(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    texture_.unbind(GL_TEXTURE_2D);
-
-    // Preparing a framebuffer for off-screen rendering
-    GLuint framebuffer;
-    glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture_.gl_id(), 0);
-    
-    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    if(font_->render_mode() != FT_RENDER_MODE_NORMAL
+    && font_->render_mode() != FT_RENDER_MODE_LCD)
+    {
         std::ostringstream oss;
-        oss << "TextRenderer error : something went wrong when creating a framebuffer "
-            << "(GL error : 0x" << std::hex << glGetError() << ")";
+        oss << "TextRenderer::update_glyphs : pixel type "
+            << font_->render_mode() << " not implemented.";
         throw std::runtime_error(oss.str());
     }
-    texture_.unbind(GL_TEXTURE_2D);
 
-    glViewport(0, 0, texture_.shape().width, texture_.shape().height);
-    glClearColor(backColor_.r, backColor_.g, backColor_.b, backColor_.a);
-    glClear(GL_COLOR_BUFFER_BIT);
+    // Fetching glyphs may evict others from the font cache. Laying out again
+    // if glyphs used by this text were evicted during the layout.
+    for(int attempt = 0; attempt < 2; attempt++) {
+        uint64_t generation = font_->generation();
+        this->layout_glyphs();
+        layoutGeneration_ = font_->generation();
+        if(layoutGeneration_ == generation) {
+            break;
+        }
+        if(attempt > 0) {
+            std::cerr << "TextRenderer warning : the font glyph cache is too "
+                      << "small for this text (see FontFace::set_cache_budget)."
+                      << std::endl;
+        }
+    }
 
-    Mat4 origin  = this->view_matrix();
-    Mat4 current = Mat4::Identity();
+    deviceQuads_.set_data(quads_.size(), quads_.data());
+}
+
+void TextRenderer::layout_glyphs() const
+{
+    quads_.clear();
+    textArea_ = layout_text(*font_, text_, quads_);
+}
+
+/**
+ * Lays out a UTF-8 text into glyph quads (in pixels at the font native size,
+ * relative to the left end of the first baseline).
+ *
+ * A background quad covering the whole text area is inserted first, followed
+ * by one quad per visible glyph. Kerning is applied.
+ *
+ * @param font  font face to fetch the glyphs from.
+ * @param text  UTF-8 encoded text.
+ * @param quads glyph quads are appended to this vector.
+ *
+ * @return the size of the text area in pixels.
+ */
+Shape TextRenderer::layout_text(const FontFace& font, const std::string& text,
+                                std::vector<GlyphQuad>& quads)
+{
+    size_t background = quads.size();
+    quads.push_back(GlyphQuad({0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, -1.0f}));
 
-    const Glyph* glyph = nullptr;
-    for(auto c : text_) {
+    int lineCount = 1;
+    float maxWidth = 0.0f;
+    types::Point2<float> pen({0.0f, 0.0f});
+    uint32_t previous = 0;
+    size_t pos = 0;
+    while(pos < text.size()) {
+        uint32_t c = utf8_next(text, pos);
         if(c == '\n') {
-            current(1,3) -= font_->baselineskip();
-            current(0,3)  = 0.0f;
+            maxWidth = std::max(maxWidth, pen.x);
+            lineCount++;
+            pen.y -= font.baselineskip();
+            pen.x  = 0.0f;
+            previous = 0;
             continue;
         }
-        if(c < 32 || c == 127) {
+        if(is_control(c)) {
             continue;
         }
-        try {
-            glyph = &font_->glyph(c);
+        if(previous) {
+            pen.x += font.get_kerning(previous, c).x / 64.0f;
         }
-        catch(const std::out_of_range&) {
-            // fallback to another glyph if not available
-            glyph = &font_->glyph('\n');
+        previous = c;
+
+        const Glyph& glyph = font.glyph(c);
+        const Rect&  rect  = glyph.atlas_rect();
+        if(rect.width() > 0 && rect.height() > 0) {
+            quads.push_back(GlyphQuad({
+                pen.x + glyph.bearing().x,
+                pen.y + glyph.bearing().y - rect.height(),
+                (float)rect.width(), (float)rect.height(),
+                (float)rect.left, (float)rect.bottom,
+                (float)rect.width(), (float)rect.height()}));
         }
-        
-        //std::cout << "character : " << c
-        //          << ", shape : " << glyph->shape()
-        //          << ", texture shape : " << glyph->texture().shape() << std::endl;
-        glyph->draw(origin * current, textColor_);
-        current(0,3) += glyph->advance().x;
+        pen.x += glyph.advance().x;
     }
+    maxWidth = std::max(maxWidth, pen.x);
 
-    // unbinding the frame buffer for re-enabling on-screen rendering
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    switch(font_->render_mode()) {
-        default: {
-            std::ostringstream oss;
-            oss << "TextRenderer::update_texture : pixel type "
-                << font_->render_mode() << " not implemented.";
-            throw std::runtime_error(oss.str());
-            }
-            break;
-        case FT_RENDER_MODE_NORMAL:
-            renderProgram_ = renderProgramFlat_;
-            break;
-        case FT_RENDER_MODE_LCD:
-            renderProgram_ = renderProgramSubPix_;
-            break;
+    Shape area({0,0});
+    if(text.size() > 0) {
+        area = Shape({(size_t)(4*(((int)maxWidth + 3) / 4)),
+                      (size_t)(lineCount * font.baselineskip())});
     }
-    //glEnable(GL_FRAMEBUFFER_SRGB);
+    quads[background].y      = font.ascender() - area.height;
+    quads[background].width  = area.width;
+    quads[background].height = area.height;
 
-    GL_CHECK_LAST();
+    return area;
 }
 
 const std::string& TextRenderer::text() const
@@ -252,27 +459,12 @@ FontFace::ConstPtr TextRenderer::font() const
     return font_;
 }
 
-const GLTexture& TextRenderer::texture() const
-{
-    return texture_;
-}
-
 /**
- * Return a view matrix transforming from 2D pixel space of the text areato
- * OpenGL clip space [-1,1] with origin at the left end of the first baseline.
- */ 
-TextRenderer::Mat4 TextRenderer::view_matrix() const
+ * @return the size of the text block in pixels.
+ */
+const Shape& TextRenderer::text_area() const
 {
-    Mat4 view = Mat4::Identity();
-    //view(0,0) =  2.0f / (texture_.width()  - 1);
-    //view(1,1) = -2.0f / (texture_.height() - 1);
-    view(0,0) =  2.0f / texture_.width();
-    view(1,1) = -2.0f / texture_.height();
-
-    view(0,3) = -1.0f;
-    view(1,3) = -(texture_.height() - 2.0f*font_->ascender()) / texture_.height();
-
-    return view;
+    return textArea_;
 }
 
 TextRenderer::Vec4& TextRenderer::origin()
@@ -311,26 +503,82 @@ float TextRenderer::anchor_depth(const View::ConstPtr& view) const
     return clipOrigin(2) / clipOrigin(3);
 }
 
+/**
+ * Ratio between the on-screen text size and the size of the glyphs in the
+ * font atlas. Always 1 for bitmap fonts.
+ */
+float TextRenderer::compute_scale(const View::ConstPtr& view) const
+{
+    if(!font_->is_distance_field() || font_->pixel_size() <= 0.0f) {
+        return 1.0f;
+    }
+    if(worldHeight_ > 0.0f) {
+        // Screen pixels per world unit around the anchor (using the largest
+        // screen-space vertical derivative of the projection).
+        Mat4 viewMatrix = view->view_matrix();
+        Vec4 clipOrigin = viewMatrix * origin_;
+        if(clipOrigin(3) <= 0.0f) {
+            return minPixels_ / font_->pixel_size();
+        }
+        float pixelsPerUnit = 0.5f*view->screen_size().height
+                            * viewMatrix.block<1,3>(1,0).norm() / clipOrigin(3);
+        float pixels = std::max(minPixels_, std::min(maxPixels_,
+                                worldHeight_*pixelsPerUnit));
+        return pixels / font_->pixel_size();
+    }
+    if(textSize_ > 0.0f) {
+        return textSize_ / font_->pixel_size();
+    }
+    return 1.0f;
+}
+
+/**
+ * Computes the screen position of the text origin (left end of the first
+ * baseline) in pixels with the anchor shift applied.
+ *
+ * The position is snapped to the pixel grid so glyph bitmaps are rendered
+ * without resampling. The z coordinate is the normalized depth of the anchor.
+ */
+TextRenderer::Vec3 TextRenderer::compute_pixel_origin(const View::ConstPtr& view) const
+{
+    Shape screen = view->screen_size();
+    float scale  = this->compute_scale(view);
+
+    Vec4 clipOrigin = view->view_matrix() * origin_;
+    clipOrigin /= clipOrigin(3);
+
+    Vec3 origin;
+    origin(0) = 0.5f*(clipOrigin(0) + 1.0f)*screen.width
+              - scale*anchor_(0)*textArea_.width;
+    origin(1) = 0.5f*(clipOrigin(1) + 1.0f)*screen.height
+              - scale*anchor_(1)*textArea_.height
+              + scale*(textArea_.height - font_->ascender());
+    origin(0) = std::round(origin(0));
+    origin(1) = std::round(origin(1));
+    origin(2) = clipOrigin(2);
+
+    return origin;
+}
+
 std::array<TextRenderer::Vec4,4> TextRenderer::compute_corners(const View::ConstPtr& view) const
 {
-    float clipWidth  = (2.0f*texture_.width() ) / view->screen_size().width;
-    float clipHeight = (2.0f*texture_.height()) / view->screen_size().height;
-    //float clipWidth  = (2.0f*texture_.width() ) / (view->screen_size().width - 1);
-    //float clipHeight = (2.0f*texture_.height()) / (view->screen_size().height- 1);
+    float scale      = this->compute_scale(view);
+    float clipWidth  = (2.0f*scale*textArea_.width ) / view->screen_size().width;
+    float clipHeight = (2.0f*scale*textArea_.height) / view->screen_size().height;
 
     // OpenGL clip space origin.
     Vec4 clipOrigin = view->view_matrix() * origin_;
 
-    // Anchor shift
-    clipOrigin(0) -= anchor_(0)*clipWidth;
-    clipOrigin(1) -= anchor_(1)*clipHeight;
-
     // normalizing coordinates
     clipOrigin(0) /= clipOrigin(3);
     clipOrigin(1) /= clipOrigin(3);
     clipOrigin(2) /= clipOrigin(3);
     clipOrigin(3)  = 1.0f;
 
+    // Anchor shift
+    clipOrigin(0) -= anchor_(0)*clipWidth;
+    clipOrigin(1) -= anchor_(1)*clipHeight;
+
     std::array<Vec4,4> corners({
         Vec4(clipOrigin + Vec4({0,0,0,0})),
         Vec4(clipOrigin + Vec4({clipWidth,0,0,0})),
@@ -342,47 +590,76 @@ std::array<TextRenderer::Vec4,4> TextRenderer::compute_corners(const View::Const
 
 void TextRenderer::draw(const View::ConstPtr& view) const
 {
-    auto corners = compute_corners(view);
-    static const float uv[] = {0,1,
-                               1,1,
-                               1,0,
-                               0,0};
-    static const unsigned int indexes[] = {0, 1, 2,
-                                           0, 2, 3};
+    if(layoutGeneration_ != font_->generation()) {
+        this->update_glyphs();
+    }
+    if(deviceQuads_.size() == 0) {
+        return;
+    }
 
-    //glEnable(GL_FRAMEBUFFER_SRGB);
+    Vec3  origin = this->compute_pixel_origin(view);
+    Shape screen = view->screen_size();
+    float scale  = this->compute_scale(view);
+
+    GLuint program = renderProgramFlat_;
     glEnable(GL_BLEND);
-    if(renderProgram_ == renderProgramFlat_)
+    if(font_->is_distance_field()) {
+        program = renderProgramSDF_;
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    else
+    }
+    else if(font_->render_mode() == FT_RENDER_MODE_LCD) {
+        program = renderProgramSubPix_;
         glBlendFunc(GL_SRC1_COLOR, GL_ONE_MINUS_SRC1_COLOR);
+    }
+    else {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    glUseProgram(program);
 
-    glUseProgram(renderProgram_);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, corners.data());
+    deviceQuads_.bind(GL_ARRAY_BUFFER);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphQuad), 0);
+    glVertexAttribDivisor(0, 1);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, uv);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphQuad),
+                          (const void*)(4*sizeof(float)));
+    glVertexAttribDivisor(1, 1);
     glEnableVertexAttribArray(1);
 
-    glUniform1i(glGetUniformLocation(renderProgram_, "tex"), 0);
+    glUniform3fv(glGetUniformLocation(program, "origin"), 1, origin.data());
+    glUniform2f(glGetUniformLocation(program, "screenSize"),
+                screen.width, screen.height);
+    glUniform1f(glGetUniformLocation(program, "scale"), scale);
+    glUniform4fv(glGetUniformLocation(program, "color"), 1,
+                 (const float*)&textColor_);
+    glUniform4fv(glGetUniformLocation(program, "backColor"), 1,
+                 (const float*)&backColor_);
+    if(program == renderProgramSDF_) {
+        glUniform1f(glGetUniformLocation(program, "spread"),
+                    font_->distance_field_spread());
+        glUniform4fv(glGetUniformLocation(program, "outlineColor"), 1,
+                     (const float*)&outlineColor_);
+        glUniform1f(glGetUniformLocation(program, "outlineWidth"), outlineWidth_);
+        glUniform4fv(glGetUniformLocation(program, "haloColor"), 1,
+                     (const float*)&haloColor_);
+        glUniform1f(glGetUniformLocation(program, "haloWidth"), haloWidth_);
+    }
+
+    glUniform1i(glGetUniformLocation(program, "atlas"), 0);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture_.gl_id());
+    glBindTexture(GL_TEXTURE_2D, font_->atlas().texture().gl_id());
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, deviceQuads_.size());
 
-    if(renderProgram_ == renderProgramSubPix_) {
-        glUniform4fv(glGetUniformLocation(renderProgram_, "color"), 1, (const float*)&textColor_);
-    }
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, indexes);
-    
     glBindTexture(GL_TEXTURE_2D, 0);
+    glVertexAttribDivisor(1, 0);
+    glVertexAttribDivisor(0, 0);
     glDisableVertexAttribArray(1);
     glDisableVertexAttribArray(0);
+    deviceQuads_.unbind(GL_ARRAY_BUFFER);
 
     glUseProgram(0);
     glDisable(GL_BLEND);
-    //glDisable(GL_FRAMEBUFFER_SRGB);
 
     GL_CHECK_LAST();
 }
@@ -0,0 +1,69 @@
+#include <rtac_display/text/utf8.h>
+
+namespace rtac { namespace display { namespace text {
+
+/**
+ * Decodes the UTF-8 sequence starting at text[pos].
+ *
+ * Invalid, truncated or overlong sequences are decoded as a single
+ * ReplacementCharacter and decoding resumes on the next byte.
+ *
+ * @param text UTF-8 encoded string.
+ * @param pos  position of the first byte of the sequence. Updated to the
+ *             first byte of the next sequence.
+ *
+ * @return the decoded code point.
+ */
+uint32_t utf8_next(const std::string& text, size_t& pos)
+{
+    uint8_t lead = text[pos++];
+    if(lead < 0x80) {
+        return lead;
+    }
+
+    unsigned int length;
+    uint32_t     codePoint;
+    uint32_t     minValue;
+    if((lead & 0xe0) == 0xc0) {
+        length = 1; codePoint = lead & 0x1f; minValue = 0x80;
+    }
+    else if((lead & 0xf0) == 0xe0) {
+        length = 2; codePoint = lead & 0x0f; minValue = 0x800;
+    }
+    else if((lead & 0xf8) == 0xf0) {
+        length = 3; codePoint = lead & 0x07; minValue = 0x10000;
+    }
+    else {
+        return ReplacementCharacter;
+    }
+
+    for(unsigned int i = 0; i < length; i++) {
+        if(pos >= text.size() || ((uint8_t)text[pos] & 0xc0) != 0x80) {
+            return ReplacementCharacter;
+        }
+        codePoint = (codePoint << 6) | ((uint8_t)text[pos++] & 0x3f);
+    }
+    if(codePoint < minValue || codePoint > 0x10ffff
+       || (codePoint >= 0xd800 && codePoint <= 0xdfff)) {
+        return ReplacementCharacter;
+    }
+    return codePoint;
+}
+
+/**
+ * Decodes a whole UTF-8 string into code points.
+ */
+std::u32string utf8_decode(const std::string& text)
+{
+    std::u32string res;
+    res.reserve(text.size());
+    size_t pos = 0;
+    while(pos < text.size()) {
+        res.push_back(utf8_next(text, pos));
+    }
+    return res;
+}
+
+}; //namespace text
+}; //namespace display
+}; //namespace rtac
@@ -0,0 +1,86 @@
+#include <rtac_display/views/Frustum.h>
+
+#include <cmath>
+
+namespace rtac { namespace display {
+
+/**
+ * Bounding sphere of the image of this sphere by an affine transform (the
+ * radius is scaled by the largest scaling factor of the transform).
+ */
+BoundingSphere BoundingSphere::transformed(const Mat4& transform) const
+{
+    if(this->is_infinite()) {
+        return *this;
+    }
+    Vector3 c = transform.topLeftCorner<3,3>()*center + transform.topRightCorner<3,1>();
+    float scale = std::max(transform.col(0).head<3>().norm(),
+                  std::max(transform.col(1).head<3>().norm(),
+                           transform.col(2).head<3>().norm()));
+    return BoundingSphere(c, scale*radius);
+}
+
+/**
+ * Smallest sphere containing both this sphere and other.
+ */
+BoundingSphere BoundingSphere::merged(const BoundingSphere& other) const
+{
+    if(this->is_infinite() || other.is_infinite()) {
+        return BoundingSphere::Infinite();
+    }
+    Vector3 d = other.center - center;
+    float distance = d.norm();
+    if(distance + other.radius <= radius) return *this;
+    if(distance + radius <= other.radius) return other;
+
+    float r = 0.5f*(distance + radius + other.radius);
+    return BoundingSphere(center + ((r - radius) / distance)*d, r);
+}
+
+/**
+ * Extracts the frustum planes from a projection matrix (clip coordinates in
+ * [-1,1]^3 are inside the frustum).
+ */
+Frustum::Frustum(const Mat4& m)
+{
+    for(int i = 0; i < 3; i++) {
+        planes_[2*i]     = (m.row(3) + m.row(i)).transpose();
+        planes_[2*i + 1] = (m.row(3) - m.row(i)).transpose();
+    }
+    for(auto& p : planes_) {
+        float norm = p.head<3>().norm();
+        if(norm > 0.0f) p /= norm;
+    }
+}
+
+/**
+ * @return false if the sphere is entirely outside of the frustum (the test
+ *         is conservative : it may return true for some spheres near the
+ *         frustum corners which are outside).
+ */
+bool Frustum::intersects(const Vector3& center, float radius) const
+{
+    if(!(radius < std::numeric_limits<float>::infinity())) {
+        return true;
+    }
+    for(const auto& p : planes_) {
+        if(p.head<3>().dot(center) + p(3) < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    return this->intersects(sphere.center, sphere.radius);
+}
+
+}; //namespace display
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::display::BoundingSphere& sphere)
+{
+    os << "(center : " << sphere.center.transpose() << ", radius : " << sphere.radius << ")";
+    return os;
+}
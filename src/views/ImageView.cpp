@@ -37,26 +37,39 @@ ImageView::ImageView(const Shape& image) :
  */
 void ImageView::update_projection()
 {
-    projectionMatrix_ = Mat4::Identity();
+    projectionMatrix_ = compute_projection(screenSize_, image_);
+}
+
+/**
+ * Projection matrix displaying an image of size image (in pixels, origin at
+ * the bottom left corner) as large as possible on a screen of size screen,
+ * keeping the apparent aspect ratio to 1.
+ *
+ * This does not modify any state and can be used directly by renderers which
+ * do not need a full ImageView instance.
+ */
+ImageView::Mat4 ImageView::compute_projection(const Shape& screen, const Shape& image)
+{
+    Mat4 projection = Mat4::Identity();
     
-    float metaRatio = screenSize_.ratio<float>() / image_.ratio<float>();
-    float screenRatio = screenSize_.ratio<float>();
-    float imageRatio  = image_.ratio<float>();
+    float screenRatio = screen.ratio<float>();
+    float imageRatio  = image.ratio<float>();
 
     if(screenRatio > imageRatio) {
         // here the screen is wider than the image.
-        projectionMatrix_(0,0) = 2.0f / (screenRatio * image_.height);
-        projectionMatrix_(0,3) = -0.5f*image_.width * projectionMatrix_(0,0);
-        projectionMatrix_(1,1) = 2.0f / image_.height;
-        projectionMatrix_(1,3) = -1.0f;
+        projection(0,0) = 2.0f / (screenRatio * image.height);
+        projection(0,3) = -0.5f*image.width * projection(0,0);
+        projection(1,1) = 2.0f / image.height;
+        projection(1,3) = -1.0f;
     }
     else {
         // here the image is wider then the screen
-        projectionMatrix_(0,0) = 2.0f / image_.width;
-        projectionMatrix_(0,3) = -1.0f;
-        projectionMatrix_(1,1) = 2.0f * screenRatio / image_.width;
-        projectionMatrix_(1,3) = -0.5f*image_.height * projectionMatrix_(1,1);
+        projection(0,0) = 2.0f / image.width;
+        projection(0,3) = -1.0f;
+        projection(1,1) = 2.0f * screenRatio / image.width;
+        projection(1,3) = -0.5f*image.height * projection(1,1);
     }
+    return projection;
 }
 
 /**
@@ -75,6 +75,15 @@ View::Mat4 View::view_matrix() const
     return projectionMatrix_;
 }
 
+/**
+ * @return the visible volume of this view, in world coordinates (extracted
+ *         from View::view_matrix).
+ */
+Frustum View::frustum() const
+{
+    return Frustum(this->view_matrix());
+}
+
 /**
  * @return the current screen size.
  */
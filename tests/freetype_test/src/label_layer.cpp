@@ -0,0 +1,71 @@
+#include <iostream>
+#include <thread>
+#include <random>
+using namespace std;
+
+#include <rtac_base/time.h>
+using FrameCounter = rtac::time::FrameCounter;
+
+#include <rtac_base/types/Pose.h>
+using Pose = rtac::types::Pose<float>;
+using Quaternion = rtac::types::Quaternion<float>;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/views/PinholeView.h>
+#include <rtac_display/text/FontFace.h>
+#include <rtac_display/text/LabelLayer.h>
+using namespace rtac::display;
+
+int main()
+{
+    std::string filename = "/usr/share/fonts/truetype/ubuntu/UbuntuMono-R.ttf";
+    unsigned int N = 10000;
+
+    Display display;
+    display.disable_frame_counter();
+
+    auto font = text::FontFace::Create(filename, 0, nullptr, FT_RENDER_MODE_NORMAL);
+    font->enable_distance_field(32, 6);
+
+    auto view3d = PinholeView::New();
+    view3d->look_at({0,0,0}, {60,40,30});
+
+    auto labels = display.create_renderer<text::LabelLayer>(view3d, font);
+    labels->set_text_size(16.0f);
+    labels->set_outline({0,0,0,1}, 1.5f);
+    labels->set_overlap_culling(true, 8, 2.0f);
+
+    std::vector<uint32_t> textIds;
+    for(int i = 0; i < 100; i++) {
+        std::ostringstream oss;
+        oss << "target_" << i;
+        textIds.push_back(labels->add_text(oss.str()));
+    }
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> hue(0.3f, 1.0f);
+    std::vector<text::LabelLayer::Anchor> anchors(N);
+    for(unsigned int i = 0; i < N; i++) {
+        anchors[i].x = position(rng);
+        anchors[i].y = position(rng);
+        anchors[i].z = 0.1f*position(rng);
+        anchors[i].textId = textIds[i % textIds.size()];
+        anchors[i].color  = Color::RGBAf({hue(rng), hue(rng), hue(rng), 1.0f});
+    }
+    labels->set_anchors(anchors.size(), anchors.data());
+
+    display.set_clear_color({0.1,0.1,0.12,1});
+
+    float dangle = 0.002;
+    Pose R({0.0,0.0,0.0}, Quaternion({cos(dangle/2), 0.0, 0.0, sin(dangle/2)}));
+
+    FrameCounter counter;
+    while(!display.should_close()) {
+        view3d->set_pose(R * view3d->pose());
+        display.draw();
+        cout << counter;
+    }
+    cout << endl;
+    return 0;
+}
@@ -91,6 +91,8 @@ int main()
     oss << "Portez ce vieux whisky au juge blond qui fume." << 1234567890;
     for(int i = 0; i < 10; i++)
         oss << endl << "Portez ce vieux whisky au juge blond qui fume.";
+    // Non-ASCII glyphs are rasterized on first use.
+    oss << endl << "Voix ambiguë d'un cœur qui au zéphyr préfère les jattes de kiwis.";
     auto textRenderer = display.create_renderer<text::TextRenderer>(
         View::New(), font, oss.str());
     //display.add_renderer(textRenderer);
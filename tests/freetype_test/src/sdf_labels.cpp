@@ -0,0 +1,65 @@
+#include <iostream>
+#include <thread>
+using namespace std;
+
+#include <rtac_base/types/Pose.h>
+using Pose = rtac::types::Pose<float>;
+using Quaternion = rtac::types::Quaternion<float>;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/views/PinholeView.h>
+#include <rtac_display/text/FontFace.h>
+#include <rtac_display/text/TextRenderer.h>
+using namespace rtac::display;
+
+int main()
+{
+    std::string filename = "/usr/share/fonts/truetype/ubuntu/UbuntuMono-R.ttf";
+    Display display;
+
+    // Single rasterization, used for all text sizes below.
+    auto font = text::FontFace::Create(filename);
+    font->enable_distance_field(48, 8);
+
+    auto view3d = PinholeView::New();
+    view3d->look_at({0,0,0}, {5,4,3});
+
+    // 3D labels on a grid, sized in world units but never smaller than 12
+    // pixels on screen.
+    for(int i = -2; i <= 2; i++) {
+        for(int j = -2; j <= 2; j++) {
+            std::ostringstream oss;
+            oss << "(" << i << "," << j << ")";
+            auto label = display.create_renderer<text::TextRenderer>(
+                view3d, font, oss.str());
+            label->origin()(0) = 2.0f*i;
+            label->origin()(1) = 2.0f*j;
+            label->set_anchor("center");
+            label->set_text_color({1,1,1,1});
+            label->set_world_size(0.3f, 12.0f, 64.0f);
+            label->set_outline({0,0,0,1}, 1.5f);
+            label->set_halo({0,0,0,0.5}, 3.0f);
+        }
+    }
+
+    // Screen space title, drawn at 3 times the rasterization size.
+    auto title = display.create_renderer<text::TextRenderer>(
+        View::New(), font, "Distance field labels");
+    title->origin()(0) = -1;
+    title->origin()(1) =  1;
+    title->set_anchor("top left");
+    title->set_text_color({1.0,0.8,0.2,1.0});
+    title->set_text_size(144.0f);
+    title->set_outline({0,0,0,1}, 3.0f);
+
+    display.set_clear_color({0.3,0.3,0.35,1});
+
+    float dangle = 0.005;
+    Pose R({0.0,0.0,0.0}, Quaternion({cos(dangle/2), 0.0, 0.0, sin(dangle/2)}));
+    while(!display.should_close()) {
+        view3d->set_pose(R * view3d->pose());
+        display.draw();
+        this_thread::sleep_for(10ms);
+    }
+    return 0;
+}
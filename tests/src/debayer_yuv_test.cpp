@@ -0,0 +1,127 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/ImageDisplay.h>
+using namespace rtac::display;
+
+// Displays the same synthetic image given as RGB, raw Bayer (RGGB), NV12,
+// I420 and YUYV. All the versions should look the same (apart from
+// demosaicing artifacts on the sharp edges).
+
+struct RGB { float r, g, b; };
+
+RGB pixel(unsigned int w, unsigned int h, unsigned int W, unsigned int H)
+{
+    float x = ((float)w) / W, y = ((float)h) / H;
+    RGB res({x, y, 0.5f + 0.5f*sin(20.0f*x*y)});
+    if(((w / 32) + (h / 32)) % 2 == 0 && x > 0.5f) {
+        res = RGB({1.0f, 1.0f, 1.0f});
+    }
+    return res;
+}
+
+uint8_t to_u8(float v)
+{
+    return (uint8_t)std::max(0.0f, std::min(255.0f, std::round(255.0f*v)));
+}
+
+// BT.601 video range
+void to_yuv(const RGB& c, float& y, float& u, float& v)
+{
+    float luma = 0.299f*c.r + 0.587f*c.g + 0.114f*c.b;
+    y = (16.0f  + 219.0f*luma) / 255.0f;
+    u = (128.0f + 224.0f*0.5f*(c.b - luma) / (1.0f - 0.114f)) / 255.0f;
+    v = (128.0f + 224.0f*0.5f*(c.r - luma) / (1.0f - 0.299f)) / 255.0f;
+}
+
+int main()
+{
+    unsigned int W = 640, H = 480;
+
+    std::vector<uint8_t> rgb(3*W*H), bayer(W*H), yuyv(2*W*H);
+    std::vector<uint8_t> nv12(W*H + W*H/2), i420(W*H + W*H/2);
+    std::vector<uint16_t> bayer12(W*H);
+    for(unsigned int h = 0; h < H; h++) {
+        for(unsigned int w = 0; w < W; w++) {
+            RGB c = pixel(w, h, W, H);
+            unsigned int idx = W*h + w;
+            rgb[3*idx]     = to_u8(c.r);
+            rgb[3*idx + 1] = to_u8(c.g);
+            rgb[3*idx + 2] = to_u8(c.b);
+
+            // RGGB mosaic
+            float raw = (h % 2 == 0) ? (w % 2 == 0 ? c.r : c.g)
+                                     : (w % 2 == 0 ? c.g : c.b);
+            bayer[idx]   = to_u8(raw);
+            bayer12[idx] = (uint16_t)std::round(4095.0f*raw);
+
+            float y, u, v;
+            to_yuv(c, y, u, v);
+            nv12[idx] = to_u8(y);
+            i420[idx] = to_u8(y);
+            yuyv[2*idx] = to_u8(y);
+            // chroma sampled on the top left pixel of each 2x2 (4:2:0) or
+            // on the left pixel of each pair (4:2:2).
+            if(w % 2 == 0) {
+                yuyv[2*idx + 1] = to_u8(u);
+                yuyv[2*idx + 3] = to_u8(v);
+                if(h % 2 == 0) {
+                    unsigned int cIdx = (W/2)*(h/2) + w/2;
+                    nv12[W*H + 2*cIdx]     = to_u8(u);
+                    nv12[W*H + 2*cIdx + 1] = to_u8(v);
+                    i420[W*H + cIdx]           = to_u8(u);
+                    i420[W*H + W*H/4 + cIdx]   = to_u8(v);
+                }
+            }
+        }
+    }
+
+    samples::ImageDisplay display;
+    auto renderer = display.renderer();
+
+    unsigned int mode = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    while(!display.should_close()) {
+        auto t = std::chrono::high_resolution_clock::now();
+        if(mode == 0 || t - t0 > 2s) {
+            switch(mode % 6) {
+                default:
+                case 0:
+                    renderer->set_image({W,H}, (const Color::RGB8*)rgb.data());
+                    cout << "RGB" << endl;
+                    break;
+                case 1:
+                    renderer->set_bayer({W,H}, bayer.data());
+                    cout << "Bayer RGGB 8 bits, bilinear" << endl;
+                    break;
+                case 2:
+                    renderer->set_bayer({W,H}, bayer12.data(),
+                                        ImageRenderer::BayerPattern::RGGB,
+                                        ImageRenderer::Demosaic::EdgeAware, 12);
+                    cout << "Bayer RGGB 12 bits, edge aware" << endl;
+                    break;
+                case 3:
+                    renderer->set_nv12({W,H}, nv12.data());
+                    cout << "NV12" << endl;
+                    break;
+                case 4:
+                    renderer->set_i420({W,H}, i420.data());
+                    cout << "I420" << endl;
+                    break;
+                case 5:
+                    renderer->set_yuyv({W,H}, yuyv.data());
+                    cout << "YUYV" << endl;
+                    break;
+            }
+            mode++;
+            t0 = t;
+        }
+        display.draw();
+        this_thread::sleep_for(10ms);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/renderers/FanRenderer.h>
+using namespace rtac::display;
+
+// Compares the bounding quad (0 subdivisions) and the tessellated sector mesh
+// of the FanRenderer for several apertures. Fragment shader invocations are
+// counted when GL_ARB_pipeline_statistics_query is available.
+
+double time_frames(Display& display, unsigned int frameCount)
+{
+    display.draw();
+    glFinish();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for(unsigned int i = 0; i < frameCount; i++) {
+        display.draw();
+    }
+    glFinish();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / frameCount;
+}
+
+GLuint64 count_fragments(Display& display)
+{
+    if(!GLEW_ARB_pipeline_statistics_query)
+        return 0;
+    GLuint query;
+    glGenQueries(1, &query);
+    glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, query);
+    display.draw();
+    glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+    GLuint64 count = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &count);
+    glDeleteQueries(1, &query);
+    return count;
+}
+
+int main()
+{
+    unsigned int frameCount = 100;
+
+    Display display(1920, 1080);
+    display.disable_frame_counter();
+
+    auto renderer = display.create_renderer<FanRenderer>(View::New());
+    auto data = GLTexture::checkerboard_data({256,512}, 1.0f, 0.0f);
+    renderer->set_data({256,512}, data.data());
+
+    std::vector<float> apertures = {10.0f, 30.0f, 60.0f, 130.0f, 220.0f};
+    for(auto aperture : apertures) {
+        renderer->set_geometry_degrees({-0.5f*aperture, 0.5f*aperture}, {0,50});
+        for(unsigned int subdivisions : {0u, 8u, 32u}) {
+            renderer->set_sector_subdivisions(subdivisions);
+            GLuint64 fragments = count_fragments(display);
+            cout << "aperture " << aperture << " deg, "
+                 << (subdivisions ? to_string(subdivisions) + " subdivisions" : "quad")
+                 << " : " << time_frames(display, frameCount) << " ms/frame";
+            if(fragments)
+                cout << ", " << fragments << " fragments";
+            cout << endl;
+        }
+    }
+
+    return 0;
+}
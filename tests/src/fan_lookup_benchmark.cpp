@@ -0,0 +1,63 @@
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/renderers/FanRenderer.h>
+using namespace rtac::display;
+
+// Compares the per-frame cost of the FanRenderer shader modes at 4K (run
+// with LIBGL_ALWAYS_SOFTWARE=1 to benchmark under llvmpipe).
+double time_frames(Display& display, unsigned int frameCount)
+{
+    // warmup (lookup table build, shader compilation...)
+    display.draw();
+    glFinish();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for(unsigned int i = 0; i < frameCount; i++) {
+        display.draw();
+    }
+    glFinish();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / frameCount;
+}
+
+int main()
+{
+    unsigned int frameCount = 50;
+
+    Display display(3840, 2160);
+    display.disable_frame_counter();
+
+    auto renderer = display.create_renderer<FanRenderer>(View::New());
+    renderer->set_geometry_degrees({-65,65}, {0,20});
+
+    auto data = GLTexture::checkerboard_data({256,512}, 1.0f, 0.0f);
+    renderer->set_data({256,512}, data.data());
+    renderer->set_value_range({0.0f,1.0f});
+
+    std::vector<float> bearings(256);
+    for(size_t i = 0; i < bearings.size(); i++) {
+        bearings[i] = 65.0f*M_PI/180.0f
+                    * tan(0.5f*M_PI*(((float)i) / (bearings.size() - 1) - 0.5f));
+    }
+
+    renderer->disable_bearing_map();
+    cout << "linear bearings                  : "
+         << time_frames(display, frameCount) << " ms/frame" << endl;
+
+    renderer->set_bearings(bearings.size(), bearings.data());
+    cout << "bearing map                      : "
+         << time_frames(display, frameCount) << " ms/frame" << endl;
+
+    renderer->enable_lookup_table();
+    cout << "lookup table (bearing map)       : "
+         << time_frames(display, frameCount) << " ms/frame" << endl;
+
+    renderer->enable_lookup_table(1024);
+    cout << "lookup table (1024, bearing map) : "
+         << time_frames(display, frameCount) << " ms/frame" << endl;
+
+    return 0;
+}
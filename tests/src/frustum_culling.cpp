@@ -0,0 +1,75 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/MeshRenderer.h>
+using namespace rtac::display;
+
+#include "mesh_helpers.h"
+using namespace rtac::display::tests;
+
+// A grid of small meshes around a large split terrain. Renderers and terrain
+// chunks outside of the view are culled : the drawn and culled counts are
+// printed every second while the camera turns around. Renderer culling is
+// toggled every second for comparison.
+
+GLMesh::Ptr make_terrain(unsigned int size, float extent)
+{
+    auto mesh = make_heightfield(size, extent, [](float x, float y) {
+        return 0.5f*std::sin(0.3f*x)*std::cos(0.2f*y) - 1.0f;
+    });
+    mesh->split(16384);
+    return mesh;
+}
+
+int main()
+{
+    samples::Display3D display;
+    display.view()->set_fovy(60.0f);
+
+    auto terrain = display.create_renderer<MeshRenderer>(display.view());
+    terrain->mesh() = make_terrain(1024, 100.0f);
+    terrain->set_render_mode(MeshRenderer::WireFrame);
+    terrain->set_color({0.3f,0.6f,0.3f,1.0f});
+
+    GLMesh::ConstPtr icosahedron = GLMesh::icosahedron(0.5f);
+    for(int i = -10; i <= 10; i++) {
+        for(int j = -10; j <= 10; j++) {
+            auto renderer = display.create_renderer<MeshRenderer>(display.view());
+            renderer->mesh() = icosahedron;
+            renderer->set_render_mode(MeshRenderer::Solid);
+            renderer->set_pose(MeshRenderer::Pose({4.0f*i, 4.0f*j, 0.0f}));
+            if(i % 5 == 0 && j % 5 == 0) {
+                display.create_renderer<Frame>(display.view(),
+                    Frame::Pose({4.0f*i, 4.0f*j, 1.0f}));
+            }
+        }
+    }
+
+    auto t0 = Clock::now(), tPrint = t0;
+    unsigned int frames = 0;
+    while(!display.should_close()) {
+        float t = std::chrono::duration<float>(Clock::now() - t0).count();
+        display.view()->look_at({0,0,0}, {10.0f*std::cos(0.2f*t),
+                                          10.0f*std::sin(0.2f*t), 3.0f});
+        display.draw();
+        frames++;
+        if(Clock::now() - tPrint > 1s) {
+            cout << (display.culling_enabled() ? "culling on  : " : "culling off : ")
+                 << frames << " fps, renderers drawn : " << display.drawn_count()
+                 << ", culled : " << display.culled_count()
+                 << ", terrain chunks drawn : " << terrain->drawn_chunk_count()
+                 << ", culled : " << terrain->culled_chunk_count() << endl;
+            if(display.culling_enabled()) display.disable_culling();
+            else                          display.enable_culling();
+            frames = 0;
+            tPrint = Clock::now();
+        }
+    }
+
+    return 0;
+}
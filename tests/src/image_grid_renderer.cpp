@@ -0,0 +1,125 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/renderers/ImageGridRenderer.h>
+#include <rtac_display/renderers/ImageRenderer.h>
+#include <rtac_display/colormaps/Viridis.h>
+using namespace rtac::display;
+
+#include "timing_helpers.h"
+using namespace rtac::display::tests;
+
+// Displays 36 animated feeds with a single ImageGridRenderer and compares the
+// frame time with one ImageRenderer per feed. A second grid with feeds of
+// different shapes (atlas layout) is displayed afterwards.
+
+std::vector<uint8_t> feed_data(const Shape& shape, unsigned int index, unsigned int frame)
+{
+    std::vector<uint8_t> data(shape.area());
+    for(unsigned int h = 0; h < shape.height; h++) {
+        for(unsigned int w = 0; w < shape.width; w++) {
+            float v = 0.5f + 0.5f*std::sin(0.1f*(w + 3*index) + 0.05f*frame)
+                                 *std::cos(0.07f*h);
+            data[shape.width*h + w] = (uint8_t)(255.0f*v);
+        }
+    }
+    return data;
+}
+
+int main()
+{
+    unsigned int feedCount  = 36;
+    unsigned int frameCount = 200;
+    Shape shape({160,120});
+
+    Display display;
+    display.disable_frame_counter();
+
+    auto view = View::New();
+    view->set_screen_size(display.window_shape());
+
+    std::vector<std::vector<uint8_t>> feeds;
+    for(unsigned int i = 0; i < feedCount; i++) {
+        feeds.push_back(feed_data(shape, i, 0));
+    }
+
+    // One ImageRenderer per feed (drawn on top of each other, only the draw
+    // cost is measured).
+    std::vector<ImageRenderer::Ptr> renderers;
+    for(unsigned int i = 0; i < feedCount; i++) {
+        auto renderer = ImageRenderer::Create(display.context());
+        renderer->set_image(shape, feeds[i].data());
+        renderers.push_back(renderer);
+    }
+    for(auto& r : renderers) r->draw(view);
+    glFinish();
+    auto t0 = Clock::now();
+    for(unsigned int n = 0; n < frameCount; n++) {
+        for(unsigned int i = 0; i < feedCount; i++) {
+            renderers[i]->set_image(shape, feeds[i].data());
+            renderers[i]->draw(view);
+        }
+    }
+    glFinish();
+    double tSeparate = elapsed_ms(t0) / frameCount;
+
+    auto grid = display.create_renderer<ImageGridRenderer>(view);
+    grid->reset<uint8_t>(feedCount, shape);
+    unsigned int viridis = grid->add_colormap(colormap::Viridis());
+    for(unsigned int i = 0; i < feedCount; i += 2) {
+        grid->set_colormap(i, viridis);
+    }
+    for(unsigned int i = 0; i < feedCount; i += 3) {
+        grid->set_value_range(i, {64.0f, 192.0f});
+    }
+    for(unsigned int i = 0; i < feedCount; i++) {
+        grid->set_feed(i, feeds[i].data());
+    }
+    grid->draw(view);
+    glFinish();
+    t0 = Clock::now();
+    for(unsigned int n = 0; n < frameCount; n++) {
+        for(unsigned int i = 0; i < feedCount; i++) {
+            grid->set_feed(i, feeds[i].data());
+        }
+        grid->draw(view);
+    }
+    glFinish();
+    double tGrid = elapsed_ms(t0) / frameCount;
+
+    cout << feedCount << " feeds " << shape.width << "x" << shape.height
+         << " (upload + draw) : "
+         << tSeparate << " ms with ImageRenderer, "
+         << tGrid     << " ms with ImageGridRenderer" << endl;
+
+    unsigned int frame = 0;
+    auto tSwitch = Clock::now();
+    bool atlas = false;
+    while(!display.should_close()) {
+        if(!atlas && Clock::now() - tSwitch > 5s) {
+            // mixed shapes : atlas layout.
+            std::vector<Shape> shapes;
+            for(unsigned int i = 0; i < 12; i++) {
+                shapes.push_back(Shape({80 + 40*(i % 4), 60 + 30*(i % 3)}));
+            }
+            grid->reset<uint8_t>(shapes);
+            feeds.resize(shapes.size());
+            feedCount = shapes.size();
+            atlas = true;
+            cout << "Atlas layout : " << grid->images()->width() << "x"
+                 << grid->images()->height() << endl;
+        }
+        frame++;
+        for(unsigned int i = 0; i < feedCount; i++) {
+            feeds[i] = feed_data(grid->feed_shape(i), i, frame);
+            grid->set_feed(i, feeds[i].data());
+        }
+        display.draw();
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+#include <rtac_display/samples/ImageDisplay.h>
+using namespace rtac::display;
+
+// High dynamic range float image (with NaN holes and a few outliers)
+// displayed with several range modes, scalings and gammas. The image is
+// uploaded once, only uniforms change afterwards.
+
+int main()
+{
+    unsigned int W = 512, H = 512;
+    std::vector<float> data(W*H);
+    for(unsigned int h = 0; h < H; h++) {
+        for(unsigned int w = 0; w < W; w++) {
+            float x = ((float)w) / W - 0.5f, y = ((float)h) / H - 0.5f;
+            // amplitude decaying over 5 decades from the center.
+            data[W*h + w] = 1000.0f*std::exp(-25.0f*(x*x + y*y))
+                          * (1.0f + 0.2f*std::sin(60.0f*x));
+            if((w / 32 + h / 32) % 7 == 0)
+                data[W*h + w] = std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+    data[W*(H/2) + W/4] = 1.0e6f; // outlier
+
+    samples::ImageDisplay display;
+    auto renderer = display.renderer();
+    renderer->set_image({W,H}, data.data());
+    renderer->set_viridis_colormap();
+    renderer->set_nan_color(Color::RGBAf({1.0f, 0.0f, 1.0f, 1.0f}));
+
+    using Mode = ImageRenderer::RangeMode;
+    using Scaling = ImageRenderer::Scaling;
+
+    unsigned int step = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    while(!display.should_close()) {
+        auto t = std::chrono::high_resolution_clock::now();
+        if(step == 0 || t - t0 > 2s) {
+            switch(step % 6) {
+                default:
+                case 0:
+                    renderer->set_scaling(Scaling::Linear);
+                    renderer->set_gamma(1.0f);
+                    renderer->set_range_mode(Mode::MinMax);
+                    cout << "linear, min/max";
+                    break;
+                case 1:
+                    renderer->set_range_mode(Mode::Percentile);
+                    cout << "linear, 1%-99% percentiles";
+                    break;
+                case 2:
+                    renderer->set_gamma(0.4f);
+                    cout << "linear, 1%-99% percentiles, gamma 0.4";
+                    break;
+                case 3:
+                    renderer->set_gamma(1.0f);
+                    renderer->set_scaling(Scaling::Log);
+                    renderer->set_range_mode(Mode::MinMax);
+                    cout << "log10, min/max";
+                    break;
+                case 4:
+                    renderer->set_scaling(Scaling::Decibel);
+                    renderer->set_value_range({-20.0f, 60.0f});
+                    cout << "dB, fixed range";
+                    break;
+                case 5:
+                    renderer->set_range_mode(Mode::Percentile);
+                    cout << "dB, 1%-99% percentiles";
+                    break;
+            }
+            auto range = renderer->value_range();
+            cout << " : [" << range.min << ", " << range.max << "]" << endl;
+            step++;
+            t0 = t;
+        }
+        display.draw();
+        this_thread::sleep_for(10ms);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/renderers/ImageRenderer.h>
+using namespace rtac::display;
+
+// Counts the heap allocations made by ImageRenderer::draw for a grid of
+// image tiles (the steady state draw path is expected to make none).
+
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    if(void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main()
+{
+    unsigned int tileCount  = 32;
+    unsigned int frameCount = 200;
+
+    Display display;
+    display.disable_frame_counter();
+
+    std::vector<ImageRenderer::Ptr> tiles;
+    for(unsigned int i = 0; i < tileCount; i++) {
+        auto renderer = ImageRenderer::Create(display.context());
+        auto data = GLTexture::checkerboard_data({64,48}, (uint8_t)255, (uint8_t)(8*i));
+        renderer->set_image({64,48}, data.data());
+        if(i % 2)
+            renderer->set_gray_colormap();
+        tiles.push_back(renderer);
+    }
+
+    auto view = View::New();
+    view->set_screen_size(display.window_shape());
+
+    // first draw (quad buffers creation)
+    for(auto& tile : tiles) tile->draw(view);
+    glFinish();
+
+    size_t count0 = allocationCount;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for(unsigned int n = 0; n < frameCount; n++) {
+        for(auto& tile : tiles) {
+            tile->draw(view);
+        }
+    }
+    glFinish();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    size_t count = allocationCount - count0;
+
+    cout << tileCount << " tiles : "
+         << ((double)count) / frameCount << " allocations per frame, "
+         << std::chrono::duration<double, std::milli>(t1 - t0).count() / frameCount
+         << " ms per frame" << endl;
+
+    return count == 0 ? 0 : 1;
+}
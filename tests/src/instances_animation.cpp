@@ -0,0 +1,82 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/FrameInstances.h>
+using namespace rtac::display;
+
+#include "timing_helpers.h"
+using namespace rtac::display::tests;
+
+// Animates a grid of frames (count given as argument, 1e5 by default, up to
+// 1e6). Each displayed frame, a rolling window of 1% of the instances is
+// rotated with FrameInstances::update_poses, so only the modified blocks are
+// uploaded. Every 300 frames, the demo switches between partial updates and
+// updating every instance, and prints the mean update + draw time.
+
+using Pose = FrameInstances::Pose;
+
+Pose grid_pose(size_t index, size_t side, float angle)
+{
+    float x = 0.5f*(index % side) - 0.25f*side;
+    float y = 0.5f*(index / side) - 0.25f*side;
+    return Pose({x, y, 0.0f}, Pose::Quaternion(
+        Eigen::AngleAxisf(angle + 0.01f*index, Eigen::Vector3f::UnitZ())));
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t side  = (size_t)std::ceil(std::sqrt((double)count));
+
+    samples::Display3D display;
+    display.disable_frame_counter();
+    display.create_renderer<Frame>(display.view());
+    display.controls()->look_at({0,0,0}, {0.3f*side, 0.25f*side, 0.2f*side});
+
+    auto frames = display.create_renderer<FrameInstances>(display.view());
+    std::vector<Pose> poses(count);
+    for(size_t i = 0; i < count; i++) {
+        poses[i] = grid_pose(i, side, 0.0f);
+    }
+    frames->set_poses(poses);
+
+    size_t window = std::max<size_t>(1, count / 100);
+    std::vector<Pose> windowPoses(window);
+    unsigned int frameCount = 0;
+    double elapsed = 0.0;
+    while(!display.should_close()) {
+        bool updateAll = (frameCount / 300) % 2 == 1;
+        float angle    = 0.05f*frameCount;
+
+        auto t0 = Clock::now();
+        if(updateAll) {
+            for(size_t i = 0; i < count; i++) {
+                poses[i] = grid_pose(i, side, angle);
+            }
+            frames->update_poses(0, poses);
+        }
+        else {
+            size_t offset = (frameCount*window) % (count - window + 1);
+            for(size_t i = 0; i < window; i++) {
+                windowPoses[i] = grid_pose(offset + i, side, angle);
+            }
+            frames->update_poses(offset, windowPoses);
+        }
+        display.draw();
+        glFinish();
+        elapsed += elapsed_ms(t0);
+
+        frameCount++;
+        if(frameCount % 300 == 0) {
+            cout << count << " frames, " << (updateAll ? "all" : "1%")
+                 << " updated : " << elapsed / 300 << " ms per frame" << endl;
+            elapsed = 0.0;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <cstring>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/MeshRenderer.h>
+using namespace rtac::display;
+
+#include "mesh_helpers.h"
+using namespace rtac::display::tests;
+
+// Preprocesses a ~10M triangles mesh (split, levels of detail, compact
+// packing), saves it to a cache file and compares the time to first frame
+// with and without the cache (raw and LZ4 compressed if available). The
+// reloaded meshes are checked against the original one (chunks, levels of
+// detail, packed vertex bytes).
+
+template <typename T>
+bool same_data(const GLVector<T>& a, const GLVector<T>& b)
+{
+    if(a.size() != b.size()) return false;
+    if(a.size() == 0)        return true;
+    std::vector<T> ha(a.size()), hb(b.size());
+    a.copy_to(ha.data());
+    b.copy_to(hb.data());
+    return std::memcmp(ha.data(), hb.data(), sizeof(T)*ha.size()) == 0;
+}
+
+bool same_mesh(const GLMesh& a, const GLMesh& b)
+{
+    if(a.vertex_count()  != b.vertex_count()
+    || a.vertex_stride() != b.vertex_stride()
+    || a.chunks().size() != b.chunks().size()
+    || a.lod_count()     != b.lod_count()) {
+        return false;
+    }
+    for(size_t c = 0; c < a.chunks().size(); c++) {
+        const auto& ca = a.chunks()[c];
+        const auto& cb = b.chunks()[c];
+        if(ca.indexOffset != cb.indexOffset || ca.indexCount  != cb.indexCount
+        || ca.baseVertex  != cb.baseVertex  || ca.vertexCount != cb.vertexCount) {
+            return false;
+        }
+        if(a.lods(c).size() != b.lods(c).size()) return false;
+        for(size_t l = 0; l < a.lods(c).size(); l++) {
+            const auto& la = a.lods(c)[l];
+            const auto& lb = b.lods(c)[l];
+            if(la.indexOffset != lb.indexOffset || la.indexCount != lb.indexCount
+            || la.error != lb.error) {
+                return false;
+            }
+        }
+    }
+    return same_data(a.vertices(),          b.vertices())
+        && same_data(a.chunk_indices(),     b.chunk_indices())
+        && same_data(a.lod_chunk_indices(), b.lod_chunk_indices())
+        && same_data(a.lod_indices(),       b.lod_indices());
+}
+
+int main()
+{
+    unsigned int size = 2237; // ~10M triangles
+    std::string cachePath = "mesh_cache_benchmark.cache";
+
+    samples::Display3D display;
+    display.disable_frame_counter();
+    display.controls()->look_at({0,0,0}, {8,6,5});
+
+    auto renderer = display.create_renderer<MeshRenderer>(display.view());
+    renderer->set_render_mode(MeshRenderer::Solid);
+
+    auto t0 = Clock::now();
+    auto mesh = make_heightfield(size);
+    mesh->split();
+    mesh->generate_lods(3);
+    mesh->wait_lods();
+    mesh->pack();
+    renderer->mesh() = mesh;
+    display.draw();
+    glFinish();
+    double buildTime = elapsed_ms(t0);
+
+    mesh->save_cache(cachePath);
+    t0 = Clock::now();
+    auto loaded = GLMesh::load_cache(cachePath);
+    renderer->mesh() = loaded;
+    display.draw();
+    glFinish();
+    double rawTime = elapsed_ms(t0);
+
+    cout << "preprocessing : " << buildTime << " ms to first frame" << endl;
+    cout << "cache         : " << rawTime   << " ms to first frame" << endl;
+    bool roundTrip = same_mesh(*mesh, *loaded);
+
+    if(GLMesh::cache_compression_available()) {
+        mesh->save_cache(cachePath, 0, true);
+        t0 = Clock::now();
+        loaded = GLMesh::load_cache(cachePath);
+        renderer->mesh() = loaded;
+        display.draw();
+        glFinish();
+        cout << "cache (LZ4)   : " << elapsed_ms(t0) << " ms to first frame" << endl;
+        roundTrip = roundTrip && same_mesh(*mesh, *loaded);
+    }
+    std::remove(cachePath.c_str());
+
+    if(!roundTrip) {
+        cout << "error : the reloaded mesh differs from the saved one" << endl;
+        return 1;
+    }
+    cout << "round trip ok" << endl;
+
+    while(!display.should_close()) {
+        display.draw();
+    }
+
+    return 0;
+}
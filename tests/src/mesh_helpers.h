@@ -0,0 +1,95 @@
+#ifndef _DEF_RTAC_DISPLAY_TESTS_MESH_HELPERS_H_
+#define _DEF_RTAC_DISPLAY_TESTS_MESH_HELPERS_H_
+
+#include <vector>
+#include <cmath>
+
+#include <rtac_display/GLMesh.h>
+#include <rtac_display/samples/Display3D.h>
+
+#include "timing_helpers.h"
+
+// Mesh generation and frame timing helpers shared by the mesh benchmarks.
+
+namespace rtac { namespace display { namespace tests {
+
+/**
+ * Mean frame time of count draws (after a first warm up draw), in ms.
+ */
+inline double draw_time(samples::Display3D& display, unsigned int count)
+{
+    display.draw();
+    glFinish();
+    auto t0 = Clock::now();
+    for(unsigned int i = 0; i < count; i++) {
+        display.draw();
+    }
+    glFinish();
+    return elapsed_ms(t0) / count;
+}
+
+/**
+ * Regular grid of size x size vertices covering [-extent/2, extent/2]^2 with
+ * z = height(x,y), 2 triangles per cell.
+ *
+ * If withAttributes is true, per vertex normals (central differences of
+ * height) and uvs (grid coordinates in [0,1]) are also set. The normals are
+ * not computed with GLMesh::compute_normals which would expand the vertices.
+ */
+template <class HeightF>
+GLMesh::Ptr make_heightfield(unsigned int size, float extent, HeightF height,
+                             bool withAttributes = false)
+{
+    std::vector<GLMesh::Point>  points(size*size);
+    std::vector<GLMesh::Normal> normals(withAttributes ? size*size : 0);
+    std::vector<GLMesh::UV>     uvs(withAttributes ? size*size : 0);
+    float step = extent / (size - 1);
+    for(unsigned int h = 0; h < size; h++) {
+        for(unsigned int w = 0; w < size; w++) {
+            float u = ((float)w) / (size - 1), v = ((float)h) / (size - 1);
+            float x = extent*(u - 0.5f), y = extent*(v - 0.5f);
+            points[size*h + w] = GLMesh::Point({x, y, height(x, y)});
+            if(withAttributes) {
+                float dx = (height(x + step, y) - height(x - step, y)) / (2.0f*step);
+                float dy = (height(x, y + step) - height(x, y - step)) / (2.0f*step);
+                float n  = std::sqrt(dx*dx + dy*dy + 1.0f);
+                normals[size*h + w] = GLMesh::Normal({-dx / n, -dy / n, 1.0f / n});
+                uvs[size*h + w]     = GLMesh::UV({u, v});
+            }
+        }
+    }
+    std::vector<GLMesh::Face> faces;
+    faces.reserve(2*(size - 1)*(size - 1));
+    for(unsigned int h = 0; h + 1 < size; h++) {
+        for(unsigned int w = 0; w + 1 < size; w++) {
+            uint32_t i = size*h + w;
+            faces.push_back(GLMesh::Face({i, i + 1, i + size + 1}));
+            faces.push_back(GLMesh::Face({i, i + size + 1, i + size}));
+        }
+    }
+
+    auto mesh = GLMesh::Create();
+    mesh->points().set_data(points.size(), points.data());
+    mesh->faces().set_data(faces.size(), faces.data());
+    if(withAttributes) {
+        mesh->normals().set_data(normals.size(), normals.data());
+        mesh->uvs().set_data(uvs.size(), uvs.data());
+    }
+    return mesh;
+}
+
+/**
+ * Small bumpy heightfield over [-5,5]^2 used by most mesh benchmarks.
+ */
+inline GLMesh::Ptr make_heightfield(unsigned int size, bool withAttributes = false)
+{
+    return make_heightfield(size, 10.0f, [](float x, float y) {
+        return 0.5f*std::sin(1.2f*x)*std::cos(0.9f*y);
+    }, withAttributes);
+}
+
+}; //namespace tests
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_TESTS_MESH_HELPERS_H_
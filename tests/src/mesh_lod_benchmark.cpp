@@ -0,0 +1,104 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/MeshRenderer.h>
+using namespace rtac::display;
+
+#include "mesh_helpers.h"
+using namespace rtac::display::tests;
+
+// Generates the levels of detail of a large split terrain on a worker thread
+// (the display keeps running in the meantime), then compares the number of
+// triangles drawn and the frame time with several screen space error
+// thresholds, from several distances. Also checks that an unwelded mesh
+// (vertices expanded by compute_normals) is simplified as well.
+
+GLMesh::Ptr make_terrain(unsigned int size, float extent, bool withNormals = false)
+{
+    auto mesh = make_heightfield(size, extent, [](float x, float y) {
+        return 2.0f*std::sin(0.3f*x)*std::cos(0.2f*y) + 0.1f*std::sin(3.0f*x + 2.0f*y);
+    });
+    if(withNormals) {
+        mesh->compute_normals();
+    }
+    mesh->split(16384);
+    return mesh;
+}
+
+int main()
+{
+    unsigned int size  = 2048; // ~8M triangles
+    unsigned int count = 50;
+
+    samples::Display3D display;
+    display.disable_frame_counter();
+
+    {
+        auto soup = make_terrain(256, 200.0f, true);
+        soup->generate_lods(2);
+        soup->wait_lods();
+        size_t fullCount = 0, lodCount = 0;
+        for(size_t c = 0; c < soup->chunks().size(); c++) {
+            const auto& lods = soup->lods(c);
+            fullCount += soup->chunks()[c].indexCount / 3;
+            lodCount  += (lods.empty() ? soup->chunks()[c].indexCount
+                                       : lods.back().indexCount) / 3;
+        }
+        cout << "unwelded mesh : " << fullCount << " triangles, last level "
+             << lodCount << " triangles" << endl;
+        if(lodCount >= fullCount) {
+            cout << "error : unwelded mesh was not simplified" << endl;
+            return 1;
+        }
+    }
+
+    auto renderer = display.create_renderer<MeshRenderer>(display.view());
+    renderer->set_render_mode(MeshRenderer::Solid);
+    renderer->set_color({0.3f,0.6f,0.3f,1.0f});
+
+    auto mesh = make_terrain(size, 200.0f);
+    renderer->mesh() = mesh;
+
+    auto t0 = Clock::now();
+    mesh->generate_lods(4);
+    unsigned int frames = 0;
+    while(mesh->lods_pending() && !display.should_close()) {
+        display.draw(); // update_lods is called by the renderer
+        frames++;
+    }
+    double lodTime = std::chrono::duration<double>(Clock::now() - t0).count();
+    cout << "levels of detail : " << mesh->lod_count() << " levels for "
+         << mesh->chunks().size() << " chunks in " << lodTime << " s ("
+         << frames << " frames drawn meanwhile)" << endl;
+    for(unsigned int l = 0; l < mesh->lods(0).size(); l++) {
+        cout << "  chunk 0, level " << l + 1 << " : "
+             << mesh->lods(0)[l].indexCount / 3 << " triangles, error "
+             << mesh->lods(0)[l].error << endl;
+    }
+
+    for(float distance : {20.0f, 100.0f, 400.0f}) {
+        display.controls()->look_at({0,0,0}, {distance, 0.0f, 0.5f*distance});
+        for(float threshold : {0.0f, 1.0f, 4.0f}) {
+            renderer->set_lod_threshold(threshold);
+            double t = draw_time(display, count);
+            cout << "distance " << distance << ", threshold " << threshold << " px : "
+                 << renderer->drawn_triangle_count() << " triangles, "
+                 << t << " ms" << endl;
+        }
+    }
+
+    renderer->set_lod_threshold(1.0f);
+    t0 = Clock::now();
+    while(!display.should_close()) {
+        float t = std::chrono::duration<float>(Clock::now() - t0).count();
+        float distance = 210.0f + 200.0f*std::sin(0.2f*t);
+        display.controls()->look_at({0,0,0}, {distance, 0.0f, 0.5f*distance});
+        display.draw();
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/MeshRenderer.h>
+using namespace rtac::display;
+
+#include "mesh_helpers.h"
+using namespace rtac::display::tests;
+
+// Compares the device memory footprint and the draw time of a ~10M triangles
+// mesh stored with separate float buffers and with the compact interleaved
+// layout (16 bits positions, octahedral normals, half float uvs).
+
+int main()
+{
+    unsigned int size  = 2237; // 2*2236^2 ~ 10M triangles
+    unsigned int count = 50;
+
+    samples::Display3D display;
+    display.disable_frame_counter();
+    display.controls()->look_at({0,0,0}, {8,6,5});
+
+    auto renderer = display.create_renderer<MeshRenderer>(display.view());
+    renderer->set_render_mode(MeshRenderer::NormalShading);
+
+    auto mesh = make_heightfield(size, true);
+    renderer->mesh() = mesh;
+    cout << "faces : " << mesh->faces().size()
+         << ", vertices : " << mesh->vertex_count() << endl;
+
+    size_t floatSize = mesh->memory_size();
+    double floatTime = draw_time(display, count);
+
+    mesh->pack(GLMesh::VertexFormat::Float32(), true);
+    size_t interleavedSize = mesh->memory_size() - floatSize;
+    double interleavedTime = draw_time(display, count);
+
+    mesh->pack(GLMesh::VertexFormat::Compact());
+    size_t compactSize = mesh->memory_size();
+    double compactTime = draw_time(display, count);
+
+    cout << "separate float buffers : " << floatSize / (1024*1024) << " MiB, "
+         << floatTime << " ms" << endl;
+    cout << "interleaved float      : " << (interleavedSize + 12*mesh->faces().size())
+                                           / (1024*1024) << " MiB, "
+         << interleavedTime << " ms (32 bytes per vertex)" << endl;
+    cout << "interleaved compact    : " << compactSize / (1024*1024) << " MiB, "
+         << compactTime << " ms (" << mesh->vertex_stride() << " bytes per vertex)" << endl;
+
+    while(!display.should_close()) {
+        display.draw();
+    }
+
+    return 0;
+}
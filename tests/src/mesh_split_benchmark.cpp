@@ -0,0 +1,90 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/MeshRenderer.h>
+using namespace rtac::display;
+
+#include "mesh_helpers.h"
+using namespace rtac::display::tests;
+
+// Splits a large heightfield in chunks of 16 bits indices and compares the
+// vertex cache efficiency (average cache miss ratio, simulated 32 entries
+// FIFO) and the draw time with the original 32 bits indexed mesh.
+
+template <typename T>
+double acmr(const T* indices, size_t count, int baseVertex = 0)
+{
+    std::deque<uint32_t> cache;
+    size_t misses = 0;
+    for(size_t i = 0; i < count; i++) {
+        uint32_t v = baseVertex + indices[i];
+        if(std::find(cache.begin(), cache.end(), v) == cache.end()) {
+            misses++;
+            cache.push_front(v);
+            if(cache.size() > 32) cache.pop_back();
+        }
+    }
+    return (3.0*misses) / count;
+}
+
+
+int main()
+{
+    unsigned int size  = 2237; // ~10M triangles
+    unsigned int count = 50;
+
+    samples::Display3D display;
+    display.disable_frame_counter();
+    display.controls()->look_at({0,0,0}, {8,6,5});
+
+    auto renderer = display.create_renderer<MeshRenderer>(display.view());
+    renderer->set_render_mode(MeshRenderer::Solid);
+
+    auto mesh = make_heightfield(size);
+    renderer->mesh() = mesh;
+
+    double acmrBefore = 0.0;
+    {
+        auto faces = mesh->faces().map();
+        acmrBefore = acmr((const uint32_t*)&faces[0], 3*mesh->faces().size());
+    }
+    size_t sizeBefore = mesh->memory_size();
+    double timeBefore = draw_time(display, count);
+
+    auto t0 = Clock::now();
+    mesh->split();
+    double splitTime = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    size_t indexCount = 0;
+    double acmrAfter  = 0.0;
+    {
+        auto indices = mesh->chunk_indices().map();
+        for(const auto& chunk : mesh->chunks()) {
+            acmrAfter  += chunk.indexCount * acmr(&indices[chunk.indexOffset],
+                                                   chunk.indexCount, chunk.baseVertex);
+            indexCount += chunk.indexCount;
+        }
+        acmrAfter /= indexCount;
+    }
+    size_t sizeAfter = mesh->memory_size();
+    double timeAfter = draw_time(display, count);
+
+    cout << "split : " << mesh->chunks().size() << " chunks in "
+         << splitTime << " ms" << endl;
+    cout << "32 bits indices : " << sizeBefore / (1024*1024) << " MiB, ACMR "
+         << acmrBefore << ", " << timeBefore << " ms" << endl;
+    cout << "16 bits chunks  : " << sizeAfter / (1024*1024) << " MiB, ACMR "
+         << acmrAfter << ", " << timeAfter << " ms" << endl;
+
+    while(!display.should_close()) {
+        display.draw();
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <thread>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/renderers/MultiFanRenderer.h>
+using namespace rtac::display;
+
+// Six sonar heads side by side with overlapping fans, composited in a single
+// draw call. The blend mode cycles through Max, Mean and Latest every 120
+// frames.
+
+std::vector<uint8_t> ping_data(const Shape& shape, unsigned int sensor, float t)
+{
+    std::vector<uint8_t> data(shape.area());
+    for(unsigned int h = 0; h < shape.height; h++) {
+        for(unsigned int w = 0; w < shape.width; w++) {
+            float v = 0.5f + 0.5f*sin(0.1f*h - 2.0f*t + sensor)
+                                *cos(0.05f*w + 0.3f*sensor);
+            data[shape.width*h + w] = (uint8_t)(255.0f*v);
+        }
+    }
+    return data;
+}
+
+int main()
+{
+    unsigned int sensorCount = 6;
+    Shape shape({128,512});
+
+    Display display;
+    display.disable_frame_counter();
+
+    auto renderer = display.create_renderer<MultiFanRenderer>(View::New(), sensorCount);
+    renderer->set_direction(FanRenderer::Direction::Up);
+    renderer->set_value_range({0.0f, 255.0f});
+
+    std::vector<float> bearings(128);
+    for(size_t i = 0; i < bearings.size(); i++) {
+        bearings[i] = 60.0f*M_PI/180.0f
+                    * tan(0.5f*M_PI*(((float)i) / (bearings.size() - 1) - 0.5f));
+    }
+
+    for(unsigned int i = 0; i < sensorCount; i++) {
+        float heading = (((float)i) - 0.5f*(sensorCount - 1)) * 30.0f*M_PI/180.0f;
+        renderer->set_pose(i, 2.0f*i, 0.0f, heading);
+        renderer->set_geometry_degrees(i, {-60,60}, {0.5,20});
+        if(i % 2) {
+            renderer->set_bearings(i, bearings.size(), bearings.data());
+        }
+    }
+
+    std::vector<MultiFanRenderer::BlendMode> modes = {
+        MultiFanRenderer::BlendMode::Max,
+        MultiFanRenderer::BlendMode::Mean,
+        MultiFanRenderer::BlendMode::Latest};
+
+    unsigned int frame = 0;
+    while(!display.should_close()) {
+        float t = 0.02f*frame;
+        unsigned int sensor = frame % sensorCount;
+        renderer->set_data(sensor, shape, ping_data(shape, sensor, t).data());
+        renderer->set_blend_mode(modes[(frame / 120) % modes.size()]);
+
+        display.draw();
+        frame++;
+        std::this_thread::sleep_for(16ms);
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/Half.h>
+#include <rtac_display/GLReductor.h>
+#include <rtac_display/renderers/FanRenderer.h>
+using namespace rtac::display;
+
+#include "timing_helpers.h"
+using namespace rtac::display::tests;
+
+// Compares float32 and narrow (uint8, uint16, half) sonar data : host to
+// device upload time, GPU min/max and frame time of the FanRenderer.
+
+template <typename T>
+std::vector<T> make_data(const Shape& shape, float maxValue)
+{
+    std::vector<T> data(shape.area());
+    for(unsigned int h = 0; h < shape.height; h++) {
+        for(unsigned int w = 0; w < shape.width; w++) {
+            float v = 0.5f + 0.5f*sin(0.05f*w)*cos(0.01f*h);
+            data[shape.width*h + w] = T(maxValue*v);
+        }
+    }
+    return data;
+}
+
+template <typename T>
+void benchmark(const std::string& name, Display& display,
+               const FanRenderer::Ptr& renderer, float maxValue,
+               unsigned int count)
+{
+    Shape shape({512,2048});
+    auto data = make_data<T>(shape, maxValue);
+
+    // host to device texture upload
+    renderer->set_data(shape, data.data());
+    glFinish();
+    auto t0 = Clock::now();
+    for(unsigned int i = 0; i < count; i++) {
+        renderer->set_data(shape, data.data());
+    }
+    glFinish();
+    double tUpload = elapsed_ms(t0) / count;
+
+    // device upload followed by a GPU min/max (value range)
+    GLVector<T> deviceData(data.size(), data.data());
+    renderer->set_data(shape, deviceData);
+    glFinish();
+    t0 = Clock::now();
+    for(unsigned int i = 0; i < count; i++) {
+        deviceData.set_data(data.size(), data.data());
+        renderer->set_data(shape, deviceData);
+    }
+    glFinish();
+    double tDevice = elapsed_ms(t0) / count;
+
+    display.draw();
+    glFinish();
+    t0 = Clock::now();
+    for(unsigned int i = 0; i < count; i++) {
+        display.draw();
+    }
+    glFinish();
+    double tFrame = elapsed_ms(t0) / count;
+
+    cout << name << " (" << sizeof(T)*shape.area() / 1024 << " KiB) :"
+         << " upload " << tUpload << " ms"
+         << ", upload + range " << tDevice << " ms"
+         << ", frame " << tFrame << " ms"
+         << ", range [" << renderer->value_range().min
+         << ", " << renderer->value_range().max << "]" << endl;
+}
+
+int main()
+{
+    unsigned int count = 100;
+
+    Display display;
+    display.disable_frame_counter();
+
+    auto renderer = display.create_renderer<FanRenderer>(View::New());
+    renderer->set_geometry_degrees({-65,65}, {0,20});
+
+    benchmark<float>   ("float32", display, renderer, 1.0f,     count);
+    benchmark<uint16_t>("uint16 ", display, renderer, 65535.0f, count);
+    benchmark<Half>    ("half   ", display, renderer, 1.0f,     count);
+    benchmark<uint8_t> ("uint8  ", display, renderer, 255.0f,   count);
+
+    // Checking GPU unpacking against host values.
+    GLReductor reductor;
+    std::vector<uint8_t> bytes = {3, 17, 250, 8, 42};
+    GLVector<uint8_t> deviceBytes(bytes.size(), bytes.data());
+    cout << "uint8 min/max : " << reductor.min_value(deviceBytes) << " "
+         << reductor.max_value(deviceBytes) << " (expected 3 250)" << endl;
+
+    std::vector<Half> halves = {Half(-1.5f), Half(0.25f), Half(1000.0f)};
+    GLVector<Half> deviceHalves(halves.size(), halves.data());
+    cout << "half min/max  : " << reductor.min_value(deviceHalves) << " "
+         << reductor.max_value(deviceHalves) << " (expected -1.5 1000)" << endl;
+
+    while(!display.should_close()) {
+        display.draw();
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/PointOctreeRenderer.h>
+using namespace rtac::display;
+
+#include "timing_helpers.h"
+using namespace rtac::display::tests;
+
+// Builds the octree of a large synthetic survey (noisy terrain, in UTM-like
+// coordinates) or opens an existing octree file (first argument), then
+// renders it under a fixed point budget. The number of drawn points stays
+// bounded whatever the size of the point cloud, the nodes are streamed from
+// the file while the camera moves. The octree is rendered in its own frame
+// (centered on PointOctree::origin()).
+
+std::vector<PointOctree::Position> make_survey(size_t count, double extent)
+{
+    const double east = 500000.0, north = 5000000.0;
+    std::vector<PointOctree::Position> points(count);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> position(-0.5*extent, 0.5*extent);
+    std::normal_distribution<double> noise(0.0, 0.02);
+    for(auto& p : points) {
+        double x = position(gen), y = position(gen);
+        p.x = east  + x;
+        p.y = north + y;
+        p.z = 4.0*std::sin(0.05*x)*std::cos(0.04*y)
+            + 0.2*std::sin(0.7*x + 0.5*y) + noise(gen);
+    }
+    return points;
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = "point_octree_renderer.octree";
+    if(argc > 1) {
+        path = argv[1];
+    }
+    else {
+        size_t count = 50000000;
+        auto t0 = Clock::now();
+        PointOctree::build(path, make_survey(count, 500.0));
+        cout << "Built octree of " << count << " points in "
+             << 1.0e-3*elapsed_ms(t0) << "s" << endl;
+    }
+
+    auto octree = PointOctree::Open(path);
+    cout << *octree << endl;
+
+    samples::Display3D display;
+    display.create_renderer<Frame>(display.view());
+
+    auto renderer = display.create_renderer<PointOctreeRenderer>(display.view(), octree);
+    renderer->set_point_budget(3000000);
+    renderer->set_color({0.4f,0.8f,0.5f,1.0f});
+
+    auto bounds = octree->bounds();
+    float radius = bounds.radius;
+
+    unsigned int frames = 0;
+    auto t0 = Clock::now();
+    while(!display.should_close()) {
+        float angle = 0.002f*frames;
+        float distance = radius*(0.4f + 0.35f*std::cos(0.5f*angle));
+        display.controls()->look_at({bounds.center.x(), bounds.center.y(), bounds.center.z()},
+            {bounds.center.x() + distance*std::cos(angle),
+             bounds.center.y() + distance*std::sin(angle),
+             bounds.center.z() + 0.3f*distance});
+        display.draw();
+        frames++;
+        if(frames % 100 == 0) {
+            double frameTime = elapsed_ms(t0) / 100;
+            cout << "frame time : " << frameTime << " ms"
+                 << ", drawn points : " << renderer->drawn_point_count()
+                 << ", drawn nodes : "  << renderer->drawn_node_count()
+                 << ", resident : "     << renderer->resident_node_count()
+                 << "/" << renderer->slot_count()
+                 << ", pending : "      << renderer->pending_node_count() << endl;
+            t0 = Clock::now();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/PointStreamRenderer.h>
+using namespace rtac::display;
+
+#include "timing_helpers.h"
+using namespace rtac::display::tests;
+
+// Simulates a scanner sweeping a terrain : a batch of points (one scan line)
+// is appended at each frame. The push time only depends on the batch size,
+// old points fade out after a few seconds.
+
+void make_scan(std::vector<PointStreamRenderer::Point>& points, double t)
+{
+    float heading = 0.5f*t;
+    float cx = 20.0f*std::cos(0.1f*t), cy = 20.0f*std::sin(0.1f*t);
+    for(size_t i = 0; i < points.size(); i++) {
+        float a = 2.0f*M_PI*i / points.size();
+        float r = 5.0f + 10.0f*(0.5f + 0.5f*std::sin(7.0f*a + heading));
+        float x = cx + r*std::cos(a + heading);
+        float y = cy + r*std::sin(a + heading);
+        points[i] = PointStreamRenderer::Point({x, y,
+            std::sin(0.2f*x)*std::cos(0.15f*y)});
+    }
+}
+
+int main()
+{
+    unsigned int batchSize = 5000;
+
+    samples::Display3D display;
+    display.create_renderer<Frame>(display.view());
+    display.controls()->look_at({0,0,0}, {40,30,40});
+
+    auto renderer = display.create_renderer<PointStreamRenderer>(display.view(), 1000000);
+    renderer->set_color({0.3f,0.9f,1.0f,1.0f});
+    renderer->set_fade_duration(5.0f);
+    renderer->set_point_size(2.0f);
+
+    std::vector<PointStreamRenderer::Point> scan(batchSize);
+    auto start = Clock::now();
+    double pushTime = 0.0;
+    unsigned int frames = 0;
+    while(!display.should_close()) {
+        double t = 1.0e-3*elapsed_ms(start);
+        make_scan(scan, t);
+
+        auto t0 = Clock::now();
+        renderer->push_points(scan.size(), scan.data(), t);
+        pushTime += 1.0e3*elapsed_ms(t0);
+
+        display.draw();
+        frames++;
+        if(frames % 100 == 0) {
+            cout << "push time : " << pushTime / 100 << " us"
+                 << ", displayed points : " << renderer->size()
+                 << ", pushed points : "    << renderer->pushed_count() << endl;
+            pushTime = 0.0;
+        }
+    }
+
+    return 0;
+}
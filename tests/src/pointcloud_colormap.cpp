@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/PointCloudRenderer.h>
+#include <rtac_display/colormaps/Gray.h>
+using namespace rtac::display;
+
+// Colors a point cloud with several per-point attributes (float height,
+// uint16_t intensity, uint8_t class). The displayed attribute changes every
+// few seconds, only the bound attribute buffer changes (no upload).
+
+int main()
+{
+    size_t count = 1000000;
+
+    std::vector<GLMesh::Point> points(count);
+    std::vector<float>         height(count);
+    std::vector<uint16_t>      intensity(count);
+    std::vector<uint8_t>       label(count);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    for(size_t i = 0; i < count; i++) {
+        float x = position(gen), y = position(gen);
+        float z = 3.0f*std::sin(0.1f*x)*std::cos(0.08f*y) + noise(gen);
+        points[i]    = GLMesh::Point({x, y, z});
+        height[i]    = z;
+        intensity[i] = (uint16_t)(30000.0f + 20000.0f*std::sin(0.5f*x + 0.3f*y));
+        label[i]     = (uint8_t)((x > 0.0f) + 2*(y > 0.0f));
+    }
+
+    samples::Display3D display;
+    display.create_renderer<Frame>(display.view());
+    display.controls()->look_at({0,0,0}, {60,50,60});
+
+    auto renderer = display.create_renderer<PointCloudRenderer>(display.view());
+    renderer->points().set_data(count, points.data());
+
+    renderer->add_attribute("height",    GLVector<float>(height));
+    renderer->add_attribute("intensity", GLVector<uint16_t>(intensity));
+    renderer->add_attribute("label",     GLVector<uint8_t>(label));
+    for(auto name : {"height", "intensity", "label"}) {
+        auto range = renderer->attribute(name).range;
+        cout << name << " range : [" << range.min << ", " << range.max << "]" << endl;
+    }
+
+    std::vector<std::string> names({"height", "intensity", "label", ""});
+    unsigned int frames = 0;
+    while(!display.should_close()) {
+        if(frames % 300 == 0) {
+            const auto& name = names[(frames / 300) % names.size()];
+            renderer->set_active_attribute(name);
+            if(name == "label") {
+                renderer->set_colormap(colormap::Gray());
+            }
+            else {
+                renderer->set_colormap(colormap::Viridis());
+            }
+            cout << "displaying : " << (name.size() > 0 ? name : "uniform color") << endl;
+        }
+        display.draw();
+        frames++;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/PointCloudRenderer.h>
+using namespace rtac::display;
+
+// Displays a sparse point cloud of a terrain with the different point
+// rendering modes of PointCloudRenderer (the mode changes every few
+// seconds) : 1 pixel points, adaptive round splats, adaptive splats with
+// eye-dome lighting and world space splats colored by height with eye-dome
+// lighting.
+
+int main()
+{
+    size_t count = 200000;
+
+    std::vector<GLMesh::Point> points(count);
+    std::vector<float>         height(count);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+    for(size_t i = 0; i < count; i++) {
+        float x = position(gen), y = position(gen);
+        float z = 4.0f*std::sin(0.1f*x)*std::cos(0.08f*y)
+                + 0.5f*std::sin(0.6f*x + 0.4f*y);
+        points[i] = GLMesh::Point({x, y, z});
+        height[i] = z;
+    }
+
+    samples::Display3D display;
+    display.create_renderer<Frame>(display.view());
+    display.controls()->look_at({0,0,0}, {60,50,40});
+
+    auto renderer = display.create_renderer<PointCloudRenderer>(display.view());
+    renderer->points().set_data(count, points.data());
+    renderer->mesh()->update_bounds();
+    renderer->add_attribute("height", GLVector<float>(height));
+    renderer->set_color({0.9f,0.9f,0.9f,1.0f});
+    renderer->set_point_size_range(1.0f, 24.0f);
+
+    unsigned int frames = 0;
+    while(!display.should_close()) {
+        if(frames % 300 == 0) {
+            switch((frames / 300) % 4) {
+                default:
+                case 0:
+                    renderer->set_point_size(1.0f);
+                    renderer->set_round_points(false);
+                    renderer->disable_eye_dome_lighting();
+                    renderer->set_active_attribute("");
+                    cout << "1 pixel points" << endl;
+                    break;
+                case 1:
+                    renderer->set_adaptive_size();
+                    renderer->set_round_points(true);
+                    cout << "adaptive round splats" << endl;
+                    break;
+                case 2:
+                    renderer->enable_eye_dome_lighting();
+                    cout << "adaptive round splats, eye-dome lighting" << endl;
+                    break;
+                case 3:
+                    renderer->set_splat_radius(0.15f);
+                    renderer->set_active_attribute("height");
+                    cout << "world space splats colored by height, eye-dome lighting" << endl;
+                    break;
+            }
+        }
+        display.draw();
+        frames++;
+    }
+
+    return 0;
+}
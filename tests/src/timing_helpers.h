@@ -0,0 +1,21 @@
+#ifndef _DEF_RTAC_DISPLAY_TESTS_TIMING_HELPERS_H_
+#define _DEF_RTAC_DISPLAY_TESTS_TIMING_HELPERS_H_
+
+#include <chrono>
+
+// Wall clock timing helpers shared by the benchmarks.
+
+namespace rtac { namespace display { namespace tests {
+
+using Clock = std::chrono::high_resolution_clock;
+
+inline double elapsed_ms(const Clock::time_point& t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+}; //namespace tests
+}; //namespace display
+}; //namespace rtac
+
+#endif //_DEF_RTAC_DISPLAY_TESTS_TIMING_HELPERS_H_
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <unordered_map>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/samples/Display3D.h>
+#include <rtac_display/renderers/Frame.h>
+#include <rtac_display/renderers/PointCloudRenderer.h>
+#include <rtac_display/GLVoxelGrid.h>
+using namespace rtac::display;
+
+#include "timing_helpers.h"
+using namespace rtac::display::tests;
+
+// Voxel grid decimation of noisy terrain point clouds (1e6 points up to the
+// count given as argument, 1e7 by default, 1e8 requires a few GB of GPU
+// memory). Compares a CPU hash map implementation with GLVoxelGrid, then
+// displays the largest cloud with a point budget of 1M points.
+
+std::vector<GLMesh::Point> make_terrain(size_t count, std::vector<float>& intensities)
+{
+    std::vector<GLMesh::Point> points(count);
+    intensities.resize(count);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    for(size_t i = 0; i < count; i++) {
+        float x = position(gen), y = position(gen);
+        float z = 5.0f*std::sin(0.05f*x)*std::cos(0.04f*y) + noise(gen);
+        points[i]      = GLMesh::Point({x, y, z});
+        intensities[i] = 0.5f + 0.5f*std::sin(0.3f*x + 0.2f*y) + noise(gen);
+    }
+    return points;
+}
+
+// first point of each voxel (same output as GLVoxelGrid::Mode::First)
+std::vector<GLMesh::Point> cpu_voxel_grid(const std::vector<GLMesh::Point>& points,
+                                          float voxelSize)
+{
+    std::unordered_map<uint64_t,uint32_t> voxels;
+    std::vector<GLMesh::Point> output;
+    for(size_t i = 0; i < points.size(); i++) {
+        uint64_t key = 0;
+        for(auto v : {points[i].x, points[i].y, points[i].z}) {
+            key = (key << 21) | ((uint64_t)(std::floor(v / voxelSize) + (1 << 20)) & 0x1fffff);
+        }
+        if(voxels.emplace(key, i).second) {
+            output.push_back(points[i]);
+        }
+    }
+    return output;
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxCount  = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    float  voxelSize = 0.25f;
+
+    samples::Display3D display;
+    display.disable_frame_counter();
+    display.create_renderer<Frame>(display.view());
+    display.controls()->look_at({0,0,0}, {120,100,80});
+
+    GLVoxelGrid grid;
+    GLVector<GLMesh::Point> output;
+    std::vector<GLMesh::Point> points;
+    std::vector<float> intensities;
+    for(size_t count = 1000000; count <= maxCount; count *= 10) {
+        points = make_terrain(count, intensities);
+
+        auto t0 = Clock::now();
+        auto expected = cpu_voxel_grid(points, voxelSize);
+        double cpuTime = elapsed_ms(t0);
+
+        GLVector<GLMesh::Point> input(points);
+        GLVector<float> inputIntensities(intensities);
+        cout << count << " points, " << expected.size() << " voxels" << endl;
+        cout << "    cpu (first) : " << cpuTime << " ms" << endl;
+
+        for(auto mode : {GLVoxelGrid::Mode::First,
+                         GLVoxelGrid::Mode::Centroid,
+                         GLVoxelGrid::Mode::MaxIntensity}) {
+            size_t kept = 0;
+            double gpuTime = 0.0;
+            for(int i = 0; i < 3; i++) { // first run builds the programs
+                glFinish();
+                t0 = Clock::now();
+                if(mode == GLVoxelGrid::Mode::MaxIntensity) {
+                    kept = grid.decimate(input, inputIntensities, voxelSize, output);
+                }
+                else {
+                    kept = grid.decimate(input, voxelSize, output, mode);
+                }
+                glFinish();
+                gpuTime = elapsed_ms(t0);
+            }
+            cout << "    gpu (" << mode << ") : " << gpuTime << " ms";
+            if(kept != expected.size()) {
+                cout << " voxel count mismatch (" << kept << ")";
+            }
+            cout << endl;
+        }
+
+        grid.decimate(input, voxelSize, output);
+        std::vector<GLMesh::Point> firstPoints(output.size());
+        output.copy_to(firstPoints.data());
+        for(size_t i = 0; i < firstPoints.size(); i++) {
+            if(firstPoints[i].x != expected[i].x || firstPoints[i].y != expected[i].y
+               || firstPoints[i].z != expected[i].z) {
+                cout << "    gpu (first) output differs from cpu at point " << i << endl;
+                break;
+            }
+        }
+    }
+
+    auto renderer = display.create_renderer<PointCloudRenderer>(display.view());
+    renderer->points().set_data(points.size(), points.data());
+    renderer->add_attribute("intensity", GLVector<float>(intensities));
+    renderer->set_active_attribute("intensity");
+    renderer->set_adaptive_size();
+    renderer->set_point_budget(1000000);
+    display.draw();
+    cout << "displaying " << renderer->drawn_point_count() << " / " << points.size()
+         << " points (voxel size : " << renderer->decimation_voxel_size() << ")" << endl;
+
+    while(!display.should_close()) {
+        display.draw();
+    }
+
+    return 0;
+}
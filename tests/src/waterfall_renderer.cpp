@@ -0,0 +1,55 @@
+#include <iostream>
+#include <thread>
+#include <cmath>
+using namespace std;
+
+#include <rtac_display/Display.h>
+#include <rtac_display/renderers/WaterfallRenderer.h>
+using namespace rtac::display;
+
+// Simulated ping : a target moving across the beams at a slowly varying range.
+std::vector<float> make_ping(unsigned int nBeams, unsigned int nRanges, unsigned int index)
+{
+    std::vector<float> data(nBeams*nRanges);
+    float beam  = 0.5f + 0.4f*std::sin(0.02f*index);
+    float range = 0.5f + 0.3f*std::sin(0.013f*index);
+    for(unsigned int r = 0; r < nRanges; r++) {
+        for(unsigned int b = 0; b < nBeams; b++) {
+            float db = ((float)b) / (nBeams  - 1) - beam;
+            float dr = ((float)r) / (nRanges - 1) - range;
+            data[nBeams*r + b] = std::exp(-(db*db + dr*dr) / 0.001f)
+                               + 0.1f*((index*7919 + 31*r + b) % 17) / 17.0f;
+        }
+    }
+    return data;
+}
+
+int main()
+{
+    unsigned int nBeams = 128, nRanges = 256;
+
+    Display display(1200, 600);
+
+    auto fan = display.create_renderer<WaterfallRenderer>(View::New(), 64);
+    fan->set_geometry_degrees({-65,65}, {0,20});
+    fan->set_value_range({0.0f, 1.0f});
+    fan->set_decay(0.85f, 16);
+
+    Display waterfallDisplay(display.context());
+    auto waterfall = waterfallDisplay.create_renderer<WaterfallRenderer>(View::New(), 256);
+    waterfall->set_mode(WaterfallRenderer::Mode::Waterfall);
+    waterfall->set_value_range({0.0f, 1.0f});
+
+    unsigned int index = 0;
+    while(!display.should_close() && !waterfallDisplay.should_close()) {
+        auto ping = make_ping(nBeams, nRanges, index++);
+        fan->push_ping({nBeams, nRanges}, ping.data(), false);
+        waterfall->set_waterfall_bearing(0.5f + 0.4f*std::sin(0.02f*index));
+        waterfall->push_ping({nBeams, nRanges}, ping.data(), false);
+
+        display.draw();
+        waterfallDisplay.draw();
+        this_thread::sleep_for(20ms);
+    }
+    return 0;
+}